@@ -19,6 +19,8 @@
 #include "IasAvbStream.hpp"
 #include "IasLocalAudioBuffer.hpp"
 #include "IasLocalAudioStream.hpp"
+#include <arpa/inet.h>
+#include <cstring>
 #include <fstream>
 #include <mutex>
 
@@ -75,6 +77,7 @@ class IasAvbAudioStream : public IasAvbStream, public virtual IasLocalAudioStrea
     // implementation mandated through base class
     virtual bool writeToAvbPacket(IasAvbPacket* packet, uint64_t nextWindowStart);
     virtual void readFromAvbPacket(const void* packet, size_t length);
+    virtual void readFromAvbPackets(const RxPacket* packets, size_t count);
     virtual void derivedCleanup();
 
     // overrides
@@ -120,6 +123,12 @@ class IasAvbAudioStream : public IasAvbStream, public virtual IasLocalAudioStrea
     ///
     IasAvbProcessingResult prepareAllPackets();
     bool resetTime(uint64_t nextWindowStart);
+    // writes the per-packet fields of the AVTP header, the rest comes from the packet template
+    inline void writeAvtpHeader(uint8_t* avtpBase8, uint32_t timestamp, bool uncertain, uint16_t numChannels,
+        uint8_t layout, uint16_t streamDataLength);
+    void updateHeaderFormat(uint16_t numChannels, uint8_t layout, uint16_t streamDataLength);
+    // mLock has to be held, localStreamLocked tells whether the local stream has been locked by the caller already
+    void readFromAvbPacketLocked(const void* packet, size_t length, bool localStreamLocked);
     static uint8_t getSampleFrequencyCode(uint32_t sampleFrequency);
     IasAvbCompatibility getCompatibilityModeAudio();
 
@@ -173,6 +182,13 @@ class IasAvbAudioStream : public IasAvbStream, public virtual IasLocalAudioStrea
     bool                  mFirstRun;
     bool                  mBTMEnable;
     uint64_t              mMasterTimeUpdateMinInterval;
+    uint32_t                mHeaderCommon;        // first word of the AVTP header, sequence number, tv and tu cleared
+    uint64_t                mHeaderFormat;        // format specific block of the AVTP header, as in the packet
+    uint16_t                mHeaderNumChannels;
+    uint16_t                mHeaderDataLength;
+    uint8_t                 mHeaderLayout;
+    bool                  mHeaderFormatValid;
+    bool                  mSparseTimestamps;
 
     static uint32_t sampleRateTable[];
 };
@@ -236,6 +252,65 @@ class IasAvbAudioFormatTraits<IasAvbAudioFormat::eIasAvbAudioFormatSafFloat>
     static const uint8_t  cFormatCode = 1u;
 };
 
+/**
+ * @brief layout of the AVTP header of the SAF/AAF formats, offsets relative to the subtype field
+ *
+ * The transmit path keeps the header of a stream in three parts: the first word containing the
+ * fields changing with every packet (sequence number, tv and tu), the stream ID written once by the
+ * packet template and the time stamp, and the format specific block up to the payload, which only
+ * changes if the channel count, the layout or the packet size does.
+ */
+class IasAvbAafHeaderLayout
+{
+  public:
+    static const uint16_t cCommonOffset = 0u;      ///< subtype|sv,version,mr,rs,gv,tv|sequence_num|tu
+    static const uint16_t cTimestampOffset = 12u;  ///< avtp_timestamp
+    static const uint16_t cFormatOffset = 16u;     ///< format up to packet info and reserved field
+    static const uint16_t cFormatSize = 8u;
+    static const uint32_t cSeqNumShift = 8u;       ///< position of sequence_num in the first word, host order
+    static const uint32_t cTvMask = 0x00010000u;   ///< tv bit in the first word, host order
+    static const uint32_t cTuMask = 0x00000001u;   ///< tu bit in the first word, host order
+};
+
+// the format block has to end where the payload starts
+static_assert(IasAvbAafHeaderLayout::cFormatOffset + IasAvbAafHeaderLayout::cFormatSize ==
+    IasAvbAudioFormatTraits<IasAvbAudioFormat::eIasAvbAudioFormatSaf16>::cHeaderSize, "AAF header layout");
+static_assert(IasAvbAafHeaderLayout::cFormatOffset + IasAvbAafHeaderLayout::cFormatSize ==
+    IasAvbAudioFormatTraits<IasAvbAudioFormat::eIasAvbAudioFormatSaf24>::cHeaderSize, "AAF header layout");
+static_assert(IasAvbAafHeaderLayout::cFormatOffset + IasAvbAafHeaderLayout::cFormatSize ==
+    IasAvbAudioFormatTraits<IasAvbAudioFormat::eIasAvbAudioFormatSaf32>::cHeaderSize, "AAF header layout");
+static_assert(IasAvbAafHeaderLayout::cFormatOffset + IasAvbAafHeaderLayout::cFormatSize ==
+    IasAvbAudioFormatTraits<IasAvbAudioFormat::eIasAvbAudioFormatSafFloat>::cHeaderSize, "AAF header layout");
+static_assert(sizeof(uint64_t) == IasAvbAafHeaderLayout::cFormatSize, "AAF header layout");
+
+inline void IasAvbAudioStream::writeAvtpHeader(uint8_t* avtpBase8, uint32_t timestamp, bool uncertain,
+    uint16_t numChannels, uint8_t layout, uint16_t streamDataLength)
+{
+  if (!mHeaderFormatValid || (numChannels != mHeaderNumChannels) || (layout != mHeaderLayout)
+      || (streamDataLength != mHeaderDataLength))
+  {
+    updateHeaderFormat(numChannels, layout, streamDataLength);
+  }
+
+  uint32_t common = mHeaderCommon | (uint32_t(mSeqNum) << IasAvbAafHeaderLayout::cSeqNumShift);
+  if (mSparseTimestamps && (0u == (mSeqNum % 8u)))
+  {
+    // time stamp valid on every 8th packet only
+    common |= IasAvbAafHeaderLayout::cTvMask;
+  }
+  if (uncertain)
+  {
+    common |= IasAvbAafHeaderLayout::cTuMask;
+  }
+  common = htonl(common);
+  timestamp = htonl(timestamp);
+
+  // one store each, the packet does not need to be aligned
+  (void) std::memcpy(avtpBase8 + IasAvbAafHeaderLayout::cCommonOffset, &common, sizeof common);
+  (void) std::memcpy(avtpBase8 + IasAvbAafHeaderLayout::cTimestampOffset, &timestamp, sizeof timestamp);
+  (void) std::memcpy(avtpBase8 + IasAvbAafHeaderLayout::cFormatOffset, &mHeaderFormat, sizeof mHeaderFormat);
+}
+
 template <IasAvbAudioFormat F>
 inline uint16_t getAvtpAudioPduSize(const uint16_t numSamples)
 {
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file    IasAvbCreditShaper.hpp
+ * @brief   The definition of the IasAvbCreditShaper class.
+ * @details Software implementation of the IEEE 802.1Q credit-based shaper (802.1Qav), used by the
+ *          transmit sequencer when the packets are not sent through the i210 Qav queues.
+ * @date    2018
+ */
+
+#ifndef IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBCREDITSHAPER_HPP
+#define IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBCREDITSHAPER_HPP
+
+#include "IasAvbTypes.hpp"
+
+namespace IasMediaTransportAvb {
+
+/**
+ * @brief credit-based shaper of one SR class, computing the launch times of its frames
+ *
+ * The shaper follows the credit rules of IEEE 802.1Q clause 8.6.8.2:
+ * - while a frame is waiting, the credit increases at idleSlope, limited to hiCredit
+ * - while a frame is sent, the credit decreases at sendSlope = idleSlope - portTransmitRate
+ * - a frame may start when the credit is >= 0
+ * - when the queue runs empty, positive credit is dropped and negative credit recovers up to 0
+ *
+ * Instead of a queue, the shaper sees the frames one by one in launch time order. shape() returns
+ * the time the frame is allowed to start, which is never before the time it was queued. All credit
+ * values are in bits, slopes and rates in bit/s, frame sizes in bytes as seen on the wire.
+ *
+ * Not thread-safe, the shaper is owned by the TX thread of the sequencer.
+ */
+class IasAvbCreditShaper
+{
+  public:
+
+    /// @brief shaper parameters, see calculate()
+    struct Config
+    {
+      uint64_t  portTransmitRate;   ///< bit/s
+      uint64_t  idleSlope;          ///< bit/s, 0 disables the shaper
+      double    hiCredit;           ///< bits
+      double    loCredit;           ///< bits, <= 0
+    };
+
+    /**
+     *  @brief Constructor.
+     */
+    IasAvbCreditShaper();
+
+    /**
+     *  @brief Destructor, virtual by default.
+     */
+    virtual ~IasAvbCreditShaper();
+
+    /**
+     * @brief computes the shaper parameters according to IEEE 802.1Q Annex L
+     *
+     * hiCredit of the highest class: maxInterferenceSize * idleSlope / portTransmitRate
+     * hiCredit of the next class:    idleSlope * (maxInterferenceSize / (portTransmitRate - idleSlopeHigh)
+     *                                             + maxFrameSizeHigh / portTransmitRate)
+     * loCredit:                      maxFrameSize * sendSlope / portTransmitRate
+     *
+     * @param[out] config             the resulting parameters
+     * @param[in] portTransmitRate    link speed in bit/s
+     * @param[in] idleSlope           reserved bandwidth of the class in bit/s, 0 disables the shaper
+     * @param[in] maxFrameSize        largest frame of the class in bytes
+     * @param[in] maxInterferenceSize largest frame of lower priority traffic in bytes
+     * @param[in] idleSlopeHigh       idleSlope of the next higher SR class, 0 if this is the highest class
+     * @param[in] maxFrameSizeHigh    largest frame of the next higher SR class in bytes
+     * @returns eIasAvbProcOK on success, eIasAvbProcInvalidParam if the bandwidth exceeds the link speed
+     */
+    static IasAvbProcessingResult calculate(Config &config, uint64_t portTransmitRate, uint64_t idleSlope,
+        uint32_t maxFrameSize, uint32_t maxInterferenceSize, uint64_t idleSlopeHigh, uint32_t maxFrameSizeHigh);
+
+    /**
+     * @brief applies new parameters, starts over with zero credit
+     */
+    void configure(const Config &config);
+
+    /**
+     * @brief starts over with zero credit, e.g. after a time warp
+     */
+    void reset();
+
+    /**
+     * @brief returns the launch time of the next frame and charges its transmission
+     *
+     * @param[in] queued     time the frame is handed to the shaper (its requested launch time) in ns
+     * @param[in] earliest   time in ns the frame cannot be sent before for other reasons, e.g. interfering traffic
+     * @param[in] frameSize  size of the frame on the wire in bytes
+     * @returns the launch time in ns, queued if the shaper is disabled
+     */
+    uint64_t shape(uint64_t queued, uint64_t earliest, uint32_t frameSize);
+
+    inline bool isEnabled() const { return (0u != mConfig.idleSlope); }
+
+    inline double getCredit() const { return mCredit; }
+
+    inline const Config& getConfig() const { return mConfig; }
+
+  private:
+    /**
+     * @brief Copy constructor, private unimplemented to prevent misuse.
+     */
+    IasAvbCreditShaper(IasAvbCreditShaper const &other);
+
+    /**
+     * @brief Assignment operator, private unimplemented to prevent misuse.
+     */
+    IasAvbCreditShaper& operator=(IasAvbCreditShaper const &other);
+
+    Config      mConfig;
+    double      mCredit;        // credit at mCreditTime
+    uint64_t    mCreditTime;    // end of the last transmission, 0 after reset
+};
+
+} // namespace IasMediaTransportAvb
+
+#endif /* IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBCREDITSHAPER_HPP */
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file    IasAvbHeapPacketAllocator.hpp
+ * @brief   The definition of the IasAvbHeapPacketAllocator class.
+ * @details Packet memory allocator taking the pages from the heap.
+ * @date    2018
+ */
+
+#ifndef IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBHEAPPACKETALLOCATOR_HPP
+#define IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBHEAPPACKETALLOCATOR_HPP
+
+#include "avb_streamhandler/IasAvbPacketAllocator.hpp"
+
+namespace IasMediaTransportAvb {
+
+/**
+ * @brief allocator of page aligned heap memory
+ *
+ * Selected with packetpool.allocator "heap", the default without igb device if the "socket" or "memory"
+ * transmit backend is used. The kernel copies the frames when they are sent, so any memory will do.
+ */
+class IasAvbHeapPacketAllocator : public IasAvbPacketAllocator
+{
+  public:
+    /**
+     *  @brief Constructor.
+     */
+    IasAvbHeapPacketAllocator();
+
+    /**
+     *  @brief Destructor, virtual by default.
+     */
+    virtual ~IasAvbHeapPacketAllocator();
+
+    //{@
+    /// @brief IasAvbPacketAllocator implementation
+    virtual IasAvbProcessingResult allocPage(size_t minSize, Page &page);
+    virtual void freePage(Page &page);
+    virtual bool isDmaCapable() const { return false; }
+    //@}
+
+  private:
+    /**
+     *  @brief Copy constructor, private unimplemented to prevent misuse.
+     */
+    IasAvbHeapPacketAllocator(IasAvbHeapPacketAllocator const &other);
+
+    /**
+     *  @brief Assignment operator, private unimplemented to prevent misuse.
+     */
+    IasAvbHeapPacketAllocator& operator=(IasAvbHeapPacketAllocator const &other);
+};
+
+} // namespace IasMediaTransportAvb
+
+#endif /* IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBHEAPPACKETALLOCATOR_HPP */
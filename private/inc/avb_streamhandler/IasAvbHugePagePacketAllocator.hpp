@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file    IasAvbHugePagePacketAllocator.hpp
+ * @brief   The definition of the IasAvbHugePagePacketAllocator class.
+ * @details Packet memory allocator mapping locked huge pages.
+ * @date    2018
+ */
+
+#ifndef IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBHUGEPAGEPACKETALLOCATOR_HPP
+#define IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBHUGEPAGEPACKETALLOCATOR_HPP
+
+#include "avb_streamhandler/IasAvbPacketAllocator.hpp"
+#include <dlt/dlt_cpp_extension.hpp>
+
+namespace IasMediaTransportAvb {
+
+/**
+ * @brief allocator of locked huge pages
+ *
+ * Selected with packetpool.allocator "hugepage". The request of the pool is rounded up to a multiple of
+ * 2 MiB and mapped with MAP_HUGETLB, so all packets of a pool are covered by a single TLB entry even
+ * for the largest pools. This needs huge pages of the default size 2 MiB to be reserved, see
+ * /proc/sys/vm/nr_hugepages. Otherwise the page is mapped from normal memory, aligned to 2 MiB and
+ * advised to be backed by transparent huge pages.
+ *
+ * The memory is locked with mlock() and thus faulted in right away, by the thread creating the pool.
+ * With the default local NUMA policy, it ends up on the node of that thread. packetpool.hugepage.node
+ * places it on another node instead, e.g. the node of the network interface or of the TX sequencers.
+ * A failing mlock(), usually due to RLIMIT_MEMLOCK, is logged and the pages are faulted in by touching
+ * them.
+ *
+ * The memory cannot be used by the igb device for DMA, so the allocator is meant for the "socket" and
+ * "memory" transmit backends and for benchmarks.
+ */
+class IasAvbHugePagePacketAllocator : public IasAvbPacketAllocator
+{
+  public:
+    /**
+     *  @brief Constructor.
+     */
+    explicit IasAvbHugePagePacketAllocator(DltContext &ctx);
+
+    /**
+     *  @brief Destructor, virtual by default.
+     */
+    virtual ~IasAvbHugePagePacketAllocator();
+
+    //{@
+    /// @brief IasAvbPacketAllocator implementation
+    virtual IasAvbProcessingResult allocPage(size_t minSize, Page &page);
+    virtual void freePage(Page &page);
+    virtual bool isDmaCapable() const { return false; }
+    //@}
+
+  private:
+    static const size_t cHugePageSize = 2u * 1024u * 1024u;
+
+    /**
+     *  @brief Copy constructor, private unimplemented to prevent misuse.
+     */
+    IasAvbHugePagePacketAllocator(IasAvbHugePagePacketAllocator const &other);
+
+    /**
+     *  @brief Assignment operator, private unimplemented to prevent misuse.
+     */
+    IasAvbHugePagePacketAllocator& operator=(IasAvbHugePagePacketAllocator const &other);
+
+    /**
+     * @brief maps size bytes of normal memory aligned to cHugePageSize, NULL on failure
+     */
+    void* mapAligned(size_t size);
+
+    /**
+     * @brief sets the preferred NUMA node of the mapping
+     */
+    void bindToNode(void *mem, size_t size, uint32_t node);
+
+    DltContext  *mLog;
+};
+
+} // namespace IasMediaTransportAvb
+
+#endif /* IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBHUGEPAGEPACKETALLOCATOR_HPP */
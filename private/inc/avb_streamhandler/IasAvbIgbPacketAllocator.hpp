@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file    IasAvbIgbPacketAllocator.hpp
+ * @brief   The definition of the IasAvbIgbPacketAllocator class.
+ * @details Packet memory allocator taking DMA pages from the igb device.
+ * @date    2018
+ */
+
+#ifndef IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBIGBPACKETALLOCATOR_HPP
+#define IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBIGBPACKETALLOCATOR_HPP
+
+#include "avb_streamhandler/IasAvbPacketAllocator.hpp"
+
+namespace IasMediaTransportAvb {
+
+/**
+ * @brief allocator of igb DMA pages
+ *
+ * Selected with packetpool.allocator "igb", the default if an igb device has been created. Each page is
+ * a single system page obtained with igb_dma_malloc_page(). The device is looked up with each call, if it
+ * has been destroyed already, the pages are released along with it.
+ */
+class IasAvbIgbPacketAllocator : public IasAvbPacketAllocator
+{
+  public:
+    /**
+     *  @brief Constructor.
+     */
+    IasAvbIgbPacketAllocator();
+
+    /**
+     *  @brief Destructor, virtual by default.
+     */
+    virtual ~IasAvbIgbPacketAllocator();
+
+    //{@
+    /// @brief IasAvbPacketAllocator implementation
+    virtual IasAvbProcessingResult allocPage(size_t minSize, Page &page);
+    virtual void freePage(Page &page);
+    virtual bool isDmaCapable() const { return true; }
+    //@}
+
+  private:
+    /**
+     *  @brief Copy constructor, private unimplemented to prevent misuse.
+     */
+    IasAvbIgbPacketAllocator(IasAvbIgbPacketAllocator const &other);
+
+    /**
+     *  @brief Assignment operator, private unimplemented to prevent misuse.
+     */
+    IasAvbIgbPacketAllocator& operator=(IasAvbIgbPacketAllocator const &other);
+};
+
+} // namespace IasMediaTransportAvb
+
+#endif /* IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBIGBPACKETALLOCATOR_HPP */
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file    IasAvbIndexStack.hpp
+ * @brief   The definition of the IasAvbIndexStack class.
+ * @details Lock-free stack of indices, used as free list of the packet pool.
+ * @date    2018
+ */
+
+#ifndef IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBINDEXSTACK_HPP
+#define IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBINDEXSTACK_HPP
+
+#include "IasAvbTypes.hpp"
+#include <atomic>
+
+namespace IasMediaTransportAvb {
+
+/**
+ * @brief fixed-capacity lock-free multi producer multi consumer stack of the indices 0 .. capacity - 1
+ *
+ * A Treiber stack linking the indices through an array: the head word holds the index on top in the
+ * lower 32 bits and a tag in the upper 32 bits, which is incremented with each change of the head, so
+ * a thread that has been preempted between reading the head and swapping it cannot succeed on a head
+ * that has been popped and pushed again meanwhile (ABA). Each index can be on the stack only once,
+ * push() refuses an index that is already there, so returning a packet twice cannot corrupt the list.
+ *
+ * push() and pop() neither block nor allocate memory. The most recently pushed index is popped first,
+ * which keeps the buffers in use hot in the cache. init(), cleanup(), clear() and the traversal with
+ * top()/next() must not be called while other threads push or pop.
+ */
+class IasAvbIndexStack
+{
+  public:
+    static const uint32_t cNone = 0xFFFFFFFFu;  ///< end of the list, returned by top() and next()
+
+    /**
+     *  @brief Constructor.
+     */
+    IasAvbIndexStack();
+
+    /**
+     *  @brief Destructor, virtual by default.
+     */
+    virtual ~IasAvbIndexStack();
+
+    /**
+     * @brief allocates the link array, the stack is empty afterwards
+     *
+     * @param[in] capacity  number of indices, must be > 0 and < cNone
+     * @returns eIasAvbProcOK on success, otherwise an error code
+     */
+    IasAvbProcessingResult init(uint32_t capacity);
+
+    /**
+     * @brief frees the link array, the stack has no capacity afterwards
+     */
+    void cleanup();
+
+    /**
+     * @brief removes all indices
+     */
+    void clear();
+
+    inline uint32_t getCapacity() const { return mCapacity; }
+
+    /**
+     * @brief returns the number of indices on the stack, only exact while no other thread pushes or pops
+     */
+    inline uint32_t size() const { return mCount.load(std::memory_order_acquire); }
+
+    inline bool empty() const { return (0u == size()); }
+
+    /**
+     * @brief puts an index on top of the stack
+     *
+     * @returns false if the index is out of range or already on the stack
+     */
+    bool push(uint32_t index);
+
+    /**
+     * @brief takes the index on top of the stack
+     *
+     * @returns false if the stack is empty
+     */
+    bool pop(uint32_t &index);
+
+    //@{
+    /// @brief traversal from the top, cNone at the end of the list
+    inline uint32_t top() const { return uint32_t(mHead.load(std::memory_order_acquire)); }
+    inline uint32_t next(uint32_t index) const { return mNext[index].load(std::memory_order_relaxed); }
+    //@}
+
+  private:
+    static const uint32_t cCacheLineSize = 64u;
+
+    /**
+     * @brief Copy constructor, private unimplemented to prevent misuse.
+     */
+    IasAvbIndexStack(IasAvbIndexStack const &other);
+
+    /**
+     * @brief Assignment operator, private unimplemented to prevent misuse.
+     */
+    IasAvbIndexStack& operator=(IasAvbIndexStack const &other);
+
+    std::atomic<uint32_t>  *mNext;        // index below each index on the stack
+    std::atomic<bool>      *mOnStack;
+    uint32_t                mCapacity;
+    uint8_t                 mPad0[cCacheLineSize];
+    std::atomic<uint64_t>   mHead;        // tag << 32 | index on top
+    std::atomic<uint32_t>   mCount;
+};
+
+} // namespace IasMediaTransportAvb
+
+#endif /* IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBINDEXSTACK_HPP */
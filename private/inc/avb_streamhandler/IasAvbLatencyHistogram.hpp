@@ -0,0 +1,246 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file    IasAvbLatencyHistogram.hpp
+ * @brief   The definition of the IasAvbLatencyHistogram class.
+ * @details Fixed size log-linear latency histogram, used to keep per stream latency statistics
+ *          on the receive path without allocating memory.
+ * @date    2018
+ */
+
+#ifndef IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBLATENCYHISTOGRAM_HPP
+#define IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBLATENCYHISTOGRAM_HPP
+
+#include "IasAvbTypes.hpp"
+#include <atomic>
+
+namespace IasMediaTransportAvb {
+
+/**
+ * @brief log-linear latency histogram
+ *
+ * Values are given in ns. Values below 2 * cSubBuckets are counted exactly, above that each power of
+ * two is split into cSubBuckets buckets of equal width, so the relative error of a bucket is below
+ * 1 / cSubBuckets. Values above cMaxValue are counted in the last bucket, negative values are counted
+ * separately and rank below all others. Minimum, maximum and mean are tracked exactly.
+ *
+ * All memory is part of the object, record() is cheap enough for the packet path. There is a single
+ * writer calling record(), reset() and merge(). Other threads must not access the samples directly,
+ * but use snapshot() and requestReset(): record() marks its updates with a sequence counter, so
+ * snapshot() can retry until it got a consistent copy, and a reset is carried out by the writer on
+ * its next record().
+ */
+class IasAvbLatencyHistogram
+{
+  public:
+    static const uint32_t cSubBucketBits = 5u;
+    static const uint32_t cSubBuckets = 1u << cSubBucketBits;
+    static const uint32_t cValueBits = 32u;
+    static const uint32_t cNumBuckets = (cValueBits - cSubBucketBits + 1u) * cSubBuckets;
+    static const uint64_t cMaxValue = (uint64_t(1u) << cValueBits) - 1u;
+
+    /**
+     *  @brief Constructor.
+     */
+    IasAvbLatencyHistogram();
+
+    /**
+     *  @brief Destructor, virtual by default.
+     */
+    virtual ~IasAvbLatencyHistogram();
+
+    /**
+     * @brief Copy constructor, copies the samples of a histogram not being written to
+     */
+    IasAvbLatencyHistogram(const IasAvbLatencyHistogram &other);
+
+    /**
+     * @brief Assignment operator, copies the samples of a histogram not being written to
+     */
+    IasAvbLatencyHistogram& operator=(const IasAvbLatencyHistogram &other);
+
+    /**
+     * @brief removes all samples, writer only
+     */
+    void reset();
+
+    /**
+     * @brief copies the samples while the writer might be recording
+     *
+     * If a reset has been requested but not carried out yet, the copy is empty.
+     *
+     * @param[out] copy  receives the samples
+     */
+    void snapshot(IasAvbLatencyHistogram &copy) const;
+
+    /**
+     * @brief lets the writer remove all samples before it records the next one
+     */
+    void requestReset();
+
+    /**
+     * @brief adds all samples of another histogram
+     */
+    void merge(const IasAvbLatencyHistogram &other);
+
+    /**
+     * @brief adds a sample
+     *
+     * @param[in] value  latency in ns
+     */
+    inline void record(int64_t value);
+
+    /**
+     * @brief returns the value below or at which the given percentage of samples lies
+     *
+     * The upper bound of the bucket is returned, i.e. the result is never lower than the exact
+     * percentile, but it is limited to the maximum recorded value. If the percentile falls into the
+     * negative samples, the minimum is returned.
+     *
+     * @param[in] percentile  0.0 .. 100.0
+     * @returns the value in ns, 0 if the histogram is empty
+     */
+    int64_t getValueAtPercentile(double percentile) const;
+
+    /**
+     * @brief returns the number of samples
+     */
+    inline uint64_t getCount() const { return mCount; }
+
+    /**
+     * @brief returns the number of negative samples
+     */
+    inline uint64_t getNegativeCount() const { return mNegativeCount; }
+
+    /**
+     * @brief returns the number of samples above cMaxValue
+     */
+    inline uint64_t getOverflowCount() const { return mOverflowCount; }
+
+    /**
+     * @brief returns the smallest sample, 0 if the histogram is empty
+     */
+    inline int64_t getMin() const { return (0u == mCount) ? 0 : mMin; }
+
+    /**
+     * @brief returns the largest sample, 0 if the histogram is empty
+     */
+    inline int64_t getMax() const { return (0u == mCount) ? 0 : mMax; }
+
+    /**
+     * @brief returns the mean of all samples, 0 if the histogram is empty
+     */
+    inline int64_t getMean() const { return (0u == mCount) ? 0 : (mSum / int64_t(mCount)); }
+
+    /**
+     * @brief returns the number of samples counted in a bucket
+     */
+    inline uint64_t getBucketCount(uint32_t index) const { return (index < cNumBuckets) ? mBuckets[index] : 0u; }
+
+    /**
+     * @brief returns the index of the bucket a non-negative value is counted in
+     */
+    static inline uint32_t getBucketIndex(uint64_t value);
+
+    /**
+     * @brief returns the smallest value counted in a bucket
+     */
+    static uint64_t getBucketLowerBound(uint32_t index);
+
+    /**
+     * @brief returns the largest value counted in a bucket
+     */
+    static uint64_t getBucketUpperBound(uint32_t index);
+
+  private:
+    /**
+     * @brief copies the samples, but not the state shared with other threads
+     */
+    void copySamples(const IasAvbLatencyHistogram &other);
+
+    std::atomic<uint32_t> mSequence;      // odd while record() is changing the samples
+    std::atomic<bool>     mResetRequest;
+    uint64_t  mCount;
+    uint64_t  mNegativeCount;
+    uint64_t  mOverflowCount;
+    int64_t   mMin;
+    int64_t   mMax;
+    int64_t   mSum;
+    uint64_t  mBuckets[cNumBuckets];
+};
+
+
+inline uint32_t IasAvbLatencyHistogram::getBucketIndex(uint64_t value)
+{
+  uint32_t index;
+
+  if (value < (2u * cSubBuckets))
+  {
+    index = uint32_t(value);
+  }
+  else
+  {
+    if (value > cMaxValue)
+    {
+      value = cMaxValue;
+    }
+    // position of the highest bit set, minus the bits resolved within the power of two
+    const uint32_t shift = uint32_t(63 - __builtin_clzll(value)) - cSubBucketBits;
+    index = shift * cSubBuckets + uint32_t(value >> shift);
+  }
+
+  return index;
+}
+
+
+inline void IasAvbLatencyHistogram::record(int64_t value)
+{
+  const uint32_t sequence = mSequence.load(std::memory_order_relaxed);
+  mSequence.store(sequence + 1u, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  if (mResetRequest.load(std::memory_order_relaxed))
+  {
+    mResetRequest.store(false, std::memory_order_relaxed);
+    reset();
+  }
+
+  if (0u == mCount)
+  {
+    mMin = value;
+    mMax = value;
+  }
+  else if (value < mMin)
+  {
+    mMin = value;
+  }
+  else if (value > mMax)
+  {
+    mMax = value;
+  }
+
+  mCount++;
+  mSum += value;
+
+  if (value < 0)
+  {
+    mNegativeCount++;
+  }
+  else
+  {
+    if (uint64_t(value) > cMaxValue)
+    {
+      mOverflowCount++;
+    }
+    mBuckets[getBucketIndex(uint64_t(value))]++;
+  }
+
+  mSequence.store(sequence + 2u, std::memory_order_release);
+}
+
+} // namespace IasMediaTransportAvb
+
+#endif /* IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBLATENCYHISTOGRAM_HPP */
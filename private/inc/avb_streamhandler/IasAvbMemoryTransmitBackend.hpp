@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file    IasAvbMemoryTransmitBackend.hpp
+ * @brief   The definition of the IasAvbMemoryTransmitBackend class.
+ * @details Transmit backend recording the packets in memory instead of sending them, used to simulate
+ *          the TX path on the virtual clock of the PTP proxy.
+ * @date    2018
+ */
+
+#ifndef IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBMEMORYTRANSMITBACKEND_HPP
+#define IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBMEMORYTRANSMITBACKEND_HPP
+
+#include "avb_streamhandler/IasAvbTransmitBackend.hpp"
+#include <vector>
+#include <dlt/dlt_cpp_extension.hpp>
+
+namespace IasMediaTransportAvb {
+
+class IasAvbStream;
+
+/**
+ * @brief in-memory transmit backend
+ *
+ * Selected with transmit.backend "memory". Each packet handed over is counted and, up to the number
+ * given by transmit.memory.records, recorded with its launch time and stream, the oldest records being
+ * overwritten. The packets are returned to their pool with the next call of reclaimPackets(), as if the
+ * frames had been sent.
+ *
+ * Together with the virtual clock of the PTP proxy (ptp.virtual), a TX schedule of many minutes runs
+ * within seconds and always produces the same packet sequence, so the ordering and the bandwidth of each
+ * SR class can be checked without a network interface.
+ *
+ * The statistics and records are owned by the sequencer thread, read them only while the sequencer is stopped.
+ */
+class IasAvbMemoryTransmitBackend : public IasAvbTransmitBackend
+{
+  public:
+    /// @brief a packet handed over for transmission
+    struct Record
+    {
+      uint64_t            attime;   ///< launch time in ns
+      const IasAvbStream *stream;   ///< stream the packet belongs to
+      uint32_t            length;   ///< frame size in bytes, without FCS
+    };
+
+    /// @brief totals of all packets handed over since init()
+    struct Stats
+    {
+      uint64_t  packets;
+      uint64_t  bytes;
+      uint64_t  reordered;      ///< packets launched before the previous one
+      uint64_t  late;           ///< packets handed over after their launch time
+      uint64_t  firstLaunch;    ///< launch time of the first packet in ns
+      uint64_t  lastLaunch;     ///< launch time of the last packet in ns
+    };
+
+    /**
+     *  @brief Constructor.
+     */
+    explicit IasAvbMemoryTransmitBackend(DltContext &ctx);
+
+    /**
+     *  @brief Destructor, virtual by default.
+     */
+    virtual ~IasAvbMemoryTransmitBackend();
+
+    //{@
+    /// @brief IasAvbTransmitBackend implementation
+    virtual IasAvbProcessingResult init(uint32_t queueIndex, IasAvbSrClass qavClass);
+    virtual void cleanup();
+    virtual int32_t xmit(IasAvbPacket *packet);
+    virtual uint32_t reclaimPackets();
+    //@}
+
+    inline const Stats& getStats() const { return mStats; }
+
+    /**
+     * @brief copies the records kept, oldest first
+     */
+    void getRecords(std::vector<Record> &records) const;
+
+  private:
+    static const uint32_t cSentReserve = 256u;
+    static const uint64_t cDefaultRecords = 65536u;
+
+    /**
+     *  @brief Copy constructor, private unimplemented to prevent misuse.
+     */
+    IasAvbMemoryTransmitBackend(IasAvbMemoryTransmitBackend const &other);
+
+    /**
+     *  @brief Assignment operator, private unimplemented to prevent misuse.
+     */
+    IasAvbMemoryTransmitBackend& operator=(IasAvbMemoryTransmitBackend const &other);
+
+    bool                         mInitialized;
+    std::vector<IasAvbPacket*>   mSent;
+    std::vector<Record>          mRecords;
+    size_t                       mNextRecord;    // index of the next record to overwrite once mRecords is full
+    size_t                       mMaxRecords;
+    Stats                        mStats;
+    DltContext                  *mLog;
+};
+
+} // namespace IasMediaTransportAvb
+
+#endif /* IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBMEMORYTRANSMITBACKEND_HPP */
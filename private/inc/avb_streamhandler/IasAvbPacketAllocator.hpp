@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file    IasAvbPacketAllocator.hpp
+ * @brief   Interface of the allocators providing the packet memory of the packet pools.
+ * @details This is a pure virtual interface class. The allocator of a pool is selected with the
+ *          packetpool.allocator registry key.
+ * @date    2018
+ */
+
+#ifndef IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBPACKETALLOCATOR_HPP
+#define IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBPACKETALLOCATOR_HPP
+
+#include "IasAvbTypes.hpp"
+#include <dlt/dlt_cpp_extension.hpp>
+
+extern "C"
+{
+  #include "igb.h"
+}
+
+namespace IasMediaTransportAvb {
+
+/**
+ * @brief interface of a packet memory allocator
+ *
+ * The pool asks for pages until all its packets are placed, each packet being assigned a section of a
+ * page. A page is described by the igb_dma_alloc structure known from libigb, so the packets can be
+ * handed over to libigb as they are if the memory has been obtained from the igb device.
+ */
+class IasAvbPacketAllocator
+{
+  public:
+    typedef igb_dma_alloc Page;
+
+    /**
+     * @brief Destructor, virtual by default.
+     */
+    virtual ~IasAvbPacketAllocator() {}
+
+    /**
+     * @brief Allocates a page of zeroed memory.
+     *
+     * The page returned may be smaller than requested, e.g. the igb device always hands out single
+     * system pages. The pool asks for further pages then.
+     *
+     * @param[in]  minSize  number of bytes still needed by the pool
+     * @param[out] page     virtual address, size and, if isDmaCapable(), bus address of the page
+     * @returns eIasAvbProcOK on success, otherwise an error code
+     */
+    virtual IasAvbProcessingResult allocPage(size_t minSize, Page &page) = 0;
+
+    /**
+     * @brief Releases a page obtained with allocPage().
+     */
+    virtual void freePage(Page &page) = 0;
+
+    /**
+     * @brief Returns true if the pages can be handed over to the igb device for DMA.
+     */
+    virtual bool isDmaCapable() const = 0;
+
+    /**
+     * @brief Creates the allocator selected with packetpool.allocator.
+     *
+     * Without the key, the igb allocator is used if there is an igb device or libigb is the transmit
+     * path, the heap allocator otherwise.
+     *
+     * @param[in]  log        context used for logging, by the allocator as well
+     * @param[out] allocator  the new allocator, to be deleted by the caller
+     * @returns eIasAvbProcOK on success, otherwise an error code
+     */
+    static IasAvbProcessingResult create(DltContext &log, IasAvbPacketAllocator *&allocator);
+
+  protected:
+    //@{
+    /// can only be created through implementation class
+    IasAvbPacketAllocator() {}
+    //@}
+};
+
+} // namespace IasMediaTransportAvb
+
+#endif /* IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBPACKETALLOCATOR_HPP */
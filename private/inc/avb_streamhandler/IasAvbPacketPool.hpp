@@ -16,9 +16,12 @@
 #include "IasAvbPacket.hpp"
 #include "IasAvbTypes.hpp"
 #include "IasAvbStreamHandlerEnvironment.hpp"
+#include "IasAvbIndexStack.hpp"
+#include "IasAvbPacketAllocator.hpp"
+#include <atomic>
+#include <mutex>
 #include <vector>
 #include <linux/if_ether.h>
-#include <mutex>
 
 extern "C"
 {
@@ -29,6 +32,24 @@ extern "C"
 namespace IasMediaTransportAvb
 {
 
+class IasAvbStream;
+class IasAvbPacketSlab;
+
+/**
+ * @brief pool of the packets of a stream
+ *
+ * The packet memory is obtained from the allocator selected with packetpool.allocator, by default DMA
+ * pages of the igb device or, for the "socket" and "memory" transmit backends, pages of the heap.
+ * getPacket() and returnPacket() are lock-free, so the TX sequencer, the igb reclaim and the receive
+ * path can share a pool without blocking each other. The free packets are kept on a stack of their
+ * indices into the packet array.
+ *
+ * reset(), initAllPacketsFromTemplate(), attachMemory() and releaseMemory() are serialized by a mutex
+ * and cope with packets being got and returned meanwhile, e.g. by the igb reclaim of another sequencer
+ * sharing the device queue. Only initAllPacketsFromTemplate() needs the stream to be inactive, as it
+ * walks the free stack. init() and cleanup() must not be called while other threads get or return
+ * packets.
+ */
 class IasAvbPacketPool
 {
   public:
@@ -57,6 +78,43 @@ class IasAvbPacketPool
     inline uint32_t getPoolSize() const;
     IasAvbProcessingResult reset();
 
+    /**
+     * @brief borrows the memory of the packets beyond the reservation from the shared packet slab
+     *
+     * Called when the stream is activated. Without slab, all packets have their memory from the start
+     * and nothing is done. If the slab is short of pages, the pool continues with less packets.
+     */
+    IasAvbProcessingResult attachMemory();
+
+    /**
+     * @brief gives the pages of the packets beyond the reservation back to the shared packet slab
+     *
+     * Called when the stream is deactivated. Pages holding packets still in use are kept until the next
+     * call or the destruction of the pool.
+     */
+    void releaseMemory();
+
+    /**
+     * @brief returns the number of packets having memory, less than the pool size while using the slab
+     */
+    inline uint32_t getPacketCount() const;
+
+    /**
+     * @brief sets the stream transmitting the packets of the pool, used to attribute TX time stamps
+     */
+    inline void setOwner(IasAvbStream *owner);
+
+    /**
+     * @brief returns the stream transmitting the packets of the pool, NULL if not set
+     */
+    inline IasAvbStream* getOwner() const;
+
+    /**
+     * @brief returns the stream transmitting a packet, NULL if unknown
+     */
+    inline static IasAvbStream* getPacketOwner(igb_packet* packet);
+    inline static IasAvbStream* getPacketOwner(const IasAvbPacket* packet);
+
   private:
     /**
      * @brief Copy constructor, private unimplemented to prevent misuse.
@@ -70,13 +128,13 @@ class IasAvbPacketPool
 
   private:
     // Local Types
-    typedef igb_dma_alloc Page;
-    typedef std::vector<IasAvbPacket*> PacketStack;
+    typedef IasAvbPacketAllocator::Page Page;
     typedef std::vector<Page*> PageList;
 
     // Constants
 
     static const uint32_t cMaxPoolSize = 2048u;                // derived from max TX ring size / 2
+    static const uint32_t cDefaultSlabReserve = 32u;           // packets guaranteed per pool with the shared slab
 #if defined(DIRECT_RX_DMA)
     static const size_t cMaxBufferSize = 2048u;              // fixed value by libigb
 #else
@@ -84,17 +142,30 @@ class IasAvbPacketPool
 #endif /* DIRECT_RX_DMA */
 
     // helpers
+    IasAvbProcessingResult initOwnPages();
+    IasAvbProcessingResult initSlabPages();
+    bool attachSlabPage(const uint32_t pageIdx);
     IasAvbProcessingResult initPage(Page * page, const uint32_t packetsPerPage, uint32_t & packetCountTotal);
     IasAvbProcessingResult doReturnPacket(IasAvbPacket* packet);
 
     // Members
     DltContext *mLog;
-    std::mutex mLock;
+    std::mutex mLock;                     // serializes the operations changing the pool, not getPacket()/returnPacket()
     size_t mPacketSize;
     uint32_t mPoolSize;
-    PacketStack mFreeBufferStack;
+    IasAvbIndexStack mFreeBufferStack;  // indices into mBase of the free packets
     IasAvbPacket* mBase;
     PageList mDmaPages;
+    IasAvbPacketAllocator* mAllocator;
+    IasAvbPacketSlab* mSlab;             // shared packet memory, NULL if the pool has its own pages
+    std::vector<Page> mSlabPages;         // pages borrowed from the slab, dma_vaddr NULL if not borrowed
+    uint32_t mPacketsPerPage;
+    uint32_t mReservedPages;
+    uint32_t mBorrowedPages;
+    std::atomic<uint32_t> mPacketCount;   // packets having memory
+    IasAvbPacket mTemplate;               // applied to the packets of pages borrowed later
+    std::vector<uint8_t> mTemplateData;
+    IasAvbStream* mOwner;
 };
 
 
@@ -114,6 +185,39 @@ inline uint32_t IasAvbPacketPool::getPoolSize() const
   return mPoolSize;
 }
 
+inline uint32_t IasAvbPacketPool::getPacketCount() const
+{
+  return mPacketCount;
+}
+
+inline void IasAvbPacketPool::setOwner(IasAvbStream *owner)
+{
+  mOwner = owner;
+}
+
+inline IasAvbStream* IasAvbPacketPool::getOwner() const
+{
+  return mOwner;
+}
+
+inline IasAvbStream* IasAvbPacketPool::getPacketOwner(igb_packet* packet)
+{
+  // simply downcast - probing will be done in the called function
+  return getPacketOwner(static_cast<const IasAvbPacket*>(packet));
+}
+
+inline IasAvbStream* IasAvbPacketPool::getPacketOwner(const IasAvbPacket* packet)
+{
+  IasAvbStream* owner = NULL;
+
+  if ((NULL != packet) && packet->isValid() && (NULL != packet->getHomePool()))
+  {
+    owner = packet->getHomePool()->getOwner();
+  }
+
+  return owner;
+}
+
 inline IasAvbPacket* IasAvbPacketPool::getDummyPacket()
 {
   IasAvbPacket* ret = getPacket();
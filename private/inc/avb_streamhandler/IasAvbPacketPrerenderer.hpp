@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file    IasAvbPacketPrerenderer.hpp
+ * @brief   The definition of the IasAvbPacketPrerenderer class.
+ * @details Worker thread rendering the packets of transmit streams ahead of time, so the transmit
+ *          sequencer only has to pick up ready packets.
+ * @date    2018
+ */
+
+#ifndef IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBPACKETPRERENDERER_HPP
+#define IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBPACKETPRERENDERER_HPP
+
+#include "IasAvbTypes.hpp"
+#include "IasAvbSpscQueue.hpp"
+#include "avb_helper/IasThread.hpp"
+#include "avb_helper/IasIRunnable.hpp"
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <string>
+
+namespace IasMediaTransportAvb {
+
+class IasAvbStream;
+class IasAvbPacket;
+
+/**
+ * @brief render worker of the transmit sequencer
+ *
+ * The worker wakes up once per period and calls IasAvbStream::preparePacket() for each of its streams
+ * until the stream has delivered all packets with a launch time up to "now + lead time", or its queue
+ * is full. The packets are handed over to the sequencer by a lock-free SPSC queue per stream
+ * (a Slot), the worker being the producer and the sequencer thread the consumer.
+ *
+ * When the sequencer resets a stream, the packets already rendered belong to the old timeline. flush()
+ * advances the generation of the slot and drops the queued packets; packets the worker tagged with
+ * an older generation while the reset was going on are dropped by fetchPacket(). As the sequence
+ * numbers are assigned by fetchPacket(), the dropped packets leave no gap in them.
+ *
+ * attach() and detach() are meant for the control path. The worker holds mLock only to take a snapshot
+ * of the slots, detach() waits for a render pass using that snapshot to end.
+ */
+class IasAvbPacketPrerenderer : private IasMediaTransportAvb::IasIRunnable
+{
+  public:
+
+    /// @brief a pre-rendered packet along with the slot generation it was rendered for
+    struct Rendered
+    {
+      IasAvbPacket  *packet;
+      uint32_t       generation;
+    };
+
+    /// @brief per stream state shared by worker and sequencer
+    struct Slot
+    {
+      Slot();
+
+      IasAvbStream               *stream;
+      IasAvbSpscQueue<Rendered>   queue;
+      std::atomic<uint32_t>       generation;          // advanced by the sequencer on stream reset
+      uint32_t                    renderedGeneration;  // worker only
+      uint64_t                    renderedUntil;       // worker only, launch time of the last packet rendered
+      uint32_t                    depth;               // number of packets rendered ahead at most
+      uint8_t                     sequence;            // sequencer only, sequence_num of the next packet fetched
+      bool                        sequenceValid;       // sequencer only, false until the first packet is fetched
+    };
+
+    /**
+     *  @brief Constructor.
+     */
+    explicit IasAvbPacketPrerenderer(DltContext &ctx);
+
+    /**
+     *  @brief Destructor, virtual by default.
+     */
+    virtual ~IasAvbPacketPrerenderer();
+
+    /**
+     * @brief Allocates internal resources and initializes instance.
+     *
+     * @param[in] name       name of the worker thread
+     * @param[in] leadTime   time in ns the packets are rendered ahead of their launch time
+     * @param[in] period     time in ns between two render passes
+     * @param[in] queueSize  number of packets that can be rendered ahead per stream
+     * @returns eIasAvbProcOK on success, otherwise an error will be returned.
+     */
+    IasAvbProcessingResult init(const std::string &name, uint64_t leadTime, uint64_t period, uint32_t queueSize);
+
+    /**
+     *  @brief Clean up all allocated resources, all slots must have been detached.
+     */
+    void cleanup();
+
+    /**
+     * @brief Starts the worker thread.
+     *
+     * @returns eIasAvbProcOK on success, otherwise an error will be returned.
+     */
+    IasAvbProcessingResult start();
+
+    /**
+     * @brief Stops the worker thread.
+     *
+     * @returns eIasAvbProcOK on success, otherwise an error will be returned.
+     */
+    IasAvbProcessingResult stop();
+
+    /**
+     * @brief starts rendering the packets of a stream
+     *
+     * @returns the slot to fetch the packets from, NULL if out of memory or if the stream's packet pool
+     *          is smaller than the configured queue size
+     */
+    Slot* attach(IasAvbStream *stream);
+
+    /**
+     * @brief stops rendering the packets of a stream, returns the rendered packets to their pool and deletes the slot
+     */
+    void detach(Slot *slot);
+
+    /**
+     * @brief returns the number of attached streams
+     */
+    uint32_t getNumSlots();
+
+    /**
+     * @brief returns the next rendered packet of the slot, sequencer only
+     *
+     * Sets the sequence_num of the packet, continuing that of the first packet fetched from the slot.
+     *
+     * @returns NULL if no packet is ready
+     */
+    IasAvbPacket* fetchPacket(Slot &slot);
+
+    /**
+     * @brief drops all packets rendered so far, to be called by the sequencer after it has reset the stream
+     */
+    void flush(Slot &slot);
+
+  private:
+    static const uint32_t cMaxQueueSize = 65536u;  ///< upper limit for the number of packets rendered ahead
+
+    /**
+     * @brief Copy constructor, private unimplemented to prevent misuse.
+     */
+    IasAvbPacketPrerenderer(IasAvbPacketPrerenderer const &other);
+
+    /**
+     * @brief Assignment operator, private unimplemented to prevent misuse.
+     */
+    IasAvbPacketPrerenderer& operator=(IasAvbPacketPrerenderer const &other);
+
+    //{@
+    /// @brief IasRunnable implementation
+    virtual IasResult beforeRun();
+    virtual IasResult run();
+    virtual IasResult shutDown();
+    virtual IasResult afterRun();
+    //@}
+
+    /**
+     * @brief renders the packets of one stream up to now + lead time
+     */
+    void render(Slot &slot, uint64_t now);
+
+    /**
+     * @brief returns all queued packets to their pool
+     */
+    void drain(Slot &slot);
+
+    inline bool isInitialized() const { return (NULL != mThread); }
+
+    IasThread             *mThread;
+    volatile bool          mEndThread;
+    uint64_t               mLeadTime;
+    uint64_t               mPeriod;
+    uint32_t               mQueueSize;
+    std::vector<Slot*>     mSlots;
+    std::vector<Slot*>     mRenderSlots; // worker only, snapshot of mSlots taken for a render pass
+    std::atomic<uint32_t>  mPassEpoch;  // incremented at begin and end of a render pass, odd while rendering
+    std::mutex             mLock;       // protects mSlots, held by the worker only to take its snapshot
+    DltContext            *mLog;
+};
+
+} // namespace IasMediaTransportAvb
+
+#endif /* IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBPACKETPRERENDERER_HPP */
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file    IasAvbPacketSlab.hpp
+ * @brief   The definition of the IasAvbPacketSlab class.
+ * @details Packet memory shared by the packet pools of all transmit streams.
+ * @date    2018
+ */
+
+#ifndef IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBPACKETSLAB_HPP
+#define IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBPACKETSLAB_HPP
+
+#include "avb_streamhandler/IasAvbPacketAllocator.hpp"
+#include <mutex>
+#include <vector>
+#include <dlt/dlt_cpp_extension.hpp>
+
+namespace IasMediaTransportAvb {
+
+/**
+ * @brief fixed amount of packet memory lent to the packet pools page by page
+ *
+ * Created by the environment if packetpool.slab.size is set. The memory is obtained from the allocator
+ * selected with packetpool.allocator when the slab is initialized and split into pages of cPageSize
+ * bytes, each of which is lent to one pool at a time. The pool places as many packets into a page as
+ * fit, so pools of any packet size share the same pages.
+ *
+ * A pool reserves the pages it needs at least when it is created. The slab refuses a reservation if
+ * there are not enough pages left that are neither lent nor reserved, so a reserved page is always
+ * available when the pool asks for it. Beyond its reservation, a pool can borrow any page that is
+ * neither borrowed by another pool nor needed to honor the reservation of another pool. The pools of
+ * the transmit streams keep the reserved pages and borrow the remainder of their size when the stream
+ * is activated, giving it back when the stream is deactivated, so the memory needed scales with the
+ * number of active streams.
+ *
+ * All methods are thread-safe. They lock the slab and are meant for the control path only.
+ */
+class IasAvbPacketSlab
+{
+  public:
+    typedef IasAvbPacketAllocator::Page Page;
+
+    static const uint32_t cPageSize = 4096u;   ///< size of the pages lent to the pools in bytes
+
+    /**
+     *  @brief Constructor.
+     */
+    explicit IasAvbPacketSlab(DltContext &ctx);
+
+    /**
+     *  @brief Destructor, virtual by default.
+     */
+    virtual ~IasAvbPacketSlab();
+
+    /**
+     * @brief allocates the memory of the slab
+     *
+     * @param[in] size  size in bytes, rounded up to a multiple of cPageSize
+     * @returns eIasAvbProcOK on success, otherwise an error code
+     */
+    IasAvbProcessingResult init(size_t size);
+
+    /**
+     * @brief releases the memory, all pages have to be returned before
+     */
+    void cleanup();
+
+    inline bool isDmaCapable() const { return (NULL != mAllocator) && mAllocator->isDmaCapable(); }
+
+    inline uint32_t getPageCount() const { return mPageCount; }
+
+    /**
+     * @brief returns the number of pages not lent to any pool
+     */
+    uint32_t getFreePageCount();
+
+    /**
+     * @brief returns the sum of all reservations in pages
+     */
+    uint32_t getReservedPageCount();
+
+    /**
+     * @brief reserves pages for a pool
+     *
+     * @returns eIasAvbProcNotEnoughMemory if the reservation cannot be guaranteed
+     */
+    IasAvbProcessingResult reserve(uint32_t pages);
+
+    /**
+     * @brief cancels a reservation, the pages of the pool have to be returned before
+     */
+    void unreserve(uint32_t pages);
+
+    /**
+     * @brief lends a page to a pool
+     *
+     * @param[in]     reserved  number of pages reserved by the pool
+     * @param[in,out] borrowed  number of pages lent to the pool, incremented on success
+     * @param[out]    page      the page
+     * @returns false if there is no page the pool may borrow
+     */
+    bool borrowPage(uint32_t reserved, uint32_t &borrowed, Page &page);
+
+    /**
+     * @brief takes back a page lent with borrowPage()
+     *
+     * @param[in]     reserved  number of pages reserved by the pool
+     * @param[in,out] borrowed  number of pages lent to the pool, decremented
+     * @param[in]     page      the page
+     */
+    void returnPage(uint32_t reserved, uint32_t &borrowed, const Page &page);
+
+  private:
+    typedef std::vector<Page*> PageList;
+
+    /**
+     *  @brief Copy constructor, private unimplemented to prevent misuse.
+     */
+    IasAvbPacketSlab(IasAvbPacketSlab const &other);
+
+    /**
+     *  @brief Assignment operator, private unimplemented to prevent misuse.
+     */
+    IasAvbPacketSlab& operator=(IasAvbPacketSlab const &other);
+
+    std::mutex              mLock;
+    IasAvbPacketAllocator  *mAllocator;
+    PageList                mChunks;          // memory obtained from the allocator
+    std::vector<Page>       mFreePages;
+    uint32_t                mPageCount;
+    uint32_t                mReserved;        // sum of all reservations
+    uint32_t                mReservedInUse;   // reserved pages lent to their pools
+    DltContext             *mLog;
+};
+
+} // namespace IasMediaTransportAvb
+
+#endif /* IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBPACKETSLAB_HPP */
@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file    IasAvbPcapFile.hpp
+ * @brief   The definition of the IasAvbPcapFile class.
+ * @details Minimal reader and writer for Ethernet capture files in the classic pcap format,
+ *          used to replay recorded traffic into the receive engine and to record what it received.
+ * @date    2018
+ */
+
+#ifndef IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBPCAPFILE_HPP
+#define IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBPCAPFILE_HPP
+
+#include "IasAvbTypes.hpp"
+#include <cstdio>
+#include <mutex>
+#include <string>
+
+namespace IasMediaTransportAvb {
+
+/**
+ * @brief pcap capture file
+ *
+ * Files are read in microsecond or nanosecond resolution and in either byte order, files are
+ * written in nanosecond resolution and host byte order. Only the Ethernet link type is supported.
+ * Time stamps are passed in ns, their time base is up to the user.
+ *
+ * Writing is thread-safe, reading is not.
+ */
+class IasAvbPcapFile
+{
+  public:
+    static const uint32_t cSnapLength = 65535u;
+
+    /**
+     *  @brief Constructor.
+     */
+    IasAvbPcapFile();
+
+    /**
+     *  @brief Destructor, virtual by default. Closes the file.
+     */
+    virtual ~IasAvbPcapFile();
+
+    /**
+     * @brief opens a capture file for reading
+     *
+     * @returns eIasAvbProcOK on success
+     * @returns eIasAvbProcInitializationFailed if the file cannot be opened or a file is open already
+     * @returns eIasAvbProcUnsupportedFormat if it is not a pcap file of Ethernet frames
+     */
+    IasAvbProcessingResult openRead(const std::string &fileName);
+
+    /**
+     * @brief creates a capture file, an existing file is overwritten
+     *
+     * @returns eIasAvbProcOK on success
+     * @returns eIasAvbProcInitializationFailed if the file cannot be created or a file is open already
+     */
+    IasAvbProcessingResult openWrite(const std::string &fileName);
+
+    /**
+     * @brief closes the file, if any
+     */
+    void close();
+
+    /**
+     * @brief reads the next frame
+     *
+     * Frames larger than the buffer are truncated.
+     *
+     * @param[in]  buffer      receives the frame
+     * @param[in]  bufferSize  size of the buffer in bytes
+     * @param[out] length      number of bytes stored in the buffer
+     * @param[out] timestamp   capture time in ns
+     * @returns eIasAvbProcOK on success
+     * @returns eIasAvbProcOff at the end of the file
+     * @returns eIasAvbProcErr if the file ends within a frame
+     * @returns eIasAvbProcNotInitialized if no file has been opened for reading
+     */
+    IasAvbProcessingResult readFrame(uint8_t *buffer, size_t bufferSize, size_t &length, uint64_t &timestamp);
+
+    /**
+     * @brief appends a frame
+     *
+     * @param[in] frame      the frame, starting with the Ethernet header
+     * @param[in] length     length of the frame in bytes, at most cSnapLength bytes are stored
+     * @param[in] timestamp  capture time in ns
+     * @returns eIasAvbProcOK on success
+     * @returns eIasAvbProcNoSpaceLeft if the frame could not be written
+     * @returns eIasAvbProcNotInitialized if no file has been opened for writing
+     */
+    IasAvbProcessingResult writeFrame(const uint8_t *frame, size_t length, uint64_t timestamp);
+
+    /**
+     * @brief returns true if a file is open
+     */
+    inline bool isOpen() const { return (NULL != mFile); }
+
+    /**
+     * @brief returns the number of frames read or written since the file was opened
+     */
+    inline uint64_t getNumFrames() const { return mNumFrames; }
+
+  private:
+    struct FileHeader
+    {
+      uint32_t magic;
+      uint16_t versionMajor;
+      uint16_t versionMinor;
+      int32_t  thisZone;
+      uint32_t sigFigs;
+      uint32_t snapLength;
+      uint32_t linkType;
+    };
+
+    struct RecordHeader
+    {
+      uint32_t tsSec;
+      uint32_t tsFraction;  // us or ns, see FileHeader::magic
+      uint32_t capturedLength;
+      uint32_t originalLength;
+    };
+
+    /**
+     *  @brief Copy constructor, private unimplemented to prevent misuse.
+     */
+    IasAvbPcapFile(IasAvbPcapFile const &other);
+
+    /**
+     *  @brief Assignment operator, private unimplemented to prevent misuse.
+     */
+    IasAvbPcapFile& operator=(IasAvbPcapFile const &other);
+
+    inline uint32_t toHost(uint32_t val) const { return mSwapped ? __builtin_bswap32(val) : val; }
+
+    FILE*      mFile;
+    bool       mWriting;
+    bool       mSwapped;       // file has been written in the other byte order
+    bool       mNanoseconds;   // time stamp fraction in ns rather than us
+    uint64_t   mNumFrames;
+    std::mutex mLock;          // serializes writers
+};
+
+} // namespace IasMediaTransportAvb
+
+#endif /* IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBPCAPFILE_HPP */
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file    IasAvbPcapRecorder.hpp
+ * @brief   The definition of the IasAvbPcapRecorder class.
+ * @details Records the frames of several receive workers to a pcap file without file I/O on their threads.
+ * @date    2018
+ */
+
+#ifndef IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBPCAPRECORDER_HPP
+#define IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBPCAPRECORDER_HPP
+
+#include "IasAvbTypes.hpp"
+#include "IasAvbPcapFile.hpp"
+#include "IasAvbSpscQueue.hpp"
+#include "avb_helper/IasThread.hpp"
+#include "avb_helper/IasIRunnable.hpp"
+#include <string>
+#include <vector>
+#include <dlt/dlt_cpp_extension.hpp>
+
+namespace IasMediaTransportAvb {
+
+/**
+ * @brief asynchronous pcap writer
+ *
+ * Each producer (a receive worker) has a lane of preallocated frame records. record() copies the frame
+ * into a free record and queues it, a writer thread appends the queued records to the file once per
+ * cWritePeriod. Free and queued records are passed between producer and writer by two lock-free SPSC
+ * queues per lane, so record() neither blocks nor allocates. If a lane runs out of free records, the
+ * frame is not recorded and counted as dropped.
+ *
+ * The file holds the frames of a lane in order; the frames of different lanes are interleaved in the
+ * order the writer picks them up, so their time stamps are not necessarily ascending.
+ */
+class IasAvbPcapRecorder : private IasMediaTransportAvb::IasIRunnable
+{
+  public:
+    static const uint32_t cMaxFrameLength = 1522u;      ///< frames are truncated to this length, VLAN tag included
+    static const uint64_t cWritePeriod = 1000000u;      ///< ns between two passes of the writer thread
+
+    /**
+     *  @brief Constructor.
+     */
+    explicit IasAvbPcapRecorder(DltContext &ctx);
+
+    /**
+     *  @brief Destructor, virtual by default.
+     */
+    virtual ~IasAvbPcapRecorder();
+
+    /**
+     * @brief creates the capture file and starts the writer thread
+     *
+     * @param[in] fileName      name of the capture file, an existing file is overwritten
+     * @param[in] numProducers  number of threads calling record(), each with its own index
+     * @param[in] numRecords    number of frames a producer can have queued
+     * @returns eIasAvbProcOK on success, otherwise an error code
+     */
+    IasAvbProcessingResult init(const std::string &fileName, uint32_t numProducers, uint32_t numRecords);
+
+    /**
+     * @brief stops the writer thread after it has written all queued frames and closes the file
+     *
+     * No producer may call record() anymore.
+     */
+    void cleanup();
+
+    /**
+     * @brief queues a frame for recording, producer thread only
+     *
+     * @param[in] producer   index of the calling producer, < numProducers
+     * @param[in] frame      the frame, starting with the Ethernet header
+     * @param[in] length     length of the frame in bytes
+     * @param[in] timestamp  capture time in ns
+     * @returns false if the frame has been dropped
+     */
+    bool record(uint32_t producer, const uint8_t *frame, size_t length, uint64_t timestamp);
+
+    /**
+     * @brief returns the number of frames written to the file so far
+     */
+    inline uint64_t getNumFrames() const { return mFile.getNumFrames(); }
+
+    /**
+     * @brief returns the number of frames dropped since construction, exact once the producers have stopped
+     */
+    uint64_t getNumDropped() const;
+
+  private:
+    struct Record
+    {
+      uint64_t timestamp;
+      uint32_t length;                   // length of the frame as passed to record()
+      uint8_t  data[cMaxFrameLength];
+    };
+
+    struct Lane
+    {
+      Lane();
+
+      Record                   *records;
+      IasAvbSpscQueue<Record*>  free;     // producer: writer, consumer: lane owner
+      IasAvbSpscQueue<Record*>  queued;   // producer: lane owner, consumer: writer
+      uint64_t                  dropped;  // lane owner only
+    };
+
+    /**
+     * @brief Copy constructor, private unimplemented to prevent misuse.
+     */
+    IasAvbPcapRecorder(IasAvbPcapRecorder const &other);
+
+    /**
+     * @brief Assignment operator, private unimplemented to prevent misuse.
+     */
+    IasAvbPcapRecorder& operator=(IasAvbPcapRecorder const &other);
+
+    //{@
+    /// @brief IasRunnable implementation
+    virtual IasResult beforeRun();
+    virtual IasResult run();
+    virtual IasResult shutDown();
+    virtual IasResult afterRun();
+    //@}
+
+    /**
+     * @brief writes all queued records to the file and hands them back to their lanes
+     */
+    void writeQueued();
+
+    IasThread             *mThread;
+    volatile bool          mEndThread;
+    IasAvbPcapFile         mFile;
+    std::vector<Lane*>     mLanes;
+    uint64_t               mNumDropped;  // frames dropped by the lanes deleted so far
+    DltContext            *mLog;
+};
+
+} // namespace IasMediaTransportAvb
+
+#endif /* IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBPCAPRECORDER_HPP */
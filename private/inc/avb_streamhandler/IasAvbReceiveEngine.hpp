@@ -19,10 +19,16 @@
 #include "avb_helper/IasThread.hpp"
 #include "avb_streamhandler/IasAvbStream.hpp"
 #include "avb_streamhandler/IasAvbStreamHandlerEnvironment.hpp"
+#include "avb_streamhandler/IasAvbTimerWheel.hpp"
+#include "avb_streamhandler/IasAvbPcapFile.hpp"
+#include "avb_streamhandler/IasAvbPcapRecorder.hpp"
 #include "avb_watchdog/IasWatchdogInterface.hpp"
 #include "avb_helper/IasIRunnable.hpp"
 #include <mutex>
+#include <atomic>
+#include <vector>
 #include <linux/if_ether.h>
+#include <linux/filter.h>
 
 namespace IasMediaTransportAvb {
 
@@ -230,6 +236,19 @@ class IasAvbReceiveEngine : private IasMediaTransportAvb::IasIRunnable
     bool getAvbStreamInfo(const IasAvbStreamId &id, AudioStreamInfoList &audioStreamInfo,
                           VideoStreamInfoList &videoStreamInfo, ClockReferenceStreamInfoList &clockRefStreamInfo) const;
 
+    /**
+     * @brief Copies the latency histograms of a receive stream.
+     *
+     * @param[in] id of the stream.
+     * @param[out] presentationLatency AVTP presentation time minus arrival time of the received packets.
+     * @param[out] dispatchLatency time from arrival until the packets have been handed to the stream.
+     * @param[in] reset if 'true', the histograms of the stream are cleared after they have been copied.
+     *
+     * @returns 'true' if the stream has been found, otherwise 'false'.
+     */
+    bool getStreamLatency(const IasAvbStreamId &id, IasAvbLatencyHistogram &presentationLatency,
+                          IasAvbLatencyHistogram &dispatchLatency, bool reset);
+
     /**
      *  @brief shutdown IGB in an emergency
      */
@@ -240,12 +259,108 @@ class IasAvbReceiveEngine : private IasMediaTransportAvb::IasIRunnable
     struct StreamData
     {
       IasAvbStream* stream;
-      IasAvbStreamState lastState;
+      IasAvbStreamState lastState;  // written by the serving worker under mStatusLock only
       uint64_t lastTimeDispatched;
+      uint32_t worker;              // index of the receive worker serving the stream
     };
 
     typedef std::map<IasAvbStreamId, StreamData> AvbStreamMap;
 
+    /**
+     * @brief immutable snapshot of mAvbStreams used by the receive workers for lock-free lookup
+     *
+     * The control thread builds a new table whenever the set of streams changes and publishes it
+     * by swapping mStreamTable. A published table is never modified. The entries point into the
+     * nodes of mAvbStreams, so a node must not be erased before a table without it has been
+     * published and all workers have left their read sections.
+     */
+    struct StreamTable
+    {
+      struct Entry
+      {
+        uint64_t    streamId;
+        StreamData *data;       // NULL marks an empty slot
+      };
+
+      std::vector<Entry>       slots;     // open addressing with linear probing, size is a power of two
+      std::vector<StreamData*> streams;   // all streams in map order
+      StreamData              *wildcard;  // stream registered with the wildcard id 0, if any
+      uint64_t                 generation; // incremented with every published table, starts at 1
+    };
+
+    struct RxStatistics
+    {
+      uint32_t packetsReceived;     // AVTP frames seen during the current log interval
+      uint32_t packetsDispatched;
+      uint32_t packetsDiscarded;
+      uint32_t packetsValid;
+      int32_t  timeDiffMin;
+      int32_t  timeDiffMax;
+      int64_t  timeDiffAcc;
+      uint64_t framesTotal;         // frames handed to processFrame() since start
+      uint64_t syscallsTotal;       // select/recvfrom calls since start
+      uint64_t framesMisrouted;     // frames of streams served by another worker since start
+      uint32_t wakeups;             // returns from select/epoll_wait/nanosleep during the current log interval
+      uint64_t wakeupsTotal;        // returns from select/epoll_wait/nanosleep since start
+      uint64_t latencyMin;          // kernel rx timestamp to dispatch, ns (ring mode only)
+      uint64_t latencyMax;
+      uint64_t latencyAcc;
+      uint64_t latencyCount;
+      uint64_t latencyAccTotal;     // latencyAcc and latencyCount since start
+      uint64_t latencyCountTotal;
+    };
+
+    /**
+     * @brief state of one receive worker thread
+     *
+     * Worker 0 always exists and runs on mReceiveThread; its socket is also used to manage the
+     * multicast memberships. In sharded mode (see IasRegKeys::cRxWorkers) the additional workers
+     * run on their own threads, each stream being served by exactly one worker (StreamData::worker).
+     */
+    class RxWorker : public IasIRunnable
+    {
+      public:
+        RxWorker();
+        virtual ~RxWorker();
+
+        virtual IasResult beforeRun();
+        virtual IasResult run();
+        virtual IasResult shutDown();
+        virtual IasResult afterRun();
+
+        IasAvbReceiveEngine   *engine;
+        uint32_t               index;
+        int32_t                cpu;             // CPU the thread is pinned to, -1 if not pinned
+        IasThread             *thread;          // NULL for worker 0, which runs on mReceiveThread
+        int32_t                socket;
+        uint8_t               *buffer;
+        RxStatistics           stats;
+        std::atomic<uint32_t>  readerEpoch;     // odd while the worker is in a read section
+        IasAvbTimerWheel       timeouts;        // stream timeouts, keyed by stream id
+        uint64_t               timeoutGeneration; // generation of the table the wheel was filled from
+        std::vector<uint64_t>  expiredStreams;  // scratch buffer for checkStreamTimeouts()
+        std::vector<IasAvbStream::RxPacket> burst; // consecutive packets of burstStream not dispatched yet
+        StreamData            *burstStream;
+        const uint8_t         *burstSmac;       // source MAC of the last packet of the burst
+        const StreamTable     *readTable;       // table of the read section kept open while a burst is pending
+        uint32_t               bufferSlot;      // slot of buffer the next frame is received into
+#if !defined(DIRECT_RX_DMA)
+        uint8_t               *ring;
+        uint32_t               ringBlockIndex;  // next block to inspect
+        int32_t                epollFd;         // event mode only, see IasRegKeys::cRxWakeup
+        int32_t                timerFd;         // armed to the next stream timeout deadline
+        int64_t                realToLocal;     // CLOCK_REALTIME to local PTP time offset, measured per wakeup
+#endif /* !DIRECT_RX_DMA */
+
+      private:
+        RxWorker(RxWorker const &other);
+        RxWorker& operator=(RxWorker const &other);
+    };
+
+    static const uint64_t cTimeoutTickDefault = 1000000u;       // ns, resolution of the stream timeouts
+    static const uint32_t cRxBurstMax = 32u;                    // max. number of packets dispatched in one call
+    static const uint32_t cPcapRecordQueueSize = 1024u;         // frames a worker can queue for recording
+
 #if defined(DIRECT_RX_DMA)
     static const size_t cReceiveFilterDataSize = 128u;  // flexible filter maximum data length
     static const size_t cReceiveFilterMaskSize = 16u;   // flexible filter maximum mask length
@@ -271,8 +386,48 @@ class IasAvbReceiveEngine : private IasMediaTransportAvb::IasIRunnable
     };
 
     typedef std::vector<IasAvbPacket*> PacketList;
+
+    static const uint32_t cRxWorkersMax = 2u;      // one worker per AVB receive queue
+    static const size_t   cRxShardFilters = 7u;    // flex filters routing streams to eRxQueue1 (eRxFilter0..6)
+
+    /**
+     * @brief flex filter routing the frames of one DMAC to the receive queue of worker 1
+     */
+    struct RxShardFilter
+    {
+      IasAvbMacAddress dmac;
+      uint32_t refCount;    // number of streams using the filter, 0 if the filter is unused
+    };
 #else
     static const size_t cReceiveBufferSize = ETH_FRAME_LEN + 4u; // consider VLAN TAG
+    static const uint32_t cRxRingFrameSize = 2048u;               // TPACKET_V3 frame size hint (must be power of 2)
+    static const uint32_t cRxRingBlockSizeDefault = 65536u;      // bytes, multiple of the page size
+    static const uint32_t cRxRingBlockCountDefault = 16u;
+    static const uint32_t cRxRingBlockTimeoutDefault = 1u;       // ms until a partially filled block is retired
+    static const uint32_t cRxWorkersMax = 16u;
+    static const uint32_t cRxBusyPollDefault = 50u;              // us the kernel spins on the device queue
+    static const uint64_t cRxWaitMin = 1000000u;                 // ns, shortest sleep of a worker without due timeouts
+    static const size_t cRxFilterMaxInstructions = BPF_MAXINSNS;
+
+    /**
+     * @brief how a worker waits for data, see IasRegKeys::cRxWakeup
+     */
+    enum RxWakeupMode
+    {
+      eRxWakeupPoll = 0u,     // select with idle timeout plus cycleWait sleep after each batch
+      eRxWakeupEvent,         // epoll on the socket and a timerfd armed to the next stream timeout
+      eRxWakeupBusyPoll       // like eRxWakeupEvent, with SO_BUSY_POLL set on the socket
+    };
+
+    /**
+     * @brief source of the arrival time passed to the streams, see IasRegKeys::cRxTimestamping
+     */
+    enum RxTimestampMode
+    {
+      eRxTimestampOff = 0u,   // time of the wakeup, shared by all frames of a batch
+      eRxTimestampSoftware,   // kernel receive time stamp
+      eRxTimestampHardware    // NIC time stamp, falls back to the kernel time stamp if there is none
+    };
 #endif /* DIRECT_RX_DMA */
     ///
     /// Inherited from IasRunnable
@@ -324,18 +479,292 @@ class IasAvbReceiveEngine : private IasMediaTransportAvb::IasIRunnable
      */
     inline void closeSocket();
 
+    /**
+     * @brief receive loop of a worker thread
+     *
+     * @param[in] worker  the worker running the loop
+     * @returns Value indicating success or failure
+     */
+    IasResult runWorker(RxWorker &worker);
+
+    /**
+     * @brief stops all running worker threads
+     * @returns eIasAvbProcOK on success, otherwise an error will be returned.
+     */
+    IasAvbProcessingResult stopWorkers();
+
+    /**
+     * @brief parses a received Ethernet frame and hands it over to the matching AvbStream
+     *
+     * @param[in] worker  the worker that received the frame
+     * @param[in] frame   pointer to the start of the Ethernet header
+     * @param[in] length  length of the frame in bytes
+     * @param[in] now     current local PTP time
+     */
+    void processFrame(RxWorker &worker, const uint8_t* frame, size_t length, uint64_t now);
+
+    /**
+     * @brief binds the socket of a worker to the receive interface
+     *
+     * In sharded mode the socket also joins the packet fanout group of the engine.
+     *
+     * @param[in] worker  the worker owning the socket
+     * @returns eIasAvbProcOK on success, otherwise an error will be returned.
+     */
+    IasAvbProcessingResult bindWorkerSocket(RxWorker &worker);
+
+    /**
+     * @brief selects the worker serving a new stream
+     *
+     * @param[in] dmac  destination MAC address of the stream
+     * @returns the worker index
+     */
+    uint32_t selectWorker(const IasAvbMacAddress &dmac);
+
+    /**
+     * @brief releases the resources selectWorker() has reserved for a stream
+     */
+    void releaseWorker(const IasAvbStream &stream, uint32_t worker);
+
+#if defined(DIRECT_RX_DMA)
+    /**
+     * @brief returns the flex filter accepting all AVTP frames on eRxQueue0
+     *
+     * In sharded mode the DMAC filters of worker 1 take the lower filter ids, so the catch-all
+     * filter moves to the end to give them precedence.
+     */
+    inline RxFilterId getCatchAllFilter() const;
+
+    /**
+     * @brief programs or clears the flex filter routing one DMAC to eRxQueue1
+     *
+     * @param[in] idx     index into mShardFilters, equal to the flex filter id
+     * @param[in] enable  true to program the filter, false to clear it
+     */
+    void setShardFilter(size_t idx, bool enable);
+#else
+    /**
+     * @brief makes a worker socket member of the engine's PACKET_FANOUT group
+     * @returns eIasAvbProcOK on success, otherwise an error will be returned.
+     */
+    IasAvbProcessingResult joinFanoutGroup(RxWorker &worker);
+
+    /**
+     * @brief sets up a TPACKET_V3 receive ring on the socket of a worker and maps it into memory
+     * @returns eIasAvbProcOK on success, otherwise an error will be returned.
+     */
+    IasAvbProcessingResult setupReceiveRing(RxWorker &worker);
+
+    /**
+     * @brief unmaps the TPACKET_V3 receive ring of a worker
+     */
+    void releaseReceiveRing(RxWorker &worker);
+
+    /**
+     * @brief processes all blocks of the receive ring that are currently owned by user space
+     *
+     * Frames are dispatched in place without being copied.
+     *
+     * @param[in] worker  the worker owning the ring
+     * @param[in] now     current local PTP time
+     * @returns the number of frames processed
+     */
+    uint32_t receiveFromRing(RxWorker &worker, uint64_t now);
+
+    /**
+     * @brief creates the epoll instance and the timeout timer of a worker (event mode only)
+     * @returns eIasAvbProcOK on success, otherwise an error will be returned.
+     */
+    IasAvbProcessingResult setupWakeupEvents(RxWorker &worker);
+
+    /**
+     * @brief blocks until the worker's socket becomes readable or the earliest stream timeout expires
+     *
+     * Timeouts that are already due are processed first, see checkStreamTimeouts(). The worker then
+     * sleeps for at least cRxWaitMin, so a deadline in the past cannot make it spin.
+     *
+     * @param[in] worker    the waiting worker
+     * @param[in] now       current local PTP time
+     * @param[in] idleWait  stream timeout in ns
+     * @returns 1 if data is available, 0 on timeout, -1 on error
+     */
+    int32_t waitForEvent(RxWorker &worker, uint64_t now, uint64_t idleWait);
+
+    /**
+     * @brief builds a classic BPF program that only passes stream data frames of the streams in the table
+     *
+     * Frames are matched by stream id, a wildcard stream is matched by its DMAC. If that is not possible
+     * (wildcard stream without DMAC, "ignore mode", too many streams) all stream data frames pass.
+     *
+     * @param[in]  table    stream table to build the filter for, NULL for no streams at all
+     * @param[out] program  the filter instructions
+     */
+    void buildReceiveFilter(const StreamTable * table, std::vector<struct sock_filter> &program) const;
+
+    /**
+     * @brief replaces the filter of the worker sockets by one matching the given table
+     *
+     * The kernel swaps the filter atomically, so no frames are lost while streams are added or removed.
+     *
+     * @param[in] table   stream table to build the filter for
+     * @param[in] worker  the worker to update, NULL for all workers that have a socket
+     */
+    void updateReceiveFilter(const StreamTable * table, RxWorker * worker = NULL);
+
+    /**
+     * @brief feeds the frames of the replay capture to a worker, see IasRegKeys::cRxPcapReplay
+     *
+     * The frames keep their distance in time from the first frame of the capture, counted from start on
+     * the local time line, and are passed to the streams with that time stamp; the replay is therefore
+     * deterministic in both the real time and the as-fast-as-possible mode. After the end of the capture
+     * only the stream timeouts are served. Returns when the engine is stopped.
+     */
+    void runReplay(RxWorker &worker, uint64_t start, uint64_t idleWait);
+
+    /**
+     * @brief enables receive time stamps on the socket of a worker
+     *
+     * Failures are not fatal, the frames are stamped with the time of the wakeup then.
+     */
+    void setupTimestamping(RxWorker &worker);
+
+    /**
+     * @brief switches on time stamping of all received frames in the NIC, keeping its TX settings
+     * @returns true if the NIC stamps all received frames
+     */
+    bool enableHwTimestamping(int32_t fd, const std::string &ifName);
+
+    /**
+     * @brief receives a single frame
+     *
+     * @param[in]  worker  the receiving worker
+     * @param[in]  buffer  receive buffer slot of the worker, cReceiveBufferSize bytes
+     * @param[in]  now     local PTP time of the wakeup
+     * @param[out] rxTime  arrival time in local PTP time, now if the frame has no time stamp
+     * @returns length of the frame, -1 on error (see errno)
+     */
+    int32_t receiveFrame(RxWorker &worker, uint8_t* buffer, uint64_t now, uint64_t &rxTime);
+
+    /**
+     * @brief measures the offset between CLOCK_REALTIME, the clock of the kernel time stamps, and local PTP time
+     */
+    inline void updateClockOffset(RxWorker &worker, uint64_t now);
+
+    /**
+     * @brief converts a kernel (CLOCK_REALTIME) or NIC time stamp to local PTP time
+     * @returns the converted time stamp, or fallback if there is no time stamp
+     */
+    inline uint64_t toLocalTime(const RxWorker &worker, uint64_t sec, uint64_t nsec, bool hardware, uint64_t fallback) const;
+#endif /* DIRECT_RX_DMA */
+
     /**
      * @brief dispatch received packet to AvbStream
      * @returns true if packet has been marked valid by AvbStream
      */
     bool dispatchPacket(StreamData &streamData, const void* packet, size_t length, uint64_t now);
 
+    /**
+     * @brief adds a received packet to the burst of a worker
+     *
+     * Consecutive packets of the same stream are collected and dispatched in one call, see
+     * dispatchBurst(). The packet data and the source MAC must stay valid until then.
+     */
+    void queuePacket(RxWorker &worker, StreamData &streamData, const void* packet, size_t length,
+                     const uint8_t* smac, uint64_t now);
+
+    /**
+     * @brief dispatches the pending burst of a worker, keeps the read section open
+     */
+    void dispatchBurst(RxWorker &worker);
+
+    /**
+     * @brief dispatches the pending burst of a worker and leaves its read section
+     *
+     * Must be called before the frame buffers are reused and before the worker blocks.
+     */
+    void flushBurst(RxWorker &worker);
+
     /**
      * @brief checks for a change in stream status and notifies client
+     *
+     * Only called by the worker serving the stream. A change is stored and notified under mStatusLock,
+     * so the notifications of the workers are serialized and the control thread reads a consistent state.
      * @returns true if AvbStream is in valid state
      */
     bool checkStreamState(StreamData &streamData);
 
+    /**
+     * @brief returns the last notified state of a stream, for the control thread
+     */
+    inline IasAvbStreamState getLastState(const StreamData &streamData) const;
+
+    /**
+     * @brief notifies the streams of a worker that have not received data for idleWait ns
+     *
+     * The streams are tracked in the worker's timer wheel, so only the streams whose timeout
+     * expires are touched. The wheel is refilled whenever a new stream table has been published.
+     *
+     * @param[in] worker    the worker serving the streams
+     * @param[in] now       current local PTP time
+     * @param[in] idleWait  stream timeout in ns
+     */
+    void checkStreamTimeouts(RxWorker &worker, uint64_t now, uint64_t idleWait);
+
+    /**
+     * @brief builds a lookup table from mAvbStreams and publishes it to the receive workers
+     *
+     * Must be called by the control thread with mLock held. The method waits until no worker uses
+     * the previous table anymore before deleting it.
+     *
+     * @param[in] exclude  stream entry to leave out of the new table (about to be erased), or NULL
+     * @returns eIasAvbProcOK on success, eIasAvbProcNotEnoughMemory if the table could not be built.
+     *          In the latter case an empty table is published.
+     */
+    IasAvbProcessingResult publishStreamTable(const StreamData * exclude = NULL);
+
+    /**
+     * @brief turns the wildcard stream into a regular stream if a worker has asked for it
+     *
+     * A worker receiving a stream by the DMAC of the wildcard stream stores the stream ID in
+     * mRekeyStreamId and keeps serving the packets through the wildcard entry, since re-keying
+     * has to wait for the workers to release the current stream table. Called by lock().
+     */
+    void rekeyWildcard();
+
+    /**
+     * @brief looks up a stream in a published table
+     * @returns pointer to the stream entry or NULL if not found
+     */
+    static inline StreamData * findStream(const StreamTable & table, uint64_t streamId);
+
+    /**
+     * @brief returns the home slot of a stream id in a table with (mask + 1) slots
+     */
+    static inline size_t hashStreamId(uint64_t streamId, size_t mask);
+
+    /**
+     * @brief marks the start of a worker section that uses the published stream table
+     * @returns the currently published table, may be NULL
+     */
+    inline const StreamTable * enterReadSection(RxWorker &worker);
+
+    /**
+     * @brief marks the end of a worker section that uses the published stream table
+     */
+    inline void leaveReadSection(RxWorker &worker);
+
+    /**
+     * @brief waits until all workers have left the read section they might currently be in
+     */
+    void waitForReaders();
+
+    /**
+     * @brief removes a stream entry from mAvbStreams in a way that is safe for the receive workers
+     *
+     * Must be called with mLock held. The stream object itself is not deleted.
+     */
+    void eraseStream(AvbStreamMap::iterator it);
+
     /**
      * @brief checks if streamId is already in use
      * @returns eIasAvbProcOK streamId is still available
@@ -344,7 +773,7 @@ class IasAvbReceiveEngine : private IasMediaTransportAvb::IasIRunnable
     IasAvbProcessingResult checkStreamIdInUse(const IasAvbStreamId & streamId) const;
 
     /**
-     * @brief lock access to the stream list
+     * @brief lock access to the stream list, carries out a pending re-key of the wildcard stream
      */
     inline void lock();
 
@@ -385,29 +814,65 @@ class IasAvbReceiveEngine : private IasMediaTransportAvb::IasIRunnable
     bool				mEndThread;
     IasThread				*mReceiveThread;
     AvbStreamMap			mAvbStreams;
+    std::atomic<StreamTable*>		mStreamTable;   // published by the control thread, read by the workers
+    uint64_t				mStreamTableGeneration;
     std::mutex				mLock;
+    mutable std::mutex			mStatusLock;    // guards StreamData::lastState and the status notifications
+    std::atomic<uint64_t>		mRekeyStreamId; // stream ID for the wildcard stream requested by a worker, 0 if none
     IasAvbStreamHandlerEventInterface*	mEventInterface;
-    int32_t				mReceiveSocket;
-    uint8_t				*mReceiveBuffer;
+    RxWorker				mWorkers[cRxWorkersMax];
+    uint32_t				mNumWorkers;
     bool				mIgnoreStreamId;
     DltContext				*mLog;           // context for Log & Trace
     IasWatchdog::IasWatchdogInterface	*mWatchdog;
+    bool				mDiscardByPts;
+    uint32_t				mDiscardAfter;  // ns
+    uint64_t				mTimeoutTick;   // ns, resolution of the stream timeout wheels
 
 #if defined(DIRECT_RX_DMA)
     device_t         * mIgbDevice;
     IasAvbPacketPool * mRcvPacketPool;
     PacketList         mPacketList;
     bool               mRecoverIgbReceiver;
+    RxShardFilter      mShardFilters[cRxShardFilters];
+#else
+    bool               mUseRxRing;
+    uint32_t           mRxRingBlockSize;
+    uint32_t           mRxRingBlockCount;
+    uint16_t           mFanoutGroupId;
+    RxWakeupMode       mWakeupMode;
+    uint32_t           mBusyPollTime;
+    bool               mUseRxFilter;
+    RxTimestampMode    mTimestampMode;
+    IasAvbPcapFile    *mPcapReplay;    // NULL unless replaying a capture
+    bool               mReplayRealtime;
 #endif /* DIRECT_RX_DMA */
+    IasAvbPcapRecorder *mPcapRecord;   // NULL unless recording
     int32_t              mRcvPortIfIndex;
 };
 
 inline void IasAvbReceiveEngine::closeSocket()
 {
-  if (-1 != mReceiveSocket)
+  for (uint32_t i = 0u; i < cRxWorkersMax; i++)
   {
-    close(mReceiveSocket);
-    mReceiveSocket = -1;
+#if !defined(DIRECT_RX_DMA)
+    releaseReceiveRing(mWorkers[i]);
+    if (-1 != mWorkers[i].timerFd)
+    {
+      close(mWorkers[i].timerFd);
+      mWorkers[i].timerFd = -1;
+    }
+    if (-1 != mWorkers[i].epollFd)
+    {
+      close(mWorkers[i].epollFd);
+      mWorkers[i].epollFd = -1;
+    }
+#endif /* !DIRECT_RX_DMA */
+    if (-1 != mWorkers[i].socket)
+    {
+      close(mWorkers[i].socket);
+      mWorkers[i].socket = -1;
+    }
   }
 }
 
@@ -429,6 +894,82 @@ inline bool IasAvbReceiveEngine::isValidStreamId(const IasAvbStreamId & avbStrea
   return (mAvbStreams.end() != mAvbStreams.find(avbStreamId));
 }
 
+inline IasAvbReceiveEngine::StreamData * IasAvbReceiveEngine::findStream(const StreamTable & table, uint64_t streamId)
+{
+  StreamData * ret = NULL;
+
+  if (!table.slots.empty())
+  {
+    const size_t mask = table.slots.size() - 1u;
+    size_t idx = hashStreamId(streamId, mask);
+
+    // load factor is kept below 50%, so there is always an empty slot to stop at
+    while (NULL != table.slots[idx].data)
+    {
+      if (table.slots[idx].streamId == streamId)
+      {
+        ret = table.slots[idx].data;
+        break;
+      }
+      idx = (idx + 1u) & mask;
+    }
+  }
+
+  return ret;
+}
+
+inline size_t IasAvbReceiveEngine::hashStreamId(uint64_t streamId, size_t mask)
+{
+  // Fibonacci hashing, stream ids tend to differ in the low bits (unique id) only
+  return size_t((streamId * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+}
+
+inline const IasAvbReceiveEngine::StreamTable * IasAvbReceiveEngine::enterReadSection(RxWorker &worker)
+{
+  // both operations are sequentially consistent, pairing with the store/load sequence in publishStreamTable()
+  worker.readerEpoch.fetch_add(1u);
+  return mStreamTable.load();
+}
+
+inline void IasAvbReceiveEngine::leaveReadSection(RxWorker &worker)
+{
+  worker.readerEpoch.fetch_add(1u);
+}
+
+#if !defined(DIRECT_RX_DMA)
+inline void IasAvbReceiveEngine::updateClockOffset(RxWorker &worker, uint64_t now)
+{
+  struct timespec tp;
+  (void) clock_gettime(CLOCK_REALTIME, &tp);
+  worker.realToLocal = int64_t(now - (uint64_t(tp.tv_sec) * 1000000000u + uint64_t(tp.tv_nsec)));
+}
+
+inline uint64_t IasAvbReceiveEngine::toLocalTime(const RxWorker &worker, uint64_t sec, uint64_t nsec, bool hardware,
+    uint64_t fallback) const
+{
+  uint64_t ret = fallback;
+
+  if ((0u != sec) || (0u != nsec))
+  {
+    // the NIC clock is the local PTP clock
+    ret = sec * 1000000000u + nsec;
+    if (!hardware)
+    {
+      ret += uint64_t(worker.realToLocal);
+    }
+  }
+
+  return ret;
+}
+#endif /* !DIRECT_RX_DMA */
+
+#if defined(DIRECT_RX_DMA)
+inline IasAvbReceiveEngine::RxFilterId IasAvbReceiveEngine::getCatchAllFilter() const
+{
+  return (mNumWorkers > 1u) ? eRxFilter7 : eRxFilter0;
+}
+#endif /* DIRECT_RX_DMA */
+
 inline IasAvbProcessingResult IasAvbReceiveEngine::unbindMcastAddr(const IasAvbMacAddress &mCastMacAddr)
 {
   return bindMcastAddr(mCastMacAddr, false);
@@ -437,6 +978,7 @@ inline IasAvbProcessingResult IasAvbReceiveEngine::unbindMcastAddr(const IasAvbM
 inline void IasAvbReceiveEngine::lock()
 {
   mLock.lock();
+  rekeyWildcard();
 }
 
 inline void IasAvbReceiveEngine::unlock()
@@ -444,6 +986,12 @@ inline void IasAvbReceiveEngine::unlock()
   mLock.unlock();
 }
 
+inline IasAvbStreamState IasAvbReceiveEngine::getLastState(const StreamData &streamData) const
+{
+  std::lock_guard<std::mutex> guard(mStatusLock);
+  return streamData.lastState;
+}
+
 
 } // namespace IasMediaTransportAvb
 
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file    IasAvbSampleInterleaver.hpp
+ * @brief   The definition of the IasAvbSampleInterleaver class.
+ * @details Conversion of 16 bit samples between the channel buffers and the SAF16 payload.
+ * @date    2018
+ */
+
+#ifndef IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBSAMPLEINTERLEAVER_HPP
+#define IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBSAMPLEINTERLEAVER_HPP
+
+#include "IasAvbTypes.hpp"
+
+namespace IasMediaTransportAvb {
+
+/**
+ * @brief interleaving and byte swapping of 16 bit samples for the SAF16 payload
+ *
+ * The samples of the stream are held planar in host byte order, one slice of channelStride samples
+ * per channel. The payload holds them interleaved frame by frame in network byte order.
+ *
+ * There is a kernel per instruction set. The SIMD kernels transpose blocks of 8 samples (16 with
+ * AVX2) of groups of 8, 4 and 2 channels, so any channel count is covered by at most one group of 4,
+ * 2 and 1 channel besides the groups of 8. The remaining single channel is done by the scalar code.
+ * A last block of less than 8 samples, e.g. a whole class A packet at 48 kHz with 6 samples per
+ * channel, is still transposed, with one store per frame of the block. The kernel is selected once at
+ * startup according to the CPU features, all kernels produce the same output.
+ */
+class IasAvbSampleInterleaver
+{
+  public:
+    enum Isa
+    {
+      eIsaScalar = 0,
+      eIsaSse2,
+      eIsaAvx2,
+      eIsaCount
+    };
+
+    /**
+     * @brief writes numSamples frames of numChannels samples to the payload
+     *
+     * @param[out] payload        start of the payload, numChannels * numSamples * 2 bytes
+     * @param[in]  samples        channel buffers, channel n starting at samples + n * channelStride
+     * @param[in]  channelStride  distance of the channel buffers in samples
+     * @param[in]  numChannels    number of channels, which is the number of samples per frame
+     * @param[in]  numSamples     number of samples per channel
+     */
+    typedef void (*InterleaveFunc)(uint8_t *payload, const int16_t *samples, uint32_t channelStride,
+        uint32_t numChannels, uint32_t numSamples);
+
+    /**
+     * @brief reads the first numChannels channels of numSamples frames from the payload
+     *
+     * @param[out] samples        channel buffers, channel n starting at samples + n * channelStride
+     * @param[in]  channelStride  distance of the channel buffers in samples
+     * @param[in]  payload        start of the payload
+     * @param[in]  frameChannels  number of samples per frame in the payload
+     * @param[in]  numChannels    number of channels to read, <= frameChannels
+     * @param[in]  numSamples     number of samples per channel
+     */
+    typedef void (*DeinterleaveFunc)(int16_t *samples, uint32_t channelStride, const uint8_t *payload,
+        uint32_t frameChannels, uint32_t numChannels, uint32_t numSamples);
+
+    /**
+     * @brief interleaves using the kernel selected for the CPU
+     */
+    static inline void interleave(uint8_t *payload, const int16_t *samples, uint32_t channelStride,
+        uint32_t numChannels, uint32_t numSamples)
+    {
+      sInterleave(payload, samples, channelStride, numChannels, numSamples);
+    }
+
+    /**
+     * @brief deinterleaves using the kernel selected for the CPU
+     */
+    static inline void deinterleave(int16_t *samples, uint32_t channelStride, const uint8_t *payload,
+        uint32_t frameChannels, uint32_t numChannels, uint32_t numSamples)
+    {
+      sDeinterleave(samples, channelStride, payload, frameChannels, numChannels, numSamples);
+    }
+
+    /**
+     * @brief returns the instruction set of the kernels selected for the CPU
+     */
+    static inline Isa getIsa() { return sIsa; }
+
+    /**
+     * @brief returns true if the CPU supports the instruction set and the kernels have been built
+     */
+    static bool isSupported(Isa isa);
+
+    /**
+     * @brief returns the interleave kernel of an instruction set, NULL if not supported
+     */
+    static InterleaveFunc getInterleave(Isa isa);
+
+    /**
+     * @brief returns the deinterleave kernel of an instruction set, NULL if not supported
+     */
+    static DeinterleaveFunc getDeinterleave(Isa isa);
+
+  private:
+    /**
+     *  @brief Constructor, private unimplemented, there are static methods only.
+     */
+    IasAvbSampleInterleaver();
+
+    static Isa selectIsa();
+
+    static const Isa sIsa;
+    static const InterleaveFunc sInterleave;
+    static const DeinterleaveFunc sDeinterleave;
+};
+
+} // namespace IasMediaTransportAvb
+
+#endif /* IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBSAMPLEINTERLEAVER_HPP */
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file    IasAvbSocketTransmitBackend.hpp
+ * @brief   The definition of the IasAvbSocketTransmitBackend class.
+ * @details Transmit backend sending the packets over a packet socket with SO_TXTIME launch times,
+ *          so talkers can run on any network interface, including virtual ones such as veth.
+ * @date    2018
+ */
+
+#ifndef IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBSOCKETTRANSMITBACKEND_HPP
+#define IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBSOCKETTRANSMITBACKEND_HPP
+
+#include "avb_streamhandler/IasAvbTransmitBackend.hpp"
+#include <vector>
+#include <sys/socket.h>
+#include <linux/if_packet.h>
+#include <dlt/dlt_cpp_extension.hpp>
+
+namespace IasMediaTransportAvb {
+
+/**
+ * @brief packet socket transmit backend
+ *
+ * Each packet is sent with an SCM_TXTIME control message carrying its launch time converted to
+ * CLOCK_TAI, as expected by the ETF and taprio qdiscs. Without such a qdisc the launch time is
+ * ignored and the frame is sent right away. The socket priority selects the traffic class of
+ * mqprio/taprio, it defaults to the VLAN priority of the SR class.
+ *
+ * Batches are sent with a single sendmmsg() call. The kernel copies the frame when it is sent, so
+ * packets are only kept until the next call of reclaimPackets(). That call also drains the socket
+ * error queue, which reports the frames the qdisc dropped because their launch time was missed or
+ * invalid.
+ *
+ * With enableTxTimestamps(), the error queue also carries a SO_TIMESTAMPING time stamp per frame, keyed
+ * by SOF_TIMESTAMPING_OPT_ID. The hardware time stamp is used if the driver delivers one, which requires
+ * hardware time stamping to be enabled on the interface (usually done by the PTP daemon already),
+ * otherwise the software time stamp taken when the driver queued the frame.
+ */
+class IasAvbSocketTransmitBackend : public IasAvbTransmitBackend
+{
+  public:
+    /**
+     *  @brief Constructor.
+     */
+    explicit IasAvbSocketTransmitBackend(DltContext &ctx);
+
+    /**
+     *  @brief Destructor, virtual by default.
+     */
+    virtual ~IasAvbSocketTransmitBackend();
+
+    //{@
+    /// @brief IasAvbTransmitBackend implementation
+    virtual IasAvbProcessingResult init(uint32_t queueIndex, IasAvbSrClass qavClass);
+    virtual void cleanup();
+    virtual int32_t xmit(IasAvbPacket *packet);
+    virtual int32_t xmitBatch(IasAvbPacket * const *packets, uint32_t count, uint32_t &sent);
+    virtual uint32_t reclaimPackets();
+    virtual bool enableTxTimestamps();
+    virtual uint32_t getTxTimestamps(TxTimestamp *stamps, uint32_t max);
+    //@}
+
+    /**
+     * @brief returns the number of frames dropped because their launch time had passed
+     */
+    inline uint64_t getMissedCount() const { return mMissedCount; }
+
+    /**
+     * @brief returns the number of frames dropped because of an invalid launch time
+     */
+    inline uint64_t getInvalidCount() const { return mInvalidCount; }
+
+    /**
+     * @brief returns the number of time stamps dropped because getTxTimestamps() was not called often enough
+     */
+    inline uint64_t getStampOverflowCount() const { return mStampOverflowCount; }
+
+  private:
+    static const uint32_t cSentReserve = 256u;
+    static const uint32_t cMaxBatch = 64u;       ///< max number of packets per sendmmsg() call
+    static const uint32_t cMaxStamps = 1024u;    ///< max number of time stamps kept until getTxTimestamps()
+
+    /// @brief control message buffer holding the launch time
+    union TxTimeControl
+    {
+      struct cmsghdr align;
+      uint8_t buf[CMSG_SPACE(sizeof(uint64_t))];
+    };
+
+    /**
+     *  @brief Copy constructor, private unimplemented to prevent misuse.
+     */
+    IasAvbSocketTransmitBackend(IasAvbSocketTransmitBackend const &other);
+
+    /**
+     *  @brief Assignment operator, private unimplemented to prevent misuse.
+     */
+    IasAvbSocketTransmitBackend& operator=(IasAvbSocketTransmitBackend const &other);
+
+    /**
+     * @brief fills in the message to send a packet with its launch time
+     */
+    void prepareMessage(IasAvbPacket *packet, struct msghdr &msg, struct iovec &iov, TxTimeControl &control);
+
+    /**
+     * @brief maps the errno of a failed send call to the xmit() return value
+     */
+    int32_t getSendError();
+
+    /**
+     * @brief updates the offset between local time and CLOCK_TAI
+     */
+    void updateClockOffset();
+
+    /**
+     * @brief reads the socket error queue, counts the frames dropped by the qdisc and collects the time stamps
+     */
+    void readErrorQueue();
+
+    int32_t                      mSocket;
+    struct sockaddr_ll           mAddress;
+    int64_t                      mClockOffset;   // CLOCK_TAI minus local time in ns
+    int64_t                      mRealtimeOffset; // CLOCK_REALTIME minus local time in ns
+    std::vector<IasAvbPacket*>   mSent;
+    std::vector<struct mmsghdr>  mMessages;
+    std::vector<struct iovec>    mIovecs;
+    std::vector<TxTimeControl>   mControls;
+    uint64_t                     mMissedCount;
+    uint64_t                     mInvalidCount;
+    bool                         mTimestamps;
+    std::vector<TxTimestamp>     mStamps;
+    uint64_t                     mStampOverflowCount;
+    DltContext                  *mLog;
+};
+
+} // namespace IasMediaTransportAvb
+
+#endif /* IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBSOCKETTRANSMITBACKEND_HPP */
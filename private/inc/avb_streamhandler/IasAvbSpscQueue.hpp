@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file    IasAvbSpscQueue.hpp
+ * @brief   The definition of the IasAvbSpscQueue class template.
+ * @details Lock-free single producer single consumer ring buffer, used to hand over pre-rendered
+ *          packets from a render worker to the transmit sequencer.
+ * @date    2018
+ */
+
+#ifndef IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBSPSCQUEUE_HPP
+#define IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBSPSCQUEUE_HPP
+
+#include "IasAvbTypes.hpp"
+#include <atomic>
+
+namespace IasMediaTransportAvb {
+
+/**
+ * @brief fixed-capacity lock-free single producer single consumer queue
+ *
+ * The capacity is rounded up to the next power of two. push() may only be called by one thread
+ * (the producer) and pop() only by one other thread (the consumer) at a time, neither of them blocks
+ * nor allocates memory. The head and tail indices are free running and padded to separate cache lines,
+ * so producer and consumer do not write to the same line.
+ *
+ * init() and cleanup() must not be called while producer or consumer are using the queue.
+ */
+template <class T>
+class IasAvbSpscQueue
+{
+  public:
+    /**
+     *  @brief Constructor.
+     */
+    IasAvbSpscQueue();
+
+    /**
+     *  @brief Destructor, virtual by default.
+     */
+    virtual ~IasAvbSpscQueue();
+
+    /**
+     * @brief allocates the storage for the entries, the queue is empty afterwards
+     *
+     * @param[in] capacity  minimum number of entries, must be > 0 and <= 2^31
+     * @returns eIasAvbProcOK on success, otherwise an error code
+     */
+    IasAvbProcessingResult init(uint32_t capacity);
+
+    /**
+     * @brief frees the storage, the queue has no capacity afterwards
+     */
+    void cleanup();
+
+    /**
+     * @brief returns the maximum number of entries
+     */
+    inline uint32_t getCapacity() const { return mMask + 1u; }
+
+    /**
+     * @brief returns the number of entries, only exact if called by producer or consumer while the other one is idle
+     */
+    inline uint32_t size() const;
+
+    /**
+     * @brief adds an entry at the tail, producer only
+     *
+     * @returns false if the queue is full
+     */
+    bool push(const T &entry);
+
+    /**
+     * @brief removes the entry at the head, consumer only
+     *
+     * @returns false if the queue is empty
+     */
+    bool pop(T &entry);
+
+  private:
+    static const uint32_t cCacheLineSize = 64u;
+
+    /**
+     * @brief Copy constructor, private unimplemented to prevent misuse.
+     */
+    IasAvbSpscQueue(IasAvbSpscQueue const &other);
+
+    /**
+     * @brief Assignment operator, private unimplemented to prevent misuse.
+     */
+    IasAvbSpscQueue& operator=(IasAvbSpscQueue const &other);
+
+    T                      *mEntries;
+    uint32_t                mMask;
+    uint8_t                 mPad0[cCacheLineSize];
+    std::atomic<uint32_t>   mHead;        // written by the consumer
+    uint8_t                 mPad1[cCacheLineSize];
+    std::atomic<uint32_t>   mTail;        // written by the producer
+};
+
+
+template <class T>
+IasAvbSpscQueue<T>::IasAvbSpscQueue()
+  : mEntries(NULL)
+  , mMask(uint32_t(-1))
+  , mPad0()
+  , mHead(0u)
+  , mPad1()
+  , mTail(0u)
+{
+  // do nothing
+}
+
+
+template <class T>
+IasAvbSpscQueue<T>::~IasAvbSpscQueue()
+{
+  cleanup();
+}
+
+
+template <class T>
+IasAvbProcessingResult IasAvbSpscQueue<T>::init(uint32_t capacity)
+{
+  IasAvbProcessingResult result = eIasAvbProcOK;
+
+  if ((0u == capacity) || (capacity > 0x80000000u))
+  {
+    result = eIasAvbProcInvalidParam;
+  }
+  else
+  {
+    cleanup();
+
+    uint32_t size = 1u;
+    while (size < capacity)
+    {
+      size <<= 1;
+    }
+
+    mEntries = new (std::nothrow) T[size];
+    if (NULL == mEntries)
+    {
+      result = eIasAvbProcNotEnoughMemory;
+    }
+    else
+    {
+      mMask = size - 1u;
+    }
+  }
+
+  return result;
+}
+
+
+template <class T>
+void IasAvbSpscQueue<T>::cleanup()
+{
+  delete[] mEntries;
+  mEntries = NULL;
+  mMask = uint32_t(-1);
+  mHead.store(0u, std::memory_order_relaxed);
+  mTail.store(0u, std::memory_order_relaxed);
+}
+
+
+template <class T>
+inline uint32_t IasAvbSpscQueue<T>::size() const
+{
+  return mTail.load(std::memory_order_acquire) - mHead.load(std::memory_order_acquire);
+}
+
+
+template <class T>
+bool IasAvbSpscQueue<T>::push(const T &entry)
+{
+  bool ret = false;
+  const uint32_t tail = mTail.load(std::memory_order_relaxed);
+
+  if ((NULL != mEntries) && ((tail - mHead.load(std::memory_order_acquire)) <= mMask))
+  {
+    mEntries[tail & mMask] = entry;
+    // publish the entry before the new tail
+    mTail.store(tail + 1u, std::memory_order_release);
+    ret = true;
+  }
+
+  return ret;
+}
+
+
+template <class T>
+bool IasAvbSpscQueue<T>::pop(T &entry)
+{
+  bool ret = false;
+  const uint32_t head = mHead.load(std::memory_order_relaxed);
+
+  if (head != mTail.load(std::memory_order_acquire))
+  {
+    entry = mEntries[head & mMask];
+    // the producer must not overwrite the entry before it has been read
+    mHead.store(head + 1u, std::memory_order_release);
+    ret = true;
+  }
+
+  return ret;
+}
+
+
+} // namespace IasMediaTransportAvb
+
+#endif /* IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBSPSCQUEUE_HPP */
@@ -16,6 +16,7 @@
 #include "avb_streamhandler/IasAvbTypes.hpp"
 #include "avb_streamhandler/IasAvbStreamId.hpp"
 #include "avb_streamhandler/IasAvbTSpec.hpp"
+#include "avb_streamhandler/IasAvbLatencyHistogram.hpp"
 #include "avb_helper/ias_safe.h"
 #include "media_transport/avb_streamhandler_api/IasAvbStreamHandlerTypes.hpp"
 
@@ -45,6 +46,16 @@ class IasAvbStream
      */
     virtual ~IasAvbStream();
 
+    /**
+     * @brief received AVTP packet, see dispatchPackets()
+     */
+    struct RxPacket
+    {
+      const void* packet;   // points to the AVTP header
+      size_t      length;   // length from the AVTP header to the end of the frame
+      uint64_t    now;      // arrival time, local PTP time
+    };
+
     // do not override; implement derivedCleanup() instead
     /*final*/ void cleanup();
 
@@ -64,7 +75,25 @@ class IasAvbStream
     inline IasAvbStreamState getStreamState() const;
     IasAvbProcessingResult resetPacketPool() const;
 
+    /**
+     * @brief provides the packet pool with the memory of all its packets, see IasAvbPacketPool::attachMemory()
+     */
+    IasAvbProcessingResult attachPacketMemory() const;
+
+    /**
+     * @brief gives the memory of the packets not reserved back, see IasAvbPacketPool::releaseMemory()
+     */
+    void releasePacketMemory() const;
+
     virtual void dispatchPacket(const void* packet, size_t length, uint64_t now);
+
+    /**
+     * @brief hands a burst of received packets of this stream over in one call
+     *
+     * Same as calling dispatchPacket() for each packet, but allows the stream to process the
+     * whole burst under one lock acquisition. The packets must not be NULL.
+     */
+    virtual void dispatchPackets(const RxPacket* packets, size_t count);
     virtual IasAvbPacket* preparePacket(uint64_t nextWindowStart);
     void activate(bool isError=false);
     void deactivate(bool isError=false);
@@ -95,6 +124,8 @@ class IasAvbStream
                                        const IasAvbMacAddress & dmac, uint16_t vid, bool preconfigured);
 
     virtual void readFromAvbPacket(const void* packet, size_t length) = 0;
+    // default implementation calls readFromAvbPacket() for each packet
+    virtual void readFromAvbPackets(const RxPacket* packets, size_t count);
     virtual bool writeToAvbPacket(IasAvbPacket* packet, uint64_t nextWindowStart) = 0;
     virtual void activationChanged() {}
     virtual void derivedCleanup() = 0;
@@ -110,15 +141,55 @@ class IasAvbStream
     IasAvbProcessingResult initCommon(const IasAvbTSpec & tSpec, const IasAvbStreamId & streamId,
                                       const IasAvbMacAddress & dmac, uint16_t vid, bool preconfigured);
     void doCleanup();
+    void checkPresentationTime(const void* packet, uint64_t now);
 
   public:
     inline const IasAvbStreamDiagnostics& getDiagnostics() const { return mDiag; }
     inline const bool& getPreconfigured() const { return mPreconfigured; }
 
+    /**
+     * @brief returns the distribution of AVTP presentation time minus arrival time of the received packets
+     *
+     * Negative values are late packets. Only packets with a valid time stamp are counted.
+     */
+    inline const IasAvbLatencyHistogram& getPresentationLatency() const { return mPresentationLatency; }
+
+    /**
+     * @brief returns the distribution of the time from arrival until dispatch of the received packets
+     */
+    inline const IasAvbLatencyHistogram& getDispatchLatency() const { return mDispatchLatency; }
+
+    /**
+     * @brief adds a sample to the dispatch latency histogram, called by the receive engine
+     */
+    inline void recordDispatchLatency(int64_t latency) { mDispatchLatency.record(latency); }
+
+    /**
+     * @brief returns the distribution of the TX time stamps minus the launch times of the transmitted packets
+     *
+     * Positive values are packets that left later than requested. Only collected if transmit.timestamps is set.
+     * With the igb backend, the DMA fetch times are used instead of the TX time stamps.
+     */
+    inline const IasAvbLatencyHistogram& getLaunchLateness() const { return mLaunchLateness; }
+
+    /**
+     * @brief adds a sample to the launch lateness histogram, called by the transmit sequencer
+     */
+    inline void recordLaunchLateness(int64_t lateness) { mLaunchLateness.record(lateness); }
+
+    /**
+     * @brief clears all latency histograms, see IasAvbLatencyHistogram::requestReset()
+     */
+    void resetLatency();
+
   protected:
     friend class IasAvbTransmitSequencer;
+    friend class IasAvbPacketPrerenderer;
     IasAvbStreamDiagnostics mDiag;
     IasAvbClockDomain::IasAvbLockState mCurrentAvbLockState;
+    IasAvbLatencyHistogram mPresentationLatency;
+    IasAvbLatencyHistogram mDispatchLatency;
+    IasAvbLatencyHistogram mLaunchLateness;
 
   public:
     uint32_t incFramesTx();
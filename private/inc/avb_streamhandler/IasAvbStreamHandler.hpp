@@ -239,6 +239,50 @@ class IAS_DSO_PUBLIC IasAvbStreamHandler : public IasAvbStreamHandlerInterface
     virtual void updateStreamStatus(uint64_t streamId, IasAvbStreamState status);
     //@}
 
+    /**
+     * @brief Retrieves the latency histograms of a receive stream.
+     *
+     * In addition to the diagnostic counters reported by getAvbStreamInfo(), the receive engine keeps
+     * the distribution of the AVTP presentation time minus arrival time and of the time from arrival
+     * until dispatch for each receive stream.
+     *
+     * @param[in] streamId Id of the receive stream
+     * @param[out] presentationLatency presentation time minus arrival time in ns, negative for late packets
+     * @param[out] dispatchLatency time from arrival until dispatch in ns
+     * @param[in] reset clear the histograms of the stream after reading them
+     *
+     * @returns eIasAvbResultOk on success, eIasAvbResultErr if the stream is unknown or not a receive stream
+     */
+    IasAvbResult getStreamLatency(AvbStreamId streamId, IasAvbLatencyHistogram &presentationLatency,
+                                  IasAvbLatencyHistogram &dispatchLatency, bool reset);
+
+    /**
+     * @brief Retrieves the launch lateness histogram of a transmit stream.
+     *
+     * If transmit.timestamps is set, the transmit engine compares the time each packet has been sent, as
+     * reported by TX time stamps, with its launch time. With the igb backend, libigb only reports the time
+     * the DMA fetched the packet, so the histogram holds the fetch lateness instead, which does not include
+     * the time the packet waited in the transmit queue of the NIC.
+     *
+     * @param[in] streamId Id of the transmit stream
+     * @param[out] launchLateness TX time minus launch time in ns, positive for packets sent too late
+     * @param[in] reset clear the histogram of the stream after reading it
+     *
+     * @returns eIasAvbResultOk on success, eIasAvbResultErr if the stream is unknown or not a transmit stream
+     */
+    IasAvbResult getStreamLaunchLateness(AvbStreamId streamId, IasAvbLatencyHistogram &launchLateness, bool reset);
+
+    /**
+     * @brief Retrieves the launch lateness histogram of all transmit streams of an SR class.
+     *
+     * @param[in] srClass the SR class
+     * @param[out] launchLateness TX time minus launch time in ns, positive for packets sent too late
+     * @param[in] reset clear the histogram of the class after reading it
+     *
+     * @returns eIasAvbResultOk on success, eIasAvbResultErr if there is no transmit engine or the class is unknown
+     */
+    IasAvbResult getClassLaunchLateness(IasAvbSrClass srClass, IasAvbLatencyHistogram &launchLateness, bool reset);
+
   private:
 
     enum State
@@ -32,6 +32,7 @@ namespace IasMediaTransportAvb {
 class IasLibPtpDaemon;
 class IasLibMrpDaemon;
 class IasDiaLogger;
+class IasAvbPacketSlab;
 
 //@{
 /**
@@ -106,17 +107,47 @@ static const char cRxDiscardOverrun[] = "receive.discard.overrun"; // 1=on, 0=of
 static const char cRxClkUpdateInterval[] = "receive.clock.updateinterval"; // us
 static const char cRxExcessPayload[] = "receive.excess.payload"; // samples
 static const char cRxRecoverIgbReceiver[] = "receive.recover.igb.receiver"; // 1=on (default), 0=off
+static const char cRxSocketRing[] = "receive.socket.ring"; // 1=TPACKET_V3 mmap ring, 0=recvfrom (default), ignored in direct RX DMA mode
+static const char cRxSocketRingBlockSize[] = "receive.socket.ring.blocksize"; // bytes, multiple of the page size (default 65536)
+static const char cRxSocketRingBlockCount[] = "receive.socket.ring.blockcount"; // number of ring blocks (default 16)
+static const char cRxSocketRingTimeout[] = "receive.socket.ring.timeout"; // ms until the kernel retires a partially filled block (default 1)
+static const char cRxWorkers[] = "receive.workers"; // number of receive worker threads, streams are sharded by DMAC (default 1, max 16 resp. 2 in direct RX DMA mode)
+static const char cRxWorkerCpu[] = "receive.worker.cpu."; // CPU the receive worker is pinned to (default: not pinned). Has to be appended by the worker index.
+static const char cRxWakeup[] = "receive.wakeup"; // 0=select + cycle wait polling (default), 1=epoll/timerfd event driven, 2=event driven + SO_BUSY_POLL, ignored in direct RX DMA mode
+static const char cRxBusyPoll[] = "receive.wakeup.busypoll"; // us the kernel busy polls the device queue in wakeup mode 2 (default 50)
+static const char cRxTimeoutTick[] = "receive.timeout.tick"; // ns, resolution of the per stream receive timeouts (default 1000000)
+static const char cRxTimestamping[] = "receive.timestamping"; // 0=off (time of wakeup), 1=kernel software RX timestamps (default), 2=NIC hardware RX timestamps, ignored in direct RX DMA mode
+static const char cRxPcapReplay[] = "receive.pcap.replay"; // file name, frames of this pcap capture are fed to the receive engine instead of the socket frames, ignored in direct RX DMA mode
+static const char cRxPcapReplayRealtime[] = "receive.pcap.replay.realtime"; // 1=replay with the original inter-arrival times (default), 0=as fast as possible
+static const char cRxPcapRecord[] = "receive.pcap.record"; // file name, all frames seen by the receive engine are written to this pcap capture
+static const char cRxSocketFilter[] = "receive.socket.filter"; // 1=in-kernel filter passing only frames of registered streams (default), 0=off, ignored in direct RX DMA mode
 static const char cXmitWndWidth[] = "transmit.window.width"; // ns
 static const char cXmitWndPitch[] = "transmit.window.pitch"; // ns
+static const char cXmitWndAuto[] = "transmit.window.auto"; // 1=adapt width and pitch to the measured scheduling lag, starting from the values above, 0=off (default)
+static const char cXmitWndWidthMax[] = "transmit.window.width.max"; // ns, upper bound of the width with transmit.window.auto (default 2 x width)
+static const char cXmitWndPitchMax[] = "transmit.window.pitch.max"; // ns, upper bound of the pitch with transmit.window.auto (default pitch)
 static const char cXmitCueThresh[] = "transmit.window.threshold.cue"; // ns
 static const char cXmitResetThresh[] = "transmit.window.threshold.reset"; // ns
 static const char cXmitPrefetchThresh[] = "transmit.window.threshold.prefetch"; // ns (default 1000000000 = 1 sec, 0=off)
 static const char cXmitResetMaxCount[] = "transmit.window.maxcount.reset"; // allowable max reset count per stream in a transmit window
 static const char cXmitDropMaxCount[] = "transmit.window.maxcount.drop"; // allowable max number of dropped packages in a transmit window
-static const char cXmitUseShaper[] = "transmit.shaper.enable"; // 0=disabled
+static const char cXmitUseShaper[] = "transmit.shaper.enable"; // 0=disabled, with the "socket" backend the launch times are shaped in software
 static const char cUseWatchdog[] = "watchdog.enable";
-static const char cXmitStrictPktOrder[] = "transmit.pktorder.enable"; // 1=on (default), 0=off
+static const char cXmitMaxStreams[] = "transmit.maxstreams"; // max number of active streams per TX sequencer, i.e. per SR class with one sequencer per class (default 256)
 static const char cXmitClkUpdateInterval[] = "transmit.clock.updateinterval"; // us
+static const char cXmitBackend[] = "transmit.backend"; // "igb" (default) = libigb, "socket" = packet socket with SO_TXTIME launch times, no igb device needed, "memory" = packets are recorded in memory, for simulations with ptp.virtual
+static const char cXmitBatchSize[] = "transmit.batch.size"; // max number of packets handed over to the transmit backend at once, 0=one by one (default 64), ignored with libigb
+static const char cXmitPrerenderWorkers[] = "transmit.prerender.workers"; // number of worker threads per SR class rendering the packets ahead of the TX thread, 0=rendered by the TX thread (default)
+static const char cXmitPrerenderLead[] = "transmit.prerender.lead"; // ns the packets are rendered ahead, must not be less than the window width (default window width + pitch)
+static const char cXmitPrerenderDepth[] = "transmit.prerender.depth"; // max number of packets rendered ahead per stream, at most its packet pool size (default 32)
+static const char cXmitTimestamps[] = "transmit.timestamps"; // 1=measure the launch time accuracy with TX time stamps (socket backend) or the DMA time reported by libigb, 0=off (default)
+static const char cXmitSocketPriority[] = "transmit.socket.priority"; // SO_PRIORITY of the "socket" backend, followed by the class suffix, defaults to the VLAN priority of the class. Can be set per TX queue by appending '.' and the queue index, to map the queues to traffic classes of the qdisc.
+static const char cXmitSeqCount[] = "transmit.sequencer.count."; // number of TX sequencers (threads) of the SR class, more than 1 only with the "socket" or "memory" backend (default 1). Has to be appended by the class suffix.
+static const char cXmitSeqMaxStreams[] = "transmit.sequencer.maxstreams"; // max number of streams placed onto one TX sequencer, 0=unlimited (default)
+static const char cXmitSeqQueue[] = "transmit.sequencer.queue."; // TX queue of the sequencer, libigb: Qav queue 0 or 1 (default 0 for high, 1 for low class), "socket" backend: any queue, see transmit.socket.priority. Has to be appended by the class suffix, '.' and the sequencer index.
+static const char cXmitSeqCpu[] = "transmit.sequencer.cpu."; // CPU the TX sequencer thread is pinned to (default: not pinned). Has to be appended by the class suffix, '.' and the sequencer index.
+static const char cXmitMemoryRecords[] = "transmit.memory.records"; // number of packets recorded per TX sequencer by the "memory" backend, 0=count only (default 65536)
+static const char cPtpVirtualClock[] = "ptp.virtual"; // 0=off (default), otherwise the PTP proxy runs a virtual clock starting at this time in ns, driven by the sleeps of the TX sequencers
 static const char cPtpPdelayCount[] = "ptp.pdelaycount"; //
 static const char cPtpSyncCount[] = "ptp.synccount"; //
 static const char cPtpLoopSleep[] = "ptp.loopsleep"; // ns
@@ -128,6 +159,10 @@ static const char cVideoOutNumPackets[] = "video.out.numpackets"; // video out r
 static const char cXmitVideoPoolsize[] = "transmit.video.poolsize"; // pool size for avb video transmit streams
 static const char cXmitAafPoolsize[] = "transmit.aaf.poolsize"; // pool size for avb audio transmit streams
 static const char cXmitCrfPoolsize[] = "transmit.crf.poolsize"; // pool size for avb clock reference transmit streams
+static const char cPacketPoolAllocator[] = "packetpool.allocator"; // memory of the packet pools, "igb" = DMA pages of the igb device (default if there is one), "heap" = heap pages (default with the "socket" or "memory" backend), "hugepage" = locked huge pages, not usable by the igb device
+static const char cPacketPoolSlabSize[] = "packetpool.slab.size"; // bytes of packet memory shared by the pools of all transmit streams, 0=each pool has its own memory (default)
+static const char cPacketPoolSlabReserve[] = "packetpool.slab.reserve"; // number of packets guaranteed to each transmit stream while the slab is used, the remainder of the pool is borrowed when the stream is activated (default 32)
+static const char cPacketPoolHugePageNode[] = "packetpool.hugepage.node"; // NUMA node preferred for the "hugepage" allocator (default: node of the thread creating the pool)
 static const char cAudioClockTimeout[] = "audio.clock.timeout"; // master time update timeout for AVB Audio TX in ns
 static const char cAlsaClockTimeout[] = "alsa.clock.timeout"; // master time update timeout for ALSA in ns
 static const char cAlsaClockCycle[] = "alsa.clock.cycle"; // adjust cycle of clock control loop in ns
@@ -184,6 +219,7 @@ class IasAvbStreamHandlerEnvironment : private virtual IasAvbConfigRegistryInter
     static inline const std::string *getNetworkInterfaceName();
     static inline IasLibPtpDaemon *getPtpProxy();
     static inline IasLibMrpDaemon *getMrpProxy();
+    static inline IasAvbPacketSlab *getPacketSlab();
     static inline device_t *getIgbDevice();
     static inline IasAvbClockDriverInterface *getClockDriver();
     static inline const IasAvbMacAddress *getSourceMac();
@@ -193,6 +229,8 @@ class IasAvbStreamHandlerEnvironment : private virtual IasAvbConfigRegistryInter
     static inline uint32_t getTxRingSize();
     static inline bool isLinkUp();
     static inline bool isTestProfileEnabled();
+    static inline bool isSocketTransmitBackend();
+    static inline bool isMemoryTransmitBackend();
 
     template<class T>
     static inline bool getConfigValue(const std::string &key, T &value);
@@ -265,6 +303,7 @@ class IasAvbStreamHandlerEnvironment : private virtual IasAvbConfigRegistryInter
     IasAvbProcessingResult createPtpProxy();
     IasAvbProcessingResult createMrpProxy();
     IasAvbProcessingResult createIgbDevice();
+    IasAvbProcessingResult createPacketSlab();
     IasAvbProcessingResult querySourceMac();
     bool queryLinkState();
     int32_t queryLinkSpeed();
@@ -289,6 +328,7 @@ class IasAvbStreamHandlerEnvironment : private virtual IasAvbConfigRegistryInter
     IasLibPtpDaemon* mPtpProxy;
     IasLibMrpDaemon* mMrpProxy;
     device_t* mIgbDevice;
+    IasAvbPacketSlab* mPacketSlab;
     IasAvbMacAddress mSourceMac;
     int32_t mStatusSocket;
     RegistryMapNumeric mRegistryNumeric;
@@ -363,6 +403,16 @@ inline IasLibMrpDaemon* IasAvbStreamHandlerEnvironment::getMrpProxy()
   return ret;
 }
 
+inline IasAvbPacketSlab* IasAvbStreamHandlerEnvironment::getPacketSlab()
+{
+  IasAvbPacketSlab* ret = NULL;
+  if (NULL != mInstance)
+  {
+    ret = mInstance->mPacketSlab;
+  }
+  return ret;
+}
+
 inline device_t* IasAvbStreamHandlerEnvironment::getIgbDevice()
 {
   device_t* ret = NULL;
@@ -417,7 +467,20 @@ inline bool IasAvbStreamHandlerEnvironment::isLinkUp()
 {
   AVB_ASSERT(NULL != mInstance);
 
-  return mInstance->queryLinkState();
+  // the in-memory backend does not have a link that could go down
+  return isMemoryTransmitBackend() || mInstance->queryLinkState();
+}
+
+inline bool IasAvbStreamHandlerEnvironment::isSocketTransmitBackend()
+{
+  std::string backend;
+  return getConfigValue(IasRegKeys::cXmitBackend, backend) && ("socket" == backend);
+}
+
+inline bool IasAvbStreamHandlerEnvironment::isMemoryTransmitBackend()
+{
+  std::string backend;
+  return getConfigValue(IasRegKeys::cXmitBackend, backend) && ("memory" == backend);
 }
 
 inline bool IasAvbStreamHandlerEnvironment::isTestProfileEnabled()
@@ -448,7 +511,8 @@ inline int32_t IasAvbStreamHandlerEnvironment::getLinkSpeed()
 {
   AVB_ASSERT(NULL != mInstance);
 
-  return mInstance->queryLinkSpeed();
+  // the in-memory backend simulates a gigabit link
+  return isMemoryTransmitBackend() ? 1000 : mInstance->queryLinkSpeed();
 }
 
 inline uint32_t IasAvbStreamHandlerEnvironment::getTxRingSize()
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file    IasAvbTimerWheel.hpp
+ * @brief   The definition of the IasAvbTimerWheel class.
+ * @details Hierarchical timer wheel used to track timeouts of a large number of objects
+ *          at a cost that depends on the number of expiring timers only.
+ * @date    2018
+ */
+
+#ifndef IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBTIMERWHEEL_HPP
+#define IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBTIMERWHEEL_HPP
+
+#include "IasAvbTypes.hpp"
+#include <vector>
+
+namespace IasMediaTransportAvb {
+
+/**
+ * @brief hierarchical timer wheel
+ *
+ * Timers are identified by an opaque 64 bit key chosen by the user, the wheel does not detect
+ * duplicates. Time is given in ns and quantized to ticks; a timer never expires before its
+ * deadline, but up to one tick after it. Level 0 covers cSlots ticks, each further level covers
+ * cSlots times the range of the level below. Timers beyond the range of the wheel are parked in
+ * the top level and re-inserted when it turns.
+ *
+ * The slots keep their capacity, so once the wheel has seen its working set no memory is
+ * allocated anymore. The class is not thread-safe.
+ */
+class IasAvbTimerWheel
+{
+  public:
+    static const uint32_t cSlotBits = 6u;
+    static const uint32_t cSlots = 1u << cSlotBits;
+    static const uint32_t cLevels = 4u;
+
+    /**
+     *  @brief Constructor.
+     */
+    IasAvbTimerWheel();
+
+    /**
+     *  @brief Destructor, virtual by default.
+     */
+    virtual ~IasAvbTimerWheel();
+
+    /**
+     * @brief sets the resolution and the current time, removes all timers
+     *
+     * @param[in] tickNs  duration of one tick in ns, must be > 0
+     * @param[in] now     current time in ns
+     * @returns eIasAvbProcOK on success, eIasAvbProcInvalidParam if tickNs is 0
+     */
+    IasAvbProcessingResult init(uint64_t tickNs, uint64_t now);
+
+    /**
+     * @brief removes all timers, keeps the current time
+     */
+    void clear();
+
+    /**
+     * @brief adds a timer
+     *
+     * A timer whose deadline has already passed is due at the tick following the last call of advance().
+     */
+    void add(uint64_t key, uint64_t deadline);
+
+    /**
+     * @brief moves the wheel forward to the given time
+     *
+     * @param[in]  now      current time in ns
+     * @param[out] expired  keys of the expired timers are appended to this vector
+     * @returns the number of expired timers
+     */
+    uint32_t advance(uint64_t now, std::vector<uint64_t> &expired);
+
+    /**
+     * @brief returns a point in time at which advance() needs to be called next
+     *
+     * This is the expiry tick of the earliest timer on level 0 or the time at which timers of a higher
+     * level move down, whichever comes first. Costs at most cSlots steps, regardless of the number of timers.
+     * Returns 0 if the wheel is empty.
+     */
+    uint64_t getNextExpiry() const;
+
+    /**
+     * @brief returns the number of pending timers
+     */
+    inline uint32_t getSize() const { return mSize; }
+
+    /**
+     * @brief returns the duration of a tick in ns
+     */
+    inline uint64_t getTick() const { return mTickNs; }
+
+  private:
+    struct Timer
+    {
+      uint64_t key;
+      uint64_t tick;      // expiry tick, the deadline rounded up
+    };
+
+    typedef std::vector<Timer> Slot;
+
+    /**
+     *  @brief Copy constructor, private unimplemented to prevent misuse.
+     */
+    IasAvbTimerWheel(IasAvbTimerWheel const &other);
+
+    /**
+     *  @brief Assignment operator, private unimplemented to prevent misuse.
+     */
+    IasAvbTimerWheel& operator=(IasAvbTimerWheel const &other);
+
+    /**
+     * @brief puts a timer into the slot matching its distance to mCurrentTick
+     */
+    void insert(const Timer &timer);
+
+    /**
+     * @brief re-inserts the timers of the current slot of a higher level
+     */
+    void cascade(uint32_t level);
+
+    /**
+     * @brief checks whether reaching the given level 0 aligned tick moves any timers down
+     */
+    bool isCascadePending(uint64_t tick) const;
+
+    uint64_t mTickNs;
+    uint64_t mCurrentTick;   // next tick to be processed, all timers of earlier ticks have expired
+    uint32_t mSize;
+    Slot     mSlots[cLevels][cSlots];
+    Slot     mCascade;       // scratch buffer used while cascading
+};
+
+} // namespace IasMediaTransportAvb
+
+#endif /* IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBTIMERWHEEL_HPP */
@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file    IasAvbTransmitBackend.hpp
+ * @brief   Interface of the packet transmit backends used by the transmit sequencer.
+ * @details This is a pure virtual interface class. The transmit sequencer uses libigb directly
+ *          unless a backend has been selected with the transmit.backend registry key.
+ * @date    2018
+ */
+
+#ifndef IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBTRANSMITBACKEND_HPP
+#define IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBTRANSMITBACKEND_HPP
+
+#include "IasAvbTypes.hpp"
+
+namespace IasMediaTransportAvb {
+
+class IasAvbPacket;
+
+/**
+ * @brief interface of a packet transmit backend
+ *
+ * A backend takes the packets prepared by the streams, with the launch time in IasAvbPacket::attime
+ * given in local (PTP proxy) time, and returns them to their pool once they are not needed anymore.
+ * It is used by a single sequencer thread.
+ */
+class IasAvbTransmitBackend
+{
+  public:
+    /// @brief time a frame has been sent, as reported by the network stack
+    struct TxTimestamp
+    {
+      uint32_t  id;     ///< number of frames accepted by xmit()/xmitBatch() before this one, since enableTxTimestamps()
+      uint64_t  time;   ///< local (PTP proxy) time in ns
+    };
+
+    /**
+     * @brief Destructor, virtual by default.
+     */
+    virtual ~IasAvbTransmitBackend() {}
+
+    /**
+     * @brief Allocates the resources needed to transmit the packets of one SR class.
+     *
+     * @param[in] queueIndex  index of the TX queue used by the sequencer
+     * @param[in] qavClass    SR class served by the sequencer
+     * @returns eIasAvbProcOK on success, otherwise an error code
+     */
+    virtual IasAvbProcessingResult init(uint32_t queueIndex, IasAvbSrClass qavClass) = 0;
+
+    /**
+     * @brief Releases all resources, returns packets still held to their pools.
+     */
+    virtual void cleanup() = 0;
+
+    /**
+     * @brief Hands a packet over for transmission at its launch time.
+     *
+     * The return values follow igb_xmit(): 0 on success, in which case the backend owns the packet,
+     * -EINVAL or -ENXIO for fatal errors, any other value if sending should be retried later.
+     * Unless 0 is returned, the packet remains with the caller.
+     */
+    virtual int32_t xmit(IasAvbPacket *packet) = 0;
+
+    /**
+     * @brief Hands a batch of packets over for transmission, in the given order.
+     *
+     * The default implementation calls xmit() for each packet. It stops at the first packet that is not
+     * accepted and returns the result of xmit() for it.
+     *
+     * @param[in]  packets  packets to send, sorted by launch time
+     * @param[in]  count    number of packets
+     * @param[out] sent     number of packets accepted, the backend owns packets[0] .. packets[sent - 1]
+     * @returns 0 if all packets have been accepted, otherwise the error of the first packet not accepted
+     */
+    virtual int32_t xmitBatch(IasAvbPacket * const *packets, uint32_t count, uint32_t &sent)
+    {
+      int32_t result = 0;
+
+      sent = 0u;
+      while (sent < count)
+      {
+        result = xmit(packets[sent]);
+        if (0 != result)
+        {
+          break;
+        }
+        sent++;
+      }
+
+      return result;
+    }
+
+    /**
+     * @brief Returns the packets that are not needed anymore to their pools.
+     *
+     * @returns number of packets returned
+     */
+    virtual uint32_t reclaimPackets() = 0;
+
+    /**
+     * @brief Requests a TX time stamp for each frame sent from now on.
+     *
+     * @returns false if the backend cannot deliver time stamps
+     */
+    virtual bool enableTxTimestamps() { return false; }
+
+    /**
+     * @brief Fetches the time stamps collected by reclaimPackets().
+     *
+     * @param[out] stamps  buffer for the time stamps, in the order they have been reported
+     * @param[in]  max     size of the buffer
+     * @returns number of time stamps copied
+     */
+    virtual uint32_t getTxTimestamps(TxTimestamp *stamps, uint32_t max)
+    {
+      (void) stamps;
+      (void) max;
+      return 0u;
+    }
+
+  protected:
+    //@{
+    /// can only be created through implementation class
+    IasAvbTransmitBackend() {}
+    //@}
+};
+
+} // namespace IasMediaTransportAvb
+
+#endif /* IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBTRANSMITBACKEND_HPP */
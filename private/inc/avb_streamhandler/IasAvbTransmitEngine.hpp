@@ -241,6 +241,30 @@ class IasAvbTransmitEngine : private IasAvbStreamHandlerEventInterface
     bool getAvbStreamInfo(const IasAvbStreamId &id, AudioStreamInfoList &audioStreamInfo,
                           VideoStreamInfoList &videoStreamInfo, ClockReferenceStreamInfoList &clockRefStreamInfo) const;
 
+    /**
+     * @brief Retrieves the launch lateness histogram of a transmit stream.
+     *
+     * @param[in] id of the stream.
+     * @param[out] launchLateness TX time stamp minus launch time of the transmitted packets, DMA fetch time
+     *             minus launch time with igb.
+     * @param[in] reset if 'true', the histogram of the stream is cleared after it has been copied.
+     *
+     * @returns 'true' if the stream has been found, otherwise 'false'.
+     */
+    bool getStreamLaunchLateness(const IasAvbStreamId &id, IasAvbLatencyHistogram &launchLateness, bool reset);
+
+    /**
+     * @brief Retrieves the launch lateness histogram of all transmit streams of an SR class.
+     *
+     * @param[in] srClass the SR class.
+     * @param[out] launchLateness TX time stamp minus launch time of the transmitted packets, DMA fetch time
+     *             minus launch time with igb.
+     * @param[in] reset if 'true', the histograms of the class are cleared after they have been copied.
+     *
+     * @returns 'true' on success, 'false' if the class is not supported or the engine is not initialized.
+     */
+    bool getClassLaunchLateness(IasAvbSrClass srClass, IasAvbLatencyHistogram &launchLateness, bool reset);
+
   private:
 
     //
@@ -248,12 +272,15 @@ class IasAvbTransmitEngine : private IasAvbStreamHandlerEventInterface
     //
 
     typedef std::map<IasAvbStreamId, IasAvbStream*> AvbStreamMap;
+    typedef std::map<IasAvbStream*, IasAvbTransmitSequencer*> AvbSequencerMap;
 
     //
     // constants
     //
 
     static const uint32_t cIgbAccessSleep = 100000u; // in us: 100 ms
+    static const uint32_t cMaxSequencersPerClass = 8u;
+    static const uint32_t cMaxSequencers = IasAvbTSpec::cIasAvbNumSupportedClasses * cMaxSequencersPerClass;
     //
     // helpers
     //
@@ -261,8 +288,24 @@ class IasAvbTransmitEngine : private IasAvbStreamHandlerEventInterface
     IasAvbTransmitSequencer * getSequencerByStream(IasAvbStream *stream) const;
     IasAvbTransmitSequencer * getSequencerByClass(IasAvbSrClass qavClass) const;
     IasAvbProcessingResult createSequencerOnDemand(IasAvbSrClass qavClass);
+
+    /**
+     * @brief places a new stream onto the least loaded sequencer of its class
+     *
+     * The load of a sequencer is the bandwidth of the streams placed onto it, active or not. Sequencers
+     * already holding the max number of streams per sequencer are skipped.
+     *
+     * @returns eIasAvbProcOK on success, eIasAvbProcNoSpaceLeft if all sequencers of the class are full
+     */
+    IasAvbProcessingResult placeStream(IasAvbStream *stream);
+
     void updateShapers();
 
+    /**
+     * @brief passes the bandwidth and max frame size of the high class to the sequencers of the low class
+     */
+    void updateShapersLow();
+
     //{@
     /// @brief IasAvbStreamHandlerEventInterface implementation
     virtual void updateLinkStatus(const bool linkIsUp);
@@ -287,11 +330,14 @@ class IasAvbTransmitEngine : private IasAvbStreamHandlerEventInterface
     ///
 
     device_t          *mIgbDevice;
+    bool               mBackendTransmit; // packets are sent through a transmit backend, no igb device
     AvbStreamMap       mAvbStreams;
     bool               mUseShaper;
     bool               mUseResume;
     bool               mRunning;
-    IasAvbTransmitSequencer * mSequencers[IasAvbTSpec::cIasAvbNumSupportedClasses];
+    IasAvbTransmitSequencer * mSequencers[cMaxSequencers];
+    AvbSequencerMap    mStreamSequencers;   // sequencer each transmit stream has been placed onto
+    uint32_t           mMaxStreamsPerSequencer; // 0 = unlimited
     IasAvbStreamHandlerEventInterface *mEventInterface;
     DltContext     *mLog;           // context for Log & Trace
     bool               mBTMEnable;
@@ -299,7 +345,7 @@ class IasAvbTransmitEngine : private IasAvbStreamHandlerEventInterface
 
 inline bool IasAvbTransmitEngine::isInitialized() const
 {
-  return (NULL != mIgbDevice);
+  return ((NULL != mIgbDevice) || mBackendTransmit);
 }
 
 
@@ -0,0 +1,334 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file    IasAvbTransmitSchedule.hpp
+ * @brief   The definition of the IasAvbTransmitSchedule class template.
+ * @details Fixed-capacity min-heap the transmit sequencer uses to find the stream
+ *          whose packet has to be sent next.
+ * @date    2018
+ */
+
+#ifndef IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBTRANSMITSCHEDULE_HPP
+#define IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBTRANSMITSCHEDULE_HPP
+
+#include "IasAvbTypes.hpp"
+#include <functional>
+
+namespace IasMediaTransportAvb {
+
+/**
+ * @brief fixed-capacity binary min-heap of transmit entries
+ *
+ * All entries live in one array allocated by init(). The first getPending() elements form a
+ * min-heap ordered by Less, the remaining ones are parked, i.e. done for the current TX window.
+ * top() is the pending entry to be served next, update() restores the order after the key of
+ * that entry has changed and pop() parks it, both in O(log n). rearm() makes all entries pending
+ * again in O(n).
+ *
+ * add() and erase() are meant for the control path. They park all entries, so rearm() has to be
+ * called before top() can be used again. Entries are moved around by all operations but
+ * operator[], references to them are only valid until the next call of a non-const method.
+ *
+ * Apart from init(), no memory is allocated. The class is not thread-safe.
+ */
+template <class T, class Less = std::less<T> >
+class IasAvbTransmitSchedule
+{
+  public:
+    /**
+     *  @brief Constructor.
+     */
+    IasAvbTransmitSchedule();
+
+    /**
+     *  @brief Destructor, virtual by default.
+     */
+    virtual ~IasAvbTransmitSchedule();
+
+    /**
+     * @brief allocates the storage for the entries, removes all entries
+     *
+     * @param[in] capacity  maximum number of entries, must be > 0
+     * @returns eIasAvbProcOK on success, otherwise an error code
+     */
+    IasAvbProcessingResult init(uint32_t capacity);
+
+    /**
+     * @brief frees the storage, the schedule has no capacity afterwards
+     */
+    void cleanup();
+
+    /**
+     * @brief returns the maximum number of entries
+     */
+    inline uint32_t getCapacity() const { return mCapacity; }
+
+    /**
+     * @brief returns the number of entries
+     */
+    inline uint32_t size() const { return mSize; }
+
+    /**
+     * @brief returns the number of entries not parked
+     */
+    inline uint32_t getPending() const { return mPending; }
+
+    /**
+     * @brief access to the entries in storage order, e.g. to iterate over all of them
+     *
+     * The key of an entry must not be changed through this operator unless rearm() is called afterwards.
+     */
+    inline T& operator[](uint32_t index);
+
+    /**
+     * @brief adds an entry, parks all entries
+     *
+     * @returns false if the schedule is full
+     */
+    bool add(const T &entry);
+
+    /**
+     * @brief removes the entry at the given storage index, parks all entries
+     *
+     * The last entry takes the place of the removed one, so it is safe to erase while iterating downwards.
+     */
+    void erase(uint32_t index);
+
+    /**
+     * @brief removes all entries
+     */
+    void clear();
+
+    /**
+     * @brief makes all entries pending again
+     */
+    void rearm();
+
+    /**
+     * @brief returns the pending entry that comes first, getPending() must be > 0
+     */
+    inline T& top();
+
+    /**
+     * @brief re-sorts the top entry after its key has increased
+     *
+     * @returns true if another entry has become the top entry
+     */
+    bool update();
+
+    /**
+     * @brief parks the top entry until the next call of rearm()
+     */
+    void pop();
+
+  private:
+    /**
+     * @brief Copy constructor, private unimplemented to prevent misuse.
+     */
+    IasAvbTransmitSchedule(IasAvbTransmitSchedule const &other);
+
+    /**
+     * @brief Assignment operator, private unimplemented to prevent misuse.
+     */
+    IasAvbTransmitSchedule& operator=(IasAvbTransmitSchedule const &other);
+
+    /**
+     * @brief moves the entry at index down the heap until the heap property is restored
+     *
+     * @returns true if the entry has been moved
+     */
+    bool siftDown(uint32_t index);
+
+    T         *mEntries;
+    uint32_t   mCapacity;
+    uint32_t   mSize;
+    uint32_t   mPending;
+    Less       mLess;
+};
+
+
+template <class T, class Less>
+IasAvbTransmitSchedule<T, Less>::IasAvbTransmitSchedule()
+  : mEntries(NULL)
+  , mCapacity(0u)
+  , mSize(0u)
+  , mPending(0u)
+  , mLess()
+{
+  // do nothing
+}
+
+
+template <class T, class Less>
+IasAvbTransmitSchedule<T, Less>::~IasAvbTransmitSchedule()
+{
+  cleanup();
+}
+
+
+template <class T, class Less>
+IasAvbProcessingResult IasAvbTransmitSchedule<T, Less>::init(uint32_t capacity)
+{
+  IasAvbProcessingResult result = eIasAvbProcOK;
+
+  if (0u == capacity)
+  {
+    result = eIasAvbProcInvalidParam;
+  }
+  else
+  {
+    cleanup();
+    mEntries = new (std::nothrow) T[capacity];
+    if (NULL == mEntries)
+    {
+      result = eIasAvbProcNotEnoughMemory;
+    }
+    else
+    {
+      mCapacity = capacity;
+    }
+  }
+
+  return result;
+}
+
+
+template <class T, class Less>
+void IasAvbTransmitSchedule<T, Less>::cleanup()
+{
+  delete[] mEntries;
+  mEntries = NULL;
+  mCapacity = 0u;
+  mSize = 0u;
+  mPending = 0u;
+}
+
+
+template <class T, class Less>
+inline T& IasAvbTransmitSchedule<T, Less>::operator[](uint32_t index)
+{
+  AVB_ASSERT(index < mSize);
+  return mEntries[index];
+}
+
+
+template <class T, class Less>
+bool IasAvbTransmitSchedule<T, Less>::add(const T &entry)
+{
+  bool ret = false;
+
+  if (mSize < mCapacity)
+  {
+    mEntries[mSize++] = entry;
+    mPending = 0u;
+    ret = true;
+  }
+
+  return ret;
+}
+
+
+template <class T, class Less>
+void IasAvbTransmitSchedule<T, Less>::erase(uint32_t index)
+{
+  AVB_ASSERT(index < mSize);
+
+  mSize--;
+  mEntries[index] = mEntries[mSize];
+  mPending = 0u;
+}
+
+
+template <class T, class Less>
+void IasAvbTransmitSchedule<T, Less>::clear()
+{
+  mSize = 0u;
+  mPending = 0u;
+}
+
+
+template <class T, class Less>
+void IasAvbTransmitSchedule<T, Less>::rearm()
+{
+  mPending = mSize;
+
+  // Floyd's heap construction, bottom-up from the last inner node
+  for (uint32_t i = mPending / 2u; i > 0u; i--)
+  {
+    (void) siftDown(i - 1u);
+  }
+}
+
+
+template <class T, class Less>
+inline T& IasAvbTransmitSchedule<T, Less>::top()
+{
+  AVB_ASSERT(0u != mPending);
+  return mEntries[0];
+}
+
+
+template <class T, class Less>
+bool IasAvbTransmitSchedule<T, Less>::update()
+{
+  return siftDown(0u);
+}
+
+
+template <class T, class Less>
+void IasAvbTransmitSchedule<T, Less>::pop()
+{
+  AVB_ASSERT(0u != mPending);
+
+  mPending--;
+  if (0u != mPending)
+  {
+    // swap the top with the last pending entry, which moves the top to the parked range
+    const T parked = mEntries[0];
+    mEntries[0] = mEntries[mPending];
+    mEntries[mPending] = parked;
+    (void) siftDown(0u);
+  }
+}
+
+
+template <class T, class Less>
+bool IasAvbTransmitSchedule<T, Less>::siftDown(uint32_t index)
+{
+  const uint32_t start = index;
+  const T entry = mEntries[index];
+
+  for (;;)
+  {
+    uint32_t child = 2u * index + 1u;
+    if (child >= mPending)
+    {
+      break;
+    }
+
+    if (((child + 1u) < mPending) && mLess(mEntries[child + 1u], mEntries[child]))
+    {
+      child++;
+    }
+
+    if (!mLess(mEntries[child], entry))
+    {
+      break;
+    }
+
+    mEntries[index] = mEntries[child];
+    index = child;
+  }
+
+  mEntries[index] = entry;
+
+  return start != index;
+}
+
+
+} // namespace IasMediaTransportAvb
+
+#endif /* IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBTRANSMITSCHEDULE_HPP */
@@ -8,8 +8,12 @@
  * @brief   Transmit sequenced perform the actual sending of AVB packets on a per-class basis.
  * @details The transmit sequencer runs a worker thread that checks a vector for active
  *          streams. If there are any, their packets will be requested from 'AvbStream' and
- *          be handed over to the 'igb' device. Packets from multiple streams are multiplexed
- *          based on their packet launch times. The worker thread starts on activation of
+ *          be handed over to the 'igb' device or the selected transmit backend. Packets from multiple streams are multiplexed
+ *          based on their packet launch times, using a min-heap of the active streams. Optionally, the packets are rendered
+ *          ahead of time by render workers (see IasAvbPacketPrerenderer). Streams are added to and removed from the
+ *          sequence by commands the worker thread picks up from a lock-free queue once per TX window, so changes
+ *          never block the worker thread. Optionally, the TX window follows the measured scheduling lag
+ *          (see IasAvbTransmitWindowTuner). The worker thread starts on activation of
  *          the first AVB stream and will be stopped if the last AVB stream has been
  *          deactivated.
  * @date    2013
@@ -21,11 +25,21 @@
 #include "IasAvbTypes.hpp"
 #include "IasAvbStream.hpp"
 #include "IasAvbStreamHandlerEnvironment.hpp"
+#include "IasAvbTransmitBackend.hpp"
+#include "IasAvbTransmitSchedule.hpp"
+#include "IasAvbTransmitWindowTuner.hpp"
+#include "IasAvbPacketPrerenderer.hpp"
+#include "IasAvbCreditShaper.hpp"
+#include "IasAvbLatencyHistogram.hpp"
+#include "IasAvbPacketPool.hpp"
+#include "IasAvbSpscQueue.hpp"
 #include "avb_helper/IasThread.hpp"
 #include "avb_helper/IasIRunnable.hpp"
 #include "avb_watchdog/IasWatchdogInterface.hpp"
+#include <atomic>
+#include <map>
 #include <mutex>
-#include <set>
+#include <vector>
 
 namespace IasMediaTransportAvb {
 
@@ -50,9 +64,13 @@ class IasAvbTransmitSequencer : private IasMediaTransportAvb::IasIRunnable
     /**
      * @brief Allocates internal resources and initializes instance.
      *
+     * @param[in] queueIndex  TX queue, 0 or 1 with libigb, any with a transmit backend
+     * @param[in] qavClass    SR class of the streams served
+     * @param[in] doReclaim   reclaim the packets of all sequencers sharing the igb device
+     * @param[in] instance    index of the sequencer within its class, selects the CPU it is pinned to
      * @returns eIasAvbProcOK on success, otherwise an error will be returned.
      */
-    IasAvbProcessingResult init(uint32_t queueIndex, IasAvbSrClass qavClass, bool doReclaim);
+    IasAvbProcessingResult init(uint32_t queueIndex, IasAvbSrClass qavClass, bool doReclaim, uint32_t instance = 0u);
 
     /**
      *  @brief Clean up all allocated resources.
@@ -108,6 +126,8 @@ class IasAvbTransmitSequencer : private IasMediaTransportAvb::IasIRunnable
 
     inline IasAvbSrClass getClass() const;
 
+    inline uint32_t getQueueIndex() const { return mQueueIndex; }
+
     inline uint32_t getCurrentBandwidth() const;
 
     /**
@@ -135,6 +155,32 @@ class IasAvbTransmitSequencer : private IasMediaTransportAvb::IasIRunnable
      */
     inline uint32_t getMaxFrameSizeHigh();
 
+    /**
+     * @brief set the bandwidth of High Class to the sequencer of Low Class
+     *
+     * Only needed for the software shaper used with a transmit backend, the igb shaper reads the
+     * idle slope of High Class from the Qav registers instead.
+     *
+     * @param[in] bandwidth  bandwidth in kBit/s
+     */
+    inline void setBandwidthHigh(uint32_t bandwidth);
+
+    /**
+     * @brief returns the distribution of the TX time stamps minus the launch times of an SR class
+     *
+     * Collected from the packets reclaimed by this sequencer if transmit.timestamps is set. With libigb, the
+     * reclaiming sequencer sees the packets of all classes, so the histograms of all sequencers have to be merged.
+     * The sequencer thread keeps recording, so other threads have to use IasAvbLatencyHistogram::snapshot().
+     *
+     * @param[in] srClass  the SR class of the transmitting streams
+     */
+    inline const IasAvbLatencyHistogram& getLaunchLateness(IasAvbSrClass srClass) const;
+
+    /**
+     * @brief clears the launch lateness histogram of an SR class, see IasAvbLatencyHistogram::requestReset()
+     */
+    inline void resetLaunchLateness(IasAvbSrClass srClass);
+
   private:
 
     //
@@ -151,6 +197,9 @@ class IasAvbTransmitSequencer : private IasMediaTransportAvb::IasIRunnable
       uint64_t txWindowWidth;           ///< width of the TX window in ns (window goes from "now" to x ns in the future)
       uint64_t txWindowPitchInit;       ///< initial iteration step with for TX window in ns
       uint64_t txWindowPitch;           ///< iteration step with for TX window in ns (window will be moved by x ns on each iteration)
+      uint64_t txWindowAuto;            ///< if not 0, width and pitch are adapted to the measured lag of the TX thread
+      uint64_t txWindowWidthMax;        ///< upper bound of the TX window width in ns if txWindowAuto is set
+      uint64_t txWindowPitchMax;        ///< upper bound of the TX window pitch in ns if txWindowAuto is set
       uint64_t txWindowCueThreshold;    ///< if current packet of stream is outdated by more than x ns, TX engine will dispose of packets until back in sync
       uint64_t txWindowResetThreshold;  ///< if current packet of stream is outdated by more than x ns, TX engine will reset the stream
       uint64_t txWindowPrefetchThreshold; ///< if current packet of stream is in the future by more than x ns, TX engine will reset the stream
@@ -158,6 +207,12 @@ class IasAvbTransmitSequencer : private IasMediaTransportAvb::IasIRunnable
       uint64_t txWindowMaxDropCount;    ///< maximum drop count TX engine can do for each stream during one TX window
       uint64_t txDelay;                 ///< delay launch of packet by x ns (to accomodate travel time through libigb and DMA)
       uint64_t txMaxBandwidth;          ///< maximum bandwidth to be used by all active streams in kBit/s
+      uint64_t txMaxStreams;            ///< maximum number of active streams, sets the capacity of the TX sequence
+      uint64_t txBatchSize;             ///< maximum number of packets handed over to the transmit backend at once
+      uint64_t txPrerenderWorkers;      ///< number of render workers, 0 if the packets are rendered by the TX thread
+      uint64_t txPrerenderLead;         ///< time in ns the render workers prepare the packets ahead of their launch time
+      uint64_t txPrerenderDepth;        ///< maximum number of packets rendered ahead per stream
+      uint64_t txTimestamps;            ///< if not 0, the launch lateness of the packets is measured
     };
 
     /**
@@ -171,7 +226,6 @@ class IasAvbTransmitSequencer : private IasMediaTransportAvb::IasIRunnable
       uint32_t reordered;
       uint32_t debugOutputCount;
       uint32_t debugErrCount;
-      uint32_t debugSkipCount;
       uint32_t debugTimingViolation;
       float avgPacketSent;
       float avgPacketReclaim;
@@ -196,6 +250,8 @@ class IasAvbTransmitSequencer : private IasMediaTransportAvb::IasIRunnable
       IasAvbPacket * packet;
       uint64_t         launchTime;
       DoneState      done;
+      IasAvbPacketPrerenderer * prerenderer;    // NULL if the packets are rendered by the TX thread
+      IasAvbPacketPrerenderer::Slot * slot;
 
       bool operator<(const StreamData& x) const
       {
@@ -204,8 +260,32 @@ class IasAvbTransmitSequencer : private IasMediaTransportAvb::IasIRunnable
       }
     };
 
-    typedef std::list<StreamData> AvbStreamDataList;
-    typedef std::set<IasAvbStream*> AvbStreamSet;
+    /// @brief changes of the TX sequence requested by the control path
+    enum CommandType
+    {
+      eCmdAdd,      ///< add the stream to the sequence
+      eCmdRemove,   ///< remove the stream from the sequence
+      eCmdReset     ///< remove all streams from the sequence
+    };
+
+    struct Command
+    {
+      CommandType  type;
+      StreamData   data;      // stream and render slot, packet and launch time are not used
+    };
+
+    /// @brief a packet handed over to the transmit backend, waiting for its TX time stamp
+    struct TxRecord
+    {
+      IasAvbStream * stream;      // NULL if the time stamp is not needed anymore
+      uint64_t       attime;
+      uint32_t       id;          // number of packets recorded before
+    };
+
+    typedef IasAvbTransmitSchedule<StreamData> AvbStreamDataSchedule;
+    typedef std::map<IasAvbStream*, StreamData> AvbStreamMap;
+    typedef IasAvbSpscQueue<Command> AvbCommandQueue;
+    typedef std::vector<IasAvbPacketPrerenderer*> AvbPrerendererVec;
 
     //
     // helpers
@@ -231,6 +311,14 @@ class IasAvbTransmitSequencer : private IasMediaTransportAvb::IasIRunnable
     static const uint32_t cFlagRestartThread = 2u;       ///< used to signal the worker thread it should start over
 
     static const uint32_t cTxMaxInterferenceSize = 1522u; ///< assumed maximum frame size of Non-SR packets
+    static const uint32_t cTxWireOverhead = 24u;         ///< preamble, SFD, CRC and IPG bytes not included in the packet length
+
+    static const uint32_t cMaxBatchSize = 4096u;         ///< upper limit for the transmit.batch.size setting
+    static const uint32_t cBatchMaxRetries = 8u;         ///< attempts to send a batch without progress before it is dropped
+    static const uint32_t cMaxPrerenderWorkers = 16u;    ///< upper limit for the transmit.prerender.workers setting
+    static const uint32_t cMaxStreams = 65536u;          ///< upper limit for the transmit.maxstreams setting
+    static const uint32_t cTxRecords = 4096u;            ///< packets waiting for their TX time stamp, power of two
+    static const uint32_t cTxStampChunk = 64u;           ///< TX time stamps fetched from the backend at once
 
 
     /**
@@ -250,57 +338,113 @@ class IasAvbTransmitSequencer : private IasMediaTransportAvb::IasIRunnable
      */
     uint32_t reclaimPackets();
 
+    /**
+     * @brief remember a packet accepted by the transmit backend, to match it with its TX time stamp later
+     */
+    inline void recordTx(IasAvbPacket * packet);
+
+    /**
+     * @brief match the TX time stamps of the backend with the recorded packets, update the lateness histograms
+     */
+    void processTxTimestamps();
+
+    /**
+     * @brief add a launch lateness sample to the stream and its class
+     *
+     * With igb, the sample is the DMA fetch time minus the launch time.
+     */
+    inline void recordLaunchLateness(IasAvbStream * stream, int64_t lateness);
+
+    /**
+     * @brief drop the recorded packets of a stream, or of all streams if stream is NULL
+     */
+    void invalidateTxRecords(const IasAvbStream * stream);
+
     /**
      * @brief check if link is up & running
      */
     void checkLinkStatus(bool &linkState);
 
     /**
-     * @brief check for requests to activate/deactive streams and update TX sequence
+     * @brief apply the commands queued by the control path to the TX sequence
+     */
+    void updateSequence();
+
+    /**
+     * @brief pick up new parameters of the software shaper, never blocks
      */
-    void updateSequence(AvbStreamDataList::iterator & it);
+    void updateSwShaper();
 
     /**
-     * @brief send packet, fetch next one, reorder TX sequence if necessary
+     * @brief queue a command for the worker thread, mLock must be held
+     *
+     * @returns false if the command queue is full
+     */
+    bool pushCommand(CommandType type, const StreamData & data);
+
+    /**
+     * @brief replace the queued commands by a reset followed by an add of each active stream
+     *
+     * Used while the worker thread is not running, mLock must be held.
+     *
+     * @returns false if the command queue is too small
+     */
+    bool resyncCommands();
+
+    /**
+     * @brief send packet of the first stream in the TX sequence, fetch next one, reorder TX sequence
+     *
+     * A stream that is done for the current window is parked in the TX sequence.
+     *
      * @param[in] windowStart begin of TX window
-     * @param[inout] nextStreamToService reference to next stream to service, affected by reordering
      * @return code for state of the serviced stream
      */
-    DoneState serviceStream(uint64_t windowStart, AvbStreamDataList::iterator & nextStreamToService);
+    DoneState serviceStream(uint64_t windowStart);
 
     /**
-     * @brief update TX sequence depending on packet launch times, determine the next stream that sends a packet
-     * @param[inout] iterator pointing to the element to be sorted
+     * @brief hand the packets collected by serviceStream() over to the transmit backend, in launch time order
+     *
+     * Only the packets accepted by the backend are counted as sent, the others are counted as dropped.
      */
-    void sortByLaunchTime(AvbStreamDataList::iterator & it);
+    void flushBatch();
 
     /**
-     * @brief generate diagnostic output for verbose mode
+     * @brief update the statistics for a packet accepted by the transmit backend
      */
-    void logOutput(float elapsed, float reclaimed);
+    void countTx(IasAvbStream * stream, IasAvbPacket * packet, IasDiaLogger * diaLogger);
 
     /**
-     * @brief helper to provide memory barrier functionality
+     * @brief toggle activation of the stream to force reinit of transmission time, drop the packets rendered ahead
      */
-    inline void sync();
+    void resetStream(StreamData & data, bool isError = false);
+
+    /**
+     * @brief let the least busy render worker prepare the packets of the stream, no-op if there are no render workers
+     *
+     * Called by the control path, may wait for the current render pass to end.
+     */
+    void attachPrerenderer(StreamData & data);
 
     /**
-     * @brief let the thread sleep
+     * @brief stop rendering the packets of the stream ahead, returns the rendered packets to their pool
      */
-    inline void nssleep(uint32_t ns);
+    void detachPrerenderer(StreamData & data);
 
     /**
-     * @brief return next iterator in sequence, considering wrap-around
+     * @brief generate diagnostic output for verbose mode
      */
-    inline AvbStreamDataList::iterator next(AvbStreamDataList::iterator it);
+    void logOutput(float elapsed, float reclaimed);
 
     /**
-     * @brief return previous iterator in sequence, considering wrap-around
+     * @brief helper to provide memory barrier functionality
      */
-    inline AvbStreamDataList::iterator prev(AvbStreamDataList::iterator it);
+    inline void sync();
 
     /**
      * @brief reset all packet pools of a the active streams
+     *
+     * The TX thread and the igb reclaim may get and return packets meanwhile, the pools serialize
+     * the reset by their own lock.
      */
     void resetPoolsOfActiveStreams();
 
@@ -310,22 +454,37 @@ class IasAvbTransmitSequencer : private IasMediaTransportAvb::IasIRunnable
     /// Member Variables
     ///
 
-    volatile uint32_t     mThreadControl;
+    volatile uint32_t     mThreadControl;   // cFlag* bits, set and cleared with __sync_fetch_and_or/and only
     IasThread            *mTransmitThread;
     device_t             *mIgbDevice;
+    IasAvbTransmitBackend *mBackend;      // NULL: packets are sent with libigb
     uint32_t              mQueueIndex;
     IasAvbSrClass         mClass;
-    int32_t               mRequestCount;
-    int32_t               mResponseCount;
+    uint32_t              mInstance;      // index within the sequencers of mClass
+    int32_t               mCpu;           // CPU the worker thread is pinned to, -1 = not pinned
     uint32_t              mCurrentBandwidth;
     uint32_t              mCurrentMaxIntervalFrames;
     uint32_t              mMaxFrameSizeHigh; // used calculate HiCredit for Class B/C
     bool                  mUseShaper;
     uint32_t              mShaperBwRate;
-    AvbStreamDataList     mSequence;
-    AvbStreamSet          mActiveStreams;
+    uint32_t              mBandwidthHigh;   // kBit/s, used to calculate the software shaper HiCredit for Class B/C
+    IasAvbCreditShaper    mSwShaper;        // worker thread only, used with a transmit backend
+    IasAvbCreditShaper::Config mSwShaperConfig; // set by updateShaper(), protected by mSwShaperLock
+    IasAvbTransmitWindowTuner mWindowTuner; // worker thread only, used if txWindowAuto is set
+    std::atomic<bool>     mSwShaperChanged;
+    std::mutex            mSwShaperLock;
+    AvbStreamDataSchedule mSequence;
+    std::vector<IasAvbPacket*> mBatch;    // packets waiting for flushBatch(), capacity set by init()
+    std::vector<TxRecord> mTxRecords;     // ring of cTxRecords entries, empty unless time stamps are taken by the backend
+    uint32_t              mTxRecordCount; // number of packets recorded
+    IasAvbLatencyHistogram mTxLateness[IasAvbTSpec::cIasAvbNumSupportedClasses];
+    AvbPrerendererVec     mPrerenderers;
+    AvbStreamMap          mActiveStreams; // control path only
+    AvbCommandQueue       mCommands;      // control path -> worker thread, pushed with mLock held
+    uint32_t              mCommandCount;  // number of commands pushed
+    std::atomic<uint32_t> mCommandsDone;  // number of commands applied by the worker thread
     bool                  mDoReclaim;
-    std::mutex            mLock;
+    std::mutex            mLock;          // serializes the control path, never taken by the worker thread
     Diag                  mDiag;
     Config                mConfig;
     IasAvbStreamHandlerEventInterface *mEventInterface;
@@ -334,7 +493,6 @@ class IasAvbTransmitSequencer : private IasMediaTransportAvb::IasIRunnable
     //IasWatchdog::IasSystemdWatchdogManager *mWatchdog;
     bool                  mFirstRun;
     bool                  mBTMEnable;
-    bool                  mStrictPktOrderEn;
 };
 
 
@@ -344,16 +502,6 @@ inline void IasAvbTransmitSequencer::sync()
   __sync_synchronize();
 }
 
-inline void IasAvbTransmitSequencer::nssleep( uint32_t ns )
-{
-  // sleep some time and try again
-  struct timespec req;
-  struct timespec rem;
-  req.tv_nsec = ns;
-  req.tv_sec = 0;
-  nanosleep(&req, &rem);
-}
-
 inline void IasAvbTransmitSequencer::setMaxFrameSizeHigh(uint32_t maxFrameSize)
 {
   mMaxFrameSizeHigh = maxFrameSize;
@@ -364,31 +512,46 @@ inline uint32_t IasAvbTransmitSequencer::getMaxFrameSizeHigh()
   return mMaxFrameSizeHigh;
 }
 
-inline IasAvbTransmitSequencer::AvbStreamDataList::iterator IasAvbTransmitSequencer::next(AvbStreamDataList::iterator it)
+inline void IasAvbTransmitSequencer::setBandwidthHigh(uint32_t bandwidth)
+{
+  mBandwidthHigh = bandwidth;
+}
+
+inline const IasAvbLatencyHistogram& IasAvbTransmitSequencer::getLaunchLateness(IasAvbSrClass srClass) const
+{
+  AVB_ASSERT(uint32_t(srClass) < IasAvbTSpec::cIasAvbNumSupportedClasses);
+  return mTxLateness[uint32_t(srClass)];
+}
+
+inline void IasAvbTransmitSequencer::resetLaunchLateness(IasAvbSrClass srClass)
+{
+  AVB_ASSERT(uint32_t(srClass) < IasAvbTSpec::cIasAvbNumSupportedClasses);
+  mTxLateness[uint32_t(srClass)].requestReset();
+}
+
+inline void IasAvbTransmitSequencer::recordTx(IasAvbPacket * packet)
 {
-  AVB_ASSERT(it != mSequence.end());
-  it++;
-  if (mSequence.end() == it)
+  if (!mTxRecords.empty())
   {
-    it = mSequence.begin();
+    TxRecord & record = mTxRecords[mTxRecordCount & (cTxRecords - 1u)];
+    record.stream = IasAvbPacketPool::getPacketOwner(packet);
+    record.attime = packet->attime;
+    record.id = mTxRecordCount;
+    mTxRecordCount++;
   }
-  return it;
 }
 
-inline IasAvbTransmitSequencer::AvbStreamDataList::iterator IasAvbTransmitSequencer::prev(AvbStreamDataList::iterator it)
+inline void IasAvbTransmitSequencer::recordLaunchLateness(IasAvbStream * stream, int64_t lateness)
 {
-  if (it != mSequence.end())
+  const uint32_t srClass = uint32_t(stream->getTSpec().getClass());
+
+  stream->recordLaunchLateness(lateness);
+  if (srClass < IasAvbTSpec::cIasAvbNumSupportedClasses)
   {
-    if (mSequence.begin() == it)
-    {
-      it = mSequence.end();
-    }
-    it--;
+    mTxLateness[srClass].record(lateness);
   }
-  return it;
 }
 
-
 inline IasAvbSrClass IasAvbTransmitSequencer::getClass() const
 {
   return mClass;
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file    IasAvbTransmitWindowTuner.hpp
+ * @brief   The definition of the IasAvbTransmitWindowTuner class.
+ * @details Adapts the TX window width and pitch of the transmit sequencer to the measured scheduling lag.
+ * @date    2018
+ */
+
+#ifndef IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBTRANSMITWINDOWTUNER_HPP
+#define IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBTRANSMITWINDOWTUNER_HPP
+
+#include "IasAvbTypes.hpp"
+
+namespace IasMediaTransportAvb {
+
+/**
+ * @brief closed-loop controller for the TX window of the transmit sequencer
+ *
+ * In each cycle the TX thread sends all packets launched within [windowStart, windowStart + width], then
+ * sleeps until windowStart + pitch. A packet just beyond the window is handed over in the next cycle, which
+ * starts late by the oversleep of the thread and finishes late by the time the thread takes to send. So
+ * no packet is late as long as width - pitch (the slack) exceeds that lag.
+ *
+ * The tuner tracks the peak lag, rising at once and decaying slowly, and keeps the slack at 1.5 times
+ * the peak, but not below minSlack. The pitch grows by one step after growCycles cycles without a dry
+ * stream, up to pitchMax, to save wakeups, and goes back towards pitchInit if streams run dry. If the slack
+ * does not fit into widthMax, the pitch is reduced down to pitchMin, as the slack has priority.
+ *
+ * Not thread-safe, the tuner is owned by the TX thread of the sequencer.
+ */
+class IasAvbTransmitWindowTuner
+{
+  public:
+
+    /// @brief bounds of the TX window, all values in ns
+    struct Config
+    {
+      Config();
+      uint64_t  widthInit;      ///< width to start with
+      uint64_t  pitchInit;      ///< pitch to start with, the pitch is not reduced below this for dry streams
+      uint64_t  widthMax;       ///< upper bound of the width
+      uint64_t  pitchMin;       ///< lower bound of the pitch
+      uint64_t  pitchMax;       ///< upper bound of the pitch
+      uint64_t  minSlack;       ///< lower bound of width - pitch
+      uint64_t  step;           ///< step width for changes of the pitch
+      uint32_t  growCycles;     ///< number of cycles without dry streams before the pitch grows
+    };
+
+    /**
+     *  @brief Constructor.
+     */
+    IasAvbTransmitWindowTuner();
+
+    /**
+     *  @brief Destructor, virtual by default.
+     */
+    virtual ~IasAvbTransmitWindowTuner();
+
+    /**
+     * @brief checks and applies the bounds, starts over with the initial width and pitch
+     *
+     * @returns eIasAvbProcOK on success, eIasAvbProcInvalidParam if the bounds contradict each other
+     */
+    IasAvbProcessingResult init(const Config &config);
+
+    /**
+     * @brief starts over with the initial width and pitch
+     */
+    void reset();
+
+    /**
+     * @brief feeds the measurements of a TX cycle, computes width and pitch of the next cycle
+     *
+     * @param[in] lag       time in ns the last packet of the cycle has been handed over after the nominal
+     *                      start of the cycle, i.e. oversleep plus processing time
+     * @param[in] dryCount  number of streams that had no packet ready within the window
+     */
+    void update(uint64_t lag, uint32_t dryCount);
+
+    inline uint64_t getWidth() const { return mWidth; }
+
+    inline uint64_t getPitch() const { return mPitch; }
+
+    inline uint64_t getPeakLag() const { return mPeakLag; }
+
+  private:
+    /**
+     * @brief Copy constructor, private unimplemented to prevent misuse.
+     */
+    IasAvbTransmitWindowTuner(IasAvbTransmitWindowTuner const &other);
+
+    /**
+     * @brief Assignment operator, private unimplemented to prevent misuse.
+     */
+    IasAvbTransmitWindowTuner& operator=(IasAvbTransmitWindowTuner const &other);
+
+    static const uint32_t cReleaseShift = 8u;    ///< the peak lag decays by 1/256 of the difference per cycle
+
+    Config    mConfig;
+    uint64_t  mWidth;
+    uint64_t  mPitch;
+    uint64_t  mTargetPitch;     // pitch wanted for the dry streams, before the slack is taken into account
+    uint64_t  mPeakLag;
+    uint32_t  mQuietCycles;     // cycles without dry streams since the last change of the pitch
+};
+
+} // namespace IasMediaTransportAvb
+
+#endif /* IAS_MEDIATRANSPORT_AVBSTREAMHANDLER_IASAVBTRANSMITWINDOWTUNER_HPP */
@@ -74,6 +74,7 @@ class IasAvbVideoStream : public IasAvbStream, public virtual IasLocalVideoStrea
 
     // implementation mandated through base class
     virtual void readFromAvbPacket(const void* packet, size_t length);
+    virtual void readFromAvbPackets(const RxPacket* packets, size_t count);
     virtual void derivedCleanup();
 
     // overrides
@@ -115,6 +116,8 @@ class IasAvbVideoStream : public IasAvbStream, public virtual IasLocalVideoStrea
     ///
     IasAvbProcessingResult prepareAllPackets();
     void resetTime(bool hard);
+    // mLock has to be held
+    void readFromAvbPacketLocked(const void* packet, size_t length);
     bool finalizeAvbPacket(IasLocalVideoBuffer::IasVideoDesc *descPacket);
     bool prepareDummyAvbPacket(IasAvbPacket* packet);
 
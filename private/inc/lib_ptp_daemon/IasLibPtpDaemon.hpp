@@ -27,7 +27,10 @@ extern "C"
 #include "ipcdef.hpp"
 #include "linux_ipc.hpp"
 
+#include <atomic>
+#include <condition_variable>
 #include <mutex>
+#include <set>
 #include <dlt.h>
 
 namespace IasMediaTransportAvb {
@@ -216,6 +219,45 @@ class IasLibPtpDaemon
      */
     inline uint64_t getRealTsc() const;
 
+    /**
+     * @brief Starts a virtual clock instead of connecting to the PTP daemon, for simulations.
+     *
+     * Local time, PTP time and system time are all the same virtual time then, which only advances
+     * through sleepUntil(). The epoch never changes and isPtpReady() returns true.
+     *
+     * @param[in] startTime  initial time in ns, must not be 0
+     * @return eIasAvbProcOK on success, error code otherwise
+     */
+    IasAvbProcessingResult initVirtualClock(uint64_t startTime);
+
+    /**
+     * @brief Returns true if the time is driven by the virtual clock.
+     */
+    inline bool isVirtualClock() const;
+
+    /**
+     * @brief Returns the system time as used by ptpToSys(), i.e. getTsc() or the virtual time.
+     */
+    inline uint64_t getSysTime() const;
+
+    /**
+     * @brief Sleeps until the given system time is reached.
+     *
+     * With the virtual clock, the caller waits until as many threads are sleeping as are attached to
+     * the clock, then the clock jumps to the earliest wakeup time. So the threads see the same sequence
+     * of wakeups in each run, regardless of how long they take to process in between.
+     *
+     * @param[in] sysTime  absolute system time in ns
+     * @return 0 on success, the negated error number returned by clock_nanosleep() otherwise
+     */
+    int32_t sleepUntil(uint64_t sysTime);
+
+    //@{
+    /// @brief registers/unregisters a thread sleepUntil() has to wait for, no-op without the virtual clock
+    void attachVirtualClock();
+    void detachVirtualClock();
+    //@}
+
   private:
 
     struct Diag
@@ -348,6 +390,12 @@ class IasLibPtpDaemon
     uint64_t                mTscFreq;
     uint64_t                mRawToLocalTstampThreshold;
     std::vector<double>  mRawToLocalFactors;
+    bool                  mVirtualClock;
+    std::atomic<uint64_t> mVirtualTime;          // ns, only advanced by sleepUntil()
+    uint32_t              mVirtualClockUsers;    // number of attached threads
+    std::multiset<uint64_t> mVirtualWakeups;     // wakeup times of the threads sleeping on the virtual clock
+    std::mutex            mVirtualClockLock;     // protects mVirtualClockUsers and mVirtualWakeups
+    std::condition_variable mVirtualClockCond;
 }; // class IasLibPtpDaemon
 
 inline uint64_t IasLibPtpDaemon::getTsc()
@@ -401,6 +449,16 @@ inline uint64_t IasLibPtpDaemon::getPtpTime()
   return getLocalTime();
 }
 
+inline bool IasLibPtpDaemon::isVirtualClock() const
+{
+  return mVirtualClock;
+}
+
+inline uint64_t IasLibPtpDaemon::getSysTime() const
+{
+  return mVirtualClock ? mVirtualTime.load() : getTsc();
+}
+
 inline uint64_t IasLibPtpDaemon::getRealTsc() const
 {
   uint32_t low = 0u;
@@ -14,11 +14,13 @@
 #include "avb_streamhandler/IasAvbPacketPool.hpp"
 #include "avb_streamhandler/IasAvbStreamHandlerEnvironment.hpp"
 #include "avb_streamhandler/IasAvbRxStreamClockDomain.hpp"
+#include "avb_streamhandler/IasAvbSampleInterleaver.hpp"
 #include "lib_ptp_daemon/IasLibPtpDaemon.hpp"
 #include "avb_helper/ias_safe.h"
 
 #include <arpa/inet.h>
 #include <cstdlib>
+#include <cstring>
 #include <math.h>
 #include <iomanip>
 // TO BE REPLACED #include "core_libraries/btm/ias_dlt_btm.h"
@@ -149,6 +151,13 @@ IasAvbAudioStream::IasAvbAudioStream()
   , mFirstRun(true)
   , mBTMEnable(false)
   , mMasterTimeUpdateMinInterval(0u)
+  , mHeaderCommon(0u)
+  , mHeaderFormat(0u)
+  , mHeaderNumChannels(0u)
+  , mHeaderDataLength(0u)
+  , mHeaderLayout(0u)
+  , mHeaderFormatValid(false)
+  , mSparseTimestamps(false)
 {
   // do nothing
 }
@@ -273,12 +282,13 @@ IasAvbProcessingResult IasAvbAudioStream::initTransmit(IasAvbSrClass srClass, ui
 
       if (eIasAvbProcOK == result)
       {
-        mTempBuffer = new (nothrow) AudioData[mSamplesPerChannelPerPacket];
+        // one slice per channel, interleaved into the packet at once
+        mTempBuffer = new (nothrow) AudioData[uint32_t(mSamplesPerChannelPerPacket) * maxNumberChannels];
 
         if (NULL == mTempBuffer)
         {
           /**
-           * @log Not enough memory to allocate AudioData[mSamplesPerChannelPerPacket]
+           * @log Not enough memory to allocate AudioData[mSamplesPerChannelPerPacket * maxNumberChannels]
            */
           DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX,
                   "Not enough memory to allocate AudioData[mSamplesPerChannelPerPacket]! mSamplesPerChannelPerPacket=",
@@ -432,7 +442,8 @@ IasAvbProcessingResult IasAvbAudioStream::initReceive(IasAvbSrClass srClass, uin
         mExcessSamples = 1u;
         (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cRxExcessPayload, mExcessSamples);
 
-        mTempBuffer = new (nothrow) AudioData[mSamplesPerChannelPerPacket + mExcessSamples];
+        // one slice per channel, deinterleaved from the packet at once
+        mTempBuffer = new (nothrow) AudioData[(mSamplesPerChannelPerPacket + mExcessSamples) * maxNumberChannels];
 
         if (NULL == mTempBuffer)
         {
@@ -598,6 +609,20 @@ IasAvbProcessingResult IasAvbAudioStream::prepareAllPackets()
      */
     referencePacket->len = uint32_t(packetData - packetStart);
 
+    // keep the header parts patched per packet, see writeAvtpHeader()
+    const uint8_t* const avtpBase8 = packetStart + ETH_HLEN + 4u;
+    uint32_t common = 0u;
+    (void) std::memcpy(&common, avtpBase8 + IasAvbAafHeaderLayout::cCommonOffset, sizeof common);
+    (void) std::memcpy(&mHeaderFormat, avtpBase8 + IasAvbAafHeaderLayout::cFormatOffset, sizeof mHeaderFormat);
+    mSparseTimestamps = (eIasAvbCompLatest == mCompatibilityModeAudio) && isSparse;
+    mHeaderCommon = ntohl(common) & ~(uint32_t(0xFFu) << IasAvbAafHeaderLayout::cSeqNumShift)
+        & ~IasAvbAafHeaderLayout::cTuMask;
+    if (mSparseTimestamps)
+    {
+      mHeaderCommon &= ~IasAvbAafHeaderLayout::cTvMask;
+    }
+    mHeaderFormatValid = false;
+
     // now copy the template to all other packets in the pool
     result = getPacketPool().initAllPacketsFromTemplate(referencePacket);
 
@@ -613,6 +638,38 @@ IasAvbProcessingResult IasAvbAudioStream::prepareAllPackets()
 }
 
 
+void IasAvbAudioStream::updateHeaderFormat(uint16_t numChannels, uint8_t layout, uint16_t streamDataLength)
+{
+  // offsets relative to IasAvbAafHeaderLayout::cFormatOffset
+  uint8_t* const format = reinterpret_cast<uint8_t*>(&mHeaderFormat);
+
+  if ((eIasAvbCompSaf == mCompatibilityModeAudio) || (eIasAvbCompD6 == mCompatibilityModeAudio))
+  {
+    format[1] = layout;
+    // set channels_per_frame, assumes M1 and M0 fields are always 0
+    format[6] = uint8_t(numChannels >> 8);
+    format[7] = uint8_t(numChannels);
+  }
+  else // eIasAvbCompLatest
+  {
+    // set channels_per_frame
+    format[1] = static_cast<uint8_t>((mSampleFrequencyCode << 4) | (uint8_t) ((numChannels >> 8) & 0x0003u));
+    format[2] = (uint8_t)(numChannels & 0x00ffu);
+    // Pass through layout value, any translation must be done by the user application
+    // Write only the lower 4 bits from the channel layout into the 'evt' Packet Info field
+    format[6] = uint8_t((format[6] & 0xF0) | (layout & 0x0F));
+  }
+
+  format[4] = uint8_t(streamDataLength >> 8);
+  format[5] = uint8_t(streamDataLength);
+
+  mHeaderNumChannels = numChannels;
+  mHeaderLayout = layout;
+  mHeaderDataLength = streamDataLength;
+  mHeaderFormatValid = true;
+}
+
+
 void IasAvbAudioStream::activationChanged()
 {
   /*
@@ -767,9 +824,8 @@ bool IasAvbAudioStream::writeToAvbPacket(IasAvbPacket* packet, uint64_t nextWind
     AVB_ASSERT(NULL != packet);
     AVB_ASSERT(NULL != packet->getBasePtr());
     uint8_t* const avtpBase8 = static_cast<uint8_t*>(packet->getBasePtr()) + ETH_HLEN + 4u; // consider VLAN tag
-    uint16_t* const avtpBase16 = reinterpret_cast<uint16_t*>(avtpBase8);
-    uint32_t* const avtpBase32 = reinterpret_cast<uint32_t*>(avtpBase8);
     uint16_t numChannels = 0u;
+    uint8_t layout = 0u;
     uint16_t written = 0u;
     bool   isReadReady = false;
 
@@ -790,32 +846,18 @@ bool IasAvbAudioStream::writeToAvbPacket(IasAvbPacket* packet, uint64_t nextWind
     }
 
     // time-stamping hard-coded for SAF
-    // write time stamp to packet
-    avtpBase32[3] = htonl(uint32_t(mRefPlaneSampleTime + getPresentationTimeOffset()));
+    // time stamp written to the packet along with the other header fields below
+    const uint32_t avtpTimestamp = uint32_t(mRefPlaneSampleTime + getPresentationTimeOffset());
 
     packet->attime = mPacketLaunchTime;
 
-    // If sparse time stamping bit (sp) is set to true
-    if (avtpBase8[22] & 0x10)
+    // If sparse time stamping bit (sp) is set, the time stamp valid bit (tv) is set every 8th packet
+    if (mSparseTimestamps && !(mSeqNum % 8))
     {
-        // Set time stamp valid bit (tv) to true every 8th packet
-        if (!(mSeqNum % 8))
-        {
-            DLT_LOG_CXX(*mLog, DLT_LOG_VERBOSE, LOG_PREFIX, "Sparse Time Stamping valid on packet SeqNum",
-                    mSeqNum);
-            avtpBase8[1] |= 0x01;
-        }
-        // Otherwise set it to false
-        else
-        {
-            avtpBase8[1] &= uint8_t(~0x01);
-        }
+        DLT_LOG_CXX(*mLog, DLT_LOG_VERBOSE, LOG_PREFIX, "Sparse Time Stamping valid on packet SeqNum",
+                mSeqNum);
     }
 
-    // insert sequence number and advance for next packet
-    avtpBase8[2] = mSeqNum;
-    mSeqNum++;
-
 
     if (isConnected())
     {
@@ -917,7 +959,7 @@ bool IasAvbAudioStream::writeToAvbPacket(IasAvbPacket* packet, uint64_t nextWind
       // observation logic only active for first channel, assume all others behave synchronously
       for (ch = 0u; ch < numChannels; ch++)
       {
-        uint8_t * pBase = avtpBase8 + 24 + getSampleSize(mAudioFormat) * ch;
+        AudioData * const channelBuffer = mTempBuffer + (ch * mSamplesPerChannelPerPacket);
 
         if (mDummySamplesSent > 0u)
         {
@@ -928,7 +970,7 @@ bool IasAvbAudioStream::writeToAvbPacket(IasAvbPacket* packet, uint64_t nextWind
           if (true == isReadReady)
           {
             uint64_t timeStamp = 0u;
-            mLocalStream->readLocalAudioBuffer(ch, mTempBuffer, mSamplesPerChannelPerPacket, written, timeStamp);
+            mLocalStream->readLocalAudioBuffer(ch, channelBuffer, mSamplesPerChannelPerPacket, written, timeStamp);
 
             if ((0u == ch) && (0u != written) && (0u != timeStamp))
             {
@@ -970,7 +1012,7 @@ bool IasAvbAudioStream::writeToAvbPacket(IasAvbPacket* packet, uint64_t nextWind
           written = mSamplesPerChannelPerPacket;
           for (uint32_t sample = 0u; sample < written; sample++)
           {
-            mTempBuffer[sample] = 0.0;
+            channelBuffer[sample] = 0.0;
           }
         }
         else
@@ -985,26 +1027,18 @@ bool IasAvbAudioStream::writeToAvbPacket(IasAvbPacket* packet, uint64_t nextWind
           }
         }
 
-        // copy samples to packet and do format conversion
-        if (mUseSaturation)
-        {
-          for (uint32_t sample = 0u; sample < written; sample++)
-          {
-            *reinterpret_cast<uint16_t*>(pBase) = htons(uint16_t(mTempBuffer[sample]));
-            pBase += mStride;
-          }
-        }
-        else
+        // a channel delivering less samples than the others is padded with silence
+        for (uint32_t sample = written; sample < mSamplesPerChannelPerPacket; sample++)
         {
-          for (uint32_t sample = 0u; sample < written; sample++)
-          {
-            *reinterpret_cast<uint16_t*>(pBase) = htons(uint16_t(int16_t(mTempBuffer[sample])));
-            pBase += mStride;
-          }
+          channelBuffer[sample] = 0;
         }
       }
 
-      uint8_t layout = 0u;
+      // copy samples of all channels to packet and do format conversion
+      AVB_ASSERT(mStride == (numChannels * getSampleSize(mAudioFormat)));
+      IasAvbSampleInterleaver::interleave(avtpBase8 + IasAvbAudioFormatTraits<IasAvbAudioFormat::eIasAvbAudioFormatSaf16>::cHeaderSize,
+          mTempBuffer, mSamplesPerChannelPerPacket, numChannels, mSamplesPerChannelPerPacket);
+
       if (mLocalStream->hasSideChannel())
       {
         uint16_t samplesWritten = 0;
@@ -1034,16 +1068,7 @@ bool IasAvbAudioStream::writeToAvbPacket(IasAvbPacket* packet, uint64_t nextWind
         mLocalStream->unlock();
       }
 
-      if ((eIasAvbCompSaf== mCompatibilityModeAudio) || (eIasAvbCompD6 == mCompatibilityModeAudio))
-      {
-        avtpBase8[17] = layout;
-      }
-      else // eIasAvbCompLatest
-      {
-        // Pass through layout value, any translation must be done by the user application
-        // Write only the lower 4 bits from the channel layout into the 'evt' Packet Info field
-        avtpBase8[22] = uint8_t((avtpBase8[22] & 0xF0) | (layout & 0x0F));
-      }
+      // the layout goes to the format block of the header, see updateHeaderFormat()
     }
     else
     {
@@ -1054,23 +1079,10 @@ bool IasAvbAudioStream::writeToAvbPacket(IasAvbPacket* packet, uint64_t nextWind
       numChannels = 0u;
     }
 
-    // set channels_per_frame
     AVB_ASSERT(numChannels <= mMaxNumChannels);
 
-    if (eIasAvbCompLatest == mCompatibilityModeAudio)
-    {
-      uint8_t *avtpData = &avtpBase8[17];
-      *avtpData++ = static_cast<uint8_t>((mSampleFrequencyCode << 4) | (uint8_t) ((numChannels >> 8) & 0x0003u));
-      *avtpData = (uint8_t)(numChannels & 0x00ffu);
-    }
-    else
-    {
-      *(avtpBase16 + 11) = htons(numChannels); // assumes M1 and M0 fields are always 0
-    }
-
-    // set packet length and stream_data_length
+    // set packet length, stream_data_length goes to the header below
     const uint16_t streamDataLength = uint16_t(written * numChannels * getSampleSize(mAudioFormat));
-    *(avtpBase16 + 10) = htons(streamDataLength);
     packet->len = streamDataLength + IasAvbAudioFormatTraits<IasAvbAudioFormat::eIasAvbAudioFormatSaf16>::cHeaderSize +
         IasAvbTSpec::cIasAvbPerFrameOverhead;
 #if DEBUG_LAUNCHTIME
@@ -1087,8 +1099,10 @@ bool IasAvbAudioStream::writeToAvbPacket(IasAvbPacket* packet, uint64_t nextWind
     IasAvbClockDomain * const pClockDomain = getClockDomain();
     AVB_ASSERT(NULL != pClockDomain);
 
-    // set timestamp uncertain bit, depending on lock state
-    avtpBase8[3] = (IasAvbClockDomain::eIasAvbLockStateLocked == pClockDomain->getLockState()) ? 0x00u : 0x01u;
+    // set timestamp uncertain bit depending on lock state, insert sequence number and advance for next packet
+    const bool uncertain = (IasAvbClockDomain::eIasAvbLockStateLocked != pClockDomain->getLockState());
+    writeAvtpHeader(avtpBase8, avtpTimestamp, uncertain, numChannels, layout, streamDataLength);
+    mSeqNum++;
 
     // advance ref pane for next packet
     AVB_ASSERT(0u != mMasterTime); // otherwise, we would have created a dummy packet above
@@ -1178,7 +1192,38 @@ bool IasAvbAudioStream::writeToAvbPacket(IasAvbPacket* packet, uint64_t nextWind
 void IasAvbAudioStream::readFromAvbPacket(const void* const packet, const size_t length)
 {
   mLock.lock();
+  readFromAvbPacketLocked(packet, length, false);
+  mLock.unlock();
+}
+
+
+void IasAvbAudioStream::readFromAvbPackets(const RxPacket* const packets, const size_t count)
+{
+  mLock.lock();
+
+  // lock the local stream once for the whole burst rather than once per packet
+  const bool lockLocalStream = isConnected() && mLocalStream->hasBufferDesc();
+  if (lockLocalStream)
+  {
+    mLocalStream->lock();
+  }
+
+  for (size_t i = 0u; i < count; i++)
+  {
+    readFromAvbPacketLocked(packets[i].packet, packets[i].length, lockLocalStream);
+  }
+
+  if (lockLocalStream)
+  {
+    mLocalStream->unlock();
+  }
 
+  mLock.unlock();
+}
+
+
+void IasAvbAudioStream::readFromAvbPacketLocked(const void* const packet, const size_t length, const bool localStreamLocked)
+{
   if (isInitialized() && isReceiveStream())
   {
     IasAvbStreamState newState = IasAvbStreamState::eIasAvbStreamInvalidData;
@@ -1385,6 +1430,7 @@ void IasAvbAudioStream::readFromAvbPacket(const void* const packet, const size_t
       // calculate iteration helpers before we adjust the number of channels
       const uint16_t sampleSize = getSampleSize(mAudioFormat);
       const uint16_t stride = static_cast<uint16_t>(sampleSize * numChannels);
+      const uint16_t frameChannels = numChannels;
       uint16_t numSamplesPerChannel = 0u;
       if (0u != stride)
       {
@@ -1408,10 +1454,14 @@ void IasAvbAudioStream::readFromAvbPacket(const void* const packet, const size_t
         AVB_ASSERT(NULL != mLocalStream);
 
         // prevent AvbAlsaWrk from accessing the local audio stream
-        if (true == mLocalStream->hasBufferDesc())
+        const bool lockLocalStream = !localStreamLocked && mLocalStream->hasBufferDesc();
+        if (lockLocalStream)
         {
           mLocalStream->lock();
+        }
 
+        if (true == mLocalStream->hasBufferDesc())
+        {
           if (IasAvbStreamState::eIasAvbStreamValid != oldState)
           {
             // reset buffers to flush old data samples and timestamp epoch
@@ -1427,20 +1477,16 @@ void IasAvbAudioStream::readFromAvbPacket(const void* const packet, const size_t
           }
         }
 
+        AVB_ASSERT(IasAvbAudioFormat::eIasAvbAudioFormatSaf16 == mAudioFormat);
+        AVB_ASSERT(numChannels <= mMaxNumChannels);
+        const uint32_t channelStride = mSamplesPerChannelPerPacket + mExcessSamples;
+        IasAvbSampleInterleaver::deinterleave(mTempBuffer, channelStride, avtpBase8 + 24u,
+            frameChannels, numChannels, numSamplesPerChannel);
+
         for (channel = 0u; channel < numChannels; channel++)
         {
-          AVB_ASSERT(IasAvbAudioFormat::eIasAvbAudioFormatSaf16 == mAudioFormat);
-
-          const uint8_t* in = avtpBase8 + (24u + (sampleSize * channel));
-
-          for (uint32_t sample = 0u; sample < numSamplesPerChannel; sample++)
-          {
-            // orig
-            mTempBuffer[sample] = AudioData(int16_t(ntohs(*reinterpret_cast<const uint16_t*>(in))));
-            in += stride;
-          }
-
-          mLocalStream->writeLocalAudioBuffer(channel, mTempBuffer, numSamplesPerChannel, written, timestamp);
+          mLocalStream->writeLocalAudioBuffer(channel, mTempBuffer + (channel * channelStride), numSamplesPerChannel,
+              written, timestamp);
 
 #if defined(DEBUG_LISTENER_UNCERTAINTY)
           /* DO NOT ENABLE THESE LINES FOR PRODUCTION SW */
@@ -1500,7 +1546,7 @@ void IasAvbAudioStream::readFromAvbPacket(const void* const packet, const size_t
           mLocalStream->writeLocalAudioBuffer(channel, mTempBuffer, numSamplesPerChannel, written, timestamp);
         }
 
-        if (true == mLocalStream->hasBufferDesc())
+        if (lockLocalStream)
         {
           mLocalStream->unlock();
         }
@@ -1596,8 +1642,6 @@ void IasAvbAudioStream::readFromAvbPacket(const void* const packet, const size_t
       }
     }
   }
-
-  mLock.unlock();
 }
 
 
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+/**
+ * @file    IasAvbCreditShaper.cpp
+ * @brief   The implementation of the IasAvbCreditShaper class.
+ * @date    2018
+ */
+
+#include "avb_streamhandler/IasAvbCreditShaper.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace IasMediaTransportAvb {
+
+static const double cNsPerSec = 1e9;
+
+
+/*
+ *  Constructor.
+ */
+IasAvbCreditShaper::IasAvbCreditShaper()
+  : mConfig()
+  , mCredit(0.0)
+  , mCreditTime(0u)
+{
+  mConfig.portTransmitRate = 0u;
+  mConfig.idleSlope = 0u;
+  mConfig.hiCredit = 0.0;
+  mConfig.loCredit = 0.0;
+}
+
+
+/*
+ *  Destructor.
+ */
+IasAvbCreditShaper::~IasAvbCreditShaper()
+{
+  // do nothing
+}
+
+
+IasAvbProcessingResult IasAvbCreditShaper::calculate(Config &config, uint64_t portTransmitRate, uint64_t idleSlope,
+    uint32_t maxFrameSize, uint32_t maxInterferenceSize, uint64_t idleSlopeHigh, uint32_t maxFrameSizeHigh)
+{
+  IasAvbProcessingResult result = eIasAvbProcOK;
+
+  if ((0u == portTransmitRate) || ((idleSlope + idleSlopeHigh) >= portTransmitRate))
+  {
+    result = eIasAvbProcInvalidParam;
+  }
+  else
+  {
+    const double portRate = double(portTransmitRate);
+    const double slope = double(idleSlope);
+
+    config.portTransmitRate = portTransmitRate;
+    config.idleSlope = idleSlope;
+
+    if (0u == idleSlopeHigh)
+    {
+      config.hiCredit = double(maxInterferenceSize) * 8.0 * slope / portRate;
+    }
+    else
+    {
+      config.hiCredit = slope * ((double(maxInterferenceSize) * 8.0 / (portRate - double(idleSlopeHigh)))
+          + (double(maxFrameSizeHigh) * 8.0 / portRate));
+    }
+
+    config.loCredit = double(maxFrameSize) * 8.0 * (slope - portRate) / portRate;
+  }
+
+  return result;
+}
+
+
+void IasAvbCreditShaper::configure(const Config &config)
+{
+  mConfig = config;
+  reset();
+}
+
+
+void IasAvbCreditShaper::reset()
+{
+  mCredit = 0.0;
+  mCreditTime = 0u;
+}
+
+
+uint64_t IasAvbCreditShaper::shape(uint64_t queued, uint64_t earliest, uint32_t frameSize)
+{
+  uint64_t launchTime = queued;
+
+  if (isEnabled())
+  {
+    const double idleSlope = double(mConfig.idleSlope);
+    double credit = mCredit;
+    uint64_t waitingSince = mCreditTime;
+
+    if (queued > mCreditTime)
+    {
+      // the queue has been empty since the last transmission
+      if (credit < 0.0)
+      {
+        credit = std::min(0.0, credit + (idleSlope * double(queued - mCreditTime) / cNsPerSec));
+      }
+      else
+      {
+        credit = 0.0;
+      }
+      waitingSince = queued;
+    }
+
+    // the frame waits for the end of the previous transmission or for the interfering traffic
+    uint64_t start = std::max(waitingSince, earliest);
+    credit = std::min(mConfig.hiCredit, credit + (idleSlope * double(start - waitingSince) / cNsPerSec));
+
+    if (credit < 0.0)
+    {
+      // wait until the credit has recovered
+      start += uint64_t(std::ceil(-credit * cNsPerSec / idleSlope));
+      credit = 0.0;
+    }
+
+    const double frameBits = double(frameSize) * 8.0;
+    const uint64_t duration = uint64_t(std::ceil(frameBits * cNsPerSec / double(mConfig.portTransmitRate)));
+
+    mCredit = credit + (frameBits * (idleSlope - double(mConfig.portTransmitRate)) / double(mConfig.portTransmitRate));
+    mCreditTime = start + duration;
+    launchTime = start;
+  }
+
+  return launchTime;
+}
+
+
+} // namespace IasMediaTransportAvb
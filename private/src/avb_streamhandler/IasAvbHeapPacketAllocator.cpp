@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file    IasAvbHeapPacketAllocator.cpp
+ * @brief   This is the implementation of the IasAvbHeapPacketAllocator class.
+ * @date    2018
+ */
+
+#include "avb_streamhandler/IasAvbHeapPacketAllocator.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+namespace IasMediaTransportAvb
+{
+
+IasAvbHeapPacketAllocator::IasAvbHeapPacketAllocator()
+{
+  // do nothing
+}
+
+
+IasAvbHeapPacketAllocator::~IasAvbHeapPacketAllocator()
+{
+  // do nothing
+}
+
+
+IasAvbProcessingResult IasAvbHeapPacketAllocator::allocPage(size_t minSize, Page &page)
+{
+  IasAvbProcessingResult result = eIasAvbProcOK;
+  const size_t pageSize = size_t(::sysconf(_SC_PAGESIZE));
+  void* mem = NULL;
+
+  // one system page at a time, like the igb device
+  (void) minSize;
+
+  if (0 != ::posix_memalign(&mem, pageSize, pageSize))
+  {
+    result = eIasAvbProcNotEnoughMemory;
+  }
+  else
+  {
+    (void) std::memset(mem, 0, pageSize);
+    page.dma_vaddr = mem;
+    page.dma_paddr = 0u;
+    page.mmap_size = static_cast<uint32_t>(pageSize);
+  }
+
+  return result;
+}
+
+
+void IasAvbHeapPacketAllocator::freePage(Page &page)
+{
+  ::free(page.dma_vaddr);
+  page.dma_vaddr = NULL;
+}
+
+
+} // namespace IasMediaTransportAvb
@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file    IasAvbHugePagePacketAllocator.cpp
+ * @brief   This is the implementation of the IasAvbHugePagePacketAllocator class.
+ * @date    2018
+ */
+
+#include "avb_streamhandler/IasAvbHugePagePacketAllocator.hpp"
+#include "avb_streamhandler/IasAvbStreamHandlerEnvironment.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <linux/mempolicy.h>
+
+namespace IasMediaTransportAvb
+{
+
+static const std::string cClassName = "IasAvbHugePagePacketAllocator::";
+#define LOG_PREFIX cClassName + __func__ + "(" + std::to_string(__LINE__) + "):"
+
+
+IasAvbHugePagePacketAllocator::IasAvbHugePagePacketAllocator(DltContext &ctx)
+  : mLog(&ctx)
+{
+  // do nothing
+}
+
+
+IasAvbHugePagePacketAllocator::~IasAvbHugePagePacketAllocator()
+{
+  // do nothing
+}
+
+
+IasAvbProcessingResult IasAvbHugePagePacketAllocator::allocPage(size_t minSize, Page &page)
+{
+  IasAvbProcessingResult result = eIasAvbProcOK;
+  const size_t size = ((std::max(minSize, size_t(1u)) + cHugePageSize - 1u) / cHugePageSize) * cHugePageSize;
+  uint64_t node = 0u;
+
+  void *mem = ::mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (MAP_FAILED == mem)
+  {
+    /*
+     * @log No huge pages reserved, the pool uses normal memory hopefully backed by transparent huge pages.
+     */
+    DLT_LOG_CXX(*mLog, DLT_LOG_WARN, LOG_PREFIX, "MAP_HUGETLB failed:", strerror(errno),
+        "- falling back to transparent huge pages");
+    mem = mapAligned(size);
+  }
+
+  if (NULL == mem)
+  {
+    DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "failed to map", uint64_t(size), "bytes");
+    result = eIasAvbProcNotEnoughMemory;
+  }
+  else
+  {
+    if (IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cPacketPoolHugePageNode, node))
+    {
+      bindToNode(mem, size, uint32_t(node));
+    }
+
+    // anonymous memory is zeroed, it only needs to be faulted in before the packets are used
+    if (0 != ::mlock(mem, size))
+    {
+      /*
+       * @log The packet memory could not be locked, check RLIMIT_MEMLOCK.
+       */
+      DLT_LOG_CXX(*mLog, DLT_LOG_WARN, LOG_PREFIX, "mlock failed:", strerror(errno));
+      (void) std::memset(mem, 0, size);
+    }
+
+    page.dma_vaddr = mem;
+    page.dma_paddr = 0u;
+    page.mmap_size = static_cast<uint32_t>(size);
+  }
+
+  return result;
+}
+
+
+void IasAvbHugePagePacketAllocator::freePage(Page &page)
+{
+  if (NULL != page.dma_vaddr)
+  {
+    // munmap() unlocks the pages as well
+    (void) ::munmap(page.dma_vaddr, page.mmap_size);
+    page.dma_vaddr = NULL;
+  }
+}
+
+
+void* IasAvbHugePagePacketAllocator::mapAligned(size_t size)
+{
+  void *ret = NULL;
+
+  // map one huge page more and cut off the unaligned ends
+  void *mem = ::mmap(NULL, size + cHugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (MAP_FAILED != mem)
+  {
+    const uintptr_t start = reinterpret_cast<uintptr_t>(mem);
+    const uintptr_t aligned = (start + cHugePageSize - 1u) & ~uintptr_t(cHugePageSize - 1u);
+    const size_t head = size_t(aligned - start);
+    const size_t tail = cHugePageSize - head;
+
+    if (0u != head)
+    {
+      (void) ::munmap(mem, head);
+    }
+    if (0u != tail)
+    {
+      (void) ::munmap(reinterpret_cast<void*>(aligned + size), tail);
+    }
+
+    ret = reinterpret_cast<void*>(aligned);
+    (void) ::madvise(ret, size, MADV_HUGEPAGE);
+  }
+
+  return ret;
+}
+
+
+void IasAvbHugePagePacketAllocator::bindToNode(void *mem, size_t size, uint32_t node)
+{
+  const uint32_t cMaxNodes = uint32_t(sizeof(unsigned long) * 8u);
+
+  if (node >= cMaxNodes)
+  {
+    DLT_LOG_CXX(*mLog, DLT_LOG_WARN, LOG_PREFIX, "NUMA node out of range:", node);
+  }
+  else
+  {
+    const unsigned long nodeMask = 1ul << node;
+
+    // preferred rather than bound, the huge page reservation is not node aware
+    if (0 != ::syscall(SYS_mbind, mem, size, MPOL_PREFERRED, &nodeMask, cMaxNodes + 1u, 0u))
+    {
+      DLT_LOG_CXX(*mLog, DLT_LOG_WARN, LOG_PREFIX, "mbind to node", node, "failed:", strerror(errno));
+    }
+  }
+}
+
+
+} // namespace IasMediaTransportAvb
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file    IasAvbIgbPacketAllocator.cpp
+ * @brief   This is the implementation of the IasAvbIgbPacketAllocator class.
+ * @date    2018
+ */
+
+#include "avb_streamhandler/IasAvbIgbPacketAllocator.hpp"
+#include "avb_streamhandler/IasAvbStreamHandlerEnvironment.hpp"
+
+namespace IasMediaTransportAvb
+{
+
+IasAvbIgbPacketAllocator::IasAvbIgbPacketAllocator()
+{
+  // do nothing
+}
+
+
+IasAvbIgbPacketAllocator::~IasAvbIgbPacketAllocator()
+{
+  // do nothing
+}
+
+
+IasAvbProcessingResult IasAvbIgbPacketAllocator::allocPage(size_t minSize, Page &page)
+{
+  IasAvbProcessingResult result = eIasAvbProcOK;
+  device_t* igbDevice = IasAvbStreamHandlerEnvironment::getIgbDevice();
+
+  (void) minSize;
+
+  if (NULL == igbDevice)
+  {
+    result = eIasAvbProcInitializationFailed;
+  }
+  else if (0 != igb_dma_malloc_page(igbDevice, &page))
+  {
+    result = eIasAvbProcNotEnoughMemory;
+  }
+  else
+  {
+    // do nothing
+  }
+
+  return result;
+}
+
+
+void IasAvbIgbPacketAllocator::freePage(Page &page)
+{
+  device_t* igbDevice = IasAvbStreamHandlerEnvironment::getIgbDevice();
+
+  if (NULL != igbDevice)
+  {
+    igb_dma_free_page(igbDevice, &page);
+  }
+}
+
+
+} // namespace IasMediaTransportAvb
@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+/**
+ * @file    IasAvbIndexStack.cpp
+ * @brief   The implementation of the IasAvbIndexStack class.
+ * @date    2018
+ */
+
+#include "avb_streamhandler/IasAvbIndexStack.hpp"
+
+#include <new>
+
+namespace IasMediaTransportAvb {
+
+static const uint64_t cTagIncrement = uint64_t(1u) << 32;
+
+
+/*
+ *  Constructor.
+ */
+IasAvbIndexStack::IasAvbIndexStack()
+  : mNext(NULL)
+  , mOnStack(NULL)
+  , mCapacity(0u)
+  , mPad0()
+  , mHead(cNone)
+  , mCount(0u)
+{
+  // do nothing
+}
+
+
+/*
+ *  Destructor.
+ */
+IasAvbIndexStack::~IasAvbIndexStack()
+{
+  cleanup();
+}
+
+
+IasAvbProcessingResult IasAvbIndexStack::init(uint32_t capacity)
+{
+  IasAvbProcessingResult result = eIasAvbProcOK;
+
+  if ((0u == capacity) || (capacity >= cNone))
+  {
+    result = eIasAvbProcInvalidParam;
+  }
+  else
+  {
+    cleanup();
+
+    mNext = new (std::nothrow) std::atomic<uint32_t>[capacity];
+    mOnStack = new (std::nothrow) std::atomic<bool>[capacity];
+    if ((NULL == mNext) || (NULL == mOnStack))
+    {
+      cleanup();
+      result = eIasAvbProcNotEnoughMemory;
+    }
+    else
+    {
+      mCapacity = capacity;
+      clear();
+    }
+  }
+
+  return result;
+}
+
+
+void IasAvbIndexStack::cleanup()
+{
+  delete[] mNext;
+  mNext = NULL;
+  delete[] mOnStack;
+  mOnStack = NULL;
+  mCapacity = 0u;
+  mHead.store(cNone, std::memory_order_relaxed);
+  mCount.store(0u, std::memory_order_relaxed);
+}
+
+
+void IasAvbIndexStack::clear()
+{
+  for (uint32_t i = 0u; i < mCapacity; i++)
+  {
+    mNext[i].store(cNone, std::memory_order_relaxed);
+    mOnStack[i].store(false, std::memory_order_relaxed);
+  }
+  mHead.store(cNone, std::memory_order_release);
+  mCount.store(0u, std::memory_order_release);
+}
+
+
+bool IasAvbIndexStack::push(uint32_t index)
+{
+  bool ret = false;
+
+  if ((index < mCapacity) && !mOnStack[index].exchange(true, std::memory_order_acq_rel))
+  {
+    // counted before it can be popped, so the count never drops below zero
+    (void) mCount.fetch_add(1u, std::memory_order_release);
+
+    uint64_t head = mHead.load(std::memory_order_relaxed);
+    uint64_t newHead;
+    do
+    {
+      mNext[index].store(uint32_t(head), std::memory_order_relaxed);
+      newHead = ((head & ~uint64_t(cNone)) + cTagIncrement) | index;
+    }
+    // release: the link and the data of the entry are visible to the thread popping it
+    while (!mHead.compare_exchange_weak(head, newHead, std::memory_order_release, std::memory_order_relaxed));
+
+    ret = true;
+  }
+
+  return ret;
+}
+
+
+bool IasAvbIndexStack::pop(uint32_t &index)
+{
+  bool ret = false;
+  uint64_t head = mHead.load(std::memory_order_acquire);
+
+  while (!ret && (cNone != uint32_t(head)))
+  {
+    /*
+     * The link may be stale if the top has been popped by another thread meanwhile, the tag
+     * makes the exchange fail then.
+     */
+    const uint32_t top = uint32_t(head);
+    const uint64_t newHead = ((head & ~uint64_t(cNone)) + cTagIncrement) | mNext[top].load(std::memory_order_relaxed);
+    if (mHead.compare_exchange_weak(head, newHead, std::memory_order_acquire, std::memory_order_acquire))
+    {
+      (void) mCount.fetch_sub(1u, std::memory_order_release);
+      mOnStack[top].store(false, std::memory_order_release);
+      index = top;
+      ret = true;
+    }
+  }
+
+  return ret;
+}
+
+
+} // namespace IasMediaTransportAvb
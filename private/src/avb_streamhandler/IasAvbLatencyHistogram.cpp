@@ -0,0 +1,228 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file    IasAvbLatencyHistogram.cpp
+ * @brief   This is the implementation of the IasAvbLatencyHistogram class.
+ * @date    2018
+ */
+
+#include "avb_streamhandler/IasAvbLatencyHistogram.hpp"
+
+#include <cstring>
+
+
+namespace IasMediaTransportAvb
+{
+
+const uint32_t IasAvbLatencyHistogram::cSubBucketBits;
+const uint32_t IasAvbLatencyHistogram::cSubBuckets;
+const uint32_t IasAvbLatencyHistogram::cValueBits;
+const uint32_t IasAvbLatencyHistogram::cNumBuckets;
+const uint64_t IasAvbLatencyHistogram::cMaxValue;
+
+
+IasAvbLatencyHistogram::IasAvbLatencyHistogram()
+  : mSequence(0u)
+  , mResetRequest(false)
+  , mCount(0u)
+  , mNegativeCount(0u)
+  , mOverflowCount(0u)
+  , mMin(0)
+  , mMax(0)
+  , mSum(0)
+{
+  (void) std::memset(mBuckets, 0, sizeof mBuckets);
+}
+
+
+IasAvbLatencyHistogram::~IasAvbLatencyHistogram()
+{
+  // nothing to do
+}
+
+
+IasAvbLatencyHistogram::IasAvbLatencyHistogram(const IasAvbLatencyHistogram &other)
+  : mSequence(0u)
+  , mResetRequest(false)
+{
+  copySamples(other);
+}
+
+
+IasAvbLatencyHistogram& IasAvbLatencyHistogram::operator=(const IasAvbLatencyHistogram &other)
+{
+  if (this != &other)
+  {
+    copySamples(other);
+  }
+
+  return *this;
+}
+
+
+void IasAvbLatencyHistogram::copySamples(const IasAvbLatencyHistogram &other)
+{
+  mCount = other.mCount;
+  mNegativeCount = other.mNegativeCount;
+  mOverflowCount = other.mOverflowCount;
+  mMin = other.mMin;
+  mMax = other.mMax;
+  mSum = other.mSum;
+  (void) std::memcpy(mBuckets, other.mBuckets, sizeof mBuckets);
+}
+
+
+void IasAvbLatencyHistogram::reset()
+{
+  mCount = 0u;
+  mNegativeCount = 0u;
+  mOverflowCount = 0u;
+  mMin = 0;
+  mMax = 0;
+  mSum = 0;
+  (void) std::memset(mBuckets, 0, sizeof mBuckets);
+}
+
+
+void IasAvbLatencyHistogram::snapshot(IasAvbLatencyHistogram &copy) const
+{
+  uint32_t before = 0u;
+  uint32_t after = 0u;
+  bool resetPending = false;
+
+  do
+  {
+    before = mSequence.load(std::memory_order_acquire);
+    resetPending = mResetRequest.load(std::memory_order_relaxed);
+    copy.copySamples(*this);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    after = mSequence.load(std::memory_order_relaxed);
+  }
+  while ((0u != (before & 1u)) || (before != after));
+
+  if (resetPending)
+  {
+    // the writer has not recorded anything since the request, the samples are outdated
+    copy.reset();
+  }
+}
+
+
+void IasAvbLatencyHistogram::requestReset()
+{
+  mResetRequest.store(true, std::memory_order_relaxed);
+}
+
+
+void IasAvbLatencyHistogram::merge(const IasAvbLatencyHistogram &other)
+{
+  if (0u != other.mCount)
+  {
+    if ((0u == mCount) || (other.mMin < mMin))
+    {
+      mMin = other.mMin;
+    }
+    if ((0u == mCount) || (other.mMax > mMax))
+    {
+      mMax = other.mMax;
+    }
+
+    mCount += other.mCount;
+    mNegativeCount += other.mNegativeCount;
+    mOverflowCount += other.mOverflowCount;
+    mSum += other.mSum;
+
+    for (uint32_t i = 0u; i < cNumBuckets; i++)
+    {
+      mBuckets[i] += other.mBuckets[i];
+    }
+  }
+}
+
+
+int64_t IasAvbLatencyHistogram::getValueAtPercentile(double percentile) const
+{
+  int64_t result = 0;
+
+  if (0u != mCount)
+  {
+    if (percentile < 0.0)
+    {
+      percentile = 0.0;
+    }
+    else if (percentile > 100.0)
+    {
+      percentile = 100.0;
+    }
+
+    uint64_t target = uint64_t(percentile / 100.0 * double(mCount) + 0.5);
+    if (0u == target)
+    {
+      target = 1u;
+    }
+
+    uint64_t total = mNegativeCount;
+    if (total >= target)
+    {
+      result = mMin;
+    }
+    else
+    {
+      result = mMax;
+      for (uint32_t i = 0u; i < cNumBuckets; i++)
+      {
+        total += mBuckets[i];
+        if (total >= target)
+        {
+          const int64_t upper = int64_t(getBucketUpperBound(i));
+          result = (upper < mMax) ? upper : mMax;
+          break;
+        }
+      }
+    }
+  }
+
+  return result;
+}
+
+
+uint64_t IasAvbLatencyHistogram::getBucketLowerBound(uint32_t index)
+{
+  uint64_t result;
+
+  if (index < (2u * cSubBuckets))
+  {
+    result = index;
+  }
+  else
+  {
+    const uint32_t shift = (index / cSubBuckets) - 1u;
+    result = uint64_t(index - shift * cSubBuckets) << shift;
+  }
+
+  return result;
+}
+
+
+uint64_t IasAvbLatencyHistogram::getBucketUpperBound(uint32_t index)
+{
+  uint64_t result;
+
+  if (index < (2u * cSubBuckets))
+  {
+    result = index;
+  }
+  else
+  {
+    const uint32_t shift = (index / cSubBuckets) - 1u;
+    result = getBucketLowerBound(index) + (uint64_t(1u) << shift) - 1u;
+  }
+
+  return result;
+}
+
+
+} // namespace IasMediaTransportAvb
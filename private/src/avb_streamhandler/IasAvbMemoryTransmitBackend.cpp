@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file    IasAvbMemoryTransmitBackend.cpp
+ * @brief   This is the implementation of the IasAvbMemoryTransmitBackend class.
+ * @date    2018
+ */
+
+#include "avb_streamhandler/IasAvbMemoryTransmitBackend.hpp"
+#include "avb_streamhandler/IasAvbPacket.hpp"
+#include "avb_streamhandler/IasAvbPacketPool.hpp"
+#include "avb_streamhandler/IasAvbStreamHandlerEnvironment.hpp"
+#include "lib_ptp_daemon/IasLibPtpDaemon.hpp"
+
+#include <cstring>
+#include <errno.h>
+
+namespace IasMediaTransportAvb
+{
+
+static const std::string cClassName = "IasAvbMemoryTransmitBackend::";
+#define LOG_PREFIX cClassName + __func__ + "(" + std::to_string(__LINE__) + "):"
+
+
+IasAvbMemoryTransmitBackend::IasAvbMemoryTransmitBackend(DltContext &ctx)
+  : mInitialized(false)
+  , mSent()
+  , mRecords()
+  , mNextRecord(0u)
+  , mMaxRecords(0u)
+  , mStats()
+  , mLog(&ctx)
+{
+  (void) std::memset(&mStats, 0, sizeof mStats);
+}
+
+
+IasAvbMemoryTransmitBackend::~IasAvbMemoryTransmitBackend()
+{
+  cleanup();
+}
+
+
+IasAvbProcessingResult IasAvbMemoryTransmitBackend::init(uint32_t queueIndex, IasAvbSrClass qavClass)
+{
+  IasAvbProcessingResult result = eIasAvbProcOK;
+  uint64_t maxRecords = cDefaultRecords;
+
+  (void) queueIndex;
+  (void) qavClass;
+
+  if (mInitialized)
+  {
+    result = eIasAvbProcInitializationFailed;
+  }
+  else
+  {
+    (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cXmitMemoryRecords, maxRecords);
+    mMaxRecords = size_t(maxRecords);
+    mRecords.reserve(mMaxRecords);
+    mNextRecord = 0u;
+    (void) std::memset(&mStats, 0, sizeof mStats);
+
+    mSent.reserve(cSentReserve);
+    mInitialized = true;
+
+    DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX, "recording up to", maxRecords, "packets of queue", queueIndex);
+  }
+
+  return result;
+}
+
+
+void IasAvbMemoryTransmitBackend::cleanup()
+{
+  (void) reclaimPackets();
+
+  mRecords.clear();
+  mNextRecord = 0u;
+  mInitialized = false;
+}
+
+
+int32_t IasAvbMemoryTransmitBackend::xmit(IasAvbPacket *packet)
+{
+  int32_t result = 0;
+
+  if (!mInitialized || (NULL == packet))
+  {
+    result = -ENXIO;
+  }
+  else
+  {
+    IasLibPtpDaemon* ptp = IasAvbStreamHandlerEnvironment::getPtpProxy();
+
+    if ((0u != mStats.packets) && (packet->attime < mStats.lastLaunch))
+    {
+      mStats.reordered++;
+    }
+    if ((NULL != ptp) && (packet->attime < ptp->getLocalTime()))
+    {
+      mStats.late++;
+    }
+    if (0u == mStats.packets)
+    {
+      mStats.firstLaunch = packet->attime;
+    }
+    mStats.lastLaunch = packet->attime;
+    mStats.packets++;
+    mStats.bytes += packet->len;
+
+    if (0u != mMaxRecords)
+    {
+      Record record;
+      record.attime = packet->attime;
+      record.stream = IasAvbPacketPool::getPacketOwner(packet);
+      record.length = packet->len;
+
+      if (mRecords.size() < mMaxRecords)
+      {
+        mRecords.push_back(record);
+      }
+      else
+      {
+        mRecords[mNextRecord] = record;
+        mNextRecord = (mNextRecord + 1u) % mMaxRecords;
+      }
+    }
+
+    mSent.push_back(packet);
+  }
+
+  return result;
+}
+
+
+uint32_t IasAvbMemoryTransmitBackend::reclaimPackets()
+{
+  const uint32_t ret = uint32_t(mSent.size());
+
+  for (std::vector<IasAvbPacket*>::iterator it = mSent.begin(); it != mSent.end(); ++it)
+  {
+    (void) IasAvbPacketPool::returnPacket(*it);
+  }
+  mSent.clear();
+
+  return ret;
+}
+
+
+void IasAvbMemoryTransmitBackend::getRecords(std::vector<Record> &records) const
+{
+  records.clear();
+  records.reserve(mRecords.size());
+  records.insert(records.end(), mRecords.begin() + ptrdiff_t(mNextRecord), mRecords.end());
+  records.insert(records.end(), mRecords.begin(), mRecords.begin() + ptrdiff_t(mNextRecord));
+}
+
+
+} // namespace IasMediaTransportAvb
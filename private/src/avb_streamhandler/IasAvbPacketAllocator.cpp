@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file    IasAvbPacketAllocator.cpp
+ * @brief   Creation of the packet memory allocators.
+ * @date    2018
+ */
+
+#include "avb_streamhandler/IasAvbPacketAllocator.hpp"
+#include "avb_streamhandler/IasAvbIgbPacketAllocator.hpp"
+#include "avb_streamhandler/IasAvbHeapPacketAllocator.hpp"
+#include "avb_streamhandler/IasAvbHugePagePacketAllocator.hpp"
+#include "avb_streamhandler/IasAvbStreamHandlerEnvironment.hpp"
+
+namespace IasMediaTransportAvb
+{
+
+static const std::string cClassName = "IasAvbPacketAllocator::";
+#define LOG_PREFIX cClassName + __func__ + "(" + std::to_string(__LINE__) + "):"
+
+
+IasAvbProcessingResult IasAvbPacketAllocator::create(DltContext &log, IasAvbPacketAllocator *&allocator)
+{
+  IasAvbProcessingResult ret = eIasAvbProcOK;
+  device_t* igbDevice = IasAvbStreamHandlerEnvironment::getIgbDevice();
+  const bool igbTransmit = !IasAvbStreamHandlerEnvironment::isSocketTransmitBackend()
+                           && !IasAvbStreamHandlerEnvironment::isMemoryTransmitBackend();
+  std::string name;
+
+  allocator = NULL;
+
+  if (!IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cPacketPoolAllocator, name))
+  {
+    name = ((NULL != igbDevice) || igbTransmit) ? "igb" : "heap";
+  }
+
+  if ("igb" == name)
+  {
+    if (NULL == igbDevice)
+    {
+      /*
+       * @log Init failed: Returned igbDevice == nullptr
+       */
+      DLT_LOG_CXX(log, DLT_LOG_ERROR, LOG_PREFIX, " Failed to getIgbDevice!");
+      ret = eIasAvbProcInitializationFailed;
+    }
+    else
+    {
+      allocator = new (nothrow) IasAvbIgbPacketAllocator();
+    }
+  }
+  else if ("heap" == name)
+  {
+    allocator = new (nothrow) IasAvbHeapPacketAllocator();
+  }
+  else if ("hugepage" == name)
+  {
+    allocator = new (nothrow) IasAvbHugePagePacketAllocator(log);
+  }
+  else
+  {
+    DLT_LOG_CXX(log, DLT_LOG_ERROR, LOG_PREFIX, "unknown packet allocator:", name.c_str());
+    ret = eIasAvbProcInvalidParam;
+  }
+
+  if ((eIasAvbProcOK == ret) && (NULL == allocator))
+  {
+    DLT_LOG_CXX(log, DLT_LOG_ERROR, LOG_PREFIX, "Couldn't create packet allocator!");
+    ret = eIasAvbProcNotEnoughMemory;
+  }
+  else if ((eIasAvbProcOK == ret) && (NULL != igbDevice) && igbTransmit && !allocator->isDmaCapable())
+  {
+    // libigb sends the packets by DMA and would read from the bus address
+    DLT_LOG_CXX(log, DLT_LOG_ERROR, LOG_PREFIX, "packet allocator", name.c_str(),
+        "cannot be used with the igb transmit backend");
+    ret = eIasAvbProcInitializationFailed;
+  }
+  else
+  {
+    // do nothing
+  }
+
+  if ((eIasAvbProcOK != ret) && (NULL != allocator))
+  {
+    delete allocator;
+    allocator = NULL;
+  }
+
+  return ret;
+}
+
+
+} // namespace IasMediaTransportAvb
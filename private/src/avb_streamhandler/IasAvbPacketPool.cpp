@@ -11,7 +11,10 @@
 
 #include "avb_streamhandler/IasAvbPacketPool.hpp"
 #include "avb_streamhandler/IasAvbStreamHandlerEnvironment.hpp"
+#include "avb_streamhandler/IasAvbPacketSlab.hpp"
+#include <algorithm>
 #include <cstring>
+#include <cstdlib>
 #include <unistd.h>
 #include <dlt/dlt_cpp_extension.hpp>
 
@@ -30,9 +33,20 @@ IasAvbPacketPool::IasAvbPacketPool(DltContext &dltContext) :
   mPoolSize(0u),
   mFreeBufferStack(),
   mBase(NULL),
-  mDmaPages()
+  mDmaPages(),
+  mAllocator(NULL),
+  mSlab(NULL),
+  mSlabPages(),
+  mPacketsPerPage(0u),
+  mReservedPages(0u),
+  mBorrowedPages(0u),
+  mPacketCount(0u),
+  mTemplate(),
+  mTemplateData(),
+  mOwner(NULL)
 {
-  // do nothing
+  // the packet constructor leaves the igb fields uninitialized, no template until initAllPacketsFromTemplate()
+  mTemplate.len = 0u;
 }
 
 
@@ -78,7 +92,7 @@ IasAvbProcessingResult IasAvbPacketPool::init(const size_t packetSize, const uin
     if (eIasAvbProcOK == ret)
     {
       mBase = new (nothrow) IasAvbPacket[poolSize];
-      if (NULL == mBase)
+      if ((NULL == mBase) || (eIasAvbProcOK != mFreeBufferStack.init(poolSize)))
       {
         /*
          * @log Not enough memory: Packet Pool not created.
@@ -95,106 +109,239 @@ IasAvbProcessingResult IasAvbPacketPool::init(const size_t packetSize, const uin
 
     if (eIasAvbProcOK == ret)
     {
-      device_t* igbDevice = IasAvbStreamHandlerEnvironment::getIgbDevice();
-      Page* page = NULL;
+      mPacketSize = packetSize;
+      mSlab = IasAvbStreamHandlerEnvironment::getPacketSlab();
+      ret = (NULL != mSlab) ? initSlabPages() : initOwnPages();
+    }
+
+    if (eIasAvbProcOK != ret)
+    {
+      cleanup();
+    }
+  }
+
+  return ret;
+}
+
 
-      if (NULL == igbDevice)
+IasAvbProcessingResult IasAvbPacketPool::initOwnPages()
+{
+  IasAvbProcessingResult ret = IasAvbPacketAllocator::create(*mLog, mAllocator);
+
+  if (eIasAvbProcOK == ret)
+  {
+    uint32_t packetCountTotal = 0u;
+    uint64_t bytesMapped = 0u;
+
+    while ((eIasAvbProcOK == ret) && (packetCountTotal < mPoolSize))
+    {
+      Page* page = new (nothrow) Page;
+
+      if (NULL == page)
+      {
+        /*
+         * @log Not enough memory: Couldn't allocate DMA page, Page corresponds to underlying igb_dma_alloc struct.
+         */
+        DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, " Not enough memory to allocate Page!");
+        ret = eIasAvbProcNotEnoughMemory;
+      }
+      else if (eIasAvbProcOK != mAllocator->allocPage(size_t(mPoolSize - packetCountTotal) * mPacketSize, *page))
       {
         /*
-         * @log Init failed: Returned igbDevice == nullptr
+         * @log Init failed: Failed to retrieve DMA page.
          */
-        DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, " Failed to getIgbDevice!");
+        DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, " packet memory allocation failure");
+        delete page;
         ret = eIasAvbProcInitializationFailed;
       }
       else
       {
-        page = new (nothrow) Page;
+        // find out how many packets fit into the page
+        const uint32_t packetsPerPage = uint32_t( size_t(page->mmap_size) / mPacketSize );
+        bytesMapped += page->mmap_size;
 
-        if (NULL == page)
-        {
-          /*
-           * @log Not enough memory: Couldn't allocate DMA page, Page corresponds to underlying igb_dma_alloc struct.
-           */
-          DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, " Not enough memory to allocate Page!");
-          ret = eIasAvbProcNotEnoughMemory;
-        }
-      }
+        // add page to list, so it is released by cleanup() in any case
+        mDmaPages.push_back(page);
 
-      if (eIasAvbProcOK == ret)
-      {
-        // allocate one DMA page to retrieve properties
-        if (0 != igb_dma_malloc_page( igbDevice, page ))
+        if (0u == packetsPerPage)
         {
+          // packetSize larger than dma page size - not supported by libigb
           /*
-           * @log Init failed: Failed to retrieve DMA page.
+           * @log Unsupported format: Packet size is larger than the dma page size - not supported by libigb.
            */
-          DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, " Failed to igb_dma_malloc_page!");
-          ret = eIasAvbProcInitializationFailed;
+          DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, " packet size > ",
+              page->mmap_size, "not supported!");
+          ret = eIasAvbProcUnsupportedFormat;
         }
         else
         {
-          uint32_t packetCountTotal = 0u;
-          mPacketSize = packetSize;
-
-          // find out how many packets fit into a page
-          const uint32_t packetsPerPage = uint32_t( size_t(page->mmap_size) / packetSize );
-
-          if (0u == packetsPerPage)
-          {
-            // packetSize larger than dma page size - not supported by libigb
-            /*
-             * @log Unsupported format: Packet size is larger than the dma page size - not supported by libigb.
-             */
-            DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, " packet size > ",
-                page->mmap_size, "not supported!");
-            ret = eIasAvbProcUnsupportedFormat;
-          }
-          else
-          {
-            const uint32_t pagesNeeded = (poolSize + (packetsPerPage - 1u)) / packetsPerPage;
-
-            DLT_LOG_CXX(*mLog, DLT_LOG_DEBUG, LOG_PREFIX, " DMA page overhead (bytes:",
-                (uint64_t(pagesNeeded) * uint64_t(page->mmap_size)) - (uint64_t(poolSize) * uint64_t(packetSize)));
-
-            mDmaPages.reserve(pagesNeeded);
-
-            ret = initPage( page, packetsPerPage, packetCountTotal );
-
-            // 1st page is already allocated
-            for (uint32_t pageCount = 1u; (eIasAvbProcOK == ret) && (pageCount < pagesNeeded); pageCount++)
-            {
-              page = new (nothrow) Page;
-
-              if (NULL == page)
-              {
-                DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, " Not enough memory to allocate Page!");
-                ret = eIasAvbProcNotEnoughMemory;
-              }
-              else if (0 != igb_dma_malloc_page( igbDevice, page ))
-              {
-                DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, " igb dma memory allocation failure");
-                ret = eIasAvbProcInitializationFailed;
-              }
-              else
-              {
-                ret = initPage( page, packetsPerPage, packetCountTotal );
-              }
-            }
-          }
+          ret = initPage( page, packetsPerPage, packetCountTotal );
         }
       }
     }
 
-    if (eIasAvbProcOK != ret)
+    if (eIasAvbProcOK == ret)
     {
-      cleanup();
+      DLT_LOG_CXX(*mLog, DLT_LOG_DEBUG, LOG_PREFIX, " DMA page overhead (bytes:",
+          bytesMapped - (uint64_t(mPoolSize) * uint64_t(mPacketSize)));
+    }
+  }
+
+  return ret;
+}
+
+
+IasAvbProcessingResult IasAvbPacketPool::initSlabPages()
+{
+  IasAvbProcessingResult ret = eIasAvbProcOK;
+  uint32_t reserve = cDefaultSlabReserve;
+
+  AVB_ASSERT(NULL != mSlab);
+  (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cPacketPoolSlabReserve, reserve);
+
+  // at least one packet is needed to set up the template of the stream
+  reserve = std::max(1u, std::min(reserve, mPoolSize));
+  mPacketsPerPage = uint32_t(IasAvbPacketSlab::cPageSize / mPacketSize);
+  AVB_ASSERT(0u != mPacketsPerPage);
+
+  Page empty;
+  (void) std::memset(&empty, 0, sizeof empty);
+  mSlabPages.assign((mPoolSize + mPacketsPerPage - 1u) / mPacketsPerPage, empty);
+
+  ret = mSlab->reserve((reserve + mPacketsPerPage - 1u) / mPacketsPerPage);
+  if (eIasAvbProcOK == ret)
+  {
+    mReservedPages = (reserve + mPacketsPerPage - 1u) / mPacketsPerPage;
+
+    // the reserved pages are kept until the pool is destroyed
+    for (uint32_t pageIdx = 0u; (eIasAvbProcOK == ret) && (pageIdx < mReservedPages); pageIdx++)
+    {
+      if (!attachSlabPage(pageIdx))
+      {
+        ret = eIasAvbProcNotEnoughMemory;
+      }
+    }
+  }
+  else
+  {
+    /*
+     * @log Not enough memory: The shared packet slab cannot guarantee the packets reserved per stream, see packetpool.slab.size and packetpool.slab.reserve.
+     */
+    DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "packet slab exhausted, cannot reserve", reserve, "packets");
+  }
+
+  return ret;
+}
+
+
+bool IasAvbPacketPool::attachSlabPage(const uint32_t pageIdx)
+{
+  AVB_ASSERT(pageIdx < mSlabPages.size());
+  Page &page = mSlabPages[pageIdx];
+  const bool ret = mSlab->borrowPage(mReservedPages, mBorrowedPages, page);
+
+  if (ret)
+  {
+    uint32_t packetCountTotal = pageIdx * mPacketsPerPage;
+    (void) initPage( &page, mPacketsPerPage, packetCountTotal );
+  }
+
+  return ret;
+}
+
+
+IasAvbProcessingResult IasAvbPacketPool::attachMemory()
+{
+  IasAvbProcessingResult ret = eIasAvbProcOK;
+
+  mLock.lock();
+
+  if (NULL == mBase)
+  {
+    ret = eIasAvbProcNotInitialized;
+  }
+  else if (NULL != mSlab)
+  {
+    for (uint32_t pageIdx = mReservedPages; pageIdx < mSlabPages.size(); pageIdx++)
+    {
+      if ((NULL == mSlabPages[pageIdx].dma_vaddr) && !attachSlabPage(pageIdx))
+      {
+        break;
+      }
+    }
+
+    if (mPacketCount < mPoolSize)
+    {
+      /*
+       * @log The shared packet slab is short of pages, the stream runs with less packets than configured.
+       */
+      DLT_LOG_CXX(*mLog, DLT_LOG_WARN, LOG_PREFIX, "packet slab exhausted, using", uint32_t(mPacketCount),
+          "of", mPoolSize, "packets");
     }
   }
+  else
+  {
+    // all packets have their memory from the start
+  }
+
+  mLock.unlock();
 
   return ret;
 }
 
 
+void IasAvbPacketPool::releaseMemory()
+{
+  mLock.lock();
+
+  if ((NULL != mBase) && (NULL != mSlab) && (mReservedPages < mSlabPages.size()))
+  {
+    // take all free packets, a page can only be given back if none of its packets is in use
+    std::vector<bool> isFree(mPoolSize, false);
+    uint32_t index = 0u;
+    while (mFreeBufferStack.pop(index))
+    {
+      isFree[index] = true;
+    }
+
+    for (uint32_t pageIdx = mReservedPages; pageIdx < mSlabPages.size(); pageIdx++)
+    {
+      Page &page = mSlabPages[pageIdx];
+      const uint32_t first = pageIdx * mPacketsPerPage;
+      const uint32_t end = std::min(first + mPacketsPerPage, mPoolSize);
+      bool allFree = (NULL != page.dma_vaddr);
+
+      for (uint32_t i = first; allFree && (i < end); i++)
+      {
+        allFree = isFree[i];
+      }
+
+      if (allFree)
+      {
+        for (uint32_t i = first; i < end; i++)
+        {
+          isFree[i] = false;
+        }
+        mPacketCount -= (end - first);
+        mSlab->returnPage(mReservedPages, mBorrowedPages, page);
+        page.dma_vaddr = NULL;
+      }
+    }
+
+    // the packets of pages still in use stay with the pool until the next call
+    for (uint32_t i = mPoolSize; i > 0u; i--)
+    {
+      if (isFree[i - 1u])
+      {
+        (void) mFreeBufferStack.push(i - 1u);
+      }
+    }
+  }
+
+  mLock.unlock();
+}
+
+
 IasAvbProcessingResult IasAvbPacketPool::initPage(Page * page, const uint32_t packetsPerPage, uint32_t & packetCountTotal)
 {
   IasAvbProcessingResult ret = eIasAvbProcOK;
@@ -203,9 +350,6 @@ IasAvbProcessingResult IasAvbPacketPool::initPage(Page * page, const uint32_t pa
   AVB_ASSERT( NULL != page );
   AVB_ASSERT( mPacketSize > 0u );
 
-  // add page to list
-  mDmaPages.push_back(page);
-
   for (uint32_t packetIdx = 0u; (packetIdx < packetsPerPage) && (packetCountTotal < mPoolSize); packetIdx++, packetCountTotal++)
   {
     /*
@@ -220,7 +364,12 @@ IasAvbProcessingResult IasAvbPacketPool::initPage(Page * page, const uint32_t pa
     packet.map.paddr = page->dma_paddr;
 
     packet.setHomePool( this );
-    mFreeBufferStack.push_back( &packet );
+    if (0u != mTemplate.len)
+    {
+      packet = mTemplate;
+    }
+    mPacketCount++;
+    (void) mFreeBufferStack.push( packetCountTotal );
   }
 
   return ret;
@@ -229,33 +378,49 @@ IasAvbProcessingResult IasAvbPacketPool::initPage(Page * page, const uint32_t pa
 
 void IasAvbPacketPool::cleanup()
 {
-  if (mFreeBufferStack.size() < mPoolSize)
+  const uint32_t packetCount = mPacketCount;
+
+  if (mFreeBufferStack.size() < packetCount)
   {
     DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX,
                 " waiting for remaining buffers before pool destruction.",
                 uint32_t(mFreeBufferStack.size()),
                 "/",
-                mPoolSize);
+                packetCount);
 
     // wait up to 40ms in 4ms intervals
     for (uint32_t i = 0u; i < 10u; i++)
     {
       ::usleep(5000u);
-      if (mFreeBufferStack.size() >= mPoolSize)
+      if (mFreeBufferStack.size() >= packetCount)
       {
         break;
       }
     }
   }
 
-  if (mFreeBufferStack.size() < mPoolSize)
+  if (mFreeBufferStack.size() < packetCount)
   {
     DLT_LOG_CXX(*mLog, DLT_LOG_WARN, LOG_PREFIX,
                 " warning: not all buffers returned before pool destruction!",
-                uint32_t(mFreeBufferStack.size()), "/", mPoolSize);
+                uint32_t(mFreeBufferStack.size()), "/", packetCount);
   }
 
-  device_t* igbDevice = IasAvbStreamHandlerEnvironment::getIgbDevice();
+  if (NULL != mSlab)
+  {
+    for (std::vector<Page>::iterator it = mSlabPages.begin(); it != mSlabPages.end(); ++it)
+    {
+      if (NULL != it->dma_vaddr)
+      {
+        mSlab->returnPage(mReservedPages, mBorrowedPages, *it);
+      }
+    }
+    mSlab->unreserve(mReservedPages);
+    mSlabPages.clear();
+    mReservedPages = 0u;
+    mBorrowedPages = 0u;
+    mSlab = NULL;
+  }
 
   while (!mDmaPages.empty())
   {
@@ -263,43 +428,35 @@ void IasAvbPacketPool::cleanup()
     mDmaPages.pop_back();
 
     AVB_ASSERT( NULL != page  );
+    AVB_ASSERT( NULL != mAllocator );
 
-    if (NULL == igbDevice)
-    {
-    }
-    else
-    {
-      igb_dma_free_page( igbDevice, page );
-      delete page;
-    }
+    mAllocator->freePage( *page );
+    delete page;
   }
 
   delete[] mBase;
   mBase = NULL;
+  mFreeBufferStack.cleanup();
+  delete mAllocator;
+  mAllocator = NULL;
+  mPacketCount = 0u;
+  mTemplate.len = 0u;
 }
 
 
 IasAvbPacket* IasAvbPacketPool::getPacket()
 {
   IasAvbPacket* ret = NULL;
+  uint32_t index = 0u;
 
-  mLock.lock();
-
-  if (NULL != mBase)
+  if ((NULL != mBase) && mFreeBufferStack.pop(index))
   {
-    if (!mFreeBufferStack.empty())
-    {
-      ret = mFreeBufferStack.back();
-      mFreeBufferStack.pop_back();
-
-      AVB_ASSERT(NULL != ret);
-      ret->flags = 0u;
-      ret->dmatime = 0u;
-    }
+    AVB_ASSERT(index < mPoolSize);
+    ret = &mBase[index];
+    ret->flags = 0u;
+    ret->dmatime = 0u;
   }
 
-  mLock.unlock();
-
   return ret;
 }
 
@@ -308,42 +465,37 @@ IasAvbProcessingResult IasAvbPacketPool::doReturnPacket(IasAvbPacket* const pack
 {
   IasAvbProcessingResult ret = eIasAvbProcOK;
 
-  mLock.lock();
-
   if (NULL == mBase)
   {
     ret = eIasAvbProcNotInitialized;
   }
+  else if ((packet < mBase) || (packet >= (mBase + mPoolSize)))
+  {
+    // only packets of the own array can be put on the free stack
+    DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, " packet does not belong to the pool\n");
+    ret = eIasAvbProcInvalidParam;
+  }
   else
   {
-    AVB_ASSERT( NULL != packet );
     AVB_ASSERT( packet->getHomePool() == this );
 
     packet->mDummyFlag = false;
 
-    if (mFreeBufferStack.size() < mPoolSize)
+    // the stack refuses a packet that is already free, so it stays consistent
+    if (!mFreeBufferStack.push(uint32_t(packet - mBase)))
     {
-      mFreeBufferStack.push_back(packet);
-
-      if (mFreeBufferStack.size() == mPoolSize)
-      {
-        DLT_LOG_CXX(*mLog, DLT_LOG_DEBUG, LOG_PREFIX, " All buffers returned\n");
-      }
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, " Too many packets returned\n");
     }
-    else if (mFreeBufferStack.size() == mPoolSize)
+    else if (mFreeBufferStack.size() == mPacketCount)
     {
-      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, " Too many packets returned\n");
-      // put it on the stack to avoid further LAT messages - stack is inconsistent anyway
-      mFreeBufferStack.push_back(packet);
+      DLT_LOG_CXX(*mLog, DLT_LOG_DEBUG, LOG_PREFIX, " All buffers returned\n");
     }
     else
     {
-      // do nothing to avoid further stack growth
+      // do nothing
     }
   }
 
-  mLock.unlock();
-
   return ret;
 }
 
@@ -352,6 +504,8 @@ IasAvbProcessingResult IasAvbPacketPool::initAllPacketsFromTemplate(const IasAvb
 {
   IasAvbProcessingResult ret = eIasAvbProcOK;
 
+  mLock.lock();
+
   if (NULL == mBase)
   {
     ret = eIasAvbProcNotInitialized;
@@ -362,15 +516,28 @@ IasAvbProcessingResult IasAvbPacketPool::initAllPacketsFromTemplate(const IasAvb
   }
   else
   {
-    for (PacketStack::iterator it = mFreeBufferStack.begin(); it != mFreeBufferStack.end(); it++)
+    if (NULL != mSlab)
     {
-      IasAvbPacket * packet = *it;
-      AVB_ASSERT( NULL != packet);
+      // kept for the packets of the pages borrowed later
+      mTemplateData.resize(templatePacket->len);
+      mTemplate.vaddr = &mTemplateData[0];
+      mTemplate = *templatePacket;
+    }
 
-      *packet = *templatePacket;
+    /*
+     * Packets returned meanwhile are pushed above the top read here and keep their content, as they
+     * did when they had to wait for the lock. The links below the top only change by popping.
+     */
+    for (uint32_t index = mFreeBufferStack.top(); IasAvbIndexStack::cNone != index;
+         index = mFreeBufferStack.next(index))
+    {
+      AVB_ASSERT(index < mPoolSize);
+      mBase[index] = *templatePacket;
     }
   }
 
+  mLock.unlock();
+
   return ret;
 }
 
@@ -387,11 +554,18 @@ IasAvbProcessingResult IasAvbPacketPool::reset()
   }
   else
   {
-    DLT_LOG_CXX(*mLog, DLT_LOG_DEBUG, LOG_PREFIX, " clear FreeBufferStack and push back all buffer");
-    mFreeBufferStack.clear();
+    /*
+     * The stack is not cleared, push() refuses the packets already on it. So a packet returned
+     * meanwhile, e.g. by the igb reclaim of another sequencer, ends up on the stack exactly once.
+     */
+    DLT_LOG_CXX(*mLog, DLT_LOG_DEBUG, LOG_PREFIX, " push back all buffers not on FreeBufferStack");
     for (uint32_t packetIdx = 0u; packetIdx < mPoolSize; packetIdx++)
     {
-      mFreeBufferStack.push_back( &mBase[packetIdx] );
+      // without memory, the packet must not be handed out
+      if ((NULL == mSlab) || (NULL != mSlabPages[packetIdx / mPacketsPerPage].dma_vaddr))
+      {
+        (void) mFreeBufferStack.push( packetIdx );
+      }
     }
   }
 
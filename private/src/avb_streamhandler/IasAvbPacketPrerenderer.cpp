@@ -0,0 +1,429 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+/**
+ * @file    IasAvbPacketPrerenderer.cpp
+ * @brief   The implementation of the IasAvbPacketPrerenderer class.
+ * @date    2018
+ */
+
+#include <time.h> // make sure we include the right timespec definition
+#include "avb_streamhandler/IasAvbPacketPrerenderer.hpp"
+#include "avb_streamhandler/IasAvbStream.hpp"
+#include "avb_streamhandler/IasAvbPacket.hpp"
+#include "avb_streamhandler/IasAvbPacketPool.hpp"
+#include "avb_streamhandler/IasAvbStreamHandlerEnvironment.hpp"
+#include "lib_ptp_daemon/IasLibPtpDaemon.hpp"
+
+#include <pthread.h>
+#include <unistd.h>
+#include <linux/if_ether.h>
+#include <cstring>
+
+namespace IasMediaTransportAvb {
+
+static const std::string cClassName = "IasAvbPacketPrerenderer::";
+#define LOG_PREFIX cClassName + __func__ + "(" + std::to_string(__LINE__) + "):"
+
+
+IasAvbPacketPrerenderer::Slot::Slot()
+  : stream(NULL)
+  , queue()
+  , generation(0u)
+  , renderedGeneration(0u)
+  , renderedUntil(0u)
+  , depth(0u)
+  , sequence(0u)
+  , sequenceValid(false)
+{
+  // do nothing
+}
+
+
+/*
+ *  Constructor.
+ */
+IasAvbPacketPrerenderer::IasAvbPacketPrerenderer(DltContext &ctx)
+  : mThread(NULL)
+  , mEndThread(false)
+  , mLeadTime(0u)
+  , mPeriod(0u)
+  , mQueueSize(0u)
+  , mSlots()
+  , mRenderSlots()
+  , mPassEpoch(0u)
+  , mLock()
+  , mLog(&ctx)
+{
+  DLT_LOG_CXX(*mLog, DLT_LOG_VERBOSE, LOG_PREFIX);
+}
+
+
+/*
+ *  Destructor.
+ */
+IasAvbPacketPrerenderer::~IasAvbPacketPrerenderer()
+{
+  DLT_LOG_CXX(*mLog, DLT_LOG_VERBOSE, LOG_PREFIX);
+  cleanup();
+}
+
+
+IasAvbProcessingResult IasAvbPacketPrerenderer::init(const std::string &name, uint64_t leadTime, uint64_t period,
+    uint32_t queueSize)
+{
+  IasAvbProcessingResult result = eIasAvbProcOK;
+
+  DLT_LOG_CXX(*mLog, DLT_LOG_VERBOSE, LOG_PREFIX);
+
+  if (isInitialized())
+  {
+    result = eIasAvbProcInitializationFailed;
+  }
+  else if ((0u == leadTime) || (0u == period) || (period >= uint64_t(1e9)) || (0u == queueSize)
+      || (queueSize > cMaxQueueSize))
+  {
+    result = eIasAvbProcInvalidParam;
+  }
+  else
+  {
+    mThread = new (nothrow) IasThread(this, name);
+    if (NULL == mThread)
+    {
+      /**
+       * @log Not enough memory to create the thread.
+       */
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "Couldn't create render thread!");
+      result = eIasAvbProcNotEnoughMemory;
+    }
+    else
+    {
+      mLeadTime = leadTime;
+      mPeriod = period;
+      mQueueSize = queueSize;
+      mSlots.reserve(16u);
+      mRenderSlots.reserve(16u);
+    }
+  }
+
+  return result;
+}
+
+
+void IasAvbPacketPrerenderer::cleanup()
+{
+  (void) stop();
+  delete mThread;
+  mThread = NULL;
+
+  // normally all slots have been detached by the sequencer already
+  for (std::vector<Slot*>::iterator it = mSlots.begin(); it != mSlots.end(); it++)
+  {
+    drain(**it);
+    delete *it;
+  }
+  mSlots.clear();
+}
+
+
+IasAvbProcessingResult IasAvbPacketPrerenderer::start()
+{
+  IasAvbProcessingResult result = eIasAvbProcOK;
+
+  if (!isInitialized())
+  {
+    result = eIasAvbProcNotInitialized;
+  }
+  else if (!mThread->isRunning())
+  {
+    IasThreadResult res = mThread->start(true);
+    if ((res != IasResult::cOk) && (res != IasThreadResult::cThreadAlreadyStarted))
+    {
+      /**
+       * @log Thread start failed: The render worker thread couldn't be started.
+       */
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "Couldn't start render thread! Error =", res.toString());
+      result = eIasAvbProcThreadStartFailed;
+    }
+  }
+  else
+  {
+    // already running
+  }
+
+  return result;
+}
+
+
+IasAvbProcessingResult IasAvbPacketPrerenderer::stop()
+{
+  IasAvbProcessingResult result = eIasAvbProcOK;
+
+  if ((NULL != mThread) && mThread->isRunning())
+  {
+    if (mThread->stop() != IasResult::cOk)
+    {
+      result = eIasAvbProcThreadStopFailed;
+    }
+  }
+
+  return result;
+}
+
+
+IasAvbPacketPrerenderer::Slot* IasAvbPacketPrerenderer::attach(IasAvbStream *stream)
+{
+  AVB_ASSERT(NULL != stream);
+
+  Slot *slot = NULL;
+  const uint32_t poolSize = stream->getPacketPool().getPoolSize();
+
+  if (mQueueSize > poolSize)
+  {
+    /**
+     * @log The stream would run out of packets before its queue is full, so it is rendered by the sequencer.
+     */
+    DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "render queue size", mQueueSize, "exceeds packet pool size",
+        poolSize);
+  }
+  else
+  {
+    slot = new (nothrow) Slot();
+    if (NULL != slot)
+    {
+      slot->stream = stream;
+      slot->depth = mQueueSize;
+      if (eIasAvbProcOK != slot->queue.init(mQueueSize))
+      {
+        delete slot;
+        slot = NULL;
+      }
+      else
+      {
+        mLock.lock();
+        mSlots.push_back(slot);
+        mLock.unlock();
+      }
+    }
+
+    if (NULL == slot)
+    {
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "not enough memory to render stream ahead");
+    }
+  }
+
+  return slot;
+}
+
+
+void IasAvbPacketPrerenderer::detach(Slot *slot)
+{
+  AVB_ASSERT(NULL != slot);
+
+  // a snapshot taken after the slot has been removed does not contain it anymore
+  mLock.lock();
+  for (std::vector<Slot*>::iterator it = mSlots.begin(); it != mSlots.end(); it++)
+  {
+    if (slot == *it)
+    {
+      (void) mSlots.erase(it);
+      break;
+    }
+  }
+  const uint32_t epoch = mPassEpoch.load();
+  mLock.unlock();
+
+  if (0u != (epoch & 1u))
+  {
+    // the current pass may still render the stream, it is over once the epoch has moved on
+    while (epoch == mPassEpoch.load())
+    {
+      (void) usleep(10u);
+    }
+  }
+
+  drain(*slot);
+  delete slot;
+}
+
+
+uint32_t IasAvbPacketPrerenderer::getNumSlots()
+{
+  std::lock_guard<std::mutex> lock(mLock);
+  return uint32_t(mSlots.size());
+}
+
+
+IasAvbPacket* IasAvbPacketPrerenderer::fetchPacket(Slot &slot)
+{
+  IasAvbPacket *packet = NULL;
+  const uint32_t generation = slot.generation.load(std::memory_order_relaxed);
+  Rendered entry;
+
+  while ((NULL == packet) && slot.queue.pop(entry))
+  {
+    if (generation == entry.generation)
+    {
+      packet = entry.packet;
+    }
+    else
+    {
+      // rendered while the stream was being reset
+      IasAvbPacketPool::returnPacket(entry.packet);
+    }
+  }
+
+  if ((NULL != packet) && !packet->isDummyPacket())
+  {
+    // numbered here rather than by the worker, so the packets dropped by flush() leave no gap
+    uint8_t* const avtpBase8 = static_cast<uint8_t*>(packet->getBasePtr()) + ETH_HLEN + 4u; // consider VLAN tag
+    if (slot.sequenceValid)
+    {
+      avtpBase8[2] = slot.sequence;
+    }
+    slot.sequence = uint8_t(avtpBase8[2] + 1u);
+    slot.sequenceValid = true;
+  }
+
+  return packet;
+}
+
+
+void IasAvbPacketPrerenderer::flush(Slot &slot)
+{
+  /* the worker reads the generation before it renders a packet. Advancing it after the reset ensures
+   * that all packets tagged with the new generation have been rendered after the reset.
+   */
+  (void) slot.generation.fetch_add(1u, std::memory_order_release);
+  drain(slot);
+}
+
+
+void IasAvbPacketPrerenderer::drain(Slot &slot)
+{
+  Rendered entry;
+  while (slot.queue.pop(entry))
+  {
+    IasAvbPacketPool::returnPacket(entry.packet);
+  }
+}
+
+
+IasResult IasAvbPacketPrerenderer::beforeRun()
+{
+  DLT_LOG_CXX(*mLog, DLT_LOG_DEBUG, LOG_PREFIX);
+  mEndThread = false;
+  return IasResult::cOk;
+}
+
+
+IasResult IasAvbPacketPrerenderer::run()
+{
+  IasLibPtpDaemon * ptp = IasAvbStreamHandlerEnvironment::getPtpProxy();
+  AVB_ASSERT(NULL != ptp);
+
+  struct sched_param sparam;
+  std::string policyStr = "fifo";
+  int32_t priority = 1;
+
+  (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cSchedPolicy, policyStr);
+  (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cSchedPriority, priority);
+
+  int32_t policy = (policyStr == "other") ? SCHED_OTHER : (policyStr == "rr") ? SCHED_RR : SCHED_FIFO;
+  sparam.sched_priority = priority;
+
+  int32_t errval = pthread_setschedparam(pthread_self(), policy, &sparam);
+  if (0 != errval)
+  {
+    DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "Error setting scheduler parameter:", strerror(errval));
+  }
+
+  uint64_t next = ptp->getLocalTime();
+  while (!mEndThread)
+  {
+    const uint64_t now = ptp->getLocalTime();
+
+    // the epoch turns odd along with the snapshot, see detach()
+    mLock.lock();
+    (void) mPassEpoch.fetch_add(1u);
+    mRenderSlots.assign(mSlots.begin(), mSlots.end());
+    mLock.unlock();
+
+    for (std::vector<Slot*>::iterator it = mRenderSlots.begin(); it != mRenderSlots.end(); it++)
+    {
+      render(**it, now);
+    }
+    (void) mPassEpoch.fetch_add(1u);
+
+    next += mPeriod;
+    if (int64_t(next - now) <= 0)
+    {
+      // fell behind, e.g. after a time warp, do not try to catch up
+      next = now + mPeriod;
+    }
+
+    timespec tp;
+    IasLibPtpDaemon::convertNsToTimespec(ptp->ptpToSys(next), tp);
+    (void) clock_nanosleep(IasLibPtpDaemon::cSysClockId, TIMER_ABSTIME, &tp, NULL);
+  }
+
+  return IasResult::cOk;
+}
+
+
+void IasAvbPacketPrerenderer::render(Slot &slot, uint64_t now)
+{
+  AVB_ASSERT(NULL != slot.stream);
+
+  const uint32_t generation = slot.generation.load(std::memory_order_acquire);
+  if (generation != slot.renderedGeneration)
+  {
+    // stream has been reset, start over
+    slot.renderedGeneration = generation;
+    slot.renderedUntil = 0u;
+  }
+
+  const uint64_t until = now + mLeadTime;
+  // the capacity of the queue is rounded up to a power of 2, the configured depth is the limit
+  while ((slot.renderedUntil < until) && (slot.queue.size() < slot.depth))
+  {
+    IasAvbPacket *packet = slot.stream->preparePacket(until);
+    if (NULL == packet)
+    {
+      // stream ran dry, try again in the next pass
+      break;
+    }
+
+    slot.renderedUntil = packet->attime;
+
+    Rendered entry;
+    entry.packet = packet;
+    entry.generation = generation;
+    if (!slot.queue.push(entry))
+    {
+      // cannot happen, only this thread pushes
+      IasAvbPacketPool::returnPacket(packet);
+      break;
+    }
+  }
+}
+
+
+IasResult IasAvbPacketPrerenderer::shutDown()
+{
+  DLT_LOG_CXX(*mLog, DLT_LOG_DEBUG, LOG_PREFIX);
+  mEndThread = true;
+  return IasResult::cOk;
+}
+
+
+IasResult IasAvbPacketPrerenderer::afterRun()
+{
+  DLT_LOG_CXX(*mLog, DLT_LOG_DEBUG, LOG_PREFIX);
+  return IasResult::cOk;
+}
+
+
+} // namespace IasMediaTransportAvb
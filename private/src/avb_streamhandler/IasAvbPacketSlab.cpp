@@ -0,0 +1,231 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file    IasAvbPacketSlab.cpp
+ * @brief   This is the implementation of the IasAvbPacketSlab class.
+ * @date    2018
+ */
+
+#include "avb_streamhandler/IasAvbPacketSlab.hpp"
+
+namespace IasMediaTransportAvb
+{
+
+static const std::string cClassName = "IasAvbPacketSlab::";
+#define LOG_PREFIX cClassName + __func__ + "(" + std::to_string(__LINE__) + "):"
+
+
+IasAvbPacketSlab::IasAvbPacketSlab(DltContext &ctx)
+  : mLock()
+  , mAllocator(NULL)
+  , mChunks()
+  , mFreePages()
+  , mPageCount(0u)
+  , mReserved(0u)
+  , mReservedInUse(0u)
+  , mLog(&ctx)
+{
+  // do nothing
+}
+
+
+IasAvbPacketSlab::~IasAvbPacketSlab()
+{
+  cleanup();
+}
+
+
+IasAvbProcessingResult IasAvbPacketSlab::init(size_t size)
+{
+  IasAvbProcessingResult result = eIasAvbProcOK;
+  const uint32_t pagesNeeded = uint32_t((size + cPageSize - 1u) / cPageSize);
+
+  if (NULL != mAllocator)
+  {
+    result = eIasAvbProcInitializationFailed;
+  }
+  else if (0u == pagesNeeded)
+  {
+    result = eIasAvbProcInvalidParam;
+  }
+  else
+  {
+    result = IasAvbPacketAllocator::create(*mLog, mAllocator);
+  }
+
+  if (eIasAvbProcOK == result)
+  {
+    mFreePages.reserve(pagesNeeded);
+
+    while ((eIasAvbProcOK == result) && (mPageCount < pagesNeeded))
+    {
+      Page *chunk = new (nothrow) Page;
+
+      if (NULL == chunk)
+      {
+        result = eIasAvbProcNotEnoughMemory;
+      }
+      else if (eIasAvbProcOK != mAllocator->allocPage(size_t(pagesNeeded - mPageCount) * cPageSize, *chunk))
+      {
+        DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "packet memory allocation failure after",
+            mPageCount, "pages");
+        delete chunk;
+        result = eIasAvbProcNotEnoughMemory;
+      }
+      else
+      {
+        mChunks.push_back(chunk);
+
+        // the bus address is contiguous within a chunk obtained from the igb device
+        for (uint32_t offset = 0u; (offset + cPageSize) <= chunk->mmap_size; offset += cPageSize)
+        {
+          Page page;
+          page.dma_vaddr = static_cast<uint8_t*>(chunk->dma_vaddr) + offset;
+          page.dma_paddr = (0u != chunk->dma_paddr) ? (chunk->dma_paddr + offset) : 0u;
+          page.mmap_size = cPageSize;
+          mFreePages.push_back(page);
+          mPageCount++;
+        }
+      }
+    }
+
+    if (eIasAvbProcOK == result)
+    {
+      DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX, "packet slab of", mPageCount, "pages");
+    }
+    else
+    {
+      cleanup();
+    }
+  }
+
+  return result;
+}
+
+
+void IasAvbPacketSlab::cleanup()
+{
+  std::lock_guard<std::mutex> lock(mLock);
+
+  if (mFreePages.size() < mPageCount)
+  {
+    /*
+     * @log Pools still hold pages of the slab, the memory is released nevertheless.
+     */
+    DLT_LOG_CXX(*mLog, DLT_LOG_WARN, LOG_PREFIX, "pages not returned:", uint32_t(mPageCount - mFreePages.size()));
+  }
+
+  while (!mChunks.empty())
+  {
+    Page *chunk = mChunks.back();
+    mChunks.pop_back();
+    AVB_ASSERT(NULL != mAllocator);
+    mAllocator->freePage(*chunk);
+    delete chunk;
+  }
+
+  mFreePages.clear();
+  mPageCount = 0u;
+  mReserved = 0u;
+  mReservedInUse = 0u;
+  delete mAllocator;
+  mAllocator = NULL;
+}
+
+
+uint32_t IasAvbPacketSlab::getFreePageCount()
+{
+  std::lock_guard<std::mutex> lock(mLock);
+  return uint32_t(mFreePages.size());
+}
+
+
+uint32_t IasAvbPacketSlab::getReservedPageCount()
+{
+  std::lock_guard<std::mutex> lock(mLock);
+  return mReserved;
+}
+
+
+IasAvbProcessingResult IasAvbPacketSlab::reserve(uint32_t pages)
+{
+  IasAvbProcessingResult result = eIasAvbProcOK;
+  std::lock_guard<std::mutex> lock(mLock);
+
+  // free pages not yet promised to the reservations of other pools
+  const uint32_t available = uint32_t(mFreePages.size()) - (mReserved - mReservedInUse);
+
+  if (pages > available)
+  {
+    DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "cannot reserve", pages, "pages, available:", available);
+    result = eIasAvbProcNotEnoughMemory;
+  }
+  else
+  {
+    mReserved += pages;
+  }
+
+  return result;
+}
+
+
+void IasAvbPacketSlab::unreserve(uint32_t pages)
+{
+  std::lock_guard<std::mutex> lock(mLock);
+
+  AVB_ASSERT(pages <= mReserved);
+  mReserved -= pages;
+}
+
+
+bool IasAvbPacketSlab::borrowPage(uint32_t reserved, uint32_t &borrowed, Page &page)
+{
+  bool ret = false;
+  std::lock_guard<std::mutex> lock(mLock);
+
+  if (borrowed < reserved)
+  {
+    // always available, see reserve()
+    AVB_ASSERT(!mFreePages.empty());
+    mReservedInUse++;
+    ret = true;
+  }
+  else if (mFreePages.size() > (mReserved - mReservedInUse))
+  {
+    ret = true;
+  }
+  else
+  {
+    // the remaining pages are promised to other pools
+  }
+
+  if (ret)
+  {
+    page = mFreePages.back();
+    mFreePages.pop_back();
+    borrowed++;
+  }
+
+  return ret;
+}
+
+
+void IasAvbPacketSlab::returnPage(uint32_t reserved, uint32_t &borrowed, const Page &page)
+{
+  std::lock_guard<std::mutex> lock(mLock);
+
+  AVB_ASSERT(0u != borrowed);
+  borrowed--;
+  if (borrowed < reserved)
+  {
+    AVB_ASSERT(0u != mReservedInUse);
+    mReservedInUse--;
+  }
+  mFreePages.push_back(page);
+}
+
+
+} // namespace IasMediaTransportAvb
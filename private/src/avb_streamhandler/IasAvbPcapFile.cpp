@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file    IasAvbPcapFile.cpp
+ * @brief   This is the implementation of the IasAvbPcapFile class.
+ * @date    2018
+ */
+
+#include "avb_streamhandler/IasAvbPcapFile.hpp"
+
+
+namespace IasMediaTransportAvb
+{
+
+static const uint32_t cMagicMicroseconds = 0xA1B2C3D4u;
+static const uint32_t cMagicNanoseconds  = 0xA1B23C4Du;
+static const uint16_t cVersionMajor      = 2u;
+static const uint16_t cVersionMinor      = 4u;
+static const uint32_t cLinkTypeEthernet  = 1u;
+
+
+IasAvbPcapFile::IasAvbPcapFile()
+  : mFile(NULL)
+  , mWriting(false)
+  , mSwapped(false)
+  , mNanoseconds(false)
+  , mNumFrames(0u)
+  , mLock()
+{
+  // nothing to do
+}
+
+
+IasAvbPcapFile::~IasAvbPcapFile()
+{
+  close();
+}
+
+
+IasAvbProcessingResult IasAvbPcapFile::openRead(const std::string &fileName)
+{
+  IasAvbProcessingResult result = eIasAvbProcOK;
+
+  if (NULL != mFile)
+  {
+    result = eIasAvbProcInitializationFailed;
+  }
+  else
+  {
+    mFile = fopen(fileName.c_str(), "rb");
+    if (NULL == mFile)
+    {
+      result = eIasAvbProcInitializationFailed;
+    }
+  }
+
+  if (eIasAvbProcOK == result)
+  {
+    FileHeader header;
+    if (1u != fread(&header, sizeof header, 1u, mFile))
+    {
+      result = eIasAvbProcUnsupportedFormat;
+    }
+    else
+    {
+      mSwapped = false;
+      if ((cMagicMicroseconds != header.magic) && (cMagicNanoseconds != header.magic))
+      {
+        mSwapped = true;
+        header.magic = __builtin_bswap32(header.magic);
+      }
+
+      mNanoseconds = (cMagicNanoseconds == header.magic);
+      if (((cMagicMicroseconds != header.magic) && (cMagicNanoseconds != header.magic))
+          || (cLinkTypeEthernet != toHost(header.linkType)))
+      {
+        result = eIasAvbProcUnsupportedFormat;
+      }
+    }
+
+    if (eIasAvbProcOK != result)
+    {
+      close();
+    }
+  }
+
+  if (eIasAvbProcOK == result)
+  {
+    mWriting = false;
+    mNumFrames = 0u;
+  }
+
+  return result;
+}
+
+
+IasAvbProcessingResult IasAvbPcapFile::openWrite(const std::string &fileName)
+{
+  IasAvbProcessingResult result = eIasAvbProcOK;
+
+  if (NULL != mFile)
+  {
+    result = eIasAvbProcInitializationFailed;
+  }
+  else
+  {
+    mFile = fopen(fileName.c_str(), "wb");
+    if (NULL == mFile)
+    {
+      result = eIasAvbProcInitializationFailed;
+    }
+  }
+
+  if (eIasAvbProcOK == result)
+  {
+    FileHeader header;
+    header.magic = cMagicNanoseconds;
+    header.versionMajor = cVersionMajor;
+    header.versionMinor = cVersionMinor;
+    header.thisZone = 0;
+    header.sigFigs = 0u;
+    header.snapLength = cSnapLength;
+    header.linkType = cLinkTypeEthernet;
+
+    if (1u != fwrite(&header, sizeof header, 1u, mFile))
+    {
+      close();
+      result = eIasAvbProcInitializationFailed;
+    }
+  }
+
+  if (eIasAvbProcOK == result)
+  {
+    mWriting = true;
+    mSwapped = false;
+    mNanoseconds = true;
+    mNumFrames = 0u;
+  }
+
+  return result;
+}
+
+
+void IasAvbPcapFile::close()
+{
+  std::lock_guard<std::mutex> lock(mLock);
+
+  if (NULL != mFile)
+  {
+    (void) fclose(mFile);
+    mFile = NULL;
+  }
+}
+
+
+IasAvbProcessingResult IasAvbPcapFile::readFrame(uint8_t *buffer, size_t bufferSize, size_t &length, uint64_t &timestamp)
+{
+  IasAvbProcessingResult result = eIasAvbProcOK;
+  RecordHeader header;
+
+  if ((NULL == mFile) || mWriting || (NULL == buffer))
+  {
+    result = eIasAvbProcNotInitialized;
+  }
+  else
+  {
+    const size_t headerLength = fread(&header, 1u, sizeof header, mFile);
+    if (sizeof header != headerLength)
+    {
+      // a partial record header means the file has been truncated
+      result = (0u == headerLength) ? eIasAvbProcOff : eIasAvbProcErr;
+    }
+  }
+
+  if (eIasAvbProcOK == result)
+  {
+    const size_t capturedLength = toHost(header.capturedLength);
+    length = (capturedLength < bufferSize) ? capturedLength : bufferSize;
+
+    timestamp = uint64_t(toHost(header.tsSec)) * 1000000000u
+        + uint64_t(toHost(header.tsFraction)) * (mNanoseconds ? 1u : 1000u);
+
+    if (length != fread(buffer, 1u, length, mFile))
+    {
+      result = eIasAvbProcErr;
+    }
+    else if ((capturedLength > length) && (0 != fseek(mFile, long(capturedLength - length), SEEK_CUR)))
+    {
+      result = eIasAvbProcErr;
+    }
+    else
+    {
+      mNumFrames++;
+    }
+  }
+
+  return result;
+}
+
+
+IasAvbProcessingResult IasAvbPcapFile::writeFrame(const uint8_t *frame, size_t length, uint64_t timestamp)
+{
+  IasAvbProcessingResult result = eIasAvbProcOK;
+  std::lock_guard<std::mutex> lock(mLock);
+
+  if ((NULL == mFile) || !mWriting || (NULL == frame))
+  {
+    result = eIasAvbProcNotInitialized;
+  }
+  else
+  {
+    RecordHeader header;
+    header.tsSec = uint32_t(timestamp / 1000000000u);
+    header.tsFraction = uint32_t(timestamp % 1000000000u);
+    header.capturedLength = uint32_t((length < cSnapLength) ? length : cSnapLength);
+    header.originalLength = uint32_t(length);
+
+    if ((1u != fwrite(&header, sizeof header, 1u, mFile))
+        || (header.capturedLength != fwrite(frame, 1u, header.capturedLength, mFile)))
+    {
+      result = eIasAvbProcNoSpaceLeft;
+    }
+    else
+    {
+      mNumFrames++;
+    }
+  }
+
+  return result;
+}
+
+
+} // namespace IasMediaTransportAvb
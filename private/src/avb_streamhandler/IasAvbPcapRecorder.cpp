@@ -0,0 +1,273 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+/**
+ * @file    IasAvbPcapRecorder.cpp
+ * @brief   The implementation of the IasAvbPcapRecorder class.
+ * @date    2018
+ */
+
+#include <time.h> // make sure we include the right timespec definition
+#include "avb_streamhandler/IasAvbPcapRecorder.hpp"
+
+#include <cstring>
+
+namespace IasMediaTransportAvb {
+
+static const std::string cClassName = "IasAvbPcapRecorder::";
+#define LOG_PREFIX cClassName + __func__ + "(" + std::to_string(__LINE__) + "):"
+
+
+IasAvbPcapRecorder::Lane::Lane()
+  : records(NULL)
+  , free()
+  , queued()
+  , dropped(0u)
+{
+  // do nothing
+}
+
+
+/*
+ *  Constructor.
+ */
+IasAvbPcapRecorder::IasAvbPcapRecorder(DltContext &ctx)
+  : mThread(NULL)
+  , mEndThread(false)
+  , mFile()
+  , mLanes()
+  , mNumDropped(0u)
+  , mLog(&ctx)
+{
+  DLT_LOG_CXX(*mLog, DLT_LOG_VERBOSE, LOG_PREFIX);
+}
+
+
+/*
+ *  Destructor.
+ */
+IasAvbPcapRecorder::~IasAvbPcapRecorder()
+{
+  DLT_LOG_CXX(*mLog, DLT_LOG_VERBOSE, LOG_PREFIX);
+  cleanup();
+}
+
+
+IasAvbProcessingResult IasAvbPcapRecorder::init(const std::string &fileName, uint32_t numProducers, uint32_t numRecords)
+{
+  IasAvbProcessingResult result = eIasAvbProcOK;
+
+  DLT_LOG_CXX(*mLog, DLT_LOG_VERBOSE, LOG_PREFIX);
+
+  if (NULL != mThread)
+  {
+    result = eIasAvbProcInitializationFailed;
+  }
+  else if ((0u == numProducers) || (0u == numRecords))
+  {
+    result = eIasAvbProcInvalidParam;
+  }
+  else
+  {
+    for (uint32_t i = 0u; (eIasAvbProcOK == result) && (i < numProducers); i++)
+    {
+      Lane *lane = new (nothrow) Lane();
+      if (NULL != lane)
+      {
+        mLanes.push_back(lane);
+        lane->records = new (nothrow) Record[numRecords];
+      }
+
+      if ((NULL == lane) || (NULL == lane->records))
+      {
+        result = eIasAvbProcNotEnoughMemory;
+      }
+      else
+      {
+        result = lane->free.init(numRecords);
+        if (eIasAvbProcOK == result)
+        {
+          result = lane->queued.init(numRecords);
+        }
+
+        for (uint32_t j = 0u; (eIasAvbProcOK == result) && (j < numRecords); j++)
+        {
+          (void) lane->free.push(&lane->records[j]);
+        }
+      }
+    }
+
+    if (eIasAvbProcOK == result)
+    {
+      result = mFile.openWrite(fileName);
+    }
+
+    if (eIasAvbProcOK == result)
+    {
+      mThread = new (nothrow) IasThread(this, "AvbPcapRecord");
+      if (NULL == mThread)
+      {
+        /**
+         * @log Not enough memory to create the thread.
+         */
+        DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "Couldn't create writer thread!");
+        result = eIasAvbProcNotEnoughMemory;
+      }
+      else
+      {
+        IasThreadResult res = mThread->start(true);
+        if (res != IasResult::cOk)
+        {
+          /**
+           * @log Thread start failed: The pcap writer thread couldn't be started.
+           */
+          DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "Couldn't start writer thread! Error =", res.toString());
+          result = eIasAvbProcThreadStartFailed;
+        }
+      }
+    }
+
+    if (eIasAvbProcOK != result)
+    {
+      cleanup();
+    }
+  }
+
+  return result;
+}
+
+
+void IasAvbPcapRecorder::cleanup()
+{
+  if (NULL != mThread)
+  {
+    if (mThread->isRunning())
+    {
+      (void) mThread->stop();
+    }
+    delete mThread;
+    mThread = NULL;
+  }
+
+  // the frames queued after the last pass of the writer
+  if (mFile.isOpen())
+  {
+    writeQueued();
+  }
+  mFile.close();
+
+  for (std::vector<Lane*>::iterator it = mLanes.begin(); it != mLanes.end(); it++)
+  {
+    mNumDropped += (*it)->dropped;
+    delete[] (*it)->records;
+    delete *it;
+  }
+  mLanes.clear();
+}
+
+
+bool IasAvbPcapRecorder::record(uint32_t producer, const uint8_t *frame, size_t length, uint64_t timestamp)
+{
+  bool ret = false;
+
+  AVB_ASSERT(producer < mLanes.size());
+  AVB_ASSERT(NULL != frame);
+
+  Lane &lane = *mLanes[producer];
+  Record *record = NULL;
+  if (lane.free.pop(record))
+  {
+    record->timestamp = timestamp;
+    record->length = uint32_t(length);
+    (void) std::memcpy(record->data, frame, (length < cMaxFrameLength) ? length : cMaxFrameLength);
+    // cannot fail, there are not more records than queue entries
+    ret = lane.queued.push(record);
+  }
+
+  if (!ret)
+  {
+    lane.dropped++;
+  }
+
+  return ret;
+}
+
+
+uint64_t IasAvbPcapRecorder::getNumDropped() const
+{
+  uint64_t ret = mNumDropped;
+
+  for (std::vector<Lane*>::const_iterator it = mLanes.begin(); it != mLanes.end(); it++)
+  {
+    ret += (*it)->dropped;
+  }
+
+  return ret;
+}
+
+
+void IasAvbPcapRecorder::writeQueued()
+{
+  for (std::vector<Lane*>::iterator it = mLanes.begin(); it != mLanes.end(); it++)
+  {
+    Lane &lane = **it;
+    Record *record = NULL;
+    while (lane.queued.pop(record))
+    {
+      // longer frames have been truncated by record()
+      (void) mFile.writeFrame(record->data, (record->length < cMaxFrameLength) ? record->length : cMaxFrameLength,
+          record->timestamp);
+      (void) lane.free.push(record);
+    }
+  }
+}
+
+
+IasResult IasAvbPcapRecorder::beforeRun()
+{
+  DLT_LOG_CXX(*mLog, DLT_LOG_DEBUG, LOG_PREFIX);
+  mEndThread = false;
+  return IasResult::cOk;
+}
+
+
+IasResult IasAvbPcapRecorder::run()
+{
+  timespec tp;
+  (void) clock_gettime(CLOCK_MONOTONIC, &tp);
+
+  while (!mEndThread)
+  {
+    writeQueued();
+
+    tp.tv_nsec += long(cWritePeriod);
+    if (tp.tv_nsec >= 1000000000)
+    {
+      tp.tv_nsec -= 1000000000;
+      tp.tv_sec++;
+    }
+    (void) clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &tp, NULL);
+  }
+
+  return IasResult::cOk;
+}
+
+
+IasResult IasAvbPcapRecorder::shutDown()
+{
+  DLT_LOG_CXX(*mLog, DLT_LOG_DEBUG, LOG_PREFIX);
+  mEndThread = true;
+  return IasResult::cOk;
+}
+
+
+IasResult IasAvbPcapRecorder::afterRun()
+{
+  DLT_LOG_CXX(*mLog, DLT_LOG_DEBUG, LOG_PREFIX);
+  return IasResult::cOk;
+}
+
+
+} // namespace IasMediaTransportAvb
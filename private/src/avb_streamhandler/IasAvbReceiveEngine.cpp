@@ -35,9 +35,12 @@
 #include <sys/socket.h>
 
 #include <linux/if_packet.h>
+#include <linux/filter.h>
 #include <linux/if_arp.h>
 #include <linux/if_vlan.h>
 #include <linux/sockios.h>
+#include <linux/net_tstamp.h>
+#include <linux/errqueue.h>
 
 #include <iostream>
 #include <sstream>
@@ -47,6 +50,9 @@
 #include <fcntl.h>
 #include <cstdio>
 #include <sys/select.h>
+#include <sys/mman.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
 
 #include <limits>
 
@@ -68,6 +74,8 @@ namespace IasMediaTransportAvb {
 static const std::string cClassName = "IasAvbReceiveEngine::";
 #define LOG_PREFIX cClassName + __func__ + "(" + std::to_string(__LINE__) + "):"
 
+const uint32_t IasAvbReceiveEngine::cRxWorkersMax;
+
 /*
  *  Constructor.
  */
@@ -75,22 +83,49 @@ IasAvbReceiveEngine::IasAvbReceiveEngine()
 : mInstanceName("IasAvbReceiveEngine")
 , mEndThread(false)
 , mReceiveThread(NULL)
+, mAvbStreams()
+, mStreamTable(NULL)
+, mStreamTableGeneration(0u)
 , mLock()
+, mStatusLock()
+, mRekeyStreamId(0u)
 , mEventInterface(NULL)
-, mReceiveSocket(-1)
-, mReceiveBuffer(NULL)
+, mWorkers()
+, mNumWorkers(1u)
 , mIgnoreStreamId(false)
 , mLog(&IasAvbStreamHandlerEnvironment::getDltContext("_RXE"))
 , mWatchdog(NULL)
+, mDiscardByPts(false)
+, mDiscardAfter(0u)
+, mTimeoutTick(cTimeoutTickDefault)
 #if defined(DIRECT_RX_DMA)
 , mIgbDevice(NULL)
 , mRcvPacketPool(NULL)
 , mPacketList()
 , mRecoverIgbReceiver(true)
+, mShardFilters()
+#else
+, mUseRxRing(false)
+, mRxRingBlockSize(cRxRingBlockSizeDefault)
+, mRxRingBlockCount(cRxRingBlockCountDefault)
+, mFanoutGroupId(0u)
+, mWakeupMode(eRxWakeupPoll)
+, mBusyPollTime(cRxBusyPollDefault)
+, mUseRxFilter(true)
+, mTimestampMode(eRxTimestampSoftware)
+, mPcapReplay(NULL)
+, mReplayRealtime(true)
 #endif /* DIRECT_RX_DMA */
+, mPcapRecord(NULL)
 , mRcvPortIfIndex(0)
 {
   DLT_LOG_CXX(*mLog, DLT_LOG_VERBOSE, LOG_PREFIX);
+
+  for (uint32_t i = 0u; i < cRxWorkersMax; i++)
+  {
+    mWorkers[i].engine = this;
+    mWorkers[i].index = i;
+  }
 }
 
 /*
@@ -122,27 +157,163 @@ IasAvbProcessingResult IasAvbReceiveEngine::init()
     uint64_t val = 0u;
     mIgnoreStreamId = (IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cRxIgnoreStreamId, val) && (0u != val));
 
-    mReceiveThread = new (nothrow) IasThread(this, "AvbRxWrk");
-    if (NULL == mReceiveThread)
+    mNumWorkers = 1u;
+    (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cRxWorkers, mNumWorkers);
+    if ((0u == mNumWorkers) || (cRxWorkersMax < mNumWorkers))
     {
       /**
-       * @log Init failed: Not enough memory to create thread.
+       * @log Init failed: The configured number of receive workers is not supported.
        */
-      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "Couldn't create receive thread!");
-      result = eIasAvbProcInitializationFailed;
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "invalid number of receive workers:", mNumWorkers,
+          "(max", cRxWorkersMax, ")");
+      mNumWorkers = 1u;
+      result = eIasAvbProcInvalidParam;
+    }
+
+    mTimeoutTick = cTimeoutTickDefault;
+    (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cRxTimeoutTick, mTimeoutTick);
+    if (0u == mTimeoutTick)
+    {
+      /**
+       * @log Init failed: The resolution of the stream timeouts must not be 0.
+       */
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "invalid stream timeout resolution:", mTimeoutTick);
+      mTimeoutTick = cTimeoutTickDefault;
+      result = eIasAvbProcInvalidParam;
     }
 
+    for (uint32_t i = 0u; (eIasAvbProcOK == result) && (i < mNumWorkers); i++)
+    {
+      RxWorker &worker = mWorkers[i];
+
+      worker.cpu = -1;
+      (void) IasAvbStreamHandlerEnvironment::getConfigValue(std::string(IasRegKeys::cRxWorkerCpu) + std::to_string(i), worker.cpu);
+
+      if (0u == i)
+      {
+        // worker 0 is run by the engine itself
+        mReceiveThread = new (nothrow) IasThread(this, "AvbRxWrk");
+      }
+      else
+      {
+        worker.thread = new (nothrow) IasThread(&worker, "AvbRxWrk" + std::to_string(i));
+      }
+
+      if ((NULL == mReceiveThread) || ((0u != i) && (NULL == worker.thread)))
+      {
+        /**
+         * @log Init failed: Not enough memory to create thread.
+         */
+        DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "Couldn't create receive thread!");
+        result = eIasAvbProcInitializationFailed;
+      }
+
 #if !defined(DIRECT_RX_DMA)
+      if (eIasAvbProcOK == result)
+      {
+        // one slot per packet of a burst, see queuePacket()
+        worker.buffer = new (nothrow) uint8_t[cRxBurstMax * cReceiveBufferSize];
+        if (NULL == worker.buffer)
+        {
+          /**
+           * @log Init failed: Not enough memory to create the buffer.
+           */
+          DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "Couldn't create receive buffer!");
+          result = eIasAvbProcInitializationFailed;
+        }
+      }
+#endif /* !DIRECT_RX_DMA */
+    }
+
     if (eIasAvbProcOK == result)
     {
-      mReceiveBuffer = new (nothrow) uint8_t[cReceiveBufferSize];
-      if (NULL == mReceiveBuffer)
+      DLT_LOG_CXX(*mLog, DLT_LOG_DEBUG, LOG_PREFIX, "Rx workers:", mNumWorkers);
+    }
+
+#if !defined(DIRECT_RX_DMA)
+    val = 0u;
+    mUseRxRing = (IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cRxSocketRing, val) && (0u != val));
+    DLT_LOG_CXX(*mLog, DLT_LOG_DEBUG, LOG_PREFIX, "Rx socket ring:", mUseRxRing ? "on" : "off");
+
+    val = eRxWakeupPoll;
+    (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cRxWakeup, val);
+    (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cRxBusyPoll, mBusyPollTime);
+    if (val > eRxWakeupBusyPoll)
+    {
+      /**
+       * @log Init failed: Unknown receive wakeup mode.
+       */
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "invalid receive wakeup mode:", val);
+      result = eIasAvbProcInvalidParam;
+    }
+    else
+    {
+      mWakeupMode = RxWakeupMode(val);
+      DLT_LOG_CXX(*mLog, DLT_LOG_DEBUG, LOG_PREFIX, "Rx wakeup mode:", uint32_t(mWakeupMode),
+          "busy poll:", mBusyPollTime, "us");
+    }
+
+    val = 1u;
+    (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cRxSocketFilter, val);
+    mUseRxFilter = (0u != val);
+    DLT_LOG_CXX(*mLog, DLT_LOG_DEBUG, LOG_PREFIX, "Rx socket filter:", mUseRxFilter ? "on" : "off");
+
+    val = eRxTimestampSoftware;
+    (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cRxTimestamping, val);
+    if (val > eRxTimestampHardware)
+    {
+      /**
+       * @log Init failed: Unknown receive time stamp mode.
+       */
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "invalid receive time stamp mode:", val);
+      result = eIasAvbProcInvalidParam;
+    }
+    else
+    {
+      mTimestampMode = RxTimestampMode(val);
+      DLT_LOG_CXX(*mLog, DLT_LOG_DEBUG, LOG_PREFIX, "Rx time stamp mode:", uint32_t(mTimestampMode));
+    }
+
+    std::string replayFile;
+    if ((eIasAvbProcOK == result) && IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cRxPcapReplay, replayFile)
+        && !replayFile.empty())
+    {
+      val = 1u;
+      (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cRxPcapReplayRealtime, val);
+      mReplayRealtime = (0u != val);
+
+      if (mNumWorkers > 1u)
       {
         /**
-         * @log Init failed: Not enough memory to create the buffer.
+         * @log Init failed: A capture can only be replayed into a single receive worker.
          */
-        DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "Couldn't create receive buffer!");
-        result = eIasAvbProcInitializationFailed;
+        DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "pcap replay requires a single receive worker");
+        result = eIasAvbProcInvalidParam;
+      }
+      else
+      {
+        mPcapReplay = new (nothrow) IasAvbPcapFile();
+        if (NULL == mPcapReplay)
+        {
+          DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "Couldn't create pcap reader!");
+          result = eIasAvbProcNotEnoughMemory;
+        }
+        else
+        {
+          result = mPcapReplay->openRead(replayFile);
+          if (eIasAvbProcOK != result)
+          {
+            /**
+             * @log Init failed: The capture to be replayed cannot be read.
+             */
+            DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "cannot replay", replayFile.c_str(), "result:", int32_t(result));
+          }
+          else
+          {
+            DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX, "replaying", replayFile.c_str(),
+                mReplayRealtime ? "in real time" : "as fast as possible");
+          }
+        }
       }
     }
 #else
@@ -155,6 +326,34 @@ IasAvbProcessingResult IasAvbReceiveEngine::init()
      * addresses to network interface. That's why still openReceiveSocket is called.
      */
 #endif /* !DIRECT_RX_DMA */
+    std::string recordFile;
+    if ((eIasAvbProcOK == result) && IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cRxPcapRecord, recordFile)
+        && !recordFile.empty())
+    {
+      mPcapRecord = new (nothrow) IasAvbPcapRecorder(*mLog);
+      if (NULL == mPcapRecord)
+      {
+        DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "Couldn't create pcap recorder!");
+        result = eIasAvbProcNotEnoughMemory;
+      }
+      else
+      {
+        // each worker queues its frames, the file is written by the recorder thread
+        result = mPcapRecord->init(recordFile, mNumWorkers, cPcapRecordQueueSize);
+        if (eIasAvbProcOK != result)
+        {
+          /**
+           * @log Init failed: The capture file for recording cannot be created.
+           */
+          DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "cannot record to", recordFile.c_str());
+        }
+        else
+        {
+          DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX, "recording received frames to", recordFile.c_str());
+        }
+      }
+    }
+
     if (eIasAvbProcOK == result)
     {
       result = openReceiveSocket();
@@ -258,6 +457,10 @@ IasAvbProcessingResult IasAvbReceiveEngine::start()
 
   DLT_LOG_CXX(*mLog, DLT_LOG_VERBOSE, LOG_PREFIX);
 
+  // read before any worker runs, the values are shared by all of them
+  mDiscardAfter = 0u;
+  mDiscardByPts = IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cRxDiscardAfter, mDiscardAfter);
+
 #if defined(DIRECT_RX_DMA)
   /* Start direct DMA for RX */
   result = startIgbReceiveEngine();
@@ -272,6 +475,21 @@ IasAvbProcessingResult IasAvbReceiveEngine::start()
       {
         result = eIasAvbProcThreadStartFailed;
       }
+
+      for (uint32_t i = 1u; (eIasAvbProcOK == result) && (i < mNumWorkers); i++)
+      {
+        AVB_ASSERT(NULL != mWorkers[i].thread);
+        res = mWorkers[i].thread->start(true);
+        if ((res != IasResult::cOk) && (res != IasThreadResult::cThreadAlreadyStarted))
+        {
+          result = eIasAvbProcThreadStartFailed;
+        }
+      }
+
+      if (eIasAvbProcOK != result)
+      {
+        (void) stopWorkers();
+      }
     }
     else
     {
@@ -314,11 +532,8 @@ IasAvbProcessingResult IasAvbReceiveEngine::stop()
   {
     if (mReceiveThread->isRunning())
     {
-      if (mReceiveThread->stop() != IasResult::cOk)
-      {
-        result = eIasAvbProcThreadStopFailed;
-      }
-      else
+      result = stopWorkers();
+      if (eIasAvbProcOK == result)
       {
 #if defined(DIRECT_RX_DMA)
         (void) stopIgbReceiveEngine();
@@ -336,6 +551,26 @@ IasAvbProcessingResult IasAvbReceiveEngine::stop()
 }
 
 
+IasAvbProcessingResult IasAvbReceiveEngine::stopWorkers()
+{
+  IasAvbProcessingResult result = eIasAvbProcOK;
+
+  for (uint32_t i = 0u; i < mNumWorkers; i++)
+  {
+    IasThread * const thread = (0u == i) ? mReceiveThread : mWorkers[i].thread;
+    if ((NULL != thread) && thread->isRunning())
+    {
+      if (thread->stop() != IasResult::cOk)
+      {
+        result = eIasAvbProcThreadStopFailed;
+      }
+    }
+  }
+
+  return result;
+}
+
+
 IasAvbProcessingResult IasAvbReceiveEngine::checkStreamIdInUse(const IasAvbStreamId & avbStreamId) const
 {
   IasAvbProcessingResult ret = eIasAvbProcOK;
@@ -380,7 +615,14 @@ IasAvbProcessingResult IasAvbReceiveEngine::createReceiveAudioStream(IasAvbSrCla
         data.lastState = newAudioStream->getStreamState();
         data.lastTimeDispatched = 0u;
         (void) lock();
+        data.worker = selectWorker(destMacAddr);
         mAvbStreams[streamId] = data;
+        result = publishStreamTable();
+        if (eIasAvbProcOK != result)
+        {
+          eraseStream(mAvbStreams.find(streamId));
+          delete newAudioStream;
+        }
         (void) unlock();
       }
       else
@@ -407,8 +649,10 @@ IasAvbProcessingResult IasAvbReceiveEngine::createReceiveAudioStream(IasAvbSrCla
        * might decrease the mac's ref counter despite of the failure of binding.
        */
       (void) lock();
-      IasAvbStream *avbStream = mAvbStreams[streamId].stream;
-      mAvbStreams.erase(streamId);
+      AvbStreamMap::iterator it = mAvbStreams.find(streamId);
+      AVB_ASSERT(mAvbStreams.end() != it);
+      IasAvbStream *avbStream = it->second.stream;
+      eraseStream(it);
       delete avbStream;
       (void) unlock();
     }
@@ -445,7 +689,14 @@ IasAvbProcessingResult IasAvbReceiveEngine::createReceiveVideoStream(IasAvbSrCla
         data.lastState = newVideoStream->getStreamState();
         data.lastTimeDispatched = 0u;
         (void) lock();
+        data.worker = selectWorker(destMacAddr);
         mAvbStreams[streamId] = data;
+        result = publishStreamTable();
+        if (eIasAvbProcOK != result)
+        {
+          eraseStream(mAvbStreams.find(streamId));
+          delete newVideoStream;
+        }
         (void) unlock();
       }
       else
@@ -470,8 +721,10 @@ IasAvbProcessingResult IasAvbReceiveEngine::createReceiveVideoStream(IasAvbSrCla
     if (eIasAvbProcOK != result)
     {
       (void) lock();
-      IasAvbStream *avbStream = mAvbStreams[streamId].stream;
-      mAvbStreams.erase(streamId);
+      AvbStreamMap::iterator it = mAvbStreams.find(streamId);
+      AVB_ASSERT(mAvbStreams.end() != it);
+      IasAvbStream *avbStream = it->second.stream;
+      eraseStream(it);
       delete avbStream;
       (void) unlock();
     }
@@ -506,7 +759,14 @@ IasAvbProcessingResult IasAvbReceiveEngine::createReceiveClockReferenceStream(Ia
         data.lastState = newStream->getStreamState();
         data.lastTimeDispatched = 0u;
         (void) lock();
+        data.worker = selectWorker(destMacAddr);
         mAvbStreams[streamId] = data;
+        result = publishStreamTable();
+        if (eIasAvbProcOK != result)
+        {
+          eraseStream(mAvbStreams.find(streamId));
+          delete newStream;
+        }
         (void) unlock();
       }
       else
@@ -528,8 +788,10 @@ IasAvbProcessingResult IasAvbReceiveEngine::createReceiveClockReferenceStream(Ia
     if (eIasAvbProcOK != result)
     {
       (void) lock();
-      IasAvbStream *avbStream = mAvbStreams[streamId].stream;
-      mAvbStreams.erase(streamId);
+      AvbStreamMap::iterator it = mAvbStreams.find(streamId);
+      AVB_ASSERT(mAvbStreams.end() != it);
+      IasAvbStream *avbStream = it->second.stream;
+      eraseStream(it);
       delete avbStream;
       (void) unlock();
     }
@@ -553,7 +815,7 @@ IasAvbProcessingResult IasAvbReceiveEngine::destroyAvbStream(IasAvbStreamId cons
   {
     IasAvbStream *avbStream = it->second.stream;
 
-    mAvbStreams.erase(streamId);
+    eraseStream(it);
 
     (void) unbindMcastAddr(avbStream->getDmac());
 
@@ -565,6 +827,234 @@ IasAvbProcessingResult IasAvbReceiveEngine::destroyAvbStream(IasAvbStreamId cons
 }
 
 
+IasAvbProcessingResult IasAvbReceiveEngine::publishStreamTable(const StreamData * exclude)
+{
+  IasAvbProcessingResult result = eIasAvbProcOK;
+
+  StreamTable * newTable = new (nothrow) StreamTable();
+  if (NULL == newTable)
+  {
+    /**
+     * @log Not enough memory: the stream lookup table could not be created, reception is suspended.
+     */
+    DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "Not enough memory to create stream lookup table!");
+    result = eIasAvbProcNotEnoughMemory;
+  }
+  else
+  {
+    // keep the load factor at or below 50%
+    size_t numSlots = 8u;
+    while (numSlots < (2u * mAvbStreams.size()))
+    {
+      numSlots <<= 1;
+    }
+    const size_t mask = numSlots - 1u;
+
+    StreamTable::Entry empty;
+    empty.streamId = 0u;
+    empty.data = NULL;
+    newTable->slots.assign(numSlots, empty);
+    newTable->streams.reserve(mAvbStreams.size());
+    newTable->wildcard = NULL;
+    newTable->generation = ++mStreamTableGeneration;
+
+    for (AvbStreamMap::iterator it = mAvbStreams.begin(); mAvbStreams.end() != it; it++)
+    {
+      StreamData * const data = &it->second;
+      if (data != exclude)
+      {
+        const uint64_t streamId = it->first;
+        size_t idx = hashStreamId(streamId, mask);
+        while (NULL != newTable->slots[idx].data)
+        {
+          idx = (idx + 1u) & mask;
+        }
+        newTable->slots[idx].streamId = streamId;
+        newTable->slots[idx].data = data;
+        newTable->streams.push_back(data);
+
+        if (0u == streamId)
+        {
+          newTable->wildcard = data;
+        }
+      }
+    }
+  }
+
+  StreamTable * const oldTable = mStreamTable.exchange(newTable);
+
+#if !defined(DIRECT_RX_DMA)
+  if (mUseRxFilter)
+  {
+    updateReceiveFilter(newTable);
+  }
+#endif /* !DIRECT_RX_DMA */
+
+  // the workers might still be using the old table or the entry about to be erased
+  waitForReaders();
+  delete oldTable;
+
+  return result;
+}
+
+
+void IasAvbReceiveEngine::waitForReaders()
+{
+  for (uint32_t i = 0u; i < mNumWorkers; i++)
+  {
+    const RxWorker &worker = mWorkers[i];
+    const uint32_t epoch = worker.readerEpoch.load();
+
+    if (0u != (epoch & 1u))
+    {
+      /*
+       * Read sections cover a single frame or one timeout pass, so this will not take long.
+       * A worker never blocks inside a read section.
+       */
+      while (epoch == worker.readerEpoch.load())
+      {
+        (void) usleep(10u);
+      }
+    }
+  }
+}
+
+
+void IasAvbReceiveEngine::eraseStream(AvbStreamMap::iterator it)
+{
+  AVB_ASSERT(mAvbStreams.end() != it);
+  AVB_ASSERT(NULL != it->second.stream);
+
+  (void) publishStreamTable(&it->second);
+  if (uint64_t(0u) == uint64_t(it->first))
+  {
+    // no worker sees the wildcard entry anymore, a pending request refers to it
+    mRekeyStreamId.store(0u);
+  }
+  releaseWorker(*it->second.stream, it->second.worker);
+  mAvbStreams.erase(it);
+}
+
+
+void IasAvbReceiveEngine::rekeyWildcard()
+{
+  const IasAvbStreamId newId(mRekeyStreamId.exchange(0u));
+
+  if (uint64_t(0u) != uint64_t(newId))
+  {
+    const IasAvbStreamId wildcardId(uint64_t(0u));
+    AvbStreamMap::iterator it = mAvbStreams.find(wildcardId);
+
+    if ((mAvbStreams.end() != it) && (mAvbStreams.end() == mAvbStreams.find(newId)))
+    {
+      StreamData &wildcard = it->second;
+      AVB_ASSERT(NULL != wildcard.stream);
+
+      {
+        // the worker serving the stream reports state changes with the stream ID under mStatusLock
+        std::lock_guard<std::mutex> guard(mStatusLock);
+        wildcard.stream->changeStreamId(newId);
+        mAvbStreams[newId] = wildcard;
+      }
+
+      // the worker keeps using the wildcard entry until it has picked up the new table
+      (void) publishStreamTable(&wildcard);
+      mAvbStreams.erase(it);
+    }
+  }
+}
+
+
+uint32_t IasAvbReceiveEngine::selectWorker(const IasAvbMacAddress &dmac)
+{
+  uint32_t worker = 0u;
+
+#if defined(DIRECT_RX_DMA)
+  /*
+   * Worker 1 polls eRxQueue1, which only receives the frames of the DMACs that have a flex filter
+   * routing them there. Once all filters are taken, new streams are served by worker 0.
+   * A filter captures all frames of its DMAC, so all streams sharing a DMAC have to be served by
+   * the same worker: a DMAC that already has a stream on worker 0 must not get a filter later on.
+   */
+  IasAvbMacAddress zeroMac;
+  std::memset(zeroMac, 0, cIasAvbMacAddressLength);
+
+  bool servedByWorker0 = false;
+  for (AvbStreamMap::const_iterator it = mAvbStreams.begin();
+       (!servedByWorker0) && (it != mAvbStreams.end()); it++)
+  {
+    AVB_ASSERT(NULL != it->second.stream);
+    servedByWorker0 = (0u == it->second.worker)
+        && (0 == std::memcmp(it->second.stream->getDmac(), dmac, cIasAvbMacAddressLength));
+  }
+
+  if ((mNumWorkers > 1u) && (1u == (dmac[5] % mNumWorkers)) && (!servedByWorker0)
+      && (0 != std::memcmp(dmac, zeroMac, cIasAvbMacAddressLength)))
+  {
+    size_t freeIdx = cRxShardFilters;
+    for (size_t i = 0u; i < cRxShardFilters; i++)
+    {
+      if (0u == mShardFilters[i].refCount)
+      {
+        freeIdx = (cRxShardFilters == freeIdx) ? i : freeIdx;
+      }
+      else if (0 == std::memcmp(mShardFilters[i].dmac, dmac, cIasAvbMacAddressLength))
+      {
+        mShardFilters[i].refCount++;
+        worker = 1u;
+        break;
+      }
+    }
+
+    if ((0u == worker) && (cRxShardFilters != freeIdx))
+    {
+      avb_safe_result copyresult = avb_safe_memcpy(mShardFilters[freeIdx].dmac, cIasAvbMacAddressLength,
+                                                   dmac, cIasAvbMacAddressLength);
+      (void) copyresult;
+      mShardFilters[freeIdx].refCount = 1u;
+      setShardFilter(freeIdx, true);
+      worker = 1u;
+    }
+  }
+#else
+  /*
+   * Must match the fanout program installed by joinFanoutGroup(): the kernel hands a frame to
+   * the group member with index (last DMAC byte % number of members).
+   */
+  worker = uint32_t(dmac[5]) % mNumWorkers;
+#endif /* DIRECT_RX_DMA */
+
+  return worker;
+}
+
+
+void IasAvbReceiveEngine::releaseWorker(const IasAvbStream &stream, uint32_t worker)
+{
+#if defined(DIRECT_RX_DMA)
+  if (1u == worker)
+  {
+    for (size_t i = 0u; i < cRxShardFilters; i++)
+    {
+      if ((0u != mShardFilters[i].refCount)
+          && (0 == std::memcmp(mShardFilters[i].dmac, stream.getDmac(), cIasAvbMacAddressLength)))
+      {
+        mShardFilters[i].refCount--;
+        if (0u == mShardFilters[i].refCount)
+        {
+          setShardFilter(i, false);
+        }
+        break;
+      }
+    }
+  }
+#else
+  // nothing reserved for socket based workers
+  (void) stream;
+  (void) worker;
+#endif /* DIRECT_RX_DMA */
+}
+
+
 IasAvbProcessingResult IasAvbReceiveEngine::connectAudioStreams(const IasAvbStreamId & avbStreamId, IasLocalAudioStream * localStream)
 {
   IasAvbProcessingResult result = eIasAvbProcInvalidParam;
@@ -710,22 +1200,80 @@ IasResult IasAvbReceiveEngine::beforeRun()
 }
 
 
-IasAvbProcessingResult IasAvbReceiveEngine::openReceiveSocket()
+IasAvbReceiveEngine::RxWorker::RxWorker()
+  : engine(NULL)
+  , index(0u)
+  , cpu(-1)
+  , thread(NULL)
+  , socket(-1)
+  , buffer(NULL)
+  , stats()
+  , readerEpoch(0u)
+  , timeouts()
+  , timeoutGeneration(0u)
+  , expiredStreams()
+  , burst()
+  , burstStream(NULL)
+  , burstSmac(NULL)
+  , readTable(NULL)
+  , bufferSlot(0u)
+#if !defined(DIRECT_RX_DMA)
+  , ring(NULL)
+  , ringBlockIndex(0u)
+  , epollFd(-1)
+  , timerFd(-1)
+  , realToLocal(0)
+#endif /* !DIRECT_RX_DMA */
 {
-  IasAvbProcessingResult result = eIasAvbProcOK;
+  // nothing to do
+}
 
-  struct sockaddr_ll recv_sa;
-  struct ifreq ifr;
-  int32_t ifindex;
-  typedef int Int; // avoid complaints about naked fundamental types
-  Int bufSize = 0u;
-  socklen_t argSize = sizeof bufSize;
-  const std::string* recvport = IasAvbStreamHandlerEnvironment::getNetworkInterfaceName();
 
-  DLT_LOG_CXX(*mLog, DLT_LOG_VERBOSE, LOG_PREFIX);
+IasAvbReceiveEngine::RxWorker::~RxWorker()
+{
+  // resources are owned by the engine
+}
 
-  // already opened or error querying network interface name
-  if ((-1 != mReceiveSocket) || (NULL == recvport))
+
+IasResult IasAvbReceiveEngine::RxWorker::beforeRun()
+{
+  // worker 0 resets mEndThread when starting, the other workers are started after it
+  return IasResult::cOk;
+}
+
+
+IasResult IasAvbReceiveEngine::RxWorker::run()
+{
+  AVB_ASSERT(NULL != engine);
+  return engine->runWorker(*this);
+}
+
+
+IasResult IasAvbReceiveEngine::RxWorker::shutDown()
+{
+  AVB_ASSERT(NULL != engine);
+  engine->mEndThread = true;
+  return IasResult::cOk;
+}
+
+
+IasResult IasAvbReceiveEngine::RxWorker::afterRun()
+{
+  return IasResult::cOk;
+}
+
+
+IasAvbProcessingResult IasAvbReceiveEngine::openReceiveSocket()
+{
+  IasAvbProcessingResult result = eIasAvbProcOK;
+
+  struct ifreq ifr;
+  const std::string* recvport = IasAvbStreamHandlerEnvironment::getNetworkInterfaceName();
+
+  DLT_LOG_CXX(*mLog, DLT_LOG_VERBOSE, LOG_PREFIX);
+
+  // already opened or error querying network interface name
+  if ((-1 != mWorkers[0].socket) || (NULL == recvport))
   {
     result = eIasAvbProcInitializationFailed;
   }
@@ -733,9 +1281,9 @@ IasAvbProcessingResult IasAvbReceiveEngine::openReceiveSocket()
   if (eIasAvbProcOK == result)
   {
     // open socket in raw mode
-    mReceiveSocket = socket(PF_PACKET, SOCK_RAW, htons(ETH_P_IEEE1722));
+    mWorkers[0].socket = socket(PF_PACKET, SOCK_RAW, htons(ETH_P_IEEE1722));
 
-    if (mReceiveSocket == -1)
+    if (mWorkers[0].socket == -1)
     {
       /**
        * @log Init failed: Raw receive socket could not be opened.
@@ -753,7 +1301,7 @@ IasAvbProcessingResult IasAvbReceiveEngine::openReceiveSocket()
     strncpy(ifr.ifr_name, recvport->c_str(), (sizeof ifr.ifr_name) - 1u);
     ifr.ifr_name[sizeof(ifr.ifr_name) - 1] = '\0';
 
-    if (ioctl(mReceiveSocket, SIOCGIFINDEX, &ifr) == -1)
+    if (ioctl(mWorkers[0].socket, SIOCGIFINDEX, &ifr) == -1)
     {
       /**
        * @log Init failed: Interface index not recognised.
@@ -764,131 +1312,931 @@ IasAvbProcessingResult IasAvbReceiveEngine::openReceiveSocket()
     }
     else
     {
-      ifindex = ifr.ifr_ifindex;
-      mRcvPortIfIndex = ifindex;
+      mRcvPortIfIndex = ifr.ifr_ifindex;
+    }
+  }
+
+  if (eIasAvbProcOK == result)
+  {
+    // Read flags from network interface...
+    strncpy(ifr.ifr_name, recvport->c_str(), (sizeof ifr.ifr_name) - 1u);
+    ifr.ifr_name[(sizeof ifr.ifr_name) - 1u] = '\0';
+
+    if (ioctl(mWorkers[0].socket, SIOCGIFFLAGS, &ifr) < 0)
+    {
+      /**
+       * @log Init failed: IOCTL could not read out the flags from the NIC.
+       */
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX,  "ioctl fails read out the current flags: ",
+          int32_t(errno), " (", strerror(errno), ")");
+      result = eIasAvbProcInitializationFailed;
+    }
+    else if ((ifr.ifr_flags & IFF_UP) == 0)
+    {
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "Warning: Interface ",
+          recvport->c_str(), " is down");
+    }
+    else if ((ifr.ifr_flags & IFF_RUNNING) == 0)
+    {
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "Warning: Interface ",
+          recvport->c_str(), "  is up, but not connected");
+    }
+    else
+    {
+      DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX, "flags: ",
+          ((ifr.ifr_flags & IFF_PROMISC) ? "PROMISC ON" : "PROMISC OFF"),
+          ((ifr.ifr_flags & IFF_MULTICAST) ? "MULTICAST ON" : "MULTICAST OFF"),
+          ((ifr.ifr_flags & IFF_ALLMULTI) ? "ALLMULTI ON" : "ALLMULTI OFF")
+          );
+    }
+  }
+
+  if (eIasAvbProcOK == result)
+  {
+    result = bindWorkerSocket(mWorkers[0]);
+  }
+
+#if !defined(DIRECT_RX_DMA)
+  // the additional workers get sockets of their own, sharing the traffic via the fanout group
+  for (uint32_t i = 1u; (eIasAvbProcOK == result) && (i < mNumWorkers); i++)
+  {
+    mWorkers[i].socket = socket(PF_PACKET, SOCK_RAW, htons(ETH_P_IEEE1722));
+    if (-1 == mWorkers[i].socket)
+    {
+      /**
+       * @log Init failed: Raw receive socket of a worker could not be opened.
+       */
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "failed to open socket of worker", i, ":",
+          int32_t(errno), " (", strerror(errno), ")");
+      result = eIasAvbProcInitializationFailed;
+    }
+    else
+    {
+      result = bindWorkerSocket(mWorkers[i]);
+    }
+  }
+#endif /* !DIRECT_RX_DMA */
+
+  if (eIasAvbProcOK != result)
+  {
+    closeSocket();
+  }
+
+  return result;
+}
+
+
+IasAvbProcessingResult IasAvbReceiveEngine::bindWorkerSocket(RxWorker &worker)
+{
+  IasAvbProcessingResult result = eIasAvbProcOK;
+
+  AVB_ASSERT(-1 != worker.socket);
+
+  struct sockaddr_ll recv_sa;
+  const std::string* recvport = IasAvbStreamHandlerEnvironment::getNetworkInterfaceName();
+  AVB_ASSERT(NULL != recvport);
+
+#if !defined(DIRECT_RX_DMA)
+  typedef int Int; // avoid complaints about naked fundamental types
+  Int bufSize = 0u;
+  socklen_t argSize = sizeof bufSize;
+
+  if (IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cRxSocketRxBufSize, bufSize))
+  {
+    // This is not needed for the direct RX mode and even worse it requires the cap_net_admin privilege.
+    if (setsockopt(worker.socket, SOL_SOCKET, SO_RCVBUFFORCE, &bufSize, sizeof bufSize) < 0)
+    {
+      /**
+       * @log Init failed: The receive buffer size could not be set.
+       */
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "failed to set RCV buffer size: ",
+          int32_t(errno), " (", strerror(errno), ")");
+      result = eIasAvbProcInitializationFailed;
+    }
+  }
+
+  if (eIasAvbProcOK == result)
+  {
+    if (getsockopt(worker.socket, SOL_SOCKET, SO_RCVBUF, &bufSize, &argSize) < 0)
+    {
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "warning: failed to read RCV buffer size: ",
+          int32_t(errno), " (", strerror(errno), ")");
+    }
+    else
+    {
+      DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX, "socket RCV buffer size is ",
+          (bufSize/2), " (", bufSize , "real)");
     }
   }
-
-  if (eIasAvbProcOK == result)
+
+  if ((eIasAvbProcOK == result) && mUseRxRing)
+  {
+    // set up the ring before binding so no frame ends up in the regular socket queue
+    result = setupReceiveRing(worker);
+  }
+
+  if ((eIasAvbProcOK == result) && mUseRxFilter)
+  {
+    // filter before binding, too, so foreign traffic never reaches the socket
+    updateReceiveFilter(mStreamTable.load(), &worker);
+  }
+
+  if ((eIasAvbProcOK == result) && (eRxTimestampOff != mTimestampMode))
+  {
+    setupTimestamping(worker);
+  }
+#endif /* !DIRECT_RX_DMA */
+
+  if (eIasAvbProcOK == result)
+  {
+    memset(&recv_sa, 0, sizeof recv_sa);
+    recv_sa.sll_family = AF_PACKET;
+    recv_sa.sll_ifindex = mRcvPortIfIndex;
+    recv_sa.sll_protocol = htons(ETH_P_IEEE1722);
+    recv_sa.sll_hatype = PACKET_MULTICAST;
+
+    if (bind(worker.socket, reinterpret_cast<sockaddr*>(&recv_sa), sizeof recv_sa) == -1)
+    {
+      /**
+       * @log Init failed: Unable to bind socket to the interface.
+       */
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "error binding socket to if",
+          int32_t(mRcvPortIfIndex), "(", recvport->c_str(), ":", strerror(errno), ")");
+      result = eIasAvbProcInitializationFailed;
+    }
+    else
+    {
+      DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX, "bound socket of worker", worker.index, "to if",
+          int32_t(mRcvPortIfIndex), "(", recvport->c_str(), ")");
+    }
+  }
+
+#if !defined(DIRECT_RX_DMA)
+  if ((eIasAvbProcOK == result) && (mNumWorkers > 1u))
+  {
+    result = joinFanoutGroup(worker);
+  }
+
+  if ((eIasAvbProcOK == result) && (eRxWakeupPoll != mWakeupMode))
+  {
+    result = setupWakeupEvents(worker);
+  }
+#endif /* !DIRECT_RX_DMA */
+
+  return result;
+}
+
+
+#if !defined(DIRECT_RX_DMA)
+IasAvbProcessingResult IasAvbReceiveEngine::joinFanoutGroup(RxWorker &worker)
+{
+  IasAvbProcessingResult result = eIasAvbProcOK;
+
+  /*
+   * PACKET_FANOUT_HASH is of no use here: the kernel's flow hash does not look into AVTP frames,
+   * so all streams would end up at the same worker. Instead a classic BPF program returns the last
+   * DMAC byte, which the kernel takes modulo the number of group members to select the socket.
+   * Members are indexed in the order they joined, which is the worker order. See selectWorker().
+   * Unlike a socket filter, the fanout program sees the frame from the network header on, so the
+   * DMAC has to be addressed relative to the link layer header.
+   */
+  struct sock_filter code[] =
+  {
+    BPF_STMT(BPF_LD | BPF_B | BPF_ABS, static_cast<uint32_t>(SKF_LL_OFF + 5)),   // A = dmac[5]
+    BPF_STMT(BPF_RET | BPF_A, 0u)                                                 // return A
+  };
+  struct sock_fprog prog;
+  prog.len = static_cast<uint16_t>(sizeof code / sizeof code[0]);
+  prog.filter = code;
+
+  if (0u == worker.index)
+  {
+    // unique per process, other processes may run fanout groups on the same interface
+    mFanoutGroupId = static_cast<uint16_t>(getpid());
+  }
+
+  typedef int Int; // avoid complaints about naked fundamental types
+  const Int fanoutArg = Int(mFanoutGroupId) | Int(PACKET_FANOUT_CBPF << 16);
+
+  if (setsockopt(worker.socket, SOL_PACKET, PACKET_FANOUT, &fanoutArg, sizeof fanoutArg) < 0)
+  {
+    /**
+     * @log Init failed: The worker socket could not join the fanout group.
+     */
+    DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "failed to join fanout group", mFanoutGroupId,
+        "with worker", worker.index, ":", int32_t(errno), " (", strerror(errno), ")");
+    result = eIasAvbProcInitializationFailed;
+  }
+  else if (setsockopt(worker.socket, SOL_PACKET, PACKET_FANOUT_DATA, &prog, sizeof prog) < 0)
+  {
+    /**
+     * @log Init failed: The fanout program could not be attached (kernel older than 4.2).
+     */
+    DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "failed to attach fanout program: ",
+        int32_t(errno), " (", strerror(errno), ")");
+    result = eIasAvbProcInitializationFailed;
+  }
+  else
+  {
+    DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX, "worker", worker.index, "joined fanout group", mFanoutGroupId);
+  }
+
+  return result;
+}
+
+
+IasAvbProcessingResult IasAvbReceiveEngine::setupReceiveRing(RxWorker &worker)
+{
+  IasAvbProcessingResult result = eIasAvbProcOK;
+
+  AVB_ASSERT(-1 != worker.socket);
+  AVB_ASSERT(NULL == worker.ring);
+
+  uint32_t blockTimeout = cRxRingBlockTimeoutDefault;
+  mRxRingBlockSize = cRxRingBlockSizeDefault;
+  mRxRingBlockCount = cRxRingBlockCountDefault;
+  worker.ringBlockIndex = 0u;
+  (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cRxSocketRingBlockSize, mRxRingBlockSize);
+  (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cRxSocketRingBlockCount, mRxRingBlockCount);
+  (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cRxSocketRingTimeout, blockTimeout);
+
+  const uint32_t pageSize = uint32_t(getpagesize());
+  if ((0u == mRxRingBlockCount) || (mRxRingBlockSize < cRxRingFrameSize) || (0u != (mRxRingBlockSize % pageSize)))
+  {
+    DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "invalid ring geometry: block size", mRxRingBlockSize,
+        "block count", mRxRingBlockCount, "page size", pageSize);
+    result = eIasAvbProcInvalidParam;
+  }
+
+  if (eIasAvbProcOK == result)
+  {
+    typedef int Int; // avoid complaints about naked fundamental types
+    Int version = TPACKET_V3;
+    if (setsockopt(worker.socket, SOL_PACKET, PACKET_VERSION, &version, sizeof version) < 0)
+    {
+      /**
+       * @log Init failed: The kernel does not support TPACKET_V3.
+       */
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "failed to select TPACKET_V3: ",
+          int32_t(errno), " (", strerror(errno), ")");
+      result = eIasAvbProcInitializationFailed;
+    }
+  }
+
+  if (eIasAvbProcOK == result)
+  {
+    struct tpacket_req3 req;
+    std::memset(&req, 0, sizeof req);
+    req.tp_block_size = mRxRingBlockSize;
+    req.tp_block_nr = mRxRingBlockCount;
+    req.tp_frame_size = cRxRingFrameSize;
+    req.tp_frame_nr = (mRxRingBlockSize / cRxRingFrameSize) * mRxRingBlockCount;
+    req.tp_retire_blk_tov = blockTimeout;
+
+    if (setsockopt(worker.socket, SOL_PACKET, PACKET_RX_RING, &req, sizeof req) < 0)
+    {
+      /**
+       * @log Init failed: The receive ring could not be allocated by the kernel.
+       */
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "failed to set up RX ring: ",
+          int32_t(errno), " (", strerror(errno), ")");
+      result = eIasAvbProcInitializationFailed;
+    }
+  }
+
+  if (eIasAvbProcOK == result)
+  {
+    void * const ring = mmap(NULL, size_t(mRxRingBlockSize) * mRxRingBlockCount, PROT_READ | PROT_WRITE,
+                             MAP_SHARED, worker.socket, 0);
+    if (MAP_FAILED == ring)
+    {
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "failed to map RX ring: ",
+          int32_t(errno), " (", strerror(errno), ")");
+      result = eIasAvbProcInitializationFailed;
+    }
+    else
+    {
+      worker.ring = static_cast<uint8_t*>(ring);
+      DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX, "RX ring mapped:", mRxRingBlockCount, "blocks of",
+          mRxRingBlockSize, "bytes, retire timeout", blockTimeout, "ms");
+    }
+  }
+
+  return result;
+}
+
+
+void IasAvbReceiveEngine::releaseReceiveRing(RxWorker &worker)
+{
+  if (NULL != worker.ring)
+  {
+    (void) munmap(worker.ring, size_t(mRxRingBlockSize) * mRxRingBlockCount);
+    worker.ring = NULL;
+  }
+  worker.ringBlockIndex = 0u;
+}
+
+
+uint32_t IasAvbReceiveEngine::receiveFromRing(RxWorker &worker, uint64_t now)
+{
+  uint32_t framesProcessed = 0u;
+
+  AVB_ASSERT(NULL != worker.ring);
+
+  for (uint32_t blocksVisited = 0u; (blocksVisited < mRxRingBlockCount) && !mEndThread; blocksVisited++)
+  {
+    struct tpacket_block_desc * const block =
+        reinterpret_cast<struct tpacket_block_desc*>(worker.ring + size_t(worker.ringBlockIndex) * mRxRingBlockSize);
+
+    if (0u == (block->hdr.bh1.block_status & TP_STATUS_USER))
+    {
+      // block still owned by the kernel, nothing more to do
+      break;
+    }
+
+    // make sure frame data is read after the block status
+    __sync_synchronize();
+
+    const uint32_t numPackets = block->hdr.bh1.num_pkts;
+    const uint8_t * frameHdr = reinterpret_cast<const uint8_t*>(block) + block->hdr.bh1.offset_to_first_pkt;
+    uint64_t rxTimeMin = std::numeric_limits<uint64_t>::max();
+    uint64_t rxTimeMax = 0u;
+    uint64_t rxTimeAcc = 0u;
+
+    for (uint32_t i = 0u; i < numPackets; i++)
+    {
+      const struct tpacket3_hdr * const hdr = reinterpret_cast<const struct tpacket3_hdr*>(frameHdr);
+
+      // the ring always carries a time stamp, the NIC one if PACKET_TIMESTAMP asked for it and it was available
+      const uint64_t rxTime = toLocalTime(worker, hdr->tp_sec, hdr->tp_nsec,
+          0u != (hdr->tp_status & TP_STATUS_TS_RAW_HARDWARE), now);
+
+      processFrame(worker, frameHdr + hdr->tp_mac, hdr->tp_snaplen, (eRxTimestampOff == mTimestampMode) ? now : rxTime);
+      framesProcessed++;
+
+      rxTimeMin = (rxTime < rxTimeMin) ? rxTime : rxTimeMin;
+      rxTimeMax = (rxTime > rxTimeMax) ? rxTime : rxTimeMax;
+      rxTimeAcc += rxTime;
+
+      frameHdr += hdr->tp_next_offset;
+    }
+
+    // the frames of the block must have been dispatched before it is handed back
+    flushBurst(worker);
+
+    if (0u != numPackets)
+    {
+      /*
+       * One clock read per block: the latency of each frame is measured up to the point where the
+       * whole block has been dispatched, i.e. it is an upper bound of the packet-to-dispatch time.
+       */
+      struct timespec tp;
+      (void) clock_gettime(CLOCK_REALTIME, &tp);
+      const uint64_t dispatchTime = toLocalTime(worker, uint64_t(tp.tv_sec), uint64_t(tp.tv_nsec), false, now);
+
+      if (dispatchTime >= rxTimeMax)
+      {
+        const uint64_t latencyMin = dispatchTime - rxTimeMax;
+        const uint64_t latencyMax = dispatchTime - rxTimeMin;
+        worker.stats.latencyMin = (latencyMin < worker.stats.latencyMin) ? latencyMin : worker.stats.latencyMin;
+        worker.stats.latencyMax = (latencyMax > worker.stats.latencyMax) ? latencyMax : worker.stats.latencyMax;
+        worker.stats.latencyAcc += uint64_t(numPackets) * dispatchTime - rxTimeAcc;
+        worker.stats.latencyCount += numPackets;
+        worker.stats.latencyAccTotal += uint64_t(numPackets) * dispatchTime - rxTimeAcc;
+        worker.stats.latencyCountTotal += numPackets;
+      }
+    }
+
+    // hand the block back to the kernel
+    __sync_synchronize();
+    block->hdr.bh1.block_status = TP_STATUS_KERNEL;
+
+    worker.ringBlockIndex = (worker.ringBlockIndex + 1u) % mRxRingBlockCount;
+  }
+
+  return framesProcessed;
+}
+
+
+void IasAvbReceiveEngine::runReplay(RxWorker &worker, uint64_t start, uint64_t idleWait)
+{
+  IasLibPtpDaemon* ptp = IasAvbStreamHandlerEnvironment::getPtpProxy();
+  AVB_ASSERT(NULL != ptp);
+  AVB_ASSERT(NULL != mPcapReplay);
+  IasWatchdog::IasWatchdogInterface * const watchdog = (0u == worker.index) ? mWatchdog : NULL;
+
+  struct timespec tp;
+  (void) clock_gettime(CLOCK_MONOTONIC, &tp);
+  const uint64_t wallStart = uint64_t(tp.tv_sec) * 1000000000u + uint64_t(tp.tv_nsec);
+
+  uint64_t now = start;
+  uint64_t firstTimestamp = 0u;
+  uint64_t nextTimeoutCheck = start;
+  bool first = true;
+  bool done = false;
+
+  while (!mEndThread)
+  {
+    if (!done)
+    {
+      // frames of a pending burst stay in their slots until it is dispatched, as with the socket
+      uint8_t * const frameBuffer = worker.buffer + size_t(worker.bufferSlot) * cReceiveBufferSize;
+      size_t length = 0u;
+      uint64_t timestamp = 0u;
+      const IasAvbProcessingResult result = mPcapReplay->readFrame(frameBuffer, cReceiveBufferSize, length, timestamp);
+
+      if (eIasAvbProcOK == result)
+      {
+        if (first)
+        {
+          firstTimestamp = timestamp;
+          first = false;
+        }
+
+        // out-of-order captures are replayed in file order
+        const uint64_t arrival = start + ((timestamp > firstTimestamp) ? (timestamp - firstTimestamp) : 0u);
+        now = (arrival > now) ? arrival : now;
+
+        if (mReplayRealtime)
+        {
+          uint64_t localNow = ptp->getLocalTime();
+          if (now > localNow)
+          {
+            flushBurst(worker);
+          }
+
+          while ((now > localNow) && !mEndThread)
+          {
+            // sleep in steps of idleWait at most so stop() is not delayed by gaps in the capture
+            const uint64_t wait = ((now - localNow) < idleWait) ? (now - localNow) : idleWait;
+            struct timespec req;
+            req.tv_sec = time_t(wait / 1000000000u);
+            req.tv_nsec = long(wait % 1000000000u);
+            (void) nanosleep(&req, NULL);
+            localNow = ptp->getLocalTime();
+          }
+        }
+
+        const uint64_t nextExpiry = worker.timeouts.getNextExpiry();
+        if ((now >= nextTimeoutCheck) || ((0u != nextExpiry) && (nextExpiry <= now)))
+        {
+          // the wheel is also refreshed once per tick in case the set of streams has changed
+          flushBurst(worker);
+          checkStreamTimeouts(worker, now, idleWait);
+          nextTimeoutCheck = now + mTimeoutTick;
+        }
+
+        processFrame(worker, frameBuffer, length, now);
+      }
+      else
+      {
+        flushBurst(worker);
+        done = true;
+
+        (void) clock_gettime(CLOCK_MONOTONIC, &tp);
+        const uint64_t wallTime = uint64_t(tp.tv_sec) * 1000000000u + uint64_t(tp.tv_nsec) - wallStart;
+        DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX, "replay finished:", mPcapReplay->getNumFrames(), "frames,",
+            now - start, "ns capture time replayed in", wallTime, "ns,",
+            (wallTime > 0u) ? double(mPcapReplay->getNumFrames()) * 1e9 / double(wallTime) : 0.0, "frames/s",
+            (eIasAvbProcOff == result) ? "" : "(capture truncated)");
+      }
+    }
+    else
+    {
+      // capture exhausted, the streams run into their timeouts on the replayed time line
+      struct timespec req;
+      req.tv_sec = time_t(idleWait / 1000000000u);
+      req.tv_nsec = long(idleWait % 1000000000u);
+      (void) nanosleep(&req, NULL);
+      now += idleWait;
+      checkStreamTimeouts(worker, now, idleWait);
+
+      if (watchdog)
+      {
+        if (!watchdog->isRegistered())
+        {
+          if (watchdog->registerWatchdog() != IasResult::cOk)
+          {
+            DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, " watchdog registration failure...");
+            mEndThread = true;
+          }
+        }
+        (void) watchdog->reset();
+      }
+    }
+  }
+
+  flushBurst(worker);
+}
+
+
+void IasAvbReceiveEngine::setupTimestamping(RxWorker &worker)
+{
+  typedef int Int; // avoid complaints about naked fundamental types
+  bool hardware = (eRxTimestampHardware == mTimestampMode);
+
+  if (hardware && (0u == worker.index))
+  {
+    // device setting, done once for all workers
+    const std::string* ifName = IasAvbStreamHandlerEnvironment::getNetworkInterfaceName();
+    AVB_ASSERT(NULL != ifName);
+    hardware = enableHwTimestamping(worker.socket, *ifName);
+  }
+
+  if (NULL != worker.ring)
+  {
+    /*
+     * The ring always carries the kernel software time stamp, PACKET_TIMESTAMP only makes it
+     * prefer the NIC time stamp, see TP_STATUS_TS_RAW_HARDWARE.
+     */
+    if (hardware)
+    {
+      Int flags = SOF_TIMESTAMPING_RAW_HARDWARE;
+      if (setsockopt(worker.socket, SOL_PACKET, PACKET_TIMESTAMP, &flags, sizeof flags) < 0)
+      {
+        DLT_LOG_CXX(*mLog, DLT_LOG_WARN, LOG_PREFIX, "failed to enable hardware time stamps on the ring:",
+            strerror(errno));
+      }
+    }
+  }
+  else
+  {
+    Int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    if (hardware)
+    {
+      flags |= SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+    }
+
+    if (setsockopt(worker.socket, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof flags) < 0)
+    {
+      // not fatal, the frames get the time of the wakeup then
+      DLT_LOG_CXX(*mLog, DLT_LOG_WARN, LOG_PREFIX, "failed to enable receive time stamps:", strerror(errno));
+    }
+  }
+}
+
+
+bool IasAvbReceiveEngine::enableHwTimestamping(int32_t fd, const std::string &ifName)
+{
+  bool ret = false;
+  struct ifreq ifr;
+  struct hwtstamp_config config;
+
+  memset(&ifr, 0, sizeof ifr);
+  memset(&config, 0, sizeof config);
+  strncpy(ifr.ifr_name, ifName.c_str(), IFNAMSIZ - 1);
+  ifr.ifr_data = reinterpret_cast<char*>(&config);
+
+  // keep the transmit setting, it might be used by others
+  if (ioctl(fd, SIOCGHWTSTAMP, &ifr) < 0)
+  {
+    config.tx_type = HWTSTAMP_TX_OFF;
+  }
+
+  if (HWTSTAMP_FILTER_ALL == config.rx_filter)
+  {
+    ret = true;
+  }
+  else
+  {
+    config.rx_filter = HWTSTAMP_FILTER_ALL;
+    if (ioctl(fd, SIOCSHWTSTAMP, &ifr) < 0)
+    {
+      DLT_LOG_CXX(*mLog, DLT_LOG_WARN, LOG_PREFIX, "hardware receive time stamps not available on",
+          ifName.c_str(), ":", strerror(errno), "using software time stamps");
+    }
+    else
+    {
+      // the driver may stamp more than requested, but not less
+      ret = (HWTSTAMP_FILTER_NONE != config.rx_filter);
+    }
+  }
+
+  DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX, "hardware receive time stamps:", ret ? "on" : "off");
+
+  return ret;
+}
+
+
+int32_t IasAvbReceiveEngine::receiveFrame(RxWorker &worker, uint8_t* buffer, uint64_t now, uint64_t &rxTime)
+{
+  int32_t ret = -1;
+
+  rxTime = now;
+
+  if (eRxTimestampOff == mTimestampMode)
+  {
+    ret = static_cast<int32_t>(recvfrom(worker.socket, buffer, cReceiveBufferSize, MSG_DONTWAIT, NULL, NULL));
+  }
+  else
+  {
+    union
+    {
+      struct cmsghdr align;
+      uint8_t        buf[CMSG_SPACE(sizeof(struct scm_timestamping))];
+    } control;
+    struct iovec iov;
+    struct msghdr msg;
+
+    iov.iov_base = buffer;
+    iov.iov_len = cReceiveBufferSize;
+    memset(&msg, 0, sizeof msg);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1u;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof control.buf;
+
+    ret = static_cast<int32_t>(recvmsg(worker.socket, &msg, MSG_DONTWAIT));
+
+    if (ret > 0)
+    {
+      for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); NULL != cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+      {
+        if ((SOL_SOCKET == cmsg->cmsg_level) && (SO_TIMESTAMPING == cmsg->cmsg_type))
+        {
+          struct scm_timestamping stamps;
+          memcpy(&stamps, CMSG_DATA(cmsg), sizeof stamps);
+
+          // ts[2] is the raw NIC time stamp, ts[0] the kernel one, either may be zero
+          const bool hardware = (0 != stamps.ts[2].tv_sec) || (0 != stamps.ts[2].tv_nsec);
+          const struct timespec &ts = hardware ? stamps.ts[2] : stamps.ts[0];
+          rxTime = toLocalTime(worker, uint64_t(ts.tv_sec), uint64_t(ts.tv_nsec), hardware, now);
+          break;
+        }
+      }
+    }
+  }
+
+  return ret;
+}
+
+
+IasAvbProcessingResult IasAvbReceiveEngine::setupWakeupEvents(RxWorker &worker)
+{
+  IasAvbProcessingResult result = eIasAvbProcOK;
+
+  worker.epollFd = epoll_create1(EPOLL_CLOEXEC);
+  worker.timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+  if ((worker.epollFd < 0) || (worker.timerFd < 0))
+  {
+    /**
+     * @log Init failed: Could not create the epoll instance or the timeout timer of a receive worker.
+     */
+    DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "failed to create wakeup events of worker", worker.index,
+        ":", strerror(errno));
+    result = eIasAvbProcInitializationFailed;
+  }
+  else
   {
-    // Read flags from network interface...
-    strncpy(ifr.ifr_name, recvport->c_str(), (sizeof ifr.ifr_name) - 1u);
-    ifr.ifr_name[(sizeof ifr.ifr_name) - 1u] = '\0';
+    struct epoll_event event;
+    memset(&event, 0, sizeof event);
+    event.events = EPOLLIN;
 
-    if (ioctl(mReceiveSocket, SIOCGIFFLAGS, &ifr) < 0)
+    event.data.fd = worker.socket;
+    if (epoll_ctl(worker.epollFd, EPOLL_CTL_ADD, worker.socket, &event) < 0)
     {
-      /**
-       * @log Init failed: IOCTL could not read out the flags from the NIC.
-       */
-      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX,  "ioctl fails read out the current flags: ",
-          int32_t(errno), " (", strerror(errno), ")");
       result = eIasAvbProcInitializationFailed;
     }
-    else if ((ifr.ifr_flags & IFF_UP) == 0)
-    {
-      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "Warning: Interface ",
-          recvport->c_str(), " is down");
-    }
-    else if ((ifr.ifr_flags & IFF_RUNNING) == 0)
+
+    event.data.fd = worker.timerFd;
+    if ((eIasAvbProcOK == result) && (epoll_ctl(worker.epollFd, EPOLL_CTL_ADD, worker.timerFd, &event) < 0))
     {
-      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "Warning: Interface ",
-          recvport->c_str(), "  is up, but not connected");
+      result = eIasAvbProcInitializationFailed;
     }
-    else
+
+    if (eIasAvbProcOK != result)
     {
-      DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX, "flags: ",
-          ((ifr.ifr_flags & IFF_PROMISC) ? "PROMISC ON" : "PROMISC OFF"),
-          ((ifr.ifr_flags & IFF_MULTICAST) ? "MULTICAST ON" : "MULTICAST OFF"),
-          ((ifr.ifr_flags & IFF_ALLMULTI) ? "ALLMULTI ON" : "ALLMULTI OFF")
-          );
+      /**
+       * @log Init failed: Could not register the socket or the timer of a receive worker with epoll.
+       */
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "epoll_ctl failed for worker", worker.index,
+          ":", strerror(errno));
     }
   }
 
-#if defined(DIRECT_RX_DMA)
-  (void) argSize;
-#else
-  if (eIasAvbProcOK == result)
+  if ((eIasAvbProcOK == result) && (eRxWakeupBusyPoll == mWakeupMode))
   {
-    if (IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cRxSocketRxBufSize, bufSize))
+    // the kernel spins on the device queue for up to mBusyPollTime us before putting the worker to sleep
+    int32_t busyPoll = static_cast<int32_t>(mBusyPollTime);
+    if (setsockopt(worker.socket, SOL_SOCKET, SO_BUSY_POLL, &busyPoll, sizeof busyPoll) < 0)
     {
-      // This is not needed for the direct RX mode and even worse it requires the cap_net_admin privilege.
-      if (setsockopt(mReceiveSocket, SOL_SOCKET, SO_RCVBUFFORCE, &bufSize, sizeof bufSize) < 0)
-      {
-        /**
-         * @log Init failed: The receive buffer size could not be set.
-         */
-        DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "failed to set RCV buffer size: ",
-            int32_t(errno), " (", strerror(errno), ")");
-        result = eIasAvbProcInitializationFailed;
-      }
+      // needs CAP_NET_ADMIN to raise the value, fall back to plain event mode
+      DLT_LOG_CXX(*mLog, DLT_LOG_WARN, LOG_PREFIX, "warning: failed to set SO_BUSY_POLL on socket of worker",
+          worker.index, ":", strerror(errno));
     }
   }
 
   if (eIasAvbProcOK == result)
   {
-    if (getsockopt(mReceiveSocket, SOL_SOCKET, SO_RCVBUF, &bufSize, &argSize) < 0)
+    DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX, "worker", worker.index, "uses event driven wakeups");
+  }
+
+  return result;
+}
+
+
+int32_t IasAvbReceiveEngine::waitForEvent(RxWorker &worker, uint64_t now, uint64_t idleWait)
+{
+  int32_t ret = 0;
+
+  // expire the due timeouts before computing the deadline, a deadline in the past would not block
+  uint64_t nextExpiry = worker.timeouts.getNextExpiry();
+  if ((0u != nextExpiry) && (nextExpiry <= now))
+  {
+    checkStreamTimeouts(worker, now, idleWait);
+    nextExpiry = worker.timeouts.getNextExpiry();
+  }
+
+  // earliest point in time at which one of the worker's streams times out
+  uint64_t deadline = now + idleWait;
+  if ((0u != nextExpiry) && (nextExpiry < deadline))
+  {
+    deadline = nextExpiry;
+  }
+
+  // nothing is due anymore, so sleep even if the wheel reports a deadline that has already passed
+  uint64_t waitTime = (deadline > now) ? (deadline - now) : 0u;
+  if (waitTime < cRxWaitMin)
+  {
+    waitTime = cRxWaitMin;
+  }
+
+  struct itimerspec timeout;
+  memset(&timeout, 0, sizeof timeout);
+  timeout.it_value.tv_sec = static_cast<time_t>(waitTime / 1000000000u);
+  timeout.it_value.tv_nsec = static_cast<long>(waitTime % 1000000000u);
+  (void) timerfd_settime(worker.timerFd, 0, &timeout, NULL);
+
+  struct epoll_event events[2];
+  const int32_t numEvents = epoll_wait(worker.epollFd, events, 2, -1);
+  worker.stats.syscallsTotal += 2u;
+  worker.stats.wakeups++;
+  worker.stats.wakeupsTotal++;
+
+  if (numEvents < 0)
+  {
+    // a signal is treated like a timeout, the caller re-evaluates the deadlines anyway
+    ret = (EINTR == errno) ? 0 : -1;
+  }
+
+  for (int32_t i = 0; i < numEvents; i++)
+  {
+    if (events[i].data.fd == worker.socket)
     {
-      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "warning: failed to read RCV buffer size: ",
-          int32_t(errno), " (", strerror(errno), ")");
+      ret = 1;
     }
     else
     {
-      DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX, "socket RCV buffer size is ",
-          (bufSize/2), " (", bufSize , "real)");
+      uint64_t expirations = 0u;
+      (void) read(worker.timerFd, &expirations, sizeof expirations);
     }
   }
-#endif
 
-  if (eIasAvbProcOK == result)
+  return ret;
+}
+
+
+void IasAvbReceiveEngine::buildReceiveFilter(const StreamTable * table, std::vector<struct sock_filter> &program) const
+{
+  const uint32_t cAccept = 0xFFFFFFFFu;   // pass the whole frame
+  const uint32_t cOffsetAvtp = ETH_HLEN;   // X holds the additional offset of a VLAN tag
+
+  /*
+   * The kernel usually strips the VLAN tag before the frame gets to the socket, but processFrame()
+   * accepts tagged frames, so the filter does as well.
+   */
+  struct sock_filter header[] =
   {
-    memset(&recv_sa, 0, sizeof recv_sa);
-    recv_sa.sll_family = AF_PACKET;
-    recv_sa.sll_ifindex = ifindex;
-    recv_sa.sll_protocol = htons(ETH_P_IEEE1722);
-    recv_sa.sll_hatype = PACKET_MULTICAST;
+    BPF_STMT(BPF_LD | BPF_H | BPF_ABS, ETH_HLEN - 2u),          // A = ethertype
+    BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, ETH_P_8021Q, 0u, 2u),
+    BPF_STMT(BPF_LDX | BPF_W | BPF_IMM, 4u),                    // X = size of the VLAN tag
+    BPF_JUMP(BPF_JMP | BPF_JA, 1u, 0u, 0u),
+    BPF_STMT(BPF_LDX | BPF_W | BPF_IMM, 0u),                    // X = 0
+    BPF_STMT(BPF_LD | BPF_B | BPF_IND, cOffsetAvtp + 1u),       // A = avtp[1]
+    BPF_JUMP(BPF_JMP | BPF_JSET | BPF_K, 0x80u, 1u, 0u),        // stream data (sv set)?
+    BPF_STMT(BPF_RET | BPF_K, 0u)
+  };
+  program.assign(header, header + (sizeof header / sizeof header[0]));
+
+  bool acceptAll = mIgnoreStreamId;
+  if ((NULL != table) && !acceptAll)
+  {
+    // 5 instructions per stream and the final drop
+    acceptAll = ((program.size() + (5u * table->streams.size()) + 1u) > cRxFilterMaxInstructions);
 
-    if (bind(mReceiveSocket, reinterpret_cast<sockaddr*>(&recv_sa), sizeof recv_sa) == -1)
-    {
-      /**
-       * @log Init failed: Unable to bind socket to the interface.
-       */
-      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "error binding socket to if",
-          int32_t(ifindex), "(", ifr.ifr_name, ":", strerror(errno), ")");
-      result = eIasAvbProcInitializationFailed;
-    }
-    else
+    const IasAvbMacAddress wildcardMac = {0u, 0u, 0u, 0u, 0u, 0u};
+    for (std::vector<StreamTable::Entry>::const_iterator it = table->slots.begin();
+         (table->slots.end() != it) && !acceptAll; it++)
     {
-      DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX, "bound socket to if",
-          int32_t(ifindex), "(", ifr.ifr_name, ")");
+      if (NULL == it->data)
+      {
+        // empty slot
+      }
+      else if (it->data != table->wildcard)
+      {
+        struct sock_filter match[] =
+        {
+          BPF_STMT(BPF_LD | BPF_W | BPF_IND, cOffsetAvtp + 4u),   // stream id, upper half
+          BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, uint32_t(it->streamId >> 32), 0u, 3u),
+          BPF_STMT(BPF_LD | BPF_W | BPF_IND, cOffsetAvtp + 8u),   // stream id, lower half
+          BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, uint32_t(it->streamId), 0u, 1u),
+          BPF_STMT(BPF_RET | BPF_K, cAccept)
+        };
+        program.insert(program.end(), match, match + (sizeof match / sizeof match[0]));
+      }
+      else
+      {
+        const uint8_t * const dmac = it->data->stream->getDmac();
+        if (0 == std::memcmp(dmac, wildcardMac, cIasAvbMacAddressLength))
+        {
+          // the wildcard stream takes any stream id on any DMAC
+          acceptAll = true;
+        }
+        else
+        {
+          struct sock_filter match[] =
+          {
+            BPF_STMT(BPF_LD | BPF_W | BPF_ABS, 0u),               // DMAC, first 4 bytes
+            BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K,
+                (uint32_t(dmac[0]) << 24) | (uint32_t(dmac[1]) << 16) | (uint32_t(dmac[2]) << 8) | uint32_t(dmac[3]), 0u, 3u),
+            BPF_STMT(BPF_LD | BPF_H | BPF_ABS, 4u),               // DMAC, last 2 bytes
+            BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, (uint32_t(dmac[4]) << 8) | uint32_t(dmac[5]), 0u, 1u),
+            BPF_STMT(BPF_RET | BPF_K, cAccept)
+          };
+          program.insert(program.end(), match, match + (sizeof match / sizeof match[0]));
+        }
+      }
     }
   }
 
-  if (eIasAvbProcOK != result)
+  if (acceptAll)
   {
-    closeSocket();
+    program.resize(sizeof header / sizeof header[0]);
+    program.push_back(BPF_STMT(BPF_RET | BPF_K, cAccept));
   }
+  else
+  {
+    program.push_back(BPF_STMT(BPF_RET | BPF_K, 0u));
+  }
+}
 
-  return result;
+
+void IasAvbReceiveEngine::updateReceiveFilter(const StreamTable * table, RxWorker * worker)
+{
+  std::vector<struct sock_filter> program;
+  buildReceiveFilter(table, program);
+
+  struct sock_fprog prog;
+  prog.len = static_cast<uint16_t>(program.size());
+  prog.filter = &program[0];
+
+  for (uint32_t i = 0u; i < mNumWorkers; i++)
+  {
+    RxWorker &current = mWorkers[i];
+    if (((NULL == worker) || (&current == worker)) && (-1 != current.socket))
+    {
+      // replaces the previous filter atomically
+      if (setsockopt(current.socket, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof prog) < 0)
+      {
+        // not fatal, the frames are still checked in processFrame()
+        DLT_LOG_CXX(*mLog, DLT_LOG_WARN, LOG_PREFIX, "warning: failed to attach receive filter to socket of worker",
+            i, ":", strerror(errno));
+      }
+      else
+      {
+        DLT_LOG_CXX(*mLog, DLT_LOG_DEBUG, LOG_PREFIX, "receive filter of worker", i, "updated:",
+            uint32_t(program.size()), "instructions");
+      }
+    }
+  }
 }
+#endif /* !DIRECT_RX_DMA */
 
 
 IasResult IasAvbReceiveEngine::run()
 {
-  IasAvbStreamId avbStreamId;
+  return runWorker(mWorkers[0]);
+}
+
+
+IasResult IasAvbReceiveEngine::runWorker(RxWorker &worker)
+{
   int32_t recv_length = 0;
-  uint32_t packetsReceived = 0u;
-  uint32_t packetsDispatched = 0u;
-  uint32_t packetsDiscarded = 0u;
-  uint32_t packetsValid = 0u;
   uint32_t cycles = 0u;
   uint64_t lastDebugOut = 0u;
-  int32_t timeDiffMin = std::numeric_limits<int32_t>::max();
-  int32_t timeDiffMax = std::numeric_limits<int32_t>::min();
-  int64_t timeDiffAcc = 0;
+  uint64_t syscallsLogged = 0u;
 
-  IasDiaLogger* diaLogger = IasAvbStreamHandlerEnvironment::getDiaLogger();
+  std::memset(&worker.stats, 0, sizeof worker.stats);
+  worker.stats.timeDiffMin = std::numeric_limits<int32_t>::max();
+  worker.stats.timeDiffMax = std::numeric_limits<int32_t>::min();
+  worker.stats.latencyMin = std::numeric_limits<uint64_t>::max();
 
-  DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX);
+  // the diagnostic counters and the watchdog are served by worker 0 only
+  IasDiaLogger* diaLogger = (0u == worker.index) ? IasAvbStreamHandlerEnvironment::getDiaLogger() : NULL;
+  IasWatchdog::IasWatchdogInterface * const watchdog = (0u == worker.index) ? mWatchdog : NULL;
+
+  DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX, "worker", worker.index);
 
   struct sched_param sparam;
   std::string policyStr = "fifo";
@@ -920,24 +2268,44 @@ IasResult IasAvbReceiveEngine::run()
     DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "Error setting scheduler parameter: ", strerror(errval));
   }
 
+  if (worker.cpu >= 0)
+  {
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(worker.cpu, &cpuSet);
+
+    errval = pthread_setaffinity_np(pthread_self(), sizeof cpuSet, &cpuSet);
+    if (0 == errval)
+    {
+      DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX, "worker", worker.index, "pinned to cpu", worker.cpu);
+    }
+    else
+    {
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "Error pinning worker", worker.index, "to cpu", worker.cpu,
+          ":", strerror(errval));
+    }
+  }
+
 #if defined(DIRECT_RX_DMA)
   IasAvbPacket* packet = NULL;
+  IasAvbPacket* burstPackets[cRxBurstMax]; // received packets kept until their burst has been dispatched
+  uint32_t burstCount = 0u;
+  uint8_t* receiveBuffer = NULL;
   uint32_t elapsedTimeNs = 0u; /* elapsed time (ns) without packet reception */
   uint32_t count = 0;
+  const RxQueueId queue = RxQueueId(worker.index);
 #else
   fd_set readSet;
   fd_set exceptSet;
   timeval selectWaitTime;
+  const bool pollMode = (eRxWakeupPoll == mWakeupMode);
+  uint64_t rxTime = 0u;
+  uint8_t* frameBuffer = NULL;
 #endif /* DIRECT_RX_DMA */
   int32_t selectResult;
-  IasAvbStreamId wildcardId(uint64_t(0u));
-  IasAvbMacAddress wildcardMac;
-  std::memset(wildcardMac, 0, cIasAvbMacAddressLength);
 
   uint32_t cycleWait = 2000000u; // ns
   uint32_t idleWait = 25000u; // 25ms, enough to deal with standard clock reference streams (50 PDU/s)
-  uint32_t discardAfter = 0u; // ns
-  bool doDiscardByPts;
 
   (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cRxCycleWait, cycleWait);
 #if defined(DIRECT_RX_DMA)
@@ -949,20 +2317,30 @@ IasResult IasAvbReceiveEngine::run()
     // config value is specified in ns
     idleWait /= 1000u;
   }
-  doDiscardByPts = IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cRxDiscardAfter, discardAfter);
-
   IasLibPtpDaemon* ptp = IasAvbStreamHandlerEnvironment::getPtpProxy();
   AVB_ASSERT(NULL != ptp);
   uint64_t now = ptp->getLocalTime();
-  uint64_t lastTimeoutCheck = now;  // This is used to perform an timeout check for individual streams
+  uint64_t lastTimeoutCheck = now;  // This is used to reset the watchdog while packets are being received
+
+  // the wheel is filled from the stream table on the first timeout check
+  (void) worker.timeouts.init(mTimeoutTick, now);
+  worker.timeoutGeneration = 0u;
+
+#if !defined(DIRECT_RX_DMA)
+  if (NULL != mPcapReplay)
+  {
+    // the capture replaces the socket as the source of frames, returns when the engine stops
+    runReplay(worker, now, uint64_t(idleWait) * 1000u);
+  }
+#endif /* !DIRECT_RX_DMA */
 
   while (!mEndThread)
   {
     while (!IasAvbStreamHandlerEnvironment::isLinkUp() && !mEndThread)
     {
       /* Don't monitor if the link is down */
-      if (mWatchdog && (mWatchdog->isRegistered()))
-        (void) mWatchdog->unregisterWatchdog();
+      if (watchdog && (watchdog->isRegistered()))
+        (void) watchdog->unregisterWatchdog();
 
       DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX, "waiting for network link...");
       ::sleep( 1u );
@@ -983,15 +2361,42 @@ IasResult IasAvbReceiveEngine::run()
       selectResult = 1u;
     }
 #else
-    FD_ZERO(&readSet);
-    FD_SET(mReceiveSocket, &readSet);
-    FD_ZERO(&exceptSet);
-    FD_SET(mReceiveSocket, &exceptSet);
+    if (pollMode)
+    {
+      FD_ZERO(&readSet);
+      FD_SET(worker.socket, &readSet);
+      FD_ZERO(&exceptSet);
+      FD_SET(worker.socket, &exceptSet);
+
+      // wake up in time for the next stream timeout
+      const uint64_t nextExpiry = worker.timeouts.getNextExpiry();
+      uint64_t waitTime = uint64_t(idleWait) * 1000u;
+      if ((0u != nextExpiry) && (nextExpiry < now + waitTime))
+      {
+        // a due timeout is handled after the wait, so don't let a deadline in the past turn this into a spin
+        waitTime = (nextExpiry > (now + cRxWaitMin)) ? (nextExpiry - now) : cRxWaitMin;
+      }
+
+      selectWaitTime.tv_sec = 0u;
+      selectWaitTime.tv_usec = static_cast<suseconds_t>(waitTime / 1000u);
 
-    selectWaitTime.tv_sec = 0u;
-    selectWaitTime.tv_usec = idleWait;
+      selectResult = select( FD_SETSIZE, &readSet, NULL, &exceptSet, &selectWaitTime );
+      worker.stats.syscallsTotal++;
+      worker.stats.wakeups++;
+      worker.stats.wakeupsTotal++;
+    }
+    else
+    {
+      selectResult = waitForEvent(worker, now, uint64_t(idleWait) * 1000u);
+    }
 
-    selectResult = select( FD_SETSIZE, &readSet, NULL, &exceptSet, &selectWaitTime );
+    // the stream timeouts are checked against the time after the wait
+    now = ptp->getLocalTime();
+    if (eRxTimestampOff != mTimestampMode)
+    {
+      // one clock pair per wakeup, the kernel time stamps of all frames of this batch are converted with it
+      updateClockOffset(worker, now);
+    }
 #endif /* DIRECT_RX_DMA */
 
     // should "now" be updated here rather than after the nanosleep?
@@ -999,25 +2404,20 @@ IasResult IasAvbReceiveEngine::run()
     if (0 == selectResult)
     {
       // general timeout, notify streams that no data has arrived
-      (void) lock();
-      for (AvbStreamMap::iterator it = mAvbStreams.begin(); mAvbStreams.end() != it; it++)
-      {
-        (void) dispatchPacket(it->second, NULL, 0u, now);
-      }
-      (void) unlock();
+      checkStreamTimeouts(worker, now, uint64_t(idleWait) * 1000u);
 
       /* Reset the timer even if we're idle waiting for packets */
-      if (mWatchdog)
+      if (watchdog)
       {
-        if(!mWatchdog->isRegistered())
+        if(!watchdog->isRegistered())
         {
-          if (mWatchdog->registerWatchdog() != IasResult::cOk)
+          if (watchdog->registerWatchdog() != IasResult::cOk)
           {
             DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, " watchdog registration failure...");
             mEndThread = true;
           }
         }
-	(void) mWatchdog->reset();
+	(void) watchdog->reset();
       }
     }
     else if (selectResult < 0)
@@ -1028,119 +2428,128 @@ IasResult IasAvbReceiveEngine::run()
     }
     else
     {
-      // If idleWait period is over check whether a timeout for a particular stream has occurred. */
+      // Check whether a timeout for a particular stream has occurred, only the expired streams are touched
+      checkStreamTimeouts(worker, now, uint64_t(idleWait) * 1000u);
+
       if (now - lastTimeoutCheck > (idleWait * 1000u))
       {
-        // Iterate over stream list and check for individual timeouts
-        (void) lock();
-        for (AvbStreamMap::iterator it = mAvbStreams.begin(); mAvbStreams.end() != it; it++)
-        {
-          // If the stream hasn't been serviced for idleWait period trigger stream state change notification
-          if (now - it->second.lastTimeDispatched > (idleWait * 1000u))
-          {
-            (void) dispatchPacket(it->second, NULL, 0u, now);
-          }
-        }
-        (void) unlock();
-        lastTimeoutCheck = now; // Memorize the time of the last timeout check
+        lastTimeoutCheck = now; // Memorize the time of the last watchdog check
 
         /* For a specific stream timeout, it should still be valid to reset the watchdog timer */
-        if (mWatchdog)
+        if (watchdog)
         {
-          if(!mWatchdog->isRegistered())
+          if(!watchdog->isRegistered())
           {
-            if (mWatchdog->registerWatchdog() != IasResult::cOk)
+            if (watchdog->registerWatchdog() != IasResult::cOk)
             {
               DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, " watchdog registration failure...");
               mEndThread = true;
             }
           }
-          (void) mWatchdog->reset();
+          (void) watchdog->reset();
         }
       }
       else
       {
-#if !DIRECT_RX_DMA
-        if (FD_ISSET(mReceiveSocket, &readSet))
+#if !defined(DIRECT_RX_DMA)
+        // waitForEvent() only reports data when the socket is readable
+        if (!pollMode || FD_ISSET(worker.socket, &readSet))
 #endif /* !DIRECT_RX_DMA */
         {
-          (void) lock(); // protect mAvbStreams
-
+          /*
+           * No locking here: stream lookup uses the table published by the control thread,
+           * see processFrame(). Workers only touch the streams they serve.
+           */
           for(;;)
           {
 #if defined(DIRECT_RX_DMA)
-            if (NULL != packet)
+            if (cRxBurstMax == burstCount)
             {
-              /* put back the used packet buffer */
-              if (igb_refresh_buffers(mIgbDevice, eRxQueue0, reinterpret_cast<struct igb_packet **>(&packet), 1u) == 0)
+              /* dispatch the full burst, then put back all its packet buffers at once */
+              flushBurst(worker);
+              if (igb_refresh_buffers(mIgbDevice, queue, reinterpret_cast<struct igb_packet **>(burstPackets), burstCount) == 0)
               {
-                packet = NULL;
+                burstCount = 0u;
+              }
+              else
+              {
+                /* no buffer left to receive into, try again with the next cycle */
+                break;
               }
             }
 
-            /* reset the variable */
+            /* reset the variables */
             recv_length = -1u;
+            packet = NULL;
 
-            if (NULL == packet)
-            {
 #if defined(DEBUG_LISTENER_UNCERTAINTY)
-              const uint64_t rxTstamp = ptp->getLocalTime();
-              const size_t rxTstampSz = sizeof(rxTstamp);
+            const uint64_t rxTstamp = ptp->getLocalTime();
+            const size_t rxTstampSz = sizeof(rxTstamp);
 #endif
-              /* try getting a received packet */
-              count = 1u;
-              if (igb_receive(mIgbDevice, eRxQueue0, reinterpret_cast<struct igb_packet **>(&packet), &count) == 0)
+            /* try getting a received packet */
+            count = 1u;
+            if (igb_receive(mIgbDevice, queue, reinterpret_cast<struct igb_packet **>(&packet), &count) == 0)
+            {
+              if (NULL != packet)
               {
-                if (NULL != packet)
-                {
-                  /* a packet is available */
-                  mReceiveBuffer = reinterpret_cast<uint8_t*>(packet->getBasePtr());
-                  recv_length = packet->len;
+                /* a packet is available, its buffer is handed back to the driver once its burst has been dispatched */
+                burstPackets[burstCount++] = packet;
+                receiveBuffer = reinterpret_cast<uint8_t*>(packet->getBasePtr());
+                recv_length = packet->len;
 
-                  /* reset the counter */
-                  elapsedTimeNs = 0u;
+                /* reset the counter */
+                elapsedTimeNs = 0u;
 
 #if defined(DEBUG_LISTENER_UNCERTAINTY)
-                  /* DO NOT ENABLE THESE LINES FOR PRODUCTION SW */
-                  if ((recv_length + rxTstampSz) <= cReceiveBufferSize)
-                  {
-                    /*
-                     * put the current time to the bottom of the receive buffer
-                     * assuming the received packet size is smaller than the buffer size of 2KB
-                     */
-                    uint64_t rxTstampBuf = uint64_t((mReceiveBuffer + recv_length + (rxTstampSz - 1u))) & ~(rxTstampSz - 1u);
-
-                    // insert the received timestamp to the buffer just after the payload
-                    *((uint64_t*)rxTstampBuf) = rxTstamp;
-                  }
-#endif
+                /* DO NOT ENABLE THESE LINES FOR PRODUCTION SW */
+                if ((recv_length + rxTstampSz) <= cReceiveBufferSize)
+                {
+                  /*
+                   * put the current time to the bottom of the receive buffer
+                   * assuming the received packet size is smaller than the buffer size of 2KB
+                   */
+                  uint64_t rxTstampBuf = uint64_t((receiveBuffer + recv_length + (rxTstampSz - 1u))) & ~(rxTstampSz - 1u);
+
+                  // insert the received timestamp to the buffer just after the payload
+                  *((uint64_t*)rxTstampBuf) = rxTstamp;
                 }
+#endif
               }
-              else
+            }
+            else
+            {
+              /*
+               * RCTL.RXEN bit could mistakenly be turned off as initializing i210's direct rx mode if some programs
+               * such as ifconfig or commnand concurrently access network interface on i210. This will drop all
+               * incoming packets. Root cause is synchronization problem between libigb (user-side) and igb_avb
+               * (kernel-side). As a workaround, monitor the bit if there is no incoming packet and enable it in case.
+               * (defect: 201518)
+               */
+              if (mRecoverIgbReceiver && (0u == worker.index))
               {
-                /*
-                 * RCTL.RXEN bit could mistakenly be turned off as initializing i210's direct rx mode if some programs
-                 * such as ifconfig or commnand concurrently access network interface on i210. This will drop all
-                 * incoming packets. Root cause is synchronization problem between libigb (user-side) and igb_avb
-                 * (kernel-side). As a workaround, monitor the bit if there is no incoming packet and enable it in case.
-                 * (defect: 201518)
-                 */
-                if (mRecoverIgbReceiver)
+                uint32_t rctlReg = 0u;
+                (void) igb_readreg(mIgbDevice, RCTL, &rctlReg);
+                if (!(rctlReg & RCTL_RXEN))
                 {
-                  uint32_t rctlReg = 0u;
-                  (void) igb_readreg(mIgbDevice, RCTL, &rctlReg);
-                  if (!(rctlReg & RCTL_RXEN))
-                  {
-                    rctlReg |= RCTL_RXEN;
-                    (void) igb_writereg(mIgbDevice, RCTL, rctlReg);
+                  rctlReg |= RCTL_RXEN;
+                  (void) igb_writereg(mIgbDevice, RCTL, rctlReg);
 
-                    DLT_LOG_CXX(*mLog, DLT_LOG_DEBUG, LOG_PREFIX, "Rx IGB Recovery: enabled RCTL.RXEN ( regval =", rctlReg, ")");
-                  }
+                  DLT_LOG_CXX(*mLog, DLT_LOG_DEBUG, LOG_PREFIX, "Rx IGB Recovery: enabled RCTL.RXEN ( regval =", rctlReg, ")");
                 }
               }
             }
 #else
-            recv_length = static_cast<int32_t>(recvfrom(mReceiveSocket, &mReceiveBuffer[0], cReceiveBufferSize, MSG_DONTWAIT, NULL, NULL ));
+            if (NULL != worker.ring)
+            {
+              // frames are processed in place, no further syscall needed until the next wakeup
+              (void) receiveFromRing(worker, now);
+              break;
+            }
+
+            // frames of a pending burst stay in their slots until it is dispatched
+            frameBuffer = worker.buffer + size_t(worker.bufferSlot) * cReceiveBufferSize;
+            recv_length = receiveFrame(worker, frameBuffer, now, rxTime);
+            worker.stats.syscallsTotal++;
 #endif /* DIRECT_RX_DMA */
             if (recv_length < 0)
             {
@@ -1149,193 +2558,22 @@ IasResult IasAvbReceiveEngine::run()
               {
                 // no new packets, just leave loop
               }
-              else
-              {
-                DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "recvfrom error: ", int32_t(err),
-                    " (", strerror(err), ")");
-                mEndThread = true;
-              }
-
-              break;
-            }
-            else if (recv_length > 0)
-            {
-              const uint16_t * ethType = reinterpret_cast<uint16_t*>(mReceiveBuffer + (ETH_HLEN - 2u));
-              if (*ethType == htons(ETH_P_8021Q))
-              {
-                ethType += 2u;
-              }
-
-              if (*ethType == htons(ETH_P_IEEE1722)) // valid AVTP packet detected
-              {
-                bool updateSmac = false;
-                packetsReceived++;
-                if (NULL != diaLogger)
-                {
-                  diaLogger->incRxCount();
-                }
-
-                const uint16_t* avtpBase16 = ethType + 1u;
-                const uint8_t* avtpBase8 = reinterpret_cast<const uint8_t*>(avtpBase16);
-                const uint32_t* avtpBase32 = reinterpret_cast<const uint32_t*>(avtpBase16);
-
-#if defined(PERFORMANCE_MEASUREMENT)
-                if (IasAvbStreamHandlerEnvironment::isAudioFlowLogEnabled()) // latency analysis
-                {
-                  uint32_t state = 0u;
-                  uint64_t logtime = 0u;
-                  (void) IasAvbStreamHandlerEnvironment::getAudioFlowLoggingState(state, logtime);
-
-                  uint64_t tscNow = ptp->getTsc();
-
-                  if ((0x02 == avtpBase8[0]) && // AAF
-                          ((0u == state) || (tscNow - logtime > (uint64_t)(1e9)))) // measurement is not ongoing or timed-out
-                  {
-                    uint16_t streamDataLen = ntohs(avtpBase16[10]);
-                    const uint32_t cBufSize = sizeof(uint16_t) * 64u;
-                    static uint8_t zeroBuf[cBufSize];
-                    if (0 != zeroBuf[0])
-                    {
-                      (void) std::memset(zeroBuf, 0, cBufSize);
-                    }
-
-                    if (streamDataLen > cBufSize)
-                    {
-                      streamDataLen = cBufSize;
-                    }
-
-                    if ((0 != avtpBase16[12]) ||
-                        (0 != std::memcmp(&avtpBase16[12], zeroBuf, streamDataLen)))
-                    {
-                      DLT_LOG_CXX(*mLog, DLT_LOG_WARN, LOG_PREFIX,
-                                  "latency-analysis(1): received samples from MAC system time =", tscNow);
-
-                      IasAvbStreamHandlerEnvironment::setAudioFlowLoggingState(1u, tscNow);
-                    }
-                  }
-                }
-#endif
-
-                avbStreamId.setStreamId(avtpBase8 + 4u);
-
-                bool dispatch = true;
-
-                if ((avtpBase8[1] & 0x80) == 0)
-                {
-                  // streamId invalid
-
-                  /* NOTE: The RX engine does only handle stream data. Any other
-                   * AVTPPDU has to be handled by other processes opening their
-                   * own raw sockets (such as MRPD).
-                   */
-                  dispatch = false;
-                }
-                else if (doDiscardByPts && (avtpBase8[1] & 0x01))
-                {
-                  // timestamp valid
-                  const int32_t delta = int32_t(now - ntohl(avtpBase32[3]));
-
-                  timeDiffMin = timeDiffMin < delta ? timeDiffMin : delta;
-                  timeDiffMax = timeDiffMax > delta ? timeDiffMax : delta;
-                  timeDiffAcc += delta;
-
-                  if (delta > int32_t(discardAfter))
-                  {
-                    dispatch = false;
-                    packetsDiscarded++;
-                  }
-                }
-                else
-                {
-                  // do nothing, dispatch is true already
-                }
-
-                if (dispatch)
-                {
-                  AvbStreamMap::iterator it = mAvbStreams.find(avbStreamId);
-
-                  if (mAvbStreams.end() == it)
-                  {
-                    // not found, look for wildcard
-                    it = mAvbStreams.find(wildcardId);
-
-                    /*
-                     * Extended wildcard semantics:
-                     * If stream has been found by wildcard, and wildcard stream has DMAC != 0,
-                     * and the DMAC matches, turn wildcard stream into regular stream by
-                     * setting the StreamId and replacing it in the lookup map.
-                     */
-
-                    if (mAvbStreams.end() != it)
-                    {
-                      StreamData data = it->second;
-                      AVB_ASSERT(NULL != data.stream);
-                      if (0 == std::memcmp(data.stream->getDmac(), mReceiveBuffer, cIasAvbMacAddressLength))
-                      {
-                        data.stream->changeStreamId(avbStreamId);
-                        mAvbStreams.erase(wildcardId);
-                        mAvbStreams[avbStreamId] = data;
-                        it = mAvbStreams.find(avbStreamId);
-                      }
-                      else if (0 == std::memcmp(data.stream->getDmac(), wildcardMac, cIasAvbMacAddressLength))
-                      {
-                        // just use the wildcard stream found
-                      }
-                      else
-                      {
-                        // no matching entry found
-                        it = mAvbStreams.end();
-                      }
-                    }
-                  }
-
-                  if (mIgnoreStreamId && (mAvbStreams.end() == it))
-                  {
-                    /*
-                     * still not found, "ignore mode" active, use first available stream
-                     * NOTE: For testing only, this should be used only under lab conditions!
-                     */
-
-                    it = mAvbStreams.begin();
-                  }
-
-                  if (mAvbStreams.end() != it)
-                  {
-                    packetsDispatched++;
-
-                    const uint8_t * sMac= mReceiveBuffer + 6u;
-                    IasAvbStream *stream = it->second.stream;
-                    AVB_ASSERT(NULL != stream);
-                    if (0 != std::memcmp(stream->getSmac(), sMac, cIasAvbMacAddressLength))
-                    {
-                      updateSmac = true;
-                    }
-
-                    if (dispatchPacket(it->second, avtpBase8, recv_length - (avtpBase8 - mReceiveBuffer), now))
-                    {
-                      if (updateSmac)
-                      {
-                        stream->setSmac(sMac);
-                      }
-                      packetsValid++;
-
-                      /* Finally, if the pkt was set successfully, we reset the watchdog timer */
-                      if (mWatchdog)
-                      {
-                        if (!mWatchdog->isRegistered())
-                        {
-                          if (mWatchdog->registerWatchdog() != IasResult::cOk)
-                          {
-                            DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, " watchdog registration failure...");
-                            mEndThread = true;
-                          }
-                        }
-                        (void) mWatchdog->reset();
-                      }
-                    }
-                  }
-                }
+              else
+              {
+                DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "recvfrom error: ", int32_t(err),
+                    " (", strerror(err), ")");
+                mEndThread = true;
               }
+
+              break;
+            }
+            else if (recv_length > 0)
+            {
+#if defined(DIRECT_RX_DMA)
+              processFrame(worker, receiveBuffer, size_t(recv_length), now);
+#else
+              processFrame(worker, frameBuffer, size_t(recv_length), rxTime);
+#endif /* DIRECT_RX_DMA */
             }
             else
             {
@@ -1343,12 +2581,25 @@ IasResult IasAvbReceiveEngine::run()
             }
           }
 
-          (void) unlock();
+          // dispatch what is left before going to sleep
+          flushBurst(worker);
+#if defined(DIRECT_RX_DMA)
+          if ((0u != burstCount) &&
+              (igb_refresh_buffers(mIgbDevice, queue, reinterpret_cast<struct igb_packet **>(burstPackets), burstCount) == 0))
+          {
+            burstCount = 0u;
+          }
+#endif /* DIRECT_RX_DMA */
         }
 
         cycles++;
 
+#if defined(DIRECT_RX_DMA)
         if (cycleWait != 0u)
+#else
+        // in event mode the next batch is picked up by the following wakeup, no need to sleep
+        if (pollMode && (cycleWait != 0u))
+#endif /* DIRECT_RX_DMA */
         {
           // sleep
           struct timespec req;
@@ -1360,41 +2611,62 @@ IasResult IasAvbReceiveEngine::run()
   #if defined(DIRECT_RX_DMA)
           /* increment the time-out counter */
           elapsedTimeNs += cycleWait; /* ns */
+  #else
+          worker.stats.wakeups++;
+          worker.stats.wakeupsTotal++;
   #endif
         }
       }
     }
 
+#if defined(DIRECT_RX_DMA)
     now = ptp->getLocalTime();
+#endif /* DIRECT_RX_DMA */
 
     if ((now - lastDebugOut) > 1000000000u)
     {
       lastDebugOut = now;
-      DLT_LOG_CXX(*mLog, DLT_LOG_DEBUG, LOG_PREFIX, packetsReceived,
+      DLT_LOG_CXX(*mLog, DLT_LOG_DEBUG, LOG_PREFIX, "worker", worker.index, ":", worker.stats.packetsReceived,
           " SAF packets received , ",
-          packetsDispatched, " dispatched, ",
-          packetsValid, " valid, ",
-          packetsDiscarded, " discarded, ",
+          worker.stats.packetsDispatched, " dispatched, ",
+          worker.stats.packetsValid, " valid, ",
+          worker.stats.packetsDiscarded, " discarded, ",
           cycles, " cycles, ",
-          (cycles > 0) ? float(packetsReceived)/float(cycles) : float(0), " pkt/cycle"
+          (cycles > 0) ? float(worker.stats.packetsReceived)/float(cycles) : float(0), " pkt/cycle, ",
+          (worker.stats.packetsReceived > 0) ? float(worker.stats.syscallsTotal - syscallsLogged)/float(worker.stats.packetsReceived) : float(0), " syscalls/pkt, ",
+          worker.stats.framesMisrouted, " misrouted total"
+          );
+#if !defined(DIRECT_RX_DMA)
+      DLT_LOG_CXX(*mLog, DLT_LOG_DEBUG, LOG_PREFIX, "worker", worker.index, ":", worker.stats.wakeups,
+          " wakeups/s, dispatch latency ",
+          (worker.stats.latencyCount > 0u) ? worker.stats.latencyMin : 0u, " min, ",
+          (worker.stats.latencyCount > 0u) ? worker.stats.latencyAcc / worker.stats.latencyCount : 0u, " avg, ",
+          worker.stats.latencyMax, " max (ns)"
           );
-      packetsDispatched = 0u;
-      packetsValid = 0u;
-      packetsDiscarded = 0u;
+      worker.stats.wakeups = 0u;
+      worker.stats.latencyMin = std::numeric_limits<uint64_t>::max();
+      worker.stats.latencyMax = 0u;
+      worker.stats.latencyAcc = 0u;
+      worker.stats.latencyCount = 0u;
+#endif /* !DIRECT_RX_DMA */
+      syscallsLogged = worker.stats.syscallsTotal;
+      worker.stats.packetsDispatched = 0u;
+      worker.stats.packetsValid = 0u;
+      worker.stats.packetsDiscarded = 0u;
       cycles = 0u;
 
-      if (doDiscardByPts)
+      if (mDiscardByPts)
       {
         DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX, "presentation time delta: ",
-            timeDiffMin, " min, ",
-            timeDiffMax, " max, ",
-            (packetsReceived > 0) ? float(timeDiffAcc) / float(packetsReceived) : float(0), " avg/"
+            worker.stats.timeDiffMin, " min, ",
+            worker.stats.timeDiffMax, " max, ",
+            (worker.stats.packetsReceived > 0) ? float(worker.stats.timeDiffAcc) / float(worker.stats.packetsReceived) : float(0), " avg/"
             );
-        timeDiffMin = std::numeric_limits<int32_t>::max();
-        timeDiffMax = std::numeric_limits<int32_t>::min();
-        timeDiffAcc = 0;
+        worker.stats.timeDiffMin = std::numeric_limits<int32_t>::max();
+        worker.stats.timeDiffMax = std::numeric_limits<int32_t>::min();
+        worker.stats.timeDiffAcc = 0;
       }
-      packetsReceived = 0u;
+      worker.stats.packetsReceived = 0u;
 
       if (NULL != diaLogger)
       {
@@ -1404,13 +2676,208 @@ IasResult IasAvbReceiveEngine::run()
   }
 
   /* Unregister the watchdog on thread exit */
-  if (mWatchdog && mWatchdog->isRegistered())
-    mWatchdog->unregisterWatchdog();
+  if (mWatchdog && watchdog->isRegistered())
+    watchdog->unregisterWatchdog();
 
   return IasResult::cOk;
 }
 
 
+void IasAvbReceiveEngine::processFrame(RxWorker &worker, const uint8_t* frame, size_t length, uint64_t now)
+{
+  AVB_ASSERT(NULL != frame);
+
+  IasAvbStreamId avbStreamId;
+  IasAvbMacAddress wildcardMac;
+  std::memset(wildcardMac, 0, cIasAvbMacAddressLength);
+  IasDiaLogger* const diaLogger = (0u == worker.index) ? IasAvbStreamHandlerEnvironment::getDiaLogger() : NULL;
+
+  worker.stats.framesTotal++;
+
+  if (NULL != mPcapRecord)
+  {
+    (void) mPcapRecord->record(worker.index, frame, length, now);
+  }
+
+  const uint16_t * ethType = reinterpret_cast<const uint16_t*>(frame + (ETH_HLEN - 2u));
+  if (*ethType == htons(ETH_P_8021Q))
+  {
+    ethType += 2u;
+  }
+
+  if (*ethType == htons(ETH_P_IEEE1722)) // valid AVTP packet detected
+  {
+    worker.stats.packetsReceived++;
+    if (NULL != diaLogger)
+    {
+      diaLogger->incRxCount();
+    }
+
+    const uint16_t* avtpBase16 = ethType + 1u;
+    const uint8_t* avtpBase8 = reinterpret_cast<const uint8_t*>(avtpBase16);
+    const uint32_t* avtpBase32 = reinterpret_cast<const uint32_t*>(avtpBase16);
+
+#if defined(PERFORMANCE_MEASUREMENT)
+    if (IasAvbStreamHandlerEnvironment::isAudioFlowLogEnabled()) // latency analysis
+    {
+      uint32_t state = 0u;
+      uint64_t logtime = 0u;
+      (void) IasAvbStreamHandlerEnvironment::getAudioFlowLoggingState(state, logtime);
+
+      uint64_t tscNow = IasAvbStreamHandlerEnvironment::getPtpProxy()->getTsc();
+
+      if ((0x02 == avtpBase8[0]) && // AAF
+              ((0u == state) || (tscNow - logtime > (uint64_t)(1e9)))) // measurement is not ongoing or timed-out
+      {
+        uint16_t streamDataLen = ntohs(avtpBase16[10]);
+        const uint32_t cBufSize = sizeof(uint16_t) * 64u;
+        static uint8_t zeroBuf[cBufSize];
+        if (0 != zeroBuf[0])
+        {
+          (void) std::memset(zeroBuf, 0, cBufSize);
+        }
+
+        if (streamDataLen > cBufSize)
+        {
+          streamDataLen = cBufSize;
+        }
+
+        if ((0 != avtpBase16[12]) ||
+            (0 != std::memcmp(&avtpBase16[12], zeroBuf, streamDataLen)))
+        {
+          DLT_LOG_CXX(*mLog, DLT_LOG_WARN, LOG_PREFIX,
+                      "latency-analysis(1): received samples from MAC system time =", tscNow);
+
+          IasAvbStreamHandlerEnvironment::setAudioFlowLoggingState(1u, tscNow);
+        }
+      }
+    }
+#endif
+
+    avbStreamId.setStreamId(avtpBase8 + 4u);
+
+    bool dispatch = true;
+
+    if ((avtpBase8[1] & 0x80) == 0)
+    {
+      // streamId invalid
+
+      /* NOTE: The RX engine does only handle stream data. Any other
+       * AVTPPDU has to be handled by other processes opening their
+       * own raw sockets (such as MRPD).
+       */
+      dispatch = false;
+    }
+    else if (mDiscardByPts && (avtpBase8[1] & 0x01))
+    {
+      // timestamp valid
+      const int32_t delta = int32_t(now - ntohl(avtpBase32[3]));
+
+      worker.stats.timeDiffMin = worker.stats.timeDiffMin < delta ? worker.stats.timeDiffMin : delta;
+      worker.stats.timeDiffMax = worker.stats.timeDiffMax > delta ? worker.stats.timeDiffMax : delta;
+      worker.stats.timeDiffAcc += delta;
+
+      if (delta > int32_t(mDiscardAfter))
+      {
+        dispatch = false;
+        worker.stats.packetsDiscarded++;
+      }
+    }
+    else
+    {
+      // do nothing, dispatch is true already
+    }
+
+    if (dispatch)
+    {
+      // a pending burst keeps the read section open, its stream entry must not go away
+      if (NULL == worker.readTable)
+      {
+        worker.readTable = enterReadSection(worker);
+      }
+      const StreamTable * table = worker.readTable;
+      StreamData * streamData = NULL;
+
+      if (NULL != table)
+      {
+        streamData = findStream(*table, uint64_t(avbStreamId));
+
+        if ((NULL == streamData) && (NULL != table->wildcard))
+        {
+          // not found, look for wildcard
+          StreamData * const wildcard = table->wildcard;
+          AVB_ASSERT(NULL != wildcard->stream);
+
+          /*
+           * Extended wildcard semantics:
+           * If stream has been found by wildcard, and wildcard stream has DMAC != 0,
+           * and the DMAC matches, turn wildcard stream into regular stream by
+           * setting the StreamId and replacing it in the lookup map.
+           */
+          if (0 == std::memcmp(wildcard->stream->getDmac(), frame, cIasAvbMacAddressLength))
+          {
+            streamData = wildcard;
+
+            /*
+             * Re-keying modifies mAvbStreams and has to wait for the workers to release the
+             * current table, which must never happen on the receive path. Leave it to the control
+             * thread, which carries it out the next time it takes the lock, see rekeyWildcard().
+             * Until then, the packets are served through the wildcard entry.
+             */
+            if ((worker.index == wildcard->worker) && (0u == mRekeyStreamId.load(std::memory_order_relaxed)))
+            {
+              mRekeyStreamId.store(uint64_t(avbStreamId), std::memory_order_relaxed);
+            }
+          }
+          else if (0 == std::memcmp(wildcard->stream->getDmac(), wildcardMac, cIasAvbMacAddressLength))
+          {
+            // just use the wildcard stream found
+            streamData = wildcard;
+          }
+          else
+          {
+            // no matching entry found
+          }
+        }
+
+        if (mIgnoreStreamId && (NULL == streamData) && (NULL != table) && !table->streams.empty())
+        {
+          /*
+           * still not found, "ignore mode" active, use first available stream
+           * NOTE: For testing only, this should be used only under lab conditions!
+           */
+
+          streamData = table->streams.front();
+        }
+      }
+
+      if ((NULL != streamData) && (worker.index != streamData->worker))
+      {
+        /*
+         * Each stream is served by a single worker. Only happens for streams not selected
+         * by their DMAC (wildcard with zero DMAC, "ignore mode"), or while a worker socket
+         * is joining the fanout group.
+         */
+        worker.stats.framesMisrouted++;
+        streamData = NULL;
+      }
+
+      if (NULL != streamData)
+      {
+        worker.stats.packetsDispatched++;
+        queuePacket(worker, *streamData, avtpBase8, length - size_t(avtpBase8 - frame), frame + 6u, now);
+      }
+
+      if (worker.burst.empty())
+      {
+        leaveReadSection(worker);
+        worker.readTable = NULL;
+      }
+    }
+  }
+}
+
+
 bool IasAvbReceiveEngine::dispatchPacket(StreamData &streamData, const void* packet, size_t length, uint64_t now)
 {
   IasAvbStream* stream = streamData.stream;
@@ -1426,14 +2893,152 @@ bool IasAvbReceiveEngine::dispatchPacket(StreamData &streamData, const void* pac
 }
 
 
+void IasAvbReceiveEngine::queuePacket(RxWorker &worker, StreamData &streamData, const void* packet, size_t length,
+                                      const uint8_t* smac, uint64_t now)
+{
+  if (&streamData != worker.burstStream)
+  {
+    dispatchBurst(worker);
+    worker.burstStream = &streamData;
+  }
+
+  IasAvbStream::RxPacket rxPacket;
+  rxPacket.packet = packet;
+  rxPacket.length = length;
+  rxPacket.now = now;
+  worker.burst.push_back(rxPacket);
+  worker.burstSmac = smac;
+
+  // the frame occupies its receive buffer slot until the burst has been dispatched
+  worker.bufferSlot = (worker.bufferSlot + 1u) % cRxBurstMax;
+
+  if (worker.burst.size() >= cRxBurstMax)
+  {
+    dispatchBurst(worker);
+  }
+}
+
+
+void IasAvbReceiveEngine::dispatchBurst(RxWorker &worker)
+{
+  if (!worker.burst.empty())
+  {
+    StreamData &streamData = *worker.burstStream;
+    IasAvbStream* stream = streamData.stream;
+    AVB_ASSERT(NULL != stream);
+    IasWatchdog::IasWatchdogInterface * const watchdog = (0u == worker.index) ? mWatchdog : NULL;
+
+    (void) checkStreamState(streamData);
+
+    // one clock read per burst, the packets of a burst are handed over together
+    IasLibPtpDaemon* ptp = IasAvbStreamHandlerEnvironment::getPtpProxy();
+    if (NULL != ptp)
+    {
+      const uint64_t dispatchTime = ptp->getLocalTime();
+      for (std::vector<IasAvbStream::RxPacket>::const_iterator it = worker.burst.begin(); it != worker.burst.end(); ++it)
+      {
+        stream->recordDispatchLatency(int64_t(dispatchTime - it->now));
+      }
+    }
+
+    // @@DIAG EARLY/LATE_TIMESTAMP
+    stream->dispatchPackets(&worker.burst[0], worker.burst.size());
+    streamData.lastTimeDispatched = worker.burst.back().now;  // Memorize the time when the stream has been dispatched
+
+    if (checkStreamState(streamData))
+    {
+      if (0 != std::memcmp(stream->getSmac(), worker.burstSmac, cIasAvbMacAddressLength))
+      {
+        stream->setSmac(worker.burstSmac);
+      }
+      worker.stats.packetsValid += uint32_t(worker.burst.size());
+
+      /* Finally, if the pkts were set successfully, we reset the watchdog timer */
+      if (watchdog)
+      {
+        if (!watchdog->isRegistered())
+        {
+          if (watchdog->registerWatchdog() != IasResult::cOk)
+          {
+            DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, " watchdog registration failure...");
+            mEndThread = true;
+          }
+        }
+        (void) watchdog->reset();
+      }
+    }
+
+    worker.burst.clear();
+  }
+  worker.burstStream = NULL;
+}
+
+
+void IasAvbReceiveEngine::flushBurst(RxWorker &worker)
+{
+  dispatchBurst(worker);
+
+  if (NULL != worker.readTable)
+  {
+    leaveReadSection(worker);
+    worker.readTable = NULL;
+  }
+}
+
+
+void IasAvbReceiveEngine::checkStreamTimeouts(RxWorker &worker, uint64_t now, uint64_t idleWait)
+{
+  const StreamTable * const table = enterReadSection(worker);
+  if (NULL != table)
+  {
+    if (table->generation != worker.timeoutGeneration)
+    {
+      // the set of streams has changed, track the streams of the new table
+      worker.timeouts.clear();
+      for (std::vector<StreamTable::Entry>::const_iterator it = table->slots.begin(); table->slots.end() != it; it++)
+      {
+        if ((NULL != it->data) && (worker.index == it->data->worker))
+        {
+          worker.timeouts.add(it->streamId, it->data->lastTimeDispatched + idleWait);
+        }
+      }
+      worker.timeoutGeneration = table->generation;
+    }
+
+    worker.expiredStreams.clear();
+    (void) worker.timeouts.advance(now, worker.expiredStreams);
+
+    for (std::vector<uint64_t>::const_iterator it = worker.expiredStreams.begin(); worker.expiredStreams.end() != it; it++)
+    {
+      StreamData * const data = findStream(*table, *it);
+      AVB_ASSERT(NULL != data);
+      if (NULL != data)
+      {
+        // If the stream hasn't been serviced for idleWait period trigger stream state change notification
+        if (now - data->lastTimeDispatched >= idleWait)
+        {
+          (void) dispatchPacket(*data, NULL, 0u, now);
+        }
+
+        // streams that received data in the meantime are re-armed without being touched on every packet
+        worker.timeouts.add(*it, data->lastTimeDispatched + idleWait);
+      }
+    }
+  }
+  leaveReadSection(worker);
+}
+
+
 bool IasAvbReceiveEngine::checkStreamState(StreamData &streamData)
 {
   AVB_ASSERT(NULL != streamData.stream);
   const IasAvbStream* stream = streamData.stream;
   IasAvbStreamState newState = stream->getStreamState();
 
+  // lastState is only written by the worker serving the stream, so reading it unlocked here is safe
   if (streamData.lastState != newState)
   {
+    std::lock_guard<std::mutex> guard(mStatusLock);
     uint64_t streamId = stream->getStreamId();
     std::stringstream ssStreamId;
     ssStreamId << "0x" << std::hex << streamId;
@@ -1456,18 +3061,37 @@ bool IasAvbReceiveEngine::checkStreamState(StreamData &streamData)
  */
 void IasAvbReceiveEngine::cleanup()
 {
-  if (mReceiveThread != NULL && mReceiveThread->isRunning())
-  {
-    mReceiveThread->stop();
-  }
+  (void) stopWorkers();
 
   delete mReceiveThread;
   mReceiveThread = NULL;
 
+  for (uint32_t i = 0u; i < cRxWorkersMax; i++)
+  {
+    delete mWorkers[i].thread;
+    mWorkers[i].thread = NULL;
+#if !defined(DIRECT_RX_DMA)
+    delete[] mWorkers[i].buffer;
+    mWorkers[i].buffer = NULL;
+#endif /* !DIRECT_RX_DMA */
+  }
+
 #if !defined(DIRECT_RX_DMA)
-  delete[] mReceiveBuffer;
-  mReceiveBuffer = NULL;
+  delete mPcapReplay;
+  mPcapReplay = NULL;
 #endif /* !DIRECT_RX_DMA */
+  if (NULL != mPcapRecord)
+  {
+    // writes the frames still queued
+    mPcapRecord->cleanup();
+    DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX, "recorded", mPcapRecord->getNumFrames(), "frames,",
+        mPcapRecord->getNumDropped(), "dropped");
+    delete mPcapRecord;
+    mPcapRecord = NULL;
+  }
+
+  // the worker threads are gone, no need to wait for them
+  delete mStreamTable.exchange(NULL);
 
   if (mWatchdog)
   {
@@ -1498,6 +3122,9 @@ void IasAvbReceiveEngine::cleanup()
     delete s;
   }
   mAvbStreams.clear();
+#if defined(DIRECT_RX_DMA)
+  std::memset(mShardFilters, 0, sizeof mShardFilters);
+#endif /* DIRECT_RX_DMA */
 
   (void) closeSocket();
 
@@ -1506,6 +3133,31 @@ void IasAvbReceiveEngine::cleanup()
 #endif /* DIRECT_RX_DMA */
 }
 
+bool IasAvbReceiveEngine::getStreamLatency(const IasAvbStreamId &id, IasAvbLatencyHistogram &presentationLatency,
+                                           IasAvbLatencyHistogram &dispatchLatency, bool reset)
+{
+  bool found = false;
+
+  lock();
+  AvbStreamMap::iterator it = mAvbStreams.find(id);
+  if (mAvbStreams.end() != it)
+  {
+    IasAvbStream *stream = it->second.stream;
+    AVB_ASSERT(NULL != stream);
+    // the receive worker serving the stream keeps recording
+    stream->getPresentationLatency().snapshot(presentationLatency);
+    stream->getDispatchLatency().snapshot(dispatchLatency);
+    if (reset)
+    {
+      stream->resetLatency();
+    }
+    found = true;
+  }
+  unlock();
+
+  return found;
+}
+
 bool IasAvbReceiveEngine::getAvbStreamInfo(const IasAvbStreamId &id,
                                            AudioStreamInfoList &audioStreamInfo,
                                            VideoStreamInfoList &videoStreamInfo,
@@ -1528,7 +3180,7 @@ bool IasAvbReceiveEngine::getAvbStreamInfo(const IasAvbStreamId &id,
         IasAvbAudioStream *audioStream = static_cast<IasAvbAudioStream *>(stream);
         IasAvbAudioStreamAttributes att;
         att.setStreamId(it->first);
-        att.setRxStatus(it->second.lastState);
+        att.setRxStatus(getLastState(it->second));
         att.setDirection(stream->getDirection());
 
         const IasAvbMacAddress &smac_array = audioStream->getSmac();
@@ -1575,7 +3227,7 @@ bool IasAvbReceiveEngine::getAvbStreamInfo(const IasAvbStreamId &id,
         IasAvbVideoStream *videoStream = static_cast<IasAvbVideoStream *>(stream);
         IasAvbVideoStreamAttributes att;
         att.setStreamId(it->first);
-        att.setRxStatus(it->second.lastState);
+        att.setRxStatus(getLastState(it->second));
         att.setDirection(stream->getDirection());
 
         const IasAvbMacAddress &smac_array = videoStream->getSmac();
@@ -1654,7 +3306,7 @@ bool IasAvbReceiveEngine::getAvbStreamInfo(const IasAvbStreamId &id,
         att.setDmac(dmac);
         att.setSourceMac(smac);
 
-        att.setRxStatus(it->second.lastState);
+        att.setRxStatus(getLastState(it->second));
 
         att.setAssignMode(IasAvbIdAssignMode::eIasAvbIdAssignModeStatic);
         att.setPreconfigured(preConfigured);
@@ -1715,7 +3367,10 @@ IasAvbProcessingResult IasAvbReceiveEngine::startIgbReceiveEngine()
       }
       else
       {
-        result = mRcvPacketPool->init(cReceiveBufferSize, cReceivePoolSize);
+        // each worker polls a receive queue of its own
+        const uint32_t poolSize = uint32_t(cReceivePoolSize) * mNumWorkers;
+
+        result = mRcvPacketPool->init(cReceiveBufferSize, poolSize);
         if (eIasAvbProcOK != result)
         {
           DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "failed to initialize packet pool",
@@ -1725,7 +3380,8 @@ IasAvbProcessingResult IasAvbReceiveEngine::startIgbReceiveEngine()
         {
           while ((packet = mRcvPacketPool->getPacket()) != NULL)
           {
-            if (igb_refresh_buffers(mIgbDevice, eRxQueue0, reinterpret_cast<igb_packet**>(&packet), 1u) != 0)
+            const RxQueueId queue = RxQueueId(mPacketList.size() / cReceivePoolSize);
+            if (igb_refresh_buffers(mIgbDevice, queue, reinterpret_cast<igb_packet**>(&packet), 1u) != 0)
             {
               DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "failed to refresh RX buffer",
                           int32_t(errno), " (", strerror(errno), ")");
@@ -1734,7 +3390,7 @@ IasAvbProcessingResult IasAvbReceiveEngine::startIgbReceiveEngine()
             mPacketList.push_back(packet);
           }
 
-          if (mPacketList.size() < cReceivePoolSize)
+          if (mPacketList.size() < poolSize)
           {
             DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "unable to get packet buffer",
                         int32_t(errno), " (", strerror(errno), ")");
@@ -1764,8 +3420,8 @@ IasAvbProcessingResult IasAvbReceiveEngine::startIgbReceiveEngine()
             }
             else
             {
-              // enable the filter on queue 0 with filter_id 0
-              if (igb_setup_flex_filter(mIgbDevice, eRxQueue0, eRxFilter0, len, flexFilterData, flexFilterMask) != 0)
+              // enable the catch-all filter on queue 0
+              if (igb_setup_flex_filter(mIgbDevice, eRxQueue0, getCatchAllFilter(), len, flexFilterData, flexFilterMask) != 0)
               {
                 DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "error enabling the flex filter",
                             int32_t(errno), " (", strerror(errno), ")");
@@ -1793,24 +3449,27 @@ IasAvbProcessingResult IasAvbReceiveEngine::startIgbReceiveEngine()
                 uint64_t rxDiscardOverrun = 0u;
                 (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cRxDiscardOverrun, rxDiscardOverrun);
 
-                uint32_t srrCtlReg = 0u;
                 const uint32_t cSrrCtlDropEn = 0x80000000;
 
-                (void) igb_readreg(mIgbDevice, SRRCTL(eRxQueue0), &srrCtlReg);
-
-                if (0u == rxDiscardOverrun)
-                {
-                  srrCtlReg &= ~cSrrCtlDropEn;  // disable
-                }
-                else
+                for (uint32_t i = 0u; i < mNumWorkers; i++)
                 {
-                  srrCtlReg |= cSrrCtlDropEn;   // enable
-                }
+                  uint32_t srrCtlReg = 0u;
+                  (void) igb_readreg(mIgbDevice, SRRCTL(i), &srrCtlReg);
+
+                  if (0u == rxDiscardOverrun)
+                  {
+                    srrCtlReg &= ~cSrrCtlDropEn;  // disable
+                  }
+                  else
+                  {
+                    srrCtlReg |= cSrrCtlDropEn;   // enable
+                  }
 
-                (void) igb_writereg(mIgbDevice, SRRCTL(eRxQueue0), srrCtlReg);
+                  (void) igb_writereg(mIgbDevice, SRRCTL(i), srrCtlReg);
+                  DLT_LOG_CXX(*mLog, DLT_LOG_DEBUG, LOG_PREFIX, "SRRCTL", i, ":", srrCtlReg);
+                }
 
                 DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX, "Rx Overrun Drop:", (0u != rxDiscardOverrun) ? "on" : "off");
-                DLT_LOG_CXX(*mLog, DLT_LOG_DEBUG, LOG_PREFIX, "SRRCTL:", srrCtlReg);
 
                 /* success */
                 result = eIasAvbProcOK;
@@ -1818,6 +3477,20 @@ IasAvbProcessingResult IasAvbReceiveEngine::startIgbReceiveEngine()
 
               (void) igb_unlock(mIgbDevice);
             }
+
+            if (eIasAvbProcOK == result)
+            {
+              // streams created before the start might already need their DMACs to be routed to eRxQueue1
+              (void) lock();
+              for (size_t i = 0u; i < cRxShardFilters; i++)
+              {
+                if (0u != mShardFilters[i].refCount)
+                {
+                  setShardFilter(i, true);
+                }
+              }
+              (void) unlock();
+            }
           }
         }
       }
@@ -1840,14 +3513,24 @@ void IasAvbReceiveEngine::stopIgbReceiveEngine()
   // Disable the Flex filterings
   if (NULL != mIgbDevice)
   {
-    (void) igb_clear_flex_filter(mIgbDevice, eRxFilter0);
+    (void) igb_clear_flex_filter(mIgbDevice, getCatchAllFilter());
+    if (mNumWorkers > 1u)
+    {
+      for (size_t i = 0u; i < cRxShardFilters; i++)
+      {
+        (void) igb_clear_flex_filter(mIgbDevice, uint32_t(eRxFilter0 + i));
+      }
+    }
 
     /*
-     * Disable the queue before releasing the memory allocated to this
-     * queue. Also it will make sure that the filter is disabled and
+     * Disable the queues before releasing the memory allocated to them.
+     * Also it will make sure that the filter is disabled and
      * all received packets are routed to the normal queue.
      */
-    (void) igb_writereg(mIgbDevice, RXDCTL(eRxQueue0), 0u);
+    for (uint32_t i = 0u; i < mNumWorkers; i++)
+    {
+      (void) igb_writereg(mIgbDevice, RXDCTL(i), 0u);
+    }
   }
 
   while (!mPacketList.empty())
@@ -1866,6 +3549,65 @@ void IasAvbReceiveEngine::stopIgbReceiveEngine()
     mRcvPacketPool = NULL;
   }
 }
+
+
+void IasAvbReceiveEngine::setShardFilter(size_t idx, bool enable)
+{
+  AVB_ASSERT(idx < cRxShardFilters);
+
+  // the hardware is programmed when the engine starts, see startIgbReceiveEngine()
+  if ((NULL != mIgbDevice) && (NULL != mRcvPacketPool))
+  {
+    const uint32_t filterId = uint32_t(eRxFilter0 + idx);
+
+    if (0 != igb_lock(mIgbDevice))
+    {
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "IGB lock failure");
+    }
+    else
+    {
+      if (enable)
+      {
+        uint8_t flexFilterData[cReceiveFilterDataSize];
+        uint8_t flexFilterMask[cReceiveFilterMaskSize];
+        std::memset((void*)flexFilterData, 0u, cReceiveFilterDataSize);
+        std::memset((void*)flexFilterMask, 0u, cReceiveFilterMaskSize);
+
+        // same as the catch-all filter, plus the DMAC
+        struct ethhdr * ethHdr = reinterpret_cast<struct ethhdr*>(flexFilterData);
+        uint16_t * vlanEthType = reinterpret_cast<uint16_t*>(flexFilterData + ETH_HLEN + 2u);
+        avb_safe_result copyresult = avb_safe_memcpy(ethHdr->h_dest, sizeof ethHdr->h_dest,
+                                                     mShardFilters[idx].dmac, cIasAvbMacAddressLength);
+        (void) copyresult;
+        ethHdr->h_proto = htons(ETH_P_8021Q);
+        *vlanEthType = htons(ETH_P_IEEE1722);
+
+        flexFilterMask[0] = 0x3F; /* 00111111b = dmac */
+        flexFilterMask[1] = 0x30; /* 00110000b = ethtype */
+        flexFilterMask[2] = 0x03; /* 00000011b = ethtype after a vlan tag */
+
+        // length must be 8 byte-aligned
+        uint32_t len = (uint32_t)sizeof(struct ethhdr) + 4u;
+        len = ((len + (8u - 1u)) / 8u) * 8u;
+
+        if (igb_setup_flex_filter(mIgbDevice, eRxQueue1, filterId, len, flexFilterData, flexFilterMask) != 0)
+        {
+          /**
+           * @log The frames of a stream served by worker 1 cannot be routed to its queue, the stream will time out.
+           */
+          DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "error enabling flex filter", filterId,
+                      int32_t(errno), " (", strerror(errno), ")");
+        }
+      }
+      else
+      {
+        (void) igb_clear_flex_filter(mIgbDevice, filterId);
+      }
+
+      (void) igb_unlock(mIgbDevice);
+    }
+  }
+}
 #endif /* DIRECT_RX_DMA */
 
 
@@ -1899,7 +3641,7 @@ IasAvbProcessingResult IasAvbReceiveEngine::bindMcastAddr(const IasAvbMacAddress
              << std::setfill('0') << std::setw(2) << std::right << uint32_t(mCastMacAddr[5]);
 
   int optname = (true == bind) ? PACKET_ADD_MEMBERSHIP : PACKET_DROP_MEMBERSHIP;
-  if (setsockopt(mReceiveSocket, SOL_PACKET, optname, &recv_addr, sizeof recv_addr) == -1)
+  if (setsockopt(mWorkers[0].socket, SOL_PACKET, optname, &recv_addr, sizeof recv_addr) == -1)
   {
     DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "error setting multicast address for if",
         int32_t(mRcvPortIfIndex), "(", recvport->c_str(), ") bind =", optname, "mac =", strMacAddr.str(),
@@ -1931,14 +3673,24 @@ void IasAvbReceiveEngine::emergencyShutdown()
     if (0 == igb_lock(mIgbDevice))
     {
       // route all packets to the best-effort queue
-      (void) igb_clear_flex_filter(mIgbDevice, eRxFilter0);
+      (void) igb_clear_flex_filter(mIgbDevice, getCatchAllFilter());
+      if (mNumWorkers > 1u)
+      {
+        for (size_t i = 0u; i < cRxShardFilters; i++)
+        {
+          (void) igb_clear_flex_filter(mIgbDevice, uint32_t(eRxFilter0 + i));
+        }
+      }
 
       /*
-       * Disable queue 0 so that AVTP packets remaining in the I210's packet buffer can be discarded.
+       * Disable the AVB queues so that AVTP packets remaining in the I210's packet buffer can be discarded.
        * Otherwise pending packets might keep occupying the buffer space if the SRRCTL.Drop_En bit is 0 and
        * interfere with the reception of the best-effort packets even after the shutdown of AVBSH.
        */
-      (void) igb_writereg(mIgbDevice, RXDCTL(eRxQueue0), 0u);
+      for (uint32_t i = 0u; i < mNumWorkers; i++)
+      {
+        (void) igb_writereg(mIgbDevice, RXDCTL(i), 0u);
+      }
 
       (void) igb_unlock(mIgbDevice);
     }
@@ -0,0 +1,642 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+/**
+ * @file    IasAvbSampleInterleaver.cpp
+ * @brief   The implementation of the IasAvbSampleInterleaver class.
+ * @date    2018
+ */
+
+#include "avb_streamhandler/IasAvbSampleInterleaver.hpp"
+
+#include <arpa/inet.h>
+#include <cstring>
+
+#if defined(__SSE2__)
+#define IAS_AVB_INTERLEAVER_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace IasMediaTransportAvb {
+
+namespace {
+
+/*
+ * Scalar kernels, also used for the channels and samples left over by the SIMD kernels.
+ */
+
+inline void interleaveChannel(uint8_t *payload, const int16_t *in, uint32_t frameBytes, uint32_t first, uint32_t end)
+{
+  uint8_t *out = payload + (first * frameBytes);
+  for (uint32_t sample = first; sample < end; sample++)
+  {
+    const uint16_t value = htons(uint16_t(in[sample]));
+    (void) std::memcpy(out, &value, sizeof value);
+    out += frameBytes;
+  }
+}
+
+
+inline void deinterleaveChannel(int16_t *out, const uint8_t *payload, uint32_t frameBytes, uint32_t first, uint32_t end)
+{
+  const uint8_t *in = payload + (first * frameBytes);
+  for (uint32_t sample = first; sample < end; sample++)
+  {
+    uint16_t value = 0u;
+    (void) std::memcpy(&value, in, sizeof value);
+    out[sample] = int16_t(ntohs(value));
+    in += frameBytes;
+  }
+}
+
+
+void interleaveScalar(uint8_t *payload, const int16_t *samples, uint32_t channelStride,
+    uint32_t numChannels, uint32_t numSamples)
+{
+  const uint32_t frameBytes = numChannels * uint32_t(sizeof(int16_t));
+  for (uint32_t ch = 0u; ch < numChannels; ch++)
+  {
+    interleaveChannel(payload + (ch * sizeof(int16_t)), samples + (ch * channelStride), frameBytes, 0u, numSamples);
+  }
+}
+
+
+void deinterleaveScalar(int16_t *samples, uint32_t channelStride, const uint8_t *payload,
+    uint32_t frameChannels, uint32_t numChannels, uint32_t numSamples)
+{
+  const uint32_t frameBytes = frameChannels * uint32_t(sizeof(int16_t));
+  for (uint32_t ch = 0u; ch < numChannels; ch++)
+  {
+    deinterleaveChannel(samples + (ch * channelStride), payload + (ch * sizeof(int16_t)), frameBytes, 0u, numSamples);
+  }
+}
+
+
+#if IAS_AVB_INTERLEAVER_SIMD
+
+/*
+ * SSE2 kernels, blocks of 8 samples. Transposing the sample matrix of a group of channels turns channel
+ * vectors into frame vectors and vice versa, so the same network is used in both directions.
+ */
+
+inline __m128i byteSwap(__m128i v)
+{
+  return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+
+
+inline void transpose8(__m128i v[8])
+{
+  const __m128i t0 = _mm_unpacklo_epi16(v[0], v[1]);
+  const __m128i t1 = _mm_unpackhi_epi16(v[0], v[1]);
+  const __m128i t2 = _mm_unpacklo_epi16(v[2], v[3]);
+  const __m128i t3 = _mm_unpackhi_epi16(v[2], v[3]);
+  const __m128i t4 = _mm_unpacklo_epi16(v[4], v[5]);
+  const __m128i t5 = _mm_unpackhi_epi16(v[4], v[5]);
+  const __m128i t6 = _mm_unpacklo_epi16(v[6], v[7]);
+  const __m128i t7 = _mm_unpackhi_epi16(v[6], v[7]);
+
+  const __m128i u0 = _mm_unpacklo_epi32(t0, t2);
+  const __m128i u1 = _mm_unpackhi_epi32(t0, t2);
+  const __m128i u2 = _mm_unpacklo_epi32(t1, t3);
+  const __m128i u3 = _mm_unpackhi_epi32(t1, t3);
+  const __m128i u4 = _mm_unpacklo_epi32(t4, t6);
+  const __m128i u5 = _mm_unpackhi_epi32(t4, t6);
+  const __m128i u6 = _mm_unpacklo_epi32(t5, t7);
+  const __m128i u7 = _mm_unpackhi_epi32(t5, t7);
+
+  v[0] = _mm_unpacklo_epi64(u0, u4);
+  v[1] = _mm_unpackhi_epi64(u0, u4);
+  v[2] = _mm_unpacklo_epi64(u1, u5);
+  v[3] = _mm_unpackhi_epi64(u1, u5);
+  v[4] = _mm_unpacklo_epi64(u2, u6);
+  v[5] = _mm_unpackhi_epi64(u2, u6);
+  v[6] = _mm_unpacklo_epi64(u3, u7);
+  v[7] = _mm_unpackhi_epi64(u3, u7);
+}
+
+
+inline void storeDword(uint8_t *out, __m128i v)
+{
+  const int32_t value = _mm_cvtsi128_si32(v);
+  (void) std::memcpy(out, &value, sizeof value);
+}
+
+
+inline __m128i loadDword(const uint8_t *in)
+{
+  int32_t value = 0;
+  (void) std::memcpy(&value, in, sizeof value);
+  return _mm_cvtsi32_si128(value);
+}
+
+
+/*
+ * The kernels below work on count <= 8 samples. Blocks of less than 8 samples, e.g. the 6 samples of a class A
+ * packet at 48 kHz, are loaded and stored in pieces of 4, 2 and 1 samples, so the channel buffers are never
+ * accessed beyond the samples of the block. The samples not loaded are zero.
+ */
+
+inline __m128i loadSamples(const int16_t *in, uint32_t count)
+{
+  __m128i v;
+  if (8u == count)
+  {
+    v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+  }
+  else
+  {
+    const int16_t * const tail = in + (count & 4u);
+    v = _mm_setzero_si128();
+    if (0u != (count & 2u))
+    {
+      v = loadDword(reinterpret_cast<const uint8_t*>(tail));
+      if (0u != (count & 1u))
+      {
+        v = _mm_insert_epi16(v, tail[2], 2);
+      }
+    }
+    else if (0u != (count & 1u))
+    {
+      v = _mm_insert_epi16(v, tail[0], 0);
+    }
+    if (0u != (count & 4u))
+    {
+      v = _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in)), v);
+    }
+  }
+  return v;
+}
+
+
+inline void storeSamples(int16_t *out, __m128i v, uint32_t count)
+{
+  if (8u == count)
+  {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), v);
+  }
+  else
+  {
+    if (0u != (count & 4u))
+    {
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(out), v);
+      v = _mm_srli_si128(v, 8);
+      out += 4u;
+    }
+    if (0u != (count & 2u))
+    {
+      storeDword(reinterpret_cast<uint8_t*>(out), v);
+      v = _mm_srli_si128(v, 4);
+      out += 2u;
+    }
+    if (0u != (count & 1u))
+    {
+      *out = int16_t(_mm_extract_epi16(v, 0));
+    }
+  }
+}
+
+
+// channels ch .. ch + 7, samples s .. s + count - 1; out points to the first of the channels in the first frame
+inline void interleave8(uint8_t *out, const int16_t *in, uint32_t channelStride, uint32_t frameBytes, uint32_t count)
+{
+  __m128i v[8];
+  for (uint32_t i = 0u; i < 8u; i++)
+  {
+    v[i] = byteSwap(loadSamples(in + (i * channelStride), count));
+  }
+  transpose8(v);
+  // one store per frame
+  for (uint32_t i = 0u; i < count; i++)
+  {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + (i * frameBytes)), v[i]);
+  }
+}
+
+
+inline void interleave4(uint8_t *out, const int16_t *in, uint32_t channelStride, uint32_t frameBytes, uint32_t count)
+{
+  const __m128i a0 = byteSwap(loadSamples(in, count));
+  const __m128i a1 = byteSwap(loadSamples(in + channelStride, count));
+  const __m128i a2 = byteSwap(loadSamples(in + (2u * channelStride), count));
+  const __m128i a3 = byteSwap(loadSamples(in + (3u * channelStride), count));
+  const __m128i t0 = _mm_unpacklo_epi16(a0, a1);
+  const __m128i t1 = _mm_unpackhi_epi16(a0, a1);
+  const __m128i t2 = _mm_unpacklo_epi16(a2, a3);
+  const __m128i t3 = _mm_unpackhi_epi16(a2, a3);
+
+  // two frames per vector
+  __m128i f[4] = { _mm_unpacklo_epi32(t0, t2), _mm_unpackhi_epi32(t0, t2),
+                   _mm_unpacklo_epi32(t1, t3), _mm_unpackhi_epi32(t1, t3) };
+  for (uint32_t i = 0u; i < count; i++)
+  {
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out), f[i / 2u]);
+    f[i / 2u] = _mm_srli_si128(f[i / 2u], 8);
+    out += frameBytes;
+  }
+}
+
+
+inline void interleave2(uint8_t *out, const int16_t *in, uint32_t channelStride, uint32_t frameBytes, uint32_t count)
+{
+  const __m128i a0 = byteSwap(loadSamples(in, count));
+  const __m128i a1 = byteSwap(loadSamples(in + channelStride, count));
+
+  // four frames per vector
+  __m128i f[2] = { _mm_unpacklo_epi16(a0, a1), _mm_unpackhi_epi16(a0, a1) };
+  for (uint32_t i = 0u; i < count; i++)
+  {
+    storeDword(out, f[i / 4u]);
+    f[i / 4u] = _mm_srli_si128(f[i / 4u], 4);
+    out += frameBytes;
+  }
+}
+
+
+// all channels for samples s .. s + count - 1, starting with channel ch
+inline void interleaveBlockSse2(uint8_t *payload, const int16_t *samples, uint32_t channelStride,
+    uint32_t numChannels, uint32_t frameBytes, uint32_t s, uint32_t ch, uint32_t count)
+{
+  uint8_t * const out = payload + (s * frameBytes);
+  for (; (ch + 8u) <= numChannels; ch += 8u)
+  {
+    interleave8(out + (ch * sizeof(int16_t)), samples + (ch * channelStride) + s, channelStride, frameBytes, count);
+  }
+  if ((ch + 4u) <= numChannels)
+  {
+    interleave4(out + (ch * sizeof(int16_t)), samples + (ch * channelStride) + s, channelStride, frameBytes, count);
+    ch += 4u;
+  }
+  if ((ch + 2u) <= numChannels)
+  {
+    interleave2(out + (ch * sizeof(int16_t)), samples + (ch * channelStride) + s, channelStride, frameBytes, count);
+    ch += 2u;
+  }
+  if (ch < numChannels)
+  {
+    interleaveChannel(payload + (ch * sizeof(int16_t)), samples + (ch * channelStride), frameBytes, s, s + count);
+  }
+}
+
+
+void interleaveSse2(uint8_t *payload, const int16_t *samples, uint32_t channelStride,
+    uint32_t numChannels, uint32_t numSamples)
+{
+  const uint32_t frameBytes = numChannels * uint32_t(sizeof(int16_t));
+  uint32_t s = 0u;
+  for (; (s + 8u) <= numSamples; s += 8u)
+  {
+    interleaveBlockSse2(payload, samples, channelStride, numChannels, frameBytes, s, 0u, 8u);
+  }
+  if (s < numSamples)
+  {
+    interleaveBlockSse2(payload, samples, channelStride, numChannels, frameBytes, s, 0u, numSamples - s);
+  }
+}
+
+
+// channels ch .. ch + 7, samples s .. s + count - 1; in points to the first of the channels in the first frame
+inline void deinterleave8(int16_t *out, uint32_t channelStride, const uint8_t *in, uint32_t frameBytes, uint32_t count)
+{
+  __m128i v[8];
+  // one load per frame
+  for (uint32_t i = 0u; i < 8u; i++)
+  {
+    v[i] = (i < count) ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + (i * frameBytes))) : _mm_setzero_si128();
+  }
+  transpose8(v);
+  for (uint32_t i = 0u; i < 8u; i++)
+  {
+    storeSamples(out + (i * channelStride), byteSwap(v[i]), count);
+  }
+}
+
+
+inline void deinterleave4(int16_t *out, uint32_t channelStride, const uint8_t *in, uint32_t frameBytes, uint32_t count)
+{
+  __m128i f[8];
+  for (uint32_t i = 0u; i < 8u; i++)
+  {
+    f[i] = (i < count) ? _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + (i * frameBytes))) : _mm_setzero_si128();
+  }
+  const __m128i p0 = _mm_unpacklo_epi16(f[0], f[1]);
+  const __m128i p1 = _mm_unpacklo_epi16(f[2], f[3]);
+  const __m128i p2 = _mm_unpacklo_epi16(f[4], f[5]);
+  const __m128i p3 = _mm_unpacklo_epi16(f[6], f[7]);
+  const __m128i q0 = _mm_unpacklo_epi32(p0, p1);
+  const __m128i q1 = _mm_unpackhi_epi32(p0, p1);
+  const __m128i q2 = _mm_unpacklo_epi32(p2, p3);
+  const __m128i q3 = _mm_unpackhi_epi32(p2, p3);
+
+  storeSamples(out, byteSwap(_mm_unpacklo_epi64(q0, q2)), count);
+  storeSamples(out + channelStride, byteSwap(_mm_unpackhi_epi64(q0, q2)), count);
+  storeSamples(out + (2u * channelStride), byteSwap(_mm_unpacklo_epi64(q1, q3)), count);
+  storeSamples(out + (3u * channelStride), byteSwap(_mm_unpackhi_epi64(q1, q3)), count);
+}
+
+
+inline void deinterleave2(int16_t *out, uint32_t channelStride, const uint8_t *in, uint32_t frameBytes, uint32_t count)
+{
+  __m128i f[8];
+  for (uint32_t i = 0u; i < 8u; i++)
+  {
+    f[i] = (i < count) ? loadDword(in + (i * frameBytes)) : _mm_setzero_si128();
+  }
+  const __m128i p0 = _mm_unpacklo_epi16(f[0], f[1]);
+  const __m128i p1 = _mm_unpacklo_epi16(f[2], f[3]);
+  const __m128i p2 = _mm_unpacklo_epi16(f[4], f[5]);
+  const __m128i p3 = _mm_unpacklo_epi16(f[6], f[7]);
+  const __m128i q0 = _mm_unpacklo_epi32(p0, p1);
+  const __m128i q1 = _mm_unpacklo_epi32(p2, p3);
+
+  storeSamples(out, byteSwap(_mm_unpacklo_epi64(q0, q1)), count);
+  storeSamples(out + channelStride, byteSwap(_mm_unpackhi_epi64(q0, q1)), count);
+}
+
+
+// channels ch .. numChannels - 1 for samples s .. s + count - 1
+inline void deinterleaveBlockSse2(int16_t *samples, uint32_t channelStride, const uint8_t *payload,
+    uint32_t numChannels, uint32_t frameBytes, uint32_t s, uint32_t ch, uint32_t count)
+{
+  const uint8_t * const in = payload + (s * frameBytes);
+  for (; (ch + 8u) <= numChannels; ch += 8u)
+  {
+    deinterleave8(samples + (ch * channelStride) + s, channelStride, in + (ch * sizeof(int16_t)), frameBytes, count);
+  }
+  if ((ch + 4u) <= numChannels)
+  {
+    deinterleave4(samples + (ch * channelStride) + s, channelStride, in + (ch * sizeof(int16_t)), frameBytes, count);
+    ch += 4u;
+  }
+  if ((ch + 2u) <= numChannels)
+  {
+    deinterleave2(samples + (ch * channelStride) + s, channelStride, in + (ch * sizeof(int16_t)), frameBytes, count);
+    ch += 2u;
+  }
+  if (ch < numChannels)
+  {
+    deinterleaveChannel(samples + (ch * channelStride), payload + (ch * sizeof(int16_t)), frameBytes, s, s + count);
+  }
+}
+
+
+void deinterleaveSse2(int16_t *samples, uint32_t channelStride, const uint8_t *payload,
+    uint32_t frameChannels, uint32_t numChannels, uint32_t numSamples)
+{
+  const uint32_t frameBytes = frameChannels * uint32_t(sizeof(int16_t));
+  uint32_t s = 0u;
+  for (; (s + 8u) <= numSamples; s += 8u)
+  {
+    deinterleaveBlockSse2(samples, channelStride, payload, numChannels, frameBytes, s, 0u, 8u);
+  }
+  if (s < numSamples)
+  {
+    deinterleaveBlockSse2(samples, channelStride, payload, numChannels, frameBytes, s, 0u, numSamples - s);
+  }
+}
+
+
+/*
+ * AVX2 kernels for the groups of 8 channels, blocks of 16 samples. The unpack instructions work within
+ * the 128 bit lanes, so the lower lane is the transpose of samples s .. s + 7 and the upper one of
+ * samples s + 8 .. s + 15. Smaller groups are left to the SSE2 code.
+ */
+
+#define IAS_AVB_TARGET_AVX2 __attribute__((target("avx2")))
+
+IAS_AVB_TARGET_AVX2 inline __m256i byteSwap256(__m256i v)
+{
+  return _mm256_or_si256(_mm256_slli_epi16(v, 8), _mm256_srli_epi16(v, 8));
+}
+
+
+IAS_AVB_TARGET_AVX2 inline void transpose8x2(__m256i v[8])
+{
+  const __m256i t0 = _mm256_unpacklo_epi16(v[0], v[1]);
+  const __m256i t1 = _mm256_unpackhi_epi16(v[0], v[1]);
+  const __m256i t2 = _mm256_unpacklo_epi16(v[2], v[3]);
+  const __m256i t3 = _mm256_unpackhi_epi16(v[2], v[3]);
+  const __m256i t4 = _mm256_unpacklo_epi16(v[4], v[5]);
+  const __m256i t5 = _mm256_unpackhi_epi16(v[4], v[5]);
+  const __m256i t6 = _mm256_unpacklo_epi16(v[6], v[7]);
+  const __m256i t7 = _mm256_unpackhi_epi16(v[6], v[7]);
+
+  const __m256i u0 = _mm256_unpacklo_epi32(t0, t2);
+  const __m256i u1 = _mm256_unpackhi_epi32(t0, t2);
+  const __m256i u2 = _mm256_unpacklo_epi32(t1, t3);
+  const __m256i u3 = _mm256_unpackhi_epi32(t1, t3);
+  const __m256i u4 = _mm256_unpacklo_epi32(t4, t6);
+  const __m256i u5 = _mm256_unpackhi_epi32(t4, t6);
+  const __m256i u6 = _mm256_unpacklo_epi32(t5, t7);
+  const __m256i u7 = _mm256_unpackhi_epi32(t5, t7);
+
+  v[0] = _mm256_unpacklo_epi64(u0, u4);
+  v[1] = _mm256_unpackhi_epi64(u0, u4);
+  v[2] = _mm256_unpacklo_epi64(u1, u5);
+  v[3] = _mm256_unpackhi_epi64(u1, u5);
+  v[4] = _mm256_unpacklo_epi64(u2, u6);
+  v[5] = _mm256_unpackhi_epi64(u2, u6);
+  v[6] = _mm256_unpacklo_epi64(u3, u7);
+  v[7] = _mm256_unpackhi_epi64(u3, u7);
+}
+
+
+IAS_AVB_TARGET_AVX2 void interleaveAvx2(uint8_t *payload, const int16_t *samples, uint32_t channelStride,
+    uint32_t numChannels, uint32_t numSamples)
+{
+  const uint32_t frameBytes = numChannels * uint32_t(sizeof(int16_t));
+  uint32_t s = 0u;
+  for (; (s + 16u) <= numSamples; s += 16u)
+  {
+    uint8_t * const out = payload + (s * frameBytes);
+    uint32_t ch = 0u;
+    for (; (ch + 8u) <= numChannels; ch += 8u)
+    {
+      const int16_t * const in = samples + (ch * channelStride) + s;
+      __m256i v[8];
+      for (uint32_t i = 0u; i < 8u; i++)
+      {
+        v[i] = byteSwap256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + (i * channelStride))));
+      }
+      transpose8x2(v);
+      for (uint32_t i = 0u; i < 8u; i++)
+      {
+        uint8_t * const frame = out + (ch * sizeof(int16_t)) + (i * frameBytes);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(frame), _mm256_castsi256_si128(v[i]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(frame + (8u * frameBytes)), _mm256_extracti128_si256(v[i], 1));
+      }
+    }
+    if (ch < numChannels)
+    {
+      interleaveBlockSse2(payload, samples, channelStride, numChannels, frameBytes, s, ch, 8u);
+      interleaveBlockSse2(payload, samples, channelStride, numChannels, frameBytes, s + 8u, ch, 8u);
+    }
+  }
+  for (; (s + 8u) <= numSamples; s += 8u)
+  {
+    interleaveBlockSse2(payload, samples, channelStride, numChannels, frameBytes, s, 0u, 8u);
+  }
+  if (s < numSamples)
+  {
+    interleaveBlockSse2(payload, samples, channelStride, numChannels, frameBytes, s, 0u, numSamples - s);
+  }
+}
+
+
+IAS_AVB_TARGET_AVX2 void deinterleaveAvx2(int16_t *samples, uint32_t channelStride, const uint8_t *payload,
+    uint32_t frameChannels, uint32_t numChannels, uint32_t numSamples)
+{
+  const uint32_t frameBytes = frameChannels * uint32_t(sizeof(int16_t));
+  uint32_t s = 0u;
+  for (; (s + 16u) <= numSamples; s += 16u)
+  {
+    const uint8_t * const in = payload + (s * frameBytes);
+    uint32_t ch = 0u;
+    for (; (ch + 8u) <= numChannels; ch += 8u)
+    {
+      __m256i v[8];
+      for (uint32_t i = 0u; i < 8u; i++)
+      {
+        const uint8_t * const frame = in + (ch * sizeof(int16_t)) + (i * frameBytes);
+        v[i] = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(frame))),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(frame + (8u * frameBytes))), 1);
+      }
+      transpose8x2(v);
+      int16_t * const out = samples + (ch * channelStride) + s;
+      for (uint32_t i = 0u; i < 8u; i++)
+      {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + (i * channelStride)), byteSwap256(v[i]));
+      }
+    }
+    if (ch < numChannels)
+    {
+      deinterleaveBlockSse2(samples, channelStride, payload, numChannels, frameBytes, s, ch, 8u);
+      deinterleaveBlockSse2(samples, channelStride, payload, numChannels, frameBytes, s + 8u, ch, 8u);
+    }
+  }
+  for (; (s + 8u) <= numSamples; s += 8u)
+  {
+    deinterleaveBlockSse2(samples, channelStride, payload, numChannels, frameBytes, s, 0u, 8u);
+  }
+  if (s < numSamples)
+  {
+    deinterleaveBlockSse2(samples, channelStride, payload, numChannels, frameBytes, s, 0u, numSamples - s);
+  }
+}
+
+#endif /* IAS_AVB_INTERLEAVER_SIMD */
+
+} // anonymous namespace
+
+
+const IasAvbSampleInterleaver::Isa IasAvbSampleInterleaver::sIsa = IasAvbSampleInterleaver::selectIsa();
+const IasAvbSampleInterleaver::InterleaveFunc IasAvbSampleInterleaver::sInterleave =
+    IasAvbSampleInterleaver::getInterleave(IasAvbSampleInterleaver::sIsa);
+const IasAvbSampleInterleaver::DeinterleaveFunc IasAvbSampleInterleaver::sDeinterleave =
+    IasAvbSampleInterleaver::getDeinterleave(IasAvbSampleInterleaver::sIsa);
+
+
+IasAvbSampleInterleaver::Isa IasAvbSampleInterleaver::selectIsa()
+{
+  Isa isa = eIsaScalar;
+
+  if (isSupported(eIsaAvx2))
+  {
+    isa = eIsaAvx2;
+  }
+  else if (isSupported(eIsaSse2))
+  {
+    isa = eIsaSse2;
+  }
+  else
+  {
+    // scalar kernels only
+  }
+
+  return isa;
+}
+
+
+bool IasAvbSampleInterleaver::isSupported(Isa isa)
+{
+  bool ret = false;
+
+  switch (isa)
+  {
+    case eIsaScalar:
+      ret = true;
+      break;
+#if IAS_AVB_INTERLEAVER_SIMD
+    case eIsaSse2:
+      // part of the baseline if the SSE2 kernels are built at all
+      ret = true;
+      break;
+    case eIsaAvx2:
+      __builtin_cpu_init();
+      ret = (0 != __builtin_cpu_supports("avx2"));
+      break;
+#endif
+    default:
+      break;
+  }
+
+  return ret;
+}
+
+
+IasAvbSampleInterleaver::InterleaveFunc IasAvbSampleInterleaver::getInterleave(Isa isa)
+{
+  InterleaveFunc ret = NULL;
+
+  if (isSupported(isa))
+  {
+    switch (isa)
+    {
+#if IAS_AVB_INTERLEAVER_SIMD
+      case eIsaSse2:
+        ret = &interleaveSse2;
+        break;
+      case eIsaAvx2:
+        ret = &interleaveAvx2;
+        break;
+#endif
+      default:
+        ret = &interleaveScalar;
+        break;
+    }
+  }
+
+  return ret;
+}
+
+
+IasAvbSampleInterleaver::DeinterleaveFunc IasAvbSampleInterleaver::getDeinterleave(Isa isa)
+{
+  DeinterleaveFunc ret = NULL;
+
+  if (isSupported(isa))
+  {
+    switch (isa)
+    {
+#if IAS_AVB_INTERLEAVER_SIMD
+      case eIsaSse2:
+        ret = &deinterleaveSse2;
+        break;
+      case eIsaAvx2:
+        ret = &deinterleaveAvx2;
+        break;
+#endif
+      default:
+        ret = &deinterleaveScalar;
+        break;
+    }
+  }
+
+  return ret;
+}
+
+
+} // namespace IasMediaTransportAvb
@@ -0,0 +1,476 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file    IasAvbSocketTransmitBackend.cpp
+ * @brief   This is the implementation of the IasAvbSocketTransmitBackend class.
+ * @date    2018
+ */
+
+#include <time.h> // make sure we include the right timespec definition
+#include "avb_streamhandler/IasAvbSocketTransmitBackend.hpp"
+#include "avb_streamhandler/IasAvbPacket.hpp"
+#include "avb_streamhandler/IasAvbPacketPool.hpp"
+#include "avb_streamhandler/IasAvbStreamHandlerEnvironment.hpp"
+#include "avb_streamhandler/IasAvbTSpec.hpp"
+#include "lib_ptp_daemon/IasLibPtpDaemon.hpp"
+
+#include <cstring>
+#include <errno.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <linux/if.h>
+#include <linux/if_ether.h>
+#include <linux/net_tstamp.h>
+#include <linux/errqueue.h>
+
+#ifndef CLOCK_TAI
+#define CLOCK_TAI 11
+#endif
+
+namespace IasMediaTransportAvb
+{
+
+static const std::string cClassName = "IasAvbSocketTransmitBackend::";
+#define LOG_PREFIX cClassName + __func__ + "(" + std::to_string(__LINE__) + "):"
+
+
+IasAvbSocketTransmitBackend::IasAvbSocketTransmitBackend(DltContext &ctx)
+  : mSocket(-1)
+  , mAddress()
+  , mClockOffset(0)
+  , mRealtimeOffset(0)
+  , mSent()
+  , mMessages()
+  , mIovecs()
+  , mControls()
+  , mMissedCount(0u)
+  , mInvalidCount(0u)
+  , mTimestamps(false)
+  , mStamps()
+  , mStampOverflowCount(0u)
+  , mLog(&ctx)
+{
+  (void) std::memset(&mAddress, 0, sizeof mAddress);
+}
+
+
+IasAvbSocketTransmitBackend::~IasAvbSocketTransmitBackend()
+{
+  cleanup();
+}
+
+
+IasAvbProcessingResult IasAvbSocketTransmitBackend::init(uint32_t queueIndex, IasAvbSrClass qavClass)
+{
+  IasAvbProcessingResult result = eIasAvbProcOK;
+  const std::string* ifName = IasAvbStreamHandlerEnvironment::getNetworkInterfaceName();
+  const bool initialized = (-1 != mSocket);
+
+  if (initialized)
+  {
+    result = eIasAvbProcInitializationFailed;
+  }
+  else if ((NULL == ifName) || ifName->empty())
+  {
+    DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "Network interface name missing!");
+    result = eIasAvbProcInitializationFailed;
+  }
+  else
+  {
+    // protocol 0: the socket is only used for sending and does not receive any frames
+    mSocket = ::socket(PF_PACKET, SOCK_RAW, 0);
+    if (mSocket < 0)
+    {
+      /**
+       * @log Init failed: Packet socket could not be opened, check for CAP_NET_RAW.
+       */
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "Couldn't open transmit socket:", strerror(errno));
+      mSocket = -1;
+      result = eIasAvbProcInitializationFailed;
+    }
+  }
+
+  if (eIasAvbProcOK == result)
+  {
+    struct ifreq ifr;
+    (void) std::memset(&ifr, 0, sizeof ifr);
+    (void) std::strncpy(ifr.ifr_name, ifName->c_str(), (sizeof ifr.ifr_name) - 1u);
+
+    if (::ioctl(mSocket, SIOCGIFINDEX, &ifr) < 0)
+    {
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "Couldn't get index of", ifName->c_str(), ":", strerror(errno));
+      result = eIasAvbProcInitializationFailed;
+    }
+    else
+    {
+      mAddress.sll_family = AF_PACKET;
+      mAddress.sll_protocol = htons(ETH_P_8021Q);
+      mAddress.sll_ifindex = ifr.ifr_ifindex;
+      mAddress.sll_halen = ETH_ALEN;
+    }
+  }
+
+  if (eIasAvbProcOK == result)
+  {
+    // the traffic class, and so the TX queue, is selected by the socket priority
+    const std::string optName = std::string(IasRegKeys::cXmitSocketPriority) + IasAvbTSpec::getClassSuffix(qavClass);
+    uint64_t priority = IasAvbTSpec::getVlanPrioritybyClass(qavClass);
+    (void) IasAvbStreamHandlerEnvironment::getConfigValue(optName, priority);
+    (void) IasAvbStreamHandlerEnvironment::getConfigValue(optName + "." + std::to_string(queueIndex), priority);
+    const int32_t prio = int32_t(priority);
+
+    struct sock_txtime txtime;
+    txtime.clockid = CLOCK_TAI;
+    txtime.flags = SOF_TXTIME_REPORT_ERRORS;
+
+    if (::setsockopt(mSocket, SOL_SOCKET, SO_PRIORITY, &prio, sizeof prio) < 0)
+    {
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "Couldn't set socket priority", prio, ":", strerror(errno));
+      result = eIasAvbProcInitializationFailed;
+    }
+    else if (::setsockopt(mSocket, SOL_SOCKET, SO_TXTIME, &txtime, sizeof txtime) < 0)
+    {
+      /**
+       * @log Init failed: The kernel does not support SO_TXTIME (needs Linux 4.19 or later).
+       */
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "Couldn't enable SO_TXTIME:", strerror(errno));
+      result = eIasAvbProcInitializationFailed;
+    }
+    else
+    {
+      mSent.reserve(cSentReserve);
+      mMessages.resize(cMaxBatch);
+      mIovecs.resize(cMaxBatch);
+      mControls.resize(cMaxBatch);
+      updateClockOffset();
+      DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX, "sending on", ifName->c_str(), "with socket priority", prio);
+    }
+  }
+
+  // a second init() must not close the socket in use
+  if ((eIasAvbProcOK != result) && !initialized)
+  {
+    cleanup();
+  }
+
+  return result;
+}
+
+
+void IasAvbSocketTransmitBackend::cleanup()
+{
+  (void) reclaimPackets();
+
+  if (-1 != mSocket)
+  {
+    (void) ::close(mSocket);
+    mSocket = -1;
+  }
+
+  mTimestamps = false;
+  mStamps.clear();
+}
+
+
+int32_t IasAvbSocketTransmitBackend::xmit(IasAvbPacket *packet)
+{
+  int32_t result = 0;
+
+  if ((-1 == mSocket) || (NULL == packet))
+  {
+    result = -ENXIO;
+  }
+  else
+  {
+    TxTimeControl control;
+    struct iovec iov;
+    struct msghdr msg;
+    prepareMessage(packet, msg, iov, control);
+
+    if (::sendmsg(mSocket, &msg, MSG_DONTWAIT) < 0)
+    {
+      result = getSendError();
+    }
+    else
+    {
+      mSent.push_back(packet);
+    }
+  }
+
+  return result;
+}
+
+
+int32_t IasAvbSocketTransmitBackend::xmitBatch(IasAvbPacket * const *packets, uint32_t count, uint32_t &sent)
+{
+  int32_t result = 0;
+  sent = 0u;
+
+  if ((-1 == mSocket) || (NULL == packets))
+  {
+    result = -ENXIO;
+  }
+
+  while ((0 == result) && (sent < count))
+  {
+    const uint32_t num = ((count - sent) < cMaxBatch) ? (count - sent) : cMaxBatch;
+
+    for (uint32_t i = 0u; i < num; i++)
+    {
+      AVB_ASSERT(NULL != packets[sent + i]);
+      mMessages[i].msg_len = 0u;
+      prepareMessage(packets[sent + i], mMessages[i].msg_hdr, mIovecs[i], mControls[i]);
+    }
+
+    // the kernel stops at the first message it cannot send, the remaining ones are tried on the next pass
+    const int32_t done = int32_t(::sendmmsg(mSocket, &mMessages[0], num, MSG_DONTWAIT));
+    if (done <= 0)
+    {
+      result = (0 == done) ? -EAGAIN : getSendError();
+    }
+    else
+    {
+      for (uint32_t i = 0u; i < uint32_t(done); i++)
+      {
+        mSent.push_back(packets[sent + i]);
+      }
+      sent += uint32_t(done);
+    }
+  }
+
+  return result;
+}
+
+
+void IasAvbSocketTransmitBackend::prepareMessage(IasAvbPacket *packet, struct msghdr &msg, struct iovec &iov,
+                                                 TxTimeControl &control)
+{
+  (void) std::memset(&control, 0, sizeof control);
+
+  iov.iov_base = packet->getBasePtr();
+  iov.iov_len = packet->len;
+
+  (void) std::memset(&msg, 0, sizeof msg);
+  msg.msg_name = &mAddress;
+  msg.msg_namelen = sizeof mAddress;
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1u;
+  msg.msg_control = control.buf;
+  msg.msg_controllen = sizeof control.buf;
+
+  struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_TXTIME;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(uint64_t));
+  const uint64_t txTime = packet->attime + uint64_t(mClockOffset);
+  (void) std::memcpy(CMSG_DATA(cmsg), &txTime, sizeof txTime);
+}
+
+
+int32_t IasAvbSocketTransmitBackend::getSendError()
+{
+  int32_t result = 0;
+
+  switch (errno)
+  {
+    case EAGAIN:
+    case ENOBUFS:
+    case ENETDOWN:
+      // qdisc or device queue full, or link down: try again
+      result = -errno;
+      break;
+
+    default:
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "send failed:", strerror(errno));
+      result = -EINVAL;
+      break;
+  }
+
+  return result;
+}
+
+
+uint32_t IasAvbSocketTransmitBackend::reclaimPackets()
+{
+  const uint32_t ret = uint32_t(mSent.size());
+
+  for (std::vector<IasAvbPacket*>::iterator it = mSent.begin(); it != mSent.end(); ++it)
+  {
+    (void) IasAvbPacketPool::returnPacket(*it);
+  }
+  mSent.clear();
+
+  if (-1 != mSocket)
+  {
+    readErrorQueue();
+    updateClockOffset();
+  }
+
+  return ret;
+}
+
+
+bool IasAvbSocketTransmitBackend::enableTxTimestamps()
+{
+  const int32_t flags = SOF_TIMESTAMPING_TX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE
+                      | SOF_TIMESTAMPING_TX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE
+                      | SOF_TIMESTAMPING_OPT_ID | SOF_TIMESTAMPING_OPT_TSONLY;
+
+  if ((-1 != mSocket) && !mTimestamps)
+  {
+    // the frame counter used as time stamp key starts over at 0
+    if (::setsockopt(mSocket, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof flags) < 0)
+    {
+      DLT_LOG_CXX(*mLog, DLT_LOG_WARN, LOG_PREFIX, "Couldn't enable TX time stamps:", strerror(errno));
+    }
+    else
+    {
+      mStamps.reserve(cMaxStamps);
+      mTimestamps = true;
+    }
+  }
+
+  return mTimestamps;
+}
+
+
+uint32_t IasAvbSocketTransmitBackend::getTxTimestamps(TxTimestamp *stamps, uint32_t max)
+{
+  uint32_t count = uint32_t(mStamps.size());
+
+  if ((NULL == stamps) || (0u == count))
+  {
+    count = 0u;
+  }
+  else
+  {
+    if (count > max)
+    {
+      count = max;
+    }
+    (void) std::memcpy(stamps, &mStamps[0], count * sizeof(TxTimestamp));
+    (void) mStamps.erase(mStamps.begin(), mStamps.begin() + count);
+  }
+
+  return count;
+}
+
+
+void IasAvbSocketTransmitBackend::updateClockOffset()
+{
+  IasLibPtpDaemon* ptp = IasAvbStreamHandlerEnvironment::getPtpProxy();
+  struct timespec tai;
+  struct timespec realtime;
+
+  // without PTP proxy, launch times are taken as CLOCK_TAI as they are
+  if ((NULL != ptp) && (0 == ::clock_gettime(CLOCK_TAI, &tai)) && (0 == ::clock_gettime(CLOCK_REALTIME, &realtime)))
+  {
+    const uint64_t localNow = ptp->getLocalTime();
+    const uint64_t taiNow = uint64_t(tai.tv_sec) * uint64_t(1000000000u) + uint64_t(tai.tv_nsec);
+    const uint64_t realtimeNow = uint64_t(realtime.tv_sec) * uint64_t(1000000000u) + uint64_t(realtime.tv_nsec);
+    mClockOffset = int64_t(taiNow - localNow);
+    mRealtimeOffset = int64_t(realtimeNow - localNow);
+  }
+}
+
+
+void IasAvbSocketTransmitBackend::readErrorQueue()
+{
+  const uint64_t missedOld = mMissedCount;
+  const uint64_t invalidOld = mInvalidCount;
+
+  for (;;)
+  {
+    union
+    {
+      struct cmsghdr align;
+      uint8_t buf[CMSG_SPACE(sizeof(struct scm_timestamping))
+                  + CMSG_SPACE(sizeof(struct sock_extended_err) + sizeof(struct sockaddr_ll))];
+    } control;
+    struct scm_timestamping stamp;
+    bool haveStamp = false;
+    bool haveId = false;
+    uint32_t id = 0u;
+
+    struct msghdr msg;
+    (void) std::memset(&msg, 0, sizeof msg);
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof control.buf;
+
+    if (::recvmsg(mSocket, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+    {
+      break;
+    }
+
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); NULL != cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+    {
+      if ((SOL_SOCKET == cmsg->cmsg_level) && (SCM_TIMESTAMPING == cmsg->cmsg_type))
+      {
+        (void) std::memcpy(&stamp, CMSG_DATA(cmsg), sizeof stamp);
+        haveStamp = true;
+      }
+      else if ((SOL_PACKET == cmsg->cmsg_level) && (PACKET_TX_TIMESTAMP == cmsg->cmsg_type))
+      {
+        struct sock_extended_err err;
+        (void) std::memcpy(&err, CMSG_DATA(cmsg), sizeof err);
+
+        if (SO_EE_ORIGIN_TXTIME == err.ee_origin)
+        {
+          if (SO_EE_CODE_TXTIME_MISSED == err.ee_code)
+          {
+            mMissedCount++;
+          }
+          else
+          {
+            mInvalidCount++;
+          }
+        }
+        else if (SO_EE_ORIGIN_TIMESTAMPING == err.ee_origin)
+        {
+          id = err.ee_data;
+          haveId = true;
+        }
+      }
+    }
+
+    if (haveStamp && haveId)
+    {
+      // ts[2] is the raw hardware time stamp, expected in CLOCK_TAI like the launch time, ts[0] is CLOCK_REALTIME
+      TxTimestamp txStamp;
+      txStamp.id = id;
+      if ((0 != stamp.ts[2].tv_sec) || (0 != stamp.ts[2].tv_nsec))
+      {
+        txStamp.time = uint64_t(stamp.ts[2].tv_sec) * uint64_t(1000000000u) + uint64_t(stamp.ts[2].tv_nsec)
+            - uint64_t(mClockOffset);
+      }
+      else
+      {
+        txStamp.time = uint64_t(stamp.ts[0].tv_sec) * uint64_t(1000000000u) + uint64_t(stamp.ts[0].tv_nsec)
+            - uint64_t(mRealtimeOffset);
+      }
+
+      if (mStamps.size() < cMaxStamps)
+      {
+        mStamps.push_back(txStamp);
+      }
+      else
+      {
+        mStampOverflowCount++;
+      }
+    }
+  }
+
+  if ((missedOld != mMissedCount) || (invalidOld != mInvalidCount))
+  {
+    DLT_LOG_CXX(*mLog, DLT_LOG_DEBUG, LOG_PREFIX, "frames dropped by qdisc: launch time missed",
+        mMissedCount, "invalid", mInvalidCount);
+  }
+}
+
+
+} // namespace IasMediaTransportAvb
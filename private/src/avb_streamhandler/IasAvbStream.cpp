@@ -29,6 +29,9 @@ static const std::string cClassName = "IasAvbStream::";
 IasAvbStream::IasAvbStream(DltContext &dltContext, const IasAvbStreamType streamType)
   : mDiag()
   , mCurrentAvbLockState(IasAvbClockDomain::eIasAvbLockStateInit)
+  , mPresentationLatency()
+  , mDispatchLatency()
+  , mLaunchLateness()
   , mLog(&dltContext)
   , mStreamStateInternal( IasAvbStreamState::eIasAvbStreamInactive )
   , mStreamType( streamType )
@@ -206,6 +209,7 @@ IasAvbProcessingResult IasAvbStream::initTransmit(const IasAvbTSpec & tSpec, con
       else
       {
         ret = mPacketPool->init( tSpec.getMaxFrameSize() + IasAvbTSpec::cIasAvbPerFrameOverhead, poolSize );
+        mPacketPool->setOwner(this);
       }
     }
 
@@ -305,41 +309,94 @@ void IasAvbStream::dispatchPacket(const void* packet, size_t length, uint64_t no
    {
      if (NULL != packet)
      {
-       const uint8_t* avtpBase8   = reinterpret_cast<const uint8_t*>(packet);
-       // If time stamp valid bit is set
-       if (avtpBase8[1] & 0x01)
-       {
-         const uint16_t* avtpBase16 = reinterpret_cast<const uint16_t*>(avtpBase8);
-         const uint32_t* avtpBase32 = reinterpret_cast<const uint32_t*>(avtpBase16);
-
-         // Handle wrap case
-         const int32_t delta = int32_t(ntohl(avtpBase32[3]) - static_cast<uint32_t>(now));
-
-         // @@DIAG check for early/late packets and increment counters
-         // Time stamp - now is -ve, packet is late.
-         if (delta < 0)
-         {
-           mDiag.setLateTimestamp(mDiag.getLateTimestamp()+1);
-
-         }
-         // Time stamp is further than maxTransitTime in the future
-         else if (delta > static_cast<int32_t>(mTSpec->getMaxTransitTime()))
-         {
-           mDiag.setEarlyTimestamp(mDiag.getEarlyTimestamp()+1);
-         }
-       }
+       checkPresentationTime(packet, now);
      }
      readFromAvbPacket(packet, length);
    }
 }
 
 
+void IasAvbStream::dispatchPackets(const RxPacket* packets, size_t count)
+{
+   if (isInitialized() && isReceiveStream() && (NULL != packets) && (0u != count))
+   {
+     for (size_t i = 0u; i < count; i++)
+     {
+       AVB_ASSERT(NULL != packets[i].packet);
+       checkPresentationTime(packets[i].packet, packets[i].now);
+     }
+     readFromAvbPackets(packets, count);
+   }
+}
+
+
+void IasAvbStream::readFromAvbPackets(const RxPacket* packets, size_t count)
+{
+   for (size_t i = 0u; i < count; i++)
+   {
+     readFromAvbPacket(packets[i].packet, packets[i].length);
+   }
+}
+
+
+void IasAvbStream::checkPresentationTime(const void* packet, uint64_t now)
+{
+   const uint8_t* avtpBase8   = reinterpret_cast<const uint8_t*>(packet);
+   // If time stamp valid bit is set
+   if (avtpBase8[1] & 0x01)
+   {
+     const uint16_t* avtpBase16 = reinterpret_cast<const uint16_t*>(avtpBase8);
+     const uint32_t* avtpBase32 = reinterpret_cast<const uint32_t*>(avtpBase16);
+
+     // Handle wrap case
+     const int32_t delta = int32_t(ntohl(avtpBase32[3]) - static_cast<uint32_t>(now));
+     mPresentationLatency.record(delta);
+
+     // @@DIAG check for early/late packets and increment counters
+     // Time stamp - now is -ve, packet is late.
+     if (delta < 0)
+     {
+       mDiag.setLateTimestamp(mDiag.getLateTimestamp()+1);
+
+     }
+     // Time stamp is further than maxTransitTime in the future
+     else if (delta > static_cast<int32_t>(mTSpec->getMaxTransitTime()))
+     {
+       mDiag.setEarlyTimestamp(mDiag.getEarlyTimestamp()+1);
+     }
+   }
+}
+
+
+void IasAvbStream::resetLatency()
+{
+  // the histograms are written by the worker serving the stream, which carries out the reset
+  mPresentationLatency.requestReset();
+  mDispatchLatency.requestReset();
+  mLaunchLateness.requestReset();
+}
+
+
 IasAvbProcessingResult IasAvbStream::resetPacketPool() const
 {
   AVB_ASSERT( NULL != mPacketPool );
   return mPacketPool->reset();
 }
 
+
+IasAvbProcessingResult IasAvbStream::attachPacketMemory() const
+{
+  AVB_ASSERT( NULL != mPacketPool );
+  return mPacketPool->attachMemory();
+}
+
+
+void IasAvbStream::releasePacketMemory() const
+{
+  AVB_ASSERT( NULL != mPacketPool );
+  mPacketPool->releaseMemory();
+}
+
 // @@DIAG handle STREAM_INTERRUPTED counter in the two methods below during case error handling
 
 void IasAvbStream::activate(bool isError)
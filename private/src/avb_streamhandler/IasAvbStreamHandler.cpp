@@ -266,6 +266,15 @@ IasAvbProcessingResult IasAvbStreamHandler::init( const std::string& configName,
         }
       }
       if (eIasAvbProcOK == result)
+      {
+        // the slab takes its pages from the igb device, if any
+        if (mEnvironment->createPacketSlab() != eIasAvbProcOK)
+        {
+          DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, " Creation of the packet slab failed");
+          result = eIasAvbProcInitializationFailed;
+        }
+      }
+      if (eIasAvbProcOK == result)
       {
         if (mBTMEnable)
         {
@@ -1538,6 +1547,69 @@ IasAvbResult IasAvbStreamHandler::getAvbStreamInfo(AudioStreamInfoList &audioStr
   return result;
 }
 
+IasAvbResult IasAvbStreamHandler::getStreamLatency(AvbStreamId streamId, IasAvbLatencyHistogram &presentationLatency,
+                                                   IasAvbLatencyHistogram &dispatchLatency, bool reset)
+{
+  IasAvbResult result = IasAvbResult::eIasAvbResultErr;
+
+  if (isInitialized())
+  {
+    lockApiMutex();
+
+    if ((NULL != mAvbReceiveEngine)
+        && mAvbReceiveEngine->getStreamLatency(IasAvbStreamId(streamId), presentationLatency, dispatchLatency, reset))
+    {
+      result = IasAvbResult::eIasAvbResultOk;
+    }
+
+    unlockApiMutex();
+  }
+
+  return result;
+}
+
+IasAvbResult IasAvbStreamHandler::getStreamLaunchLateness(AvbStreamId streamId, IasAvbLatencyHistogram &launchLateness,
+                                                          bool reset)
+{
+  IasAvbResult result = IasAvbResult::eIasAvbResultErr;
+
+  if (isInitialized())
+  {
+    lockApiMutex();
+
+    if ((NULL != mAvbTransmitEngine)
+        && mAvbTransmitEngine->getStreamLaunchLateness(IasAvbStreamId(streamId), launchLateness, reset))
+    {
+      result = IasAvbResult::eIasAvbResultOk;
+    }
+
+    unlockApiMutex();
+  }
+
+  return result;
+}
+
+IasAvbResult IasAvbStreamHandler::getClassLaunchLateness(IasAvbSrClass srClass, IasAvbLatencyHistogram &launchLateness,
+                                                         bool reset)
+{
+  IasAvbResult result = IasAvbResult::eIasAvbResultErr;
+
+  if (isInitialized())
+  {
+    lockApiMutex();
+
+    if ((NULL != mAvbTransmitEngine)
+        && mAvbTransmitEngine->getClassLaunchLateness(srClass, launchLateness, reset))
+    {
+      result = IasAvbResult::eIasAvbResultOk;
+    }
+
+    unlockApiMutex();
+  }
+
+  return result;
+}
+
 IasAvbResult IasAvbStreamHandler::getLocalStreamInfo(LocalAudioStreamInfoList &audioStreamInfo,
                                            LocalVideoStreamInfoList &videoStreamInfo)
 {
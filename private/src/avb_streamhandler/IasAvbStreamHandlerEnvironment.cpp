@@ -11,6 +11,7 @@
 
 #include "avb_streamhandler/IasAvbStreamHandlerEnvironment.hpp"
 #include "avb_streamhandler/IasDiaLogger.hpp"
+#include "avb_streamhandler/IasAvbPacketSlab.hpp"
 #include "avb_streamhandler/IasAvbTSpec.hpp"
 #include "avb_streamhandler/IasLocalAudioBufferDesc.hpp"
 #include "avb_watchdog/IasSystemdWatchdogManager.hpp"
@@ -98,6 +99,7 @@ IasAvbStreamHandlerEnvironment::IasAvbStreamHandlerEnvironment(DltLogLevelType d
   , mPtpProxy(NULL)
   , mMrpProxy(NULL)
   , mIgbDevice(NULL)
+  , mPacketSlab(NULL)
   , mStatusSocket(-1)
   , mRegistryLocked(false)
   , mTestingProfileEnabled(false)
@@ -147,6 +149,10 @@ IasAvbStreamHandlerEnvironment::~IasAvbStreamHandlerEnvironment()
 
   AVB_ASSERT(NULL == mMrpProxy); // not yet implemented, should not be set
 
+  // the slab may hold pages of the igb device
+  delete mPacketSlab;
+  mPacketSlab = NULL;
+
   if (NULL != mIgbDevice)
   {
     DLT_LOG_CXX(*mLog,  DLT_LOG_INFO, LOG_PREFIX, "igb_detach");
@@ -219,9 +225,17 @@ IasAvbProcessingResult IasAvbStreamHandlerEnvironment::createPtpProxy()
   {
     // shared memory object name can remain hard-coded for the time being
     mPtpProxy = new (nothrow) IasLibPtpDaemon("/ptp", static_cast<uint32_t>(SHM_SIZE));
+    uint64_t virtualStart = 0u;
+    (void) getConfigValue(IasRegKeys::cPtpVirtualClock, virtualStart);
+
     if (NULL != mPtpProxy)
     {
-      if (NULL == mIgbDevice)
+      if (0u != virtualStart)
+      {
+        // simulation: neither the PTP daemon nor the igb device are needed
+        ret = mPtpProxy->initVirtualClock(virtualStart);
+      }
+      else if ((NULL == mIgbDevice) && !isSocketTransmitBackend() && !isMemoryTransmitBackend())
       {
         // must create igb device first
         ret = eIasAvbProcInitializationFailed;
@@ -248,6 +262,37 @@ IasAvbProcessingResult IasAvbStreamHandlerEnvironment::createPtpProxy()
 }
 
 
+IasAvbProcessingResult IasAvbStreamHandlerEnvironment::createPacketSlab()
+{
+  IasAvbProcessingResult ret = eIasAvbProcOK;
+  uint64_t size = 0u;
+
+  (void) getConfigValue(IasRegKeys::cPacketPoolSlabSize, size);
+
+  if ((NULL == mPacketSlab) && (0u != size))
+  {
+    mPacketSlab = new (nothrow) IasAvbPacketSlab(*mLog);
+
+    if (NULL == mPacketSlab)
+    {
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "Not enough memory to allocate IasAvbPacketSlab");
+      ret = eIasAvbProcNotEnoughMemory;
+    }
+    else
+    {
+      ret = mPacketSlab->init(size_t(size));
+      if (eIasAvbProcOK != ret)
+      {
+        delete mPacketSlab;
+        mPacketSlab = NULL;
+      }
+    }
+  }
+
+  return ret;
+}
+
+
 IasAvbProcessingResult IasAvbStreamHandlerEnvironment::createMrpProxy()
 {
   return eIasAvbProcNotImplemented;
@@ -339,7 +384,21 @@ IasAvbProcessingResult IasAvbStreamHandlerEnvironment::createIgbDevice()
   IasAvbProcessingResult ret = eIasAvbProcOK;
   int32_t err = -1;
 
-  if (NULL == mIgbDevice)
+  if (isMemoryTransmitBackend())
+  {
+    // packets are recorded in memory, no network interface is needed at all
+    DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX, "memory transmit backend selected, igb device not attached");
+  }
+  else if (isSocketTransmitBackend())
+  {
+    // packets are sent through a socket, the network interface does not need to be an igb device
+    DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX, "socket transmit backend selected, igb device not attached");
+    if (eIasAvbProcOK != querySourceMac())
+    {
+      ret = eIasAvbProcInitializationFailed;
+    }
+  }
+  else if (NULL == mIgbDevice)
   {
     mIgbDevice = new (nothrow) device_t;
 
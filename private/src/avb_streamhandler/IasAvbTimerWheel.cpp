@@ -0,0 +1,216 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file    IasAvbTimerWheel.cpp
+ * @brief   This is the implementation of the IasAvbTimerWheel class.
+ * @date    2018
+ */
+
+#include "avb_streamhandler/IasAvbTimerWheel.hpp"
+
+
+namespace IasMediaTransportAvb
+{
+
+static const uint64_t cSlotMask = IasAvbTimerWheel::cSlots - 1u;
+static const uint64_t cWheelRange = uint64_t(1u) << (IasAvbTimerWheel::cSlotBits * IasAvbTimerWheel::cLevels);
+
+
+IasAvbTimerWheel::IasAvbTimerWheel()
+  : mTickNs(1u)
+  , mCurrentTick(0u)
+  , mSize(0u)
+  , mSlots()
+  , mCascade()
+{
+  // nothing to do
+}
+
+
+IasAvbTimerWheel::~IasAvbTimerWheel()
+{
+  // nothing to do
+}
+
+
+IasAvbProcessingResult IasAvbTimerWheel::init(uint64_t tickNs, uint64_t now)
+{
+  IasAvbProcessingResult result = eIasAvbProcOK;
+
+  if (0u == tickNs)
+  {
+    result = eIasAvbProcInvalidParam;
+  }
+  else
+  {
+    clear();
+    mTickNs = tickNs;
+    mCurrentTick = now / tickNs;
+  }
+
+  return result;
+}
+
+
+void IasAvbTimerWheel::clear()
+{
+  for (uint32_t level = 0u; level < cLevels; level++)
+  {
+    for (uint32_t slot = 0u; slot < cSlots; slot++)
+    {
+      mSlots[level][slot].clear();
+    }
+  }
+  mSize = 0u;
+}
+
+
+void IasAvbTimerWheel::add(uint64_t key, uint64_t deadline)
+{
+  Timer timer;
+  timer.key = key;
+  // round up, a timer must not expire early
+  timer.tick = (deadline / mTickNs) + ((0u != (deadline % mTickNs)) ? 1u : 0u);
+
+  insert(timer);
+}
+
+
+void IasAvbTimerWheel::insert(const Timer &timer)
+{
+  uint64_t tick = (timer.tick < mCurrentTick) ? mCurrentTick : timer.tick;
+  uint64_t delta = tick - mCurrentTick;
+
+  if (delta >= cWheelRange)
+  {
+    // out of range, park it in the last slot of the top level, it is re-inserted when that slot is cascaded
+    delta = cWheelRange - 1u;
+    tick = mCurrentTick + delta;
+  }
+
+  uint32_t level = 0u;
+  while ((level < (cLevels - 1u)) && (delta >= (uint64_t(1u) << (cSlotBits * (level + 1u)))))
+  {
+    level++;
+  }
+
+  const uint64_t slot = (tick >> (cSlotBits * level)) & cSlotMask;
+  mSlots[level][slot].push_back(timer);
+  mSize++;
+}
+
+
+void IasAvbTimerWheel::cascade(uint32_t level)
+{
+  const uint64_t slot = (mCurrentTick >> (cSlotBits * level)) & cSlotMask;
+
+  mCascade.swap(mSlots[level][slot]);
+  mSize -= uint32_t(mCascade.size());
+
+  for (Slot::const_iterator it = mCascade.begin(); mCascade.end() != it; it++)
+  {
+    insert(*it);
+  }
+  mCascade.clear();
+}
+
+
+uint32_t IasAvbTimerWheel::advance(uint64_t now, std::vector<uint64_t> &expired)
+{
+  uint32_t numExpired = 0u;
+  const uint64_t nowTick = now / mTickNs;
+
+  while ((mCurrentTick <= nowTick) && (0u != mSize))
+  {
+    if (0u == (mCurrentTick & cSlotMask))
+    {
+      // level 0 turned over, pull down the timers of the next slot of the higher levels
+      for (uint32_t level = 1u; level < cLevels; level++)
+      {
+        cascade(level);
+        if (0u != ((mCurrentTick >> (cSlotBits * level)) & cSlotMask))
+        {
+          break;
+        }
+      }
+    }
+
+    Slot &slot = mSlots[0][mCurrentTick & cSlotMask];
+    for (Slot::const_iterator it = slot.begin(); slot.end() != it; it++)
+    {
+      expired.push_back(it->key);
+    }
+    numExpired += uint32_t(slot.size());
+    mSize -= uint32_t(slot.size());
+    slot.clear();
+
+    mCurrentTick++;
+  }
+
+  if ((0u == mSize) && (mCurrentTick <= nowTick))
+  {
+    // nothing left to wait for, skip the empty ticks
+    mCurrentTick = nowTick + 1u;
+  }
+
+  return numExpired;
+}
+
+
+uint64_t IasAvbTimerWheel::getNextExpiry() const
+{
+  uint64_t ret = 0u;
+
+  if (0u != mSize)
+  {
+    // level 0 covers the next cSlots ticks, with exactly one turn of level 1 in between at most
+    const uint64_t end = mCurrentTick + cSlots;
+    uint64_t tick = mCurrentTick;
+    for (; tick < end; tick++)
+    {
+      if (((0u == (tick & cSlotMask)) && isCascadePending(tick)) || !mSlots[0][tick & cSlotMask].empty())
+      {
+        break;
+      }
+    }
+
+    if (tick == end)
+    {
+      // all timers are further away, wake up when level 1 turns the next time
+      tick = ((end - 1u) & ~cSlotMask) + cSlots;
+    }
+
+    ret = tick * mTickNs;
+  }
+
+  return ret;
+}
+
+
+bool IasAvbTimerWheel::isCascadePending(uint64_t tick) const
+{
+  bool ret = false;
+
+  // same walk as in advance()
+  for (uint32_t level = 1u; level < cLevels; level++)
+  {
+    const uint64_t slot = (tick >> (cSlotBits * level)) & cSlotMask;
+    if (!mSlots[level][slot].empty())
+    {
+      ret = true;
+      break;
+    }
+    if (0u != slot)
+    {
+      break;
+    }
+  }
+
+  return ret;
+}
+
+
+} // namespace IasMediaTransportAvb
@@ -21,6 +21,7 @@
 #include "avb_streamhandler/IasAvbStreamHandlerEventInterface.hpp"
 // TO BE REPLACED #include "core_libraries/btm/ias_dlt_btm.h"
 
+#include <algorithm>
 #include <sstream>
 #include <unistd.h>
 #include <errno.h>
@@ -45,11 +46,14 @@ static const std::string cClassName = "IasAvbTransmitEngine::";
  */
 IasAvbTransmitEngine::IasAvbTransmitEngine()
   : mIgbDevice(NULL)
+  , mBackendTransmit(false)
   , mAvbStreams()
   , mUseShaper(false)
   , mUseResume(false)
   , mRunning(false)
   , mSequencers() // inits to NULL
+  , mStreamSequencers()
+  , mMaxStreamsPerSequencer(0u)
   , mEventInterface(NULL)
   , mLog(&IasAvbStreamHandlerEnvironment::getDltContext("_TXE"))
   , mBTMEnable(false)
@@ -82,7 +86,9 @@ IasAvbProcessingResult IasAvbTransmitEngine::init()
   }
 
   mIgbDevice = IasAvbStreamHandlerEnvironment::getIgbDevice();
-  if (NULL == mIgbDevice)
+  mBackendTransmit = (NULL == mIgbDevice) && (IasAvbStreamHandlerEnvironment::isSocketTransmitBackend()
+                                               || IasAvbStreamHandlerEnvironment::isMemoryTransmitBackend());
+  if ((NULL == mIgbDevice) && !mBackendTransmit)
   {
     /**
      * @log Init failed: Returned igbDevice == NULL
@@ -103,7 +109,7 @@ IasAvbProcessingResult IasAvbTransmitEngine::init()
     (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cIgbAccessTimeoutCnt, timeoutCnt);
 
     // Retry until igb_avb is ready.
-    while ((0 != err) && (timeoutCnt > errCount))
+    while ((NULL != mIgbDevice) && (0 != err) && (timeoutCnt > errCount))
     {
       err = igb_set_class_bandwidth( mIgbDevice, 0u, 0u, 1500u, 64u ); /* Qav disabled*/
       if (0u != err)
@@ -123,8 +129,11 @@ IasAvbProcessingResult IasAvbTransmitEngine::init()
     }
   }
 
+  mMaxStreamsPerSequencer = 0u;
+  (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cXmitSeqMaxStreams, mMaxStreamsPerSequencer);
+
   // this should actually be redundant
-  for (uint32_t i = 0u; i < IasAvbTSpec::cIasAvbNumSupportedClasses; i++)
+  for (uint32_t i = 0u; i < cMaxSequencers; i++)
   {
     mSequencers[i] = NULL;
   }
@@ -140,11 +149,12 @@ void IasAvbTransmitEngine::cleanup()
 {
   (void) stop();
 
-  for (uint32_t i = 0u; i < IasAvbTSpec::cIasAvbNumSupportedClasses; i++)
+  for (uint32_t i = 0u; i < cMaxSequencers; i++)
   {
     delete mSequencers[i];
     mSequencers[i] = NULL;
   }
+  mStreamSequencers.clear();
 
   for (AvbStreamMap::iterator it = mAvbStreams.begin(); it != mAvbStreams.end(); it++)
   {
@@ -158,6 +168,7 @@ void IasAvbTransmitEngine::cleanup()
   }
 
   mIgbDevice = NULL;
+  mBackendTransmit = false;
   mAvbStreams.clear();
 }
 
@@ -207,15 +218,23 @@ IasAvbProcessingResult IasAvbTransmitEngine::unregisterEventInterface( IasAvbStr
 
 IasAvbTransmitSequencer * IasAvbTransmitEngine::getSequencerByStream(IasAvbStream *stream) const
 {
+  IasAvbTransmitSequencer * ret = NULL;
+
   AVB_ASSERT(NULL != stream);
-  return getSequencerByClass(stream->getTSpec().getClass());
+  AvbSequencerMap::const_iterator it = mStreamSequencers.find(stream);
+  if (mStreamSequencers.end() != it)
+  {
+    ret = it->second;
+  }
+
+  return ret;
 }
 
 IasAvbTransmitSequencer * IasAvbTransmitEngine::getSequencerByClass(IasAvbSrClass qavClass) const
 {
   IasAvbTransmitSequencer * ret = NULL;
 
-  for (uint32_t i = 0u; i < IasAvbTSpec::cIasAvbNumSupportedClasses; i++)
+  for (uint32_t i = 0u; i < cMaxSequencers; i++)
   {
     if ((NULL == mSequencers[i]) || (mSequencers[i]->getClass() == qavClass))
     {
@@ -241,7 +260,7 @@ void IasAvbTransmitEngine::updateLinkStatus(const bool linkIsUp)
     if (mUseShaper)
     {
       // after link is back, igb_avb will reset the shapers
-      for (uint32_t i = 0u; i < IasAvbTSpec::cIasAvbNumSupportedClasses; i++)
+      for (uint32_t i = 0u; i < cMaxSequencers; i++)
       {
         IasAvbTransmitSequencer *seq = mSequencers[i];
         if (NULL != seq)
@@ -261,7 +280,7 @@ void IasAvbTransmitEngine::updateLinkStatus(const bool linkIsUp)
                 strerror(err));
         }
       }
-      else
+      else if (!mBackendTransmit)
       {
         DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "mIgbDevice == NULL!");
       }
@@ -331,7 +350,7 @@ IasAvbProcessingResult IasAvbTransmitEngine::start()
     }
     mUseResume = true;
 
-    for (uint32_t i = 0u; (i < IasAvbTSpec::cIasAvbNumSupportedClasses) && (eIasAvbProcOK == result); i++)
+    for (uint32_t i = 0u; (i < cMaxSequencers) && (eIasAvbProcOK == result); i++)
     {
       IasAvbTransmitSequencer *seq = mSequencers[i];
       if (NULL != seq)
@@ -379,7 +398,7 @@ IasAvbProcessingResult IasAvbTransmitEngine::stop()
   }
   else
   {
-    for (uint32_t i = 0u; i < IasAvbTSpec::cIasAvbNumSupportedClasses; i++)
+    for (uint32_t i = 0u; i < cMaxSequencers; i++)
     {
       IasAvbTransmitSequencer *seq = mSequencers[i];
       if (NULL != seq)
@@ -408,12 +427,35 @@ IasAvbProcessingResult IasAvbTransmitEngine::createSequencerOnDemand(IasAvbSrCla
 
   AVB_ASSERT(isInitialized());
 
-  // sequencer already existing?
-  if (NULL == getSequencerByClass(qavClass))
+  if (static_cast<uint32_t>(qavClass) >= IasAvbTSpec::cIasAvbNumSupportedClasses)
+  {
+    DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "Trying to create TX sequencers for more than", int32_t(IasAvbTSpec::cIasAvbNumSupportedClasses), "SR classes");
+    result = eIasAvbProcNoSpaceLeft;
+  }
+  // sequencers already existing?
+  else if (NULL == getSequencerByClass(qavClass))
   {
+    const char * const suffix = IasAvbTSpec::getClassSuffix(qavClass);
+    uint32_t count = 1u;
+    (void) IasAvbStreamHandlerEnvironment::getConfigValue(std::string(IasRegKeys::cXmitSeqCount) + suffix, count);
+
+    if ((0u == count) || (count > cMaxSequencersPerClass))
+    {
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "bad number of TX sequencers for class", suffix, ":", count);
+      result = eIasAvbProcInvalidParam;
+    }
+    else if ((count > 1u) && !mBackendTransmit)
+    {
+      /**
+       * @log libigb has a single Qav queue per SR class, the launch times of which have to be in order.
+       */
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "more than one TX sequencer per class needs a transmit backend");
+      result = eIasAvbProcInvalidParam;
+    }
+
     // search list for free entry
     uint32_t i;
-    for (i = 0u; i < IasAvbTSpec::cIasAvbNumSupportedClasses; i++)
+    for (i = 0u; i < cMaxSequencers; i++)
     {
       if (NULL == mSequencers[i])
       {
@@ -421,73 +463,86 @@ IasAvbProcessingResult IasAvbTransmitEngine::createSequencerOnDemand(IasAvbSrCla
       }
     }
 
-    if (IasAvbTSpec::cIasAvbNumSupportedClasses == i)
+    /*
+     *  determine I210 queue for this SR class: "high" class always goes to Q0, "low" class B always to Q1
+     */
+    uint32_t q = 0;
+    std::string dltCtxName = "_TX";
+    switch (qavClass)
     {
-      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "Trying to create TX sequencers for more than", int32_t(IasAvbTSpec::cIasAvbNumSupportedClasses), "SR classes");
-      result = eIasAvbProcNoSpaceLeft;
+    case IasAvbSrClass::eIasAvbSrClassHigh:
+      dltCtxName += "1";
+      q = 0u;
+      break;
+
+    case IasAvbSrClass::eIasAvbSrClassLow:
+      dltCtxName += "2";
+      q = 1u;
+      break;
+
+    default:
+      result = eIasAvbProcErr;
+      AVB_ASSERT(false);
     }
 
     if (eIasAvbProcOK == result)
     {
-      /*
-       *  determine I210 queue for this SR class: "high" class always goes to Q0, "low" class B always to Q1
-       */
-      uint32_t q = 0;
-      std::string dltCtxName = "_TX";
-      switch (qavClass)
-      {
-      case IasAvbSrClass::eIasAvbSrClassHigh:
-        dltCtxName += "1";
-        q = 0u;
-        break;
+      // the entries are filled without gaps, so the array always has room for all sequencers of a class
+      AVB_ASSERT((i + count) <= cMaxSequencers);
+      const uint32_t first = i;
 
-      case IasAvbSrClass::eIasAvbSrClassLow:
-        dltCtxName += "2";
-        q = 1u;
-        break;
-
-      default:
-        result = eIasAvbProcErr;
-        AVB_ASSERT(false);
-      }
+      for (uint32_t instance = 0u; (instance < count) && (eIasAvbProcOK == result); instance++, i++)
+      {
+        uint32_t queue = q;
+        (void) IasAvbStreamHandlerEnvironment::getConfigValue(std::string(IasRegKeys::cXmitSeqQueue) + suffix + "."
+                                                              + std::to_string(instance), queue);
 
-      DltContext &ctx = IasAvbStreamHandlerEnvironment::getDltContext(dltCtxName);
-      IasAvbTransmitSequencer *seq = new (nothrow) IasAvbTransmitSequencer(ctx);
+        DltContext &ctx = IasAvbStreamHandlerEnvironment::getDltContext(dltCtxName);
+        IasAvbTransmitSequencer *seq = new (nothrow) IasAvbTransmitSequencer(ctx);
 
-      if (NULL == seq)
-      {
-        DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "Couldn't create transmit sequencer");
-        result = eIasAvbProcNotEnoughMemory;
-      }
-      else
-      {
-        if (eIasAvbProcOK == result)// does this condition make sense here with assert in line 449?
+        if (NULL == seq)
         {
-          result = seq->init(q, qavClass, (i == 0u));
+          DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "Couldn't create transmit sequencer");
+          result = eIasAvbProcNotEnoughMemory;
         }
-
-        // use the first sequencer created to get link status events
-        if ((0u == i) && (eIasAvbProcOK == result))
+        else
         {
-          result = seq->registerEventInterface(this);
-        }
+          result = seq->init(queue, qavClass, (i == 0u), instance);
 
-        if ((eIasAvbProcOK == result) && isRunning())
-        {
-          result = seq->start();
-        }
+          // use the first sequencer created to get link status events
+          if ((0u == i) && (eIasAvbProcOK == result))
+          {
+            result = seq->registerEventInterface(this);
+          }
 
-        if (eIasAvbProcOK == result)
-        {
-          mSequencers[i] = seq;
-          if (mBTMEnable)
+          if ((eIasAvbProcOK == result) && isRunning())
           {
-            // TO BE REPLACED ias_dlt_log_btm_mark(mLog, "avb started TX sequencer on demand",NULL);
+            result = seq->start();
+          }
+
+          if (eIasAvbProcOK == result)
+          {
+            mSequencers[i] = seq;
+            DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX, "TX sequencer", instance, "of class", suffix, "on queue", queue);
+            if (mBTMEnable)
+            {
+              // TO BE REPLACED ias_dlt_log_btm_mark(mLog, "avb started TX sequencer on demand",NULL);
+            }
+          }
+          else
+          {
+            delete seq;
           }
         }
-        else
+      }
+
+      if (eIasAvbProcOK != result)
+      {
+        // all or none of the sequencers of a class
+        for (i = first; (i < cMaxSequencers) && (NULL != mSequencers[i]); i++)
         {
-          delete seq;
+          delete mSequencers[i];
+          mSequencers[i] = NULL;
         }
       }
     }
@@ -496,6 +551,58 @@ IasAvbProcessingResult IasAvbTransmitEngine::createSequencerOnDemand(IasAvbSrCla
 }
 
 
+IasAvbProcessingResult IasAvbTransmitEngine::placeStream(IasAvbStream *stream)
+{
+  IasAvbProcessingResult result = eIasAvbProcOK;
+  IasAvbTransmitSequencer *best = NULL;
+  uint64_t bestLoad = 0u;
+
+  AVB_ASSERT(NULL != stream);
+  const IasAvbSrClass qavClass = stream->getTSpec().getClass();
+
+  for (uint32_t i = 0u; (i < cMaxSequencers) && (NULL != mSequencers[i]); i++)
+  {
+    IasAvbTransmitSequencer * const seq = mSequencers[i];
+    if (seq->getClass() == qavClass)
+    {
+      uint32_t numStreams = 0u;
+      uint64_t load = 0u;
+      for (AvbSequencerMap::const_iterator it = mStreamSequencers.begin(); it != mStreamSequencers.end(); it++)
+      {
+        if (seq == it->second)
+        {
+          numStreams++;
+          load += it->first->getTSpec().getRequiredBandwidth();
+        }
+      }
+
+      // on equal load, the sequencer created first wins
+      if (((0u == mMaxStreamsPerSequencer) || (numStreams < mMaxStreamsPerSequencer))
+          && ((NULL == best) || (load < bestLoad)))
+      {
+        best = seq;
+        bestLoad = load;
+      }
+    }
+  }
+
+  if (NULL == best)
+  {
+    /**
+     * @log All sequencers of the class hold transmit.sequencer.maxstreams streams already.
+     */
+    DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "no TX sequencer left for class",
+        IasAvbTSpec::getClassSuffix(qavClass));
+    result = eIasAvbProcNoSpaceLeft;
+  }
+  else
+  {
+    mStreamSequencers[stream] = best;
+  }
+
+  return result;
+}
+
 
 IasAvbProcessingResult IasAvbTransmitEngine::createTransmitAudioStream(IasAvbSrClass srClass,
                                             uint16_t const maxNumberChannels,
@@ -531,6 +638,11 @@ IasAvbProcessingResult IasAvbTransmitEngine::createTransmitAudioStream(IasAvbSrC
         result = createSequencerOnDemand(newAudioStream->getTSpec().getClass());
       }
 
+      if (eIasAvbProcOK == result)
+      {
+        result = placeStream(newAudioStream);
+      }
+
       if (eIasAvbProcOK == result)
       {
         // add stream to vector
@@ -593,6 +705,11 @@ IasAvbProcessingResult IasAvbTransmitEngine::createTransmitVideoStream(IasAvbSrC
         result = createSequencerOnDemand(newVideoStream->getTSpec().getClass());
       }
 
+      if (eIasAvbProcOK == result)
+      {
+        result = placeStream(newVideoStream);
+      }
+
       if (eIasAvbProcOK == result)
       {
         // add stream to vector
@@ -652,6 +769,11 @@ IasAvbProcessingResult IasAvbTransmitEngine::createTransmitClockReferenceStream(
         result = createSequencerOnDemand(newStream->getTSpec().getClass());
       }
 
+      if (eIasAvbProcOK == result)
+      {
+        result = placeStream(newStream);
+      }
+
       if (eIasAvbProcOK == result)
       {
         // add stream to vector
@@ -692,6 +814,7 @@ IasAvbProcessingResult IasAvbTransmitEngine::destroyAvbStream(IasAvbStreamId con
     if (eIasAvbProcOK == result)
     {
       mAvbStreams.erase(streamId);
+      (void) mStreamSequencers.erase(avbStream);
 
       delete avbStream;
     }
@@ -717,7 +840,17 @@ IasAvbProcessingResult IasAvbTransmitEngine::activateAvbStream(IasAvbStreamId co
       IasAvbTransmitSequencer *seq = getSequencerByStream(stream);
       AVB_ASSERT(NULL != seq);
 
-      result = seq->addStreamToTransmitList(stream);
+      // with the shared packet slab, the pool only has its reserved packets while inactive
+      result = stream->attachPacketMemory();
+
+      if (eIasAvbProcOK == result)
+      {
+        result = seq->addStreamToTransmitList(stream);
+        if (eIasAvbProcOK != result)
+        {
+          stream->releasePacketMemory();
+        }
+      }
 
       if (eIasAvbProcOK == result)
       {
@@ -725,11 +858,7 @@ IasAvbProcessingResult IasAvbTransmitEngine::activateAvbStream(IasAvbStreamId co
 
         if ((mUseShaper) && (IasAvbSrClass::eIasAvbSrClassHigh == seq->getClass()))
         {
-          IasAvbTransmitSequencer *seqLow = getSequencerByClass(IasAvbSrClass::eIasAvbSrClassLow);
-          if (NULL != seqLow)
-          {
-            seqLow->setMaxFrameSizeHigh(seq->getMaxFrameSizeHigh());
-          }
+          updateShapersLow();
         }
       }
     }
@@ -765,6 +894,8 @@ IasAvbProcessingResult IasAvbTransmitEngine::deactivateAvbStream(IasAvbStreamId
 
       if (result == eIasAvbProcOK)
       {
+        stream->releasePacketMemory();
+
         if (stream->isActive())
         {
           /*
@@ -787,11 +918,7 @@ IasAvbProcessingResult IasAvbTransmitEngine::deactivateAvbStream(IasAvbStreamId
 
         if ((mUseShaper) && (IasAvbSrClass::eIasAvbSrClassHigh == seq->getClass()))
         {
-          IasAvbTransmitSequencer *seqLow = getSequencerByClass(IasAvbSrClass::eIasAvbSrClassLow);
-          if (NULL != seqLow)
-          {
-            seqLow->setMaxFrameSizeHigh(seq->getMaxFrameSizeHigh());
-          }
+          updateShapersLow();
         }
       }
       else
@@ -813,7 +940,7 @@ void IasAvbTransmitEngine::updateShapers()
 {
   uint32_t bwHigh = 0;
   uint32_t bwLow = 0;
-  for (uint32_t i = 0u; i < IasAvbTSpec::cIasAvbNumSupportedClasses; i++)
+  for (uint32_t i = 0u; i < cMaxSequencers; i++)
   {
     IasAvbTransmitSequencer *seq = mSequencers[i];
     if (NULL != seq)
@@ -821,11 +948,11 @@ void IasAvbTransmitEngine::updateShapers()
       switch (seq->getClass())
       {
       case IasAvbSrClass::eIasAvbSrClassHigh:
-        bwHigh = seq->getCurrentBandwidth();
+        bwHigh += seq->getCurrentBandwidth();
         break;
 
       case IasAvbSrClass::eIasAvbSrClassLow:
-        bwLow = seq->getCurrentBandwidth();
+        bwLow += seq->getCurrentBandwidth();
         break;
 
       default:
@@ -857,15 +984,49 @@ void IasAvbTransmitEngine::updateShapers()
     bwLow = (bwLow + 3999u) / 4000u;
   }
 
-  /* hack: call the igb function with a pseudo packet size of 83 bytes payload, since this would results
-   * in a packet on the wire of exactly 1000bits, which enables us to use the class_a and class_b
-   * parameters to specify the bandwidth in kbit/observationInterval
-   */
-  const int32_t err = igb_set_class_bandwidth(mIgbDevice, bwHigh, bwLow, 83u, 83u);
-  if (err < 0)
+  if (NULL == mIgbDevice)
+  {
+    // socket transmit backend: shaping is up to the qdisc (cbs, taprio) configured on the interface
+    DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX, "no igb device, shaper not configured");
+  }
+  else
+  {
+    /* hack: call the igb function with a pseudo packet size of 83 bytes payload, since this would results
+     * in a packet on the wire of exactly 1000bits, which enables us to use the class_a and class_b
+     * parameters to specify the bandwidth in kbit/observationInterval
+     */
+    const int32_t err = igb_set_class_bandwidth(mIgbDevice, bwHigh, bwLow, 83u, 83u);
+    if (err < 0)
+    {
+        DLT_LOG_CXX(*mLog, DLT_LOG_WARN, LOG_PREFIX, "Couldn't configure shaper: ",
+            strerror(err));
+    }
+  }
+}
+
+void IasAvbTransmitEngine::updateShapersLow()
+{
+  // the high class may be spread over several sequencers
+  uint32_t maxFrameSizeHigh = 0u;
+  uint32_t bwHigh = 0u;
+  for (uint32_t i = 0u; (i < cMaxSequencers) && (NULL != mSequencers[i]); i++)
+  {
+    IasAvbTransmitSequencer *seq = mSequencers[i];
+    if (IasAvbSrClass::eIasAvbSrClassHigh == seq->getClass())
+    {
+      maxFrameSizeHigh = std::max(maxFrameSizeHigh, seq->getMaxFrameSizeHigh());
+      bwHigh += seq->getCurrentBandwidth();
+    }
+  }
+
+  for (uint32_t i = 0u; (i < cMaxSequencers) && (NULL != mSequencers[i]); i++)
   {
-      DLT_LOG_CXX(*mLog, DLT_LOG_WARN, LOG_PREFIX, "Couldn't configure shaper: ",
-          strerror(err));
+    IasAvbTransmitSequencer *seq = mSequencers[i];
+    if (IasAvbSrClass::eIasAvbSrClassLow == seq->getClass())
+    {
+      seq->setMaxFrameSizeHigh(maxFrameSizeHigh);
+      seq->setBandwidthHigh(bwHigh);
+    }
   }
 }
 
@@ -1150,4 +1311,54 @@ bool IasAvbTransmitEngine::getAvbStreamInfo(const IasAvbStreamId &id,
 
 }
 
+bool IasAvbTransmitEngine::getStreamLaunchLateness(const IasAvbStreamId &id, IasAvbLatencyHistogram &launchLateness,
+                                                   bool reset)
+{
+  bool found = false;
+
+  AvbStreamMap::iterator it = mAvbStreams.find(id);
+  if (mAvbStreams.end() != it)
+  {
+    IasAvbStream *stream = it->second;
+    AVB_ASSERT(NULL != stream);
+    // the sequencer reclaiming the stream's packets keeps recording
+    stream->getLaunchLateness().snapshot(launchLateness);
+    if (reset)
+    {
+      stream->resetLatency();
+    }
+    found = true;
+  }
+
+  return found;
+}
+
+bool IasAvbTransmitEngine::getClassLaunchLateness(IasAvbSrClass srClass, IasAvbLatencyHistogram &launchLateness,
+                                                  bool reset)
+{
+  bool ret = false;
+
+  if (isInitialized() && (uint32_t(srClass) < IasAvbTSpec::cIasAvbNumSupportedClasses))
+  {
+    // with libigb, the packets of all classes are reclaimed by a single sequencer
+    launchLateness.reset();
+    for (uint32_t i = 0u; i < cMaxSequencers; i++)
+    {
+      if (NULL != mSequencers[i])
+      {
+        IasAvbLatencyHistogram lateness;
+        mSequencers[i]->getLaunchLateness(srClass).snapshot(lateness);
+        launchLateness.merge(lateness);
+        if (reset)
+        {
+          mSequencers[i]->resetLaunchLateness(srClass);
+        }
+      }
+    }
+    ret = true;
+  }
+
+  return ret;
+}
+
 } // namespace IasMediaTransportAvb
@@ -18,6 +18,8 @@
 #include "avb_streamhandler/IasAvbVideoStream.hpp"
 #include "avb_streamhandler/IasAvbPacket.hpp"
 #include "avb_streamhandler/IasAvbPacketPool.hpp"
+#include "avb_streamhandler/IasAvbSocketTransmitBackend.hpp"
+#include "avb_streamhandler/IasAvbMemoryTransmitBackend.hpp"
 #include "lib_ptp_daemon/IasLibPtpDaemon.hpp"
 #include "avb_streamhandler/IasAvbStreamHandlerEventInterface.hpp"
 // TO BE REPLACED #include "core_libraries/btm/ias_dlt_btm.h"
@@ -58,17 +60,31 @@ IasAvbTransmitSequencer::IasAvbTransmitSequencer(DltContext &ctx)
   : mThreadControl(0u)
   , mTransmitThread(NULL)
   , mIgbDevice(NULL)
+  , mBackend(NULL)
   , mQueueIndex(uint32_t(-1))
   , mClass(IasAvbSrClass::eIasAvbSrClassHigh)
-  , mRequestCount(0)
-  , mResponseCount(0)
+  , mInstance(0u)
+  , mCpu(-1)
   , mCurrentBandwidth(0u)
   , mCurrentMaxIntervalFrames(0u)
   , mMaxFrameSizeHigh(0u)
   , mUseShaper(false)
   , mShaperBwRate(100u)
+  , mBandwidthHigh(0u)
+  , mSwShaper()
+  , mSwShaperConfig()
+  , mWindowTuner()
+  , mSwShaperChanged(false)
+  , mSwShaperLock()
   , mSequence()
+  , mBatch()
+  , mTxRecords()
+  , mTxRecordCount(0u)
+  , mPrerenderers()
   , mActiveStreams()
+  , mCommands()
+  , mCommandCount(0u)
+  , mCommandsDone(0u)
   , mDoReclaim(false)
   , mLock()
   , mEventInterface(NULL)
@@ -76,7 +92,6 @@ IasAvbTransmitSequencer::IasAvbTransmitSequencer(DltContext &ctx)
   , mWatchdog(NULL)
   , mFirstRun(true)
   , mBTMEnable(false)
-  , mStrictPktOrderEn(true)
 {
   DLT_LOG_CXX(*mLog, DLT_LOG_VERBOSE, LOG_PREFIX);
 }
@@ -86,6 +101,9 @@ IasAvbTransmitSequencer::Config::Config()
   , txWindowWidth(txWindowWidthInit)
   , txWindowPitchInit(16u * 125000u)
   , txWindowPitch(txWindowPitchInit)
+  , txWindowAuto(0u)
+  , txWindowWidthMax(0u)
+  , txWindowPitchMax(0u)
   , txWindowCueThreshold(8u * 125000u)
   , txWindowResetThreshold(32u * 125000u)
   , txWindowPrefetchThreshold(1000000000u)
@@ -93,6 +111,12 @@ IasAvbTransmitSequencer::Config::Config()
   , txWindowMaxDropCount(8000u)
   , txDelay(100000u)
   , txMaxBandwidth(70000u)
+  , txMaxStreams(256u)
+  , txBatchSize(64u)
+  , txPrerenderWorkers(0u)
+  , txPrerenderLead(0u)
+  , txPrerenderDepth(32u)      // below the 60 packets of an audio stream, a deeper queue is not rendered ahead
+  , txTimestamps(0u)
 {
   // do nothing
 }
@@ -104,7 +128,6 @@ IasAvbTransmitSequencer::Diag::Diag()
   , reordered(0u)
   , debugOutputCount(0u)
   , debugErrCount(0u)
-  , debugSkipCount(0u)
   , debugTimingViolation(0u)
   , avgPacketSent(0.0f)
   , avgPacketReclaim(0.0f)
@@ -128,10 +151,16 @@ IasAvbTransmitSequencer::~IasAvbTransmitSequencer()
 /*
  *  Initialization method.
  */
-IasAvbProcessingResult IasAvbTransmitSequencer::init(uint32_t queueIndex, IasAvbSrClass qavClass, bool doReclaim)
+IasAvbProcessingResult IasAvbTransmitSequencer::init(uint32_t queueIndex, IasAvbSrClass qavClass, bool doReclaim,
+                                                     uint32_t instance)
 {
   IasAvbProcessingResult result = eIasAvbProcOK;
   const char * const suffix = IasAvbTSpec::getClassSuffix(qavClass);
+  // further sequencers of a class are told apart by their index
+  const std::string name = std::string(suffix) + ((0u == instance) ? std::string() : std::to_string(instance));
+  std::string backend;
+  const bool useBackend = IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cXmitBackend, backend)
+      && ("igb" != backend);
 
   DLT_LOG_CXX(*mLog, DLT_LOG_VERBOSE, LOG_PREFIX);
 
@@ -142,14 +171,15 @@ IasAvbProcessingResult IasAvbTransmitSequencer::init(uint32_t queueIndex, IasAvb
     result = eIasAvbProcInitializationFailed;
   }
 
-  if ((queueIndex > 1u) || (static_cast<uint32_t>(qavClass) >= IasAvbTSpec::cIasAvbNumSupportedClasses))
+  // libigb only shapes the first two queues
+  if (((queueIndex > 1u) && !useBackend) || (static_cast<uint32_t>(qavClass) >= IasAvbTSpec::cIasAvbNumSupportedClasses))
   {
     result = eIasAvbProcInvalidParam;
   }
 
   if (eIasAvbProcOK == result)
   {
-    mTransmitThread = new (nothrow) IasThread(this, std::string("AvbTxWrk") + suffix);
+    mTransmitThread = new (nothrow) IasThread(this, std::string("AvbTxWrk") + name);
     if (NULL == mTransmitThread)
     {
       /**
@@ -164,12 +194,55 @@ IasAvbProcessingResult IasAvbTransmitSequencer::init(uint32_t queueIndex, IasAvb
   {
     mClass = qavClass;
     mQueueIndex = queueIndex;
+    mInstance = instance;
     mDoReclaim = doReclaim;
     mIgbDevice = IasAvbStreamHandlerEnvironment::getIgbDevice();
-    AVB_ASSERT(NULL != mIgbDevice);
+
+    mCpu = -1;
+    (void) IasAvbStreamHandlerEnvironment::getConfigValue(std::string(IasRegKeys::cXmitSeqCpu) + suffix + "."
+                                                          + std::to_string(instance), mCpu);
+
+    if (useBackend)
+    {
+      if (("socket" == backend) || ("memory" == backend))
+      {
+        if ("socket" == backend)
+        {
+          mBackend = new (nothrow) IasAvbSocketTransmitBackend(*mLog);
+        }
+        else
+        {
+          mBackend = new (nothrow) IasAvbMemoryTransmitBackend(*mLog);
+        }
+
+        if (NULL == mBackend)
+        {
+          DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "Couldn't create transmit backend!");
+          result = eIasAvbProcNotEnoughMemory;
+        }
+        else
+        {
+          result = mBackend->init(queueIndex, qavClass);
+        }
+      }
+      else
+      {
+        DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "unknown transmit backend:", backend.c_str());
+        result = eIasAvbProcInvalidParam;
+      }
+    }
+    else
+    {
+      AVB_ASSERT(NULL != mIgbDevice);
+    }
 
     (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cXmitWndWidth, mConfig.txWindowWidthInit);
     (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cXmitWndPitch, mConfig.txWindowPitchInit);
+    (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cXmitWndAuto, mConfig.txWindowAuto);
+    mConfig.txWindowWidthMax = 2u * mConfig.txWindowWidthInit;
+    (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cXmitWndWidthMax, mConfig.txWindowWidthMax);
+    mConfig.txWindowPitchMax = mConfig.txWindowPitchInit;
+    (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cXmitWndPitchMax, mConfig.txWindowPitchMax);
     (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cXmitCueThresh, mConfig.txWindowCueThreshold);
     (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cXmitResetThresh, mConfig.txWindowResetThreshold);
     (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cXmitResetMaxCount, mConfig.txWindowMaxResetCount);
@@ -177,6 +250,13 @@ IasAvbProcessingResult IasAvbTransmitSequencer::init(uint32_t queueIndex, IasAvb
     (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cXmitPrefetchThresh, mConfig.txWindowPrefetchThreshold);
     (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cXmitDelay, mConfig.txDelay );
     (void) IasAvbStreamHandlerEnvironment::getConfigValue(std::string(IasRegKeys::cTxMaxBw) + suffix, mConfig.txMaxBandwidth );
+    (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cXmitMaxStreams, mConfig.txMaxStreams);
+    (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cXmitBatchSize, mConfig.txBatchSize);
+    (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cXmitPrerenderWorkers, mConfig.txPrerenderWorkers);
+    (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cXmitPrerenderDepth, mConfig.txPrerenderDepth);
+    mConfig.txPrerenderLead = mConfig.txWindowWidthInit + mConfig.txWindowPitchInit;
+    (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cXmitPrerenderLead, mConfig.txPrerenderLead);
+    (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cXmitTimestamps, mConfig.txTimestamps);
 
     if ((mConfig.txWindowWidthInit < mConfig.txWindowPitchInit)
         || (mConfig.txWindowWidthInit < cMinTxWindowWidth)
@@ -188,6 +268,133 @@ IasAvbProcessingResult IasAvbTransmitSequencer::init(uint32_t queueIndex, IasAvb
           "pitch =", mConfig.txWindowPitchInit);
       result = eIasAvbProcInitializationFailed;
     }
+    else if ((0u == mConfig.txMaxStreams) || (mConfig.txMaxStreams > cMaxStreams))
+    {
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "bad max number of streams:", mConfig.txMaxStreams);
+      result = eIasAvbProcInitializationFailed;
+    }
+    else if (eIasAvbProcOK == result)
+    {
+      // the sequence never grows beyond this, so the TX thread does not need to allocate memory
+      result = mSequence.init(uint32_t(mConfig.txMaxStreams));
+      if (eIasAvbProcOK == result)
+      {
+        // room for a reset and an add of each stream, plus the changes of one TX window
+        result = mCommands.init(2u * uint32_t(mConfig.txMaxStreams) + 1u);
+      }
+    }
+
+    if (NULL == mBackend)
+    {
+      // libigb takes one packet at a time
+      mConfig.txBatchSize = 0u;
+    }
+    else if (mConfig.txBatchSize > cMaxBatchSize)
+    {
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "bad batch size:", mConfig.txBatchSize);
+      result = eIasAvbProcInitializationFailed;
+    }
+    else
+    {
+      mBatch.reserve(size_t(mConfig.txBatchSize));
+    }
+
+    if (mConfig.txPrerenderWorkers > cMaxPrerenderWorkers)
+    {
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "bad number of render workers:", mConfig.txPrerenderWorkers);
+      result = eIasAvbProcInitializationFailed;
+    }
+    else if (mConfig.txPrerenderDepth > uint64_t(uint32_t(-1)))
+    {
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "bad render depth:", mConfig.txPrerenderDepth);
+      result = eIasAvbProcInitializationFailed;
+    }
+    else if ((0u != mConfig.txPrerenderWorkers) && (NULL != IasAvbStreamHandlerEnvironment::getPtpProxy())
+             && IasAvbStreamHandlerEnvironment::getPtpProxy()->isVirtualClock())
+    {
+      // the render workers are paced by the system clock, they would not keep up with the virtual clock
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "render workers not supported with the virtual clock");
+      result = eIasAvbProcInitializationFailed;
+    }
+    else if ((0u != mConfig.txPrerenderWorkers) && (mConfig.txPrerenderLead < mConfig.txWindowWidthInit))
+    {
+      // the packets of a window would not be ready when the TX thread needs them
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "render lead time", mConfig.txPrerenderLead,
+          "less than TX window width", mConfig.txWindowWidthInit);
+      result = eIasAvbProcInitializationFailed;
+    }
+    else
+    {
+      for (uint32_t i = 0u; (eIasAvbProcOK == result) && (i < mConfig.txPrerenderWorkers); i++)
+      {
+        IasAvbPacketPrerenderer *worker = new (nothrow) IasAvbPacketPrerenderer(*mLog);
+        if (NULL == worker)
+        {
+          DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "Couldn't create render worker!");
+          result = eIasAvbProcNotEnoughMemory;
+        }
+        else
+        {
+          mPrerenderers.push_back(worker);
+          result = worker->init(std::string("AvbTxRnd") + name + std::to_string(i), mConfig.txPrerenderLead,
+              mConfig.txWindowPitchInit, uint32_t(mConfig.txPrerenderDepth));
+          if (eIasAvbProcOK != result)
+          {
+            DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "bad render worker parameters: lead =",
+                mConfig.txPrerenderLead, "depth =", mConfig.txPrerenderDepth);
+          }
+        }
+      }
+    }
+
+    if ((0u != mConfig.txWindowAuto) && (eIasAvbProcOK == result))
+    {
+      if ((0u != mConfig.txPrerenderWorkers) && (mConfig.txWindowWidthMax > mConfig.txPrerenderLead))
+      {
+        // the render workers have to stay ahead of the widest window
+        DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX, "max TX window width limited to render lead time",
+            mConfig.txPrerenderLead);
+        mConfig.txWindowWidthMax = mConfig.txPrerenderLead;
+      }
+
+      IasAvbTransmitWindowTuner::Config tunerConfig;
+      tunerConfig.widthInit = mConfig.txWindowWidthInit;
+      tunerConfig.pitchInit = mConfig.txWindowPitchInit;
+      tunerConfig.widthMax = mConfig.txWindowWidthMax;
+      tunerConfig.pitchMin = cMinTxWindowPitch;
+      tunerConfig.pitchMax = mConfig.txWindowPitchMax;
+      tunerConfig.minSlack = cMinTxWindowWidth - cMinTxWindowPitch;
+      tunerConfig.step = cTxWindowAdjust;
+
+      if (eIasAvbProcOK != mWindowTuner.init(tunerConfig))
+      {
+        DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "bad TX window bounds: max width =", mConfig.txWindowWidthMax,
+            "max pitch =", mConfig.txWindowPitchMax);
+        result = eIasAvbProcInitializationFailed;
+      }
+    }
+
+    if ((0u != mConfig.txTimestamps) && (NULL != mBackend) && (eIasAvbProcOK == result))
+    {
+      if (mBackend->enableTxTimestamps())
+      {
+        // sized once, the TX thread only overwrites the entries
+        TxRecord record;
+        record.stream = NULL;
+        record.attime = 0u;
+        record.id = 0u;
+        mTxRecords.assign(cTxRecords, record);
+        mTxRecordCount = 0u;
+      }
+      else
+      {
+        /**
+         * @log The transmit backend cannot deliver TX time stamps, launch lateness is not measured.
+         */
+        DLT_LOG_CXX(*mLog, DLT_LOG_WARN, LOG_PREFIX, "TX time stamps not available");
+        mConfig.txTimestamps = 0u;
+      }
+    }
 
     uint64_t val = 0u;
     (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cXmitUseShaper, val);
@@ -230,7 +437,7 @@ IasAvbProcessingResult IasAvbTransmitSequencer::init(uint32_t queueIndex, IasAvb
       if (NULL != wdManager)
       {
         uint32_t timeout = IasAvbStreamHandlerEnvironment::getWatchdogTimeout();
-        std::string wdName = std::string("AvbTxWd") + IasAvbTSpec::getClassSuffix(mClass);
+        std::string wdName = std::string("AvbTxWd") + name;
 
         mWatchdog = wdManager->createWatchdog(timeout, wdName);
         if (NULL != mWatchdog)
@@ -247,9 +454,6 @@ IasAvbProcessingResult IasAvbTransmitSequencer::init(uint32_t queueIndex, IasAvb
     }
   }
 
-  // the flag ensures xmit packets being sorted in ascending launchtime order but cpu load may increase
-  (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cXmitStrictPktOrder, mStrictPktOrderEn);
-
   if (eIasAvbProcOK != result)
   {
     cleanup();
@@ -267,6 +471,25 @@ void IasAvbTransmitSequencer::cleanup()
   delete mTransmitThread;
   mTransmitThread = NULL;
 
+  for (AvbStreamMap::iterator it = mActiveStreams.begin(); it != mActiveStreams.end(); it++)
+  {
+    detachPrerenderer(it->second);
+  }
+
+  for (AvbPrerendererVec::iterator it = mPrerenderers.begin(); it != mPrerenderers.end(); it++)
+  {
+    delete *it;
+  }
+  mPrerenderers.clear();
+
+  // the thread has stopped, the backend can return the packets it still holds
+  delete mBackend;
+  mBackend = NULL;
+
+  mSequence.cleanup();
+  mCommands.cleanup();
+  mTxRecords.clear();
+
   if (NULL != mWatchdog)
   {
     IasWatchdog::IasSystemdWatchdogManager* wdManager = NULL;
@@ -331,15 +554,46 @@ IasAvbProcessingResult IasAvbTransmitSequencer::start()
 
   if (isInitialized())
   {
+    std::lock_guard<std::mutex> lock(mLock);
+    IasLibPtpDaemon * ptp = IasAvbStreamHandlerEnvironment::getPtpProxy();
+    const bool starting = !mTransmitThread->isRunning();
+
+    if (starting)
+    {
+      // the sequence is rebuilt from the active streams when the TX thread starts over
+      if (!resyncCommands())
+      {
+        DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "TX command queue full");
+        result = eIasAvbProcErr;
+      }
+    }
+
+    // the render workers have to run before the TX thread asks for packets
+    for (AvbPrerendererVec::iterator it = mPrerenderers.begin();
+        (eIasAvbProcOK == result) && (it != mPrerenderers.end()); it++)
+    {
+      result = (*it)->start();
+    }
+
+    /*
+     * With the virtual clock, time only advances while all attached threads are sleeping. The TX thread
+     * is attached before it is started, so the threads of the engine share the clock from the first cycle
+     * on, no matter in which order they get to run. run() detaches on exit.
+     */
+    if (starting && (NULL != ptp))
+    {
+      ptp->attachVirtualClock();
+    }
+
     IasThreadResult res = mTransmitThread->start(true);
     if ((res != IasResult::cOk) && (res != IasThreadResult::cThreadAlreadyStarted))
     {
       result = eIasAvbProcThreadStartFailed;
+      if (starting && (NULL != ptp))
+      {
+        ptp->detachVirtualClock();
+      }
     }
-
-    mRequestCount++;
-    sync();
-
   }
   else
   {
@@ -359,6 +613,8 @@ IasAvbProcessingResult IasAvbTransmitSequencer::stop()
 
   if (isInitialized())
   {
+    std::lock_guard<std::mutex> lock(mLock);
+
     if (mTransmitThread->isRunning())
     {
       if (mTransmitThread->stop() != IasResult::cOk)
@@ -366,12 +622,23 @@ IasAvbProcessingResult IasAvbTransmitSequencer::stop()
         result = eIasAvbProcThreadStopFailed;
       }
 
+      /* the streams stay attached to the render workers, stopping them now keeps them from rendering while
+       * transmission is interrupted. The packets still queued are flushed by resyncCommands() on restart.
+       */
+      for (AvbPrerendererVec::iterator it = mPrerenderers.begin(); it != mPrerenderers.end(); it++)
+      {
+        if (eIasAvbProcOK != (*it)->stop())
+        {
+          result = eIasAvbProcThreadStopFailed;
+        }
+      }
+
       /* signal interruption of transmission to streams, but set them back to active
        * right afterwards so they will be restarted when the engine is started again
        */
-      for (AvbStreamSet::iterator it = mActiveStreams.begin(); it != mActiveStreams.end(); it++)
+      for (AvbStreamMap::iterator it = mActiveStreams.begin(); it != mActiveStreams.end(); it++)
       {
-        IasAvbStream *stream = *it;
+        IasAvbStream *stream = it->first;
         AVB_ASSERT(NULL != stream);
         stream->deactivate();
         stream->activate();
@@ -393,16 +660,38 @@ uint32_t IasAvbTransmitSequencer::reclaimPackets()
   uint32_t ret = 0u;
   igb_packet* packetList = NULL;
 
-  if (mDoReclaim)
+  if (NULL != mBackend)
+  {
+    // a backend only holds packets of this sequencer
+    ret = mBackend->reclaimPackets();
+
+    if (!mTxRecords.empty())
+    {
+      processTxTimestamps();
+    }
+  }
+  else if (mDoReclaim)
   {
     // check and return packets that are not used any longer
     // NOTE: this is done for all sequencers, not only for this one!
     igb_clean(mIgbDevice, &packetList);
     while (NULL != packetList)
     {
+      // the packet may be reused as soon as it is back in its pool, so fetch the link first
+      igb_packet * const next = packetList->next;
+      if ((0u != mConfig.txTimestamps) && (0u != packetList->dmatime))
+      {
+        // libigb reports the lower 32 bits of the device time the packet was fetched by the DMA, not the time it
+        // left the port, so with igb the launch lateness is the fetch lateness of the packet
+        IasAvbStream * const stream = IasAvbPacketPool::getPacketOwner(packetList);
+        if (NULL != stream)
+        {
+          recordLaunchLateness(stream, int64_t(int32_t(uint32_t(packetList->dmatime) - uint32_t(packetList->attime))));
+        }
+      }
       IasAvbPacketPool::returnPacket(packetList);
       ret++;
-      packetList = packetList->next;
+      packetList = next;
     }
   }
 
@@ -428,17 +717,11 @@ IasResult IasAvbTransmitSequencer::run()
   uint32_t linkStateWaitCount = 0u;
   uint64_t lastOversleep = 0u;
   uint32_t oversleepCount = 0u;
-
-  /*
-   * nextStreamToService either points to:
-   * 1) nothing (i.e. mSequence.end()) when the list is empty
-   * 2) a stream which does not currently have a packet to be sent (stream out of buffers, aka dry stream)
-   * 3) the packet with the closest launch time
-   */
-  AvbStreamDataList::iterator nextStreamToService = mSequence.end();
+  uint64_t lastOver = 0u;
 
   mConfig.txWindowWidth = mConfig.txWindowWidthInit;
   mConfig.txWindowPitch = mConfig.txWindowPitchInit;
+  mWindowTuner.reset();
 
   struct sched_param sparam;
   std::string policyStr = "fifo";
@@ -472,30 +755,51 @@ IasResult IasAvbTransmitSequencer::run()
     DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "Error setting scheduler parameter:", strerror(errval));
   }
 
+  if (mCpu >= 0)
+  {
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(mCpu, &cpuSet);
+
+    errval = pthread_setaffinity_np(pthread_self(), sizeof cpuSet, &cpuSet);
+    if (0 == errval)
+    {
+      DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX, "TransmitEngineThread", mInstance, "pinned to cpu", mCpu);
+    }
+    else
+    {
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "Error pinning TransmitEngineThread", mInstance, "to cpu", mCpu,
+          ":", strerror(errval));
+    }
+  }
+
   mDiag.debugLastLaunchTime = 0u;
   mDiag.debugLastResetMsgOutputTime = 0u;
+  updateSwShaper();
+  mSwShaper.reset();
   windowStart = ptp->getLocalTime();
   uint32_t lastEpoch = ptp->getEpochCounter();
   while (0u == (mThreadControl & cFlagEndThread))
   {
     if (0u != mThreadControl)
     {
-      mLock.lock();
-      // acknowledge restart
-      mThreadControl &= ~cFlagRestartThread;
+      // acknowledge restart, shutDown() might set the end flag concurrently
+      (void) __sync_fetch_and_and(&mThreadControl, ~cFlagRestartThread);
       // sleep for 500ms - wait until ptp daemon has recovered
-      nssleep(500000000u);
-      // reset all active streams
-      for (AvbStreamSet::iterator it = mActiveStreams.begin(); it != mActiveStreams.end(); it++)
+      (void) ptp->sleepUntil(ptp->getSysTime() + 500000000u);
+      // apply pending changes, then reset all streams of the sequence
+      updateSequence();
+      for (uint32_t i = 0u; i < mSequence.size(); i++)
       {
-        IasAvbStream *stream = *it;
-        AVB_ASSERT(NULL != stream);
-        stream->deactivate();
-        stream->activate();
+        resetStream(mSequence[i]);
       }
-      // tick back response counter to retrigger sequence update
-      mResponseCount--;
-      mLock.unlock();
+      // the credit refers to the old timeline
+      mSwShaper.reset();
+      // the lag measured before does not tell anything about the new situation
+      mConfig.txWindowWidth = mConfig.txWindowWidthInit;
+      mConfig.txWindowPitch = mConfig.txWindowPitchInit;
+      mWindowTuner.reset();
+      lastOver = 0u;
 
       windowStart = ptp->getLocalTime();
       DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX, "TX worker thread restarted\n");
@@ -504,12 +808,13 @@ IasResult IasAvbTransmitSequencer::run()
     }
 
     checkLinkStatus(linkState);
-    uint64_t previousSleepTimestamp = ptp->getTsc();
+    uint64_t previousSleepTimestamp = ptp->getSysTime();
     while (!mThreadControl)
     {
       bool oldLinkState = linkState;
       checkLinkStatus(linkState);
-      updateSequence(nextStreamToService);
+      updateSequence();
+      updateSwShaper();
 
       if (!linkState)
       {
@@ -524,7 +829,7 @@ IasResult IasAvbTransmitSequencer::run()
         }
         linkStateWaitCount++;
         (void) reclaimPackets();
-        ::usleep(1000000u / cPollLinkPerSecond);
+        (void) ptp->sleepUntil(ptp->getSysTime() + (1000000000u / cPollLinkPerSecond));
         continue;
       }
       else
@@ -538,8 +843,8 @@ IasResult IasAvbTransmitSequencer::run()
 
           DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX, "link state has changed from",
               oldLinkState, "to", linkState);
-          ::sleep(3);
-          mThreadControl |= cFlagRestartThread;
+          (void) ptp->sleepUntil(ptp->getSysTime() + 3000000000u);
+          (void) __sync_fetch_and_or(&mThreadControl, cFlagRestartThread);
         }
       }
 
@@ -557,7 +862,7 @@ IasResult IasAvbTransmitSequencer::run()
           if (IasResult::cOk != mWatchdog->registerWatchdog())
           {
             DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, " watchdog registration failure...");
-            mThreadControl |= cFlagEndThread;
+            (void) __sync_fetch_and_or(&mThreadControl, cFlagEndThread);
           }
           else
           {
@@ -573,27 +878,33 @@ IasResult IasAvbTransmitSequencer::run()
           (void) mWatchdog->unregisterWatchdog();
       }
 
-      for (AvbStreamDataList::iterator it = mSequence.begin(); it != mSequence.end(); it++)
+      for (uint32_t i = 0u; i < mSequence.size(); i++)
       {
-        it->done = eNotDone;
+        mSequence[i].done = eNotDone;
       }
+      mSequence.rearm();
 
-      /* iterate through our sequence while dynamically resorting it until all streams have delivered
-       * all packets belonging to the current TX window
+      /* always service the stream with the earliest launch time until all streams have delivered
+       * all packets belonging to the current TX window. Streams that are done are parked until the next window.
        *
        * Note: By design, this could lead to the same stream being serviced multiple times in a row!
        */
+      uint32_t dryCount = 0u;
       while (!mThreadControl && (streamsToService > 0u))
       {
-        DoneState done = serviceStream(windowStart, nextStreamToService);
+        DoneState done = serviceStream(windowStart);
         switch (done)
         {
         case eNotDone:
           // do nothing
           break;
 
-        case eEndOfWindow:
         case eDry:
+          dryCount++;
+          streamsToService--;
+          break;
+
+        case eEndOfWindow:
           streamsToService--;
           break;
 
@@ -605,11 +916,18 @@ IasResult IasAvbTransmitSequencer::run()
         }
       }
 
-      if (mStrictPktOrderEn)
+      if (!mBatch.empty())
+      {
+        flushBatch();
+      }
+
+      if ((0u != mConfig.txWindowAuto) && (0u != mSequence.size()))
       {
-        // re-sort streams based on launch time
-        (void) mSequence.sort();
-        nextStreamToService = mSequence.begin();
+        // the last packet of this window has been handed over this late after the nominal wakeup
+        const uint64_t busy = ptp->getSysTime() - previousSleepTimestamp;
+        mWindowTuner.update(lastOver + busy, dryCount);
+        mConfig.txWindowWidth = mWindowTuner.getWidth();
+        mConfig.txWindowPitch = mWindowTuner.getPitch();
       }
 
       // advance TX window and sleep until the new window is reached
@@ -622,20 +940,20 @@ IasResult IasAvbTransmitSequencer::run()
       {
           lastEpoch = epoch;
           DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "ptp time warp detected - restarting TX worker thread");
-          mThreadControl |= cFlagRestartThread;
+          (void) __sync_fetch_and_or(&mThreadControl, cFlagRestartThread);
           continue;
       }
-      timespec tp;
-      IasLibPtpDaemon::convertNsToTimespec(sleepUntil, tp);
-      int rc = clock_nanosleep(IasLibPtpDaemon::cSysClockId, TIMER_ABSTIME, &tp, NULL);
-      if (rc < 0)
+      const int32_t rc = ptp->sleepUntil(sleepUntil);
+      // a signal just ends the sleep early, the window is re-evaluated anyway
+      if ((rc < 0) && (-EINTR != rc))
       {
-        DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "clock_nanosleep failure: ", strerror(rc));
-        mThreadControl |= cFlagEndThread;
+        DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "clock_nanosleep failure: ", strerror(-rc));
+        (void) __sync_fetch_and_or(&mThreadControl, cFlagEndThread);
       }
 
-      const uint64_t timestampNow =  ptp->getTsc();
+      const uint64_t timestampNow =  ptp->getSysTime();
       int64_t over = timestampNow - sleepUntil;
+      lastOver = (over > 0) ? uint64_t(over) : 0u;
       if (over > int64_t(mConfig.txWindowWidth - mConfig.txWindowPitch))
       {
         oversleepCount++;
@@ -665,22 +983,26 @@ IasResult IasAvbTransmitSequencer::run()
      */
 
     // wait some time for the buffers to return from igb
-    nssleep(static_cast<uint32_t>(3u * mConfig.txWindowWidth));
+    (void) ptp->sleepUntil(ptp->getSysTime() + 3u * mConfig.txWindowWidth);
     (void) reclaimPackets();
 
     // return the packets still held by the sequence
-    for (AvbStreamDataList::iterator it = mSequence.begin(); it != mSequence.end(); it++)
+    for (uint32_t i = 0u; i < mSequence.size(); i++)
     {
-      if (NULL != it->packet)
+      if (NULL != mSequence[i].packet)
       {
-        IasAvbPacketPool::returnPacket(it->packet);
-        it->packet = NULL;
+        IasAvbPacketPool::returnPacket(mSequence[i].packet);
+        mSequence[i].packet = NULL;
       }
     }
 
-    nextStreamToService = mSequence.end();
     mSequence.clear();
 
+    for (std::vector<IasAvbPacket*>::iterator it = mBatch.begin(); it != mBatch.end(); it++)
+    {
+      IasAvbPacketPool::returnPacket(*it);
+    }
+    mBatch.clear();
   }
 
   // unregister the watchdog before exiting the thread
@@ -697,6 +1019,8 @@ IasResult IasAvbTransmitSequencer::run()
     (void) mWatchdog->unregisterWatchdog();
   }
 
+  ptp->detachVirtualClock();
+
   return IasResult::cOk;
 }
 
@@ -725,93 +1049,78 @@ void IasAvbTransmitSequencer::checkLinkStatus(bool &linkState)
   }
 }
 
-void IasAvbTransmitSequencer::updateSequence(AvbStreamDataList::iterator & nextStreamToService)
+void IasAvbTransmitSequencer::updateSequence()
 {
-  // check for changes in the active streams set, indicated by an increased request counter
-
   const uint32_t numStreamsOld = static_cast<uint32_t>(mSequence.size());
-  (void) numStreamsOld;
   bool change = false;
+  Command command;
 
-  sync();
-  while ((mRequestCount - mResponseCount) > 0)
+  // apply the changes of the active streams queued by the control path, lock-free
+  while (mCommands.pop(command))
   {
     change = true;
 
-    /*
-     * sync active stream set with sequence list by first erasing obsolete objects from sequence list
-     * and then adding the ones remaining in the (temporary copy of the) active list
-     */
-
-    mLock.lock();
-
-    AvbStreamSet temp = mActiveStreams;
-    for (AvbStreamDataList::iterator s = mSequence.begin(); s != mSequence.end(); /*in loop*/)
+    switch (command.type)
     {
-      if (temp.find(s->stream) == temp.end())
+    case eCmdAdd:
       {
-        // stream not found in active set anymore -> erase from sequence
-        if (nextStreamToService == s)
-        {
-          nextStreamToService++;
-          if (mSequence.end() == nextStreamToService)
-          {
-            nextStreamToService = mSequence.begin();
-          }
-        }
-        if (NULL != s->packet)
-        {
-          IasAvbPacketPool::returnPacket(s->packet);
-        }
-        s = mSequence.erase(s);
-        if (mSequence.size() == 0u)
+        // new streams come first since they have no launch time yet
+        StreamData newData = command.data;
+        AVB_ASSERT(NULL != newData.stream);
+        newData.done = eNotDone;
+        newData.packet = NULL;
+        newData.launchTime = 0u;
+        if (!mSequence.add(newData))
         {
-          nextStreamToService = mSequence.end();
+          // cannot happen, addStreamToTransmitList() checks the capacity
+          DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "TX sequence full, stream not added");
         }
       }
-      else
+      break;
+
+    case eCmdRemove:
+      for (uint32_t i = mSequence.size(); i > 0u; i--)
       {
-        // take away from temp set so only the new ones remain
-        temp.erase(s->stream);
-        s++;
+        StreamData & s = mSequence[i - 1u];
+        if (command.data.stream == s.stream)
+        {
+          if (NULL != s.packet)
+          {
+            IasAvbPacketPool::returnPacket(s.packet);
+          }
+          mSequence.erase(i - 1u);
+          break;
+        }
       }
-    }
+      // the stream might be destroyed once the command is acknowledged
+      invalidateTxRecords(command.data.stream);
+      break;
 
-    // insert new streams into sequence
-    for (AvbStreamSet::iterator it = temp.begin(); it != temp.end(); it++)
-    {
-      IasAvbStream * stream = *it;
-      AVB_ASSERT( NULL != stream );
-      StreamData newData;
-      newData.done = eNotDone;
-      newData.stream = stream;
-      newData.packet = NULL;
-      newData.launchTime = 0u;
-      mSequence.push_front( newData );
-
-      // this happens only when mSequence is empty
-      if (mSequence.end() == nextStreamToService)
+    case eCmdReset:
+    default:
+      for (uint32_t i = 0u; i < mSequence.size(); i++)
       {
-        nextStreamToService = mSequence.begin();
+        if (NULL != mSequence[i].packet)
+        {
+          IasAvbPacketPool::returnPacket(mSequence[i].packet);
+        }
       }
-
-      sortByLaunchTime(nextStreamToService);
+      mSequence.clear();
+      invalidateTxRecords(NULL);
+      break;
     }
 
-    mLock.unlock();
-
     /*
      * respond to client after sequence list is updated. In case of destroy stream request
      * client might destroy stream once sequencer responded to the request.
      */
-    mResponseCount++;
-    DLT_LOG_CXX(*mLog, DLT_LOG_DEBUG, LOG_PREFIX, "request/response:", mRequestCount, "/", mResponseCount);
-
-    sync();
+    (void) mCommandsDone.fetch_add(1u, std::memory_order_release);
   }
 
   if (change)
   {
+    mSequence.rearm();
+
     DLT_LOG_CXX(*mLog, DLT_LOG_DEBUG, LOG_PREFIX, "sync done, sequence size =", uint32_t(mSequence.size()));
 
     if (numStreamsOld > mSequence.size())
@@ -819,15 +1128,104 @@ void IasAvbTransmitSequencer::updateSequence(AvbStreamDataList::iterator & nextS
       // less active streams, try if we can use the original TX timing
       mConfig.txWindowWidth = mConfig.txWindowWidthInit;
       mConfig.txWindowPitch = mConfig.txWindowPitchInit;
+      mWindowTuner.reset();
     }
   }
 }
 
-IasAvbTransmitSequencer::DoneState IasAvbTransmitSequencer::serviceStream(uint64_t windowStart, AvbStreamDataList::iterator & nextStreamToService)
+void IasAvbTransmitSequencer::processTxTimestamps()
+{
+  AVB_ASSERT(NULL != mBackend);
+  IasAvbTransmitBackend::TxTimestamp stamps[cTxStampChunk];
+  uint32_t count = 0u;
+
+  do
+  {
+    count = mBackend->getTxTimestamps(stamps, cTxStampChunk);
+    for (uint32_t i = 0u; i < count; i++)
+    {
+      // ignore time stamps of packets that have been overwritten in the ring already
+      const uint32_t age = mTxRecordCount - stamps[i].id;
+      TxRecord & record = mTxRecords[stamps[i].id & (cTxRecords - 1u)];
+      if ((0u != age) && (age <= cTxRecords) && (stamps[i].id == record.id) && (NULL != record.stream))
+      {
+        recordLaunchLateness(record.stream, int64_t(stamps[i].time - record.attime));
+        record.stream = NULL;
+      }
+    }
+  } while (cTxStampChunk == count);
+}
+
+void IasAvbTransmitSequencer::invalidateTxRecords(const IasAvbStream * stream)
+{
+  for (std::vector<TxRecord>::iterator it = mTxRecords.begin(); it != mTxRecords.end(); it++)
+  {
+    if ((NULL == stream) || (stream == it->stream))
+    {
+      it->stream = NULL;
+    }
+  }
+}
+
+void IasAvbTransmitSequencer::updateSwShaper()
+{
+  // the control path holds the lock only to copy the parameters, try again in the next window if busy
+  if (mSwShaperChanged.load(std::memory_order_acquire) && mSwShaperLock.try_lock())
+  {
+    mSwShaper.configure(mSwShaperConfig);
+    mSwShaperChanged.store(false, std::memory_order_relaxed);
+    mSwShaperLock.unlock();
+  }
+}
+
+bool IasAvbTransmitSequencer::pushCommand(CommandType type, const StreamData & data)
+{
+  Command command;
+  command.type = type;
+  command.data = data;
+
+  const bool ret = mCommands.push(command);
+  if (ret)
+  {
+    mCommandCount++;
+  }
+
+  return ret;
+}
+
+bool IasAvbTransmitSequencer::resyncCommands()
+{
+  Command command;
+
+  // the worker thread is not running, so this thread may act as consumer
+  while (mCommands.pop(command))
+  {
+    // superseded by the reset below
+    (void) mCommandsDone.fetch_add(1u, std::memory_order_release);
+  }
+
+  bool ret = pushCommand(eCmdReset, StreamData());
+
+  for (AvbStreamMap::iterator it = mActiveStreams.begin(); it != mActiveStreams.end(); it++)
+  {
+    StreamData & data = it->second;
+    if (NULL != data.slot)
+    {
+      // the packets rendered before the worker thread stopped are outdated
+      data.prerenderer->flush(*data.slot);
+    }
+    ret = pushCommand(eCmdAdd, data) && ret;
+  }
+
+  return ret;
+}
+
+IasAvbTransmitSequencer::DoneState IasAvbTransmitSequencer::serviceStream(uint64_t windowStart)
 {
   int32_t result;
-  StreamData & current = *nextStreamToService;
+  StreamData & current = mSequence.top();
   bool fetch = true;
+  bool resort = false;
   uint64_t streamId = 0;
 
   IasDiaLogger *diaLogger = IasAvbStreamHandlerEnvironment::getDiaLogger();
@@ -853,7 +1251,6 @@ IasAvbTransmitSequencer::DoneState IasAvbTransmitSequencer::serviceStream(uint64
       {
         // stream does not need to be serviced within the current window
         current.done = eEndOfWindow;
-        nextStreamToService = next(nextStreamToService);
         fetch = false;
       }
       else
@@ -882,6 +1279,12 @@ IasAvbTransmitSequencer::DoneState IasAvbTransmitSequencer::serviceStream(uint64
         {
           // send the packet
           current.packet->attime = current.launchTime + mConfig.txDelay;
+          if (mSwShaper.isEnabled())
+          {
+            // packets due before the window started have been waiting, which the shaper credits up to hiCredit
+            current.packet->attime = mSwShaper.shape(current.packet->attime, windowStart,
+                current.packet->len + cTxWireOverhead);
+          }
           if (current.packet->attime < mDiag.debugLastLaunchTime)
           {
             IasAvbStream *prev = mDiag.debugLastStream;
@@ -935,19 +1338,37 @@ IasAvbTransmitSequencer::DoneState IasAvbTransmitSequencer::serviceStream(uint64
           }
 #endif
 
-          result = current.packet->xmit(mIgbDevice, mQueueIndex);
+          if (0u != mConfig.txBatchSize)
+          {
+            // the packet is sent along with the others of this window by flushBatch()
+            mBatch.push_back(current.packet);
+            result = 0;
+            if (mBatch.size() >= mConfig.txBatchSize)
+            {
+              flushBatch();
+            }
+          }
+          else if (NULL != mBackend)
+          {
+            result = mBackend->xmit(current.packet);
+          }
+          else
+          {
+            result = current.packet->xmit(mIgbDevice, mQueueIndex);
+          }
           if (mFirstRun && mBTMEnable)
           {
             mFirstRun = false;
             // TO BE REPLACED ias_dlt_log_btm_mark(mLog, "avb sending now",NULL);
           }
-          uint32_t counterTx = 0u;
           switch (result)
           {
           case -EINVAL:
           case -ENXIO:
             // fatal errors, dispose of packet
             IasAvbPacketPool::returnPacket(current.packet);
+            current.packet = NULL;
+            mDiag.dropped++;
             DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "igb_xmit error:", int32_t(result));
             fetch = false;
             current.done = eTxError;
@@ -957,14 +1378,10 @@ IasAvbTransmitSequencer::DoneState IasAvbTransmitSequencer::serviceStream(uint64
             // success
             fetch = true;
 
-            counterTx = current.stream->incFramesTx();
-            (void) counterTx;
-            mDiag.sent++;
-
-            // Where to reset the counter
-            if (NULL != diaLogger)
+            if (0u == mConfig.txBatchSize)
             {
-              diaLogger->incTxCount();
+              // batched packets are counted by flushBatch() once the backend has accepted them
+              countTx(current.stream, current.packet, diaLogger);
             }
 
             // reset the watchdog timer when packet was successfully sent
@@ -979,10 +1396,10 @@ IasAvbTransmitSequencer::DoneState IasAvbTransmitSequencer::serviceStream(uint64
             {
               // Insufficient ring size: Calculate the required ring size for diagnostic purposes
               uint32_t frames = 0u;
-              for (AvbStreamDataList::iterator it = mSequence.begin(); it != mSequence.end(); it++)
+              for (uint32_t i = 0u; i < mSequence.size(); i++)
               {
-                AVB_ASSERT(NULL != it->stream);
-                frames += it->stream->getTSpec().getMaxIntervalFrames();
+                AVB_ASSERT(NULL != mSequence[i].stream);
+                frames += mSequence[i].stream->getTSpec().getMaxIntervalFrames();
               }
               AVB_ASSERT(0u != mConfig.txWindowWidth);
 
@@ -1003,7 +1420,7 @@ IasAvbTransmitSequencer::DoneState IasAvbTransmitSequencer::serviceStream(uint64
               }
               else
               {
-                mThreadControl |= cFlagRestartThread;
+                (void) __sync_fetch_and_or(&mThreadControl, cFlagRestartThread);
               }
             }
             break;
@@ -1027,7 +1444,15 @@ IasAvbTransmitSequencer::DoneState IasAvbTransmitSequencer::serviceStream(uint64
       // fetch new packet and re-sort the stream in the sequence, depending on the new packet's launch time
       fetch = false;
       bool isDry = (NULL == current.packet);
-      current.packet = current.stream->preparePacket(windowStart + mConfig.txWindowPitch);
+      if (NULL != current.slot)
+      {
+        // rendered ahead by the render worker
+        current.packet = current.prerenderer->fetchPacket(*current.slot);
+      }
+      else
+      {
+        current.packet = current.stream->preparePacket(windowStart + mConfig.txWindowPitch);
+      }
 
       if (NULL != current.packet)
       {
@@ -1059,9 +1484,7 @@ IasAvbTransmitSequencer::DoneState IasAvbTransmitSequencer::serviceStream(uint64
             IasAvbPacketPool::returnPacket(current.packet);
             current.packet = NULL;
 
-            // toggle activation of stream to force reinit of transmission time
-            current.stream->deactivate();
-            current.stream->activate();
+            resetStream(current);
 
             if (++resetCnt <= maxResetCnt)
             {
@@ -1076,7 +1499,6 @@ IasAvbTransmitSequencer::DoneState IasAvbTransmitSequencer::serviceStream(uint64
           {
             // we're out of the tx window, done with this stream for now
             current.done = eEndOfWindow;
-            nextStreamToService = next(nextStreamToService);
           }
         }
         else if (timeFromWindowStart < -int64_t(mConfig.txWindowResetThreshold))
@@ -1093,9 +1515,7 @@ IasAvbTransmitSequencer::DoneState IasAvbTransmitSequencer::serviceStream(uint64
           IasAvbPacketPool::returnPacket(current.packet);
           current.packet = NULL;
 
-          // toggle activation of stream to force reinit of transmission time
-          current.stream->deactivate();
-          current.stream->activate();
+          resetStream(current);
 
           if (++resetCnt <= maxResetCnt)
           {
@@ -1133,8 +1553,7 @@ IasAvbTransmitSequencer::DoneState IasAvbTransmitSequencer::serviceStream(uint64
 
             // @@DIAG error handling, not normal start/stop
             const bool error = true;
-            current.stream->deactivate(error);
-            current.stream->activate(error);
+            resetStream(current, error);
             current.done = eDry; // to avoid an infinite loop
           }
           else
@@ -1144,11 +1563,8 @@ IasAvbTransmitSequencer::DoneState IasAvbTransmitSequencer::serviceStream(uint64
         }
         else
         {
-          // yay, we're inside the window!
-          /* Note that the sort method also skips to the next stream already, but
-           * that skipping does not consider the 'done' state of that stream.
-           */
-          sortByLaunchTime(nextStreamToService);
+          // yay, we're inside the window! Move the stream to its place in the sequence.
+          resort = true;
         }
       }
       else
@@ -1162,24 +1578,143 @@ IasAvbTransmitSequencer::DoneState IasAvbTransmitSequencer::serviceStream(uint64
 
         current.launchTime = 0u;
         current.done = eDry;
-        nextStreamToService = next(nextStreamToService);
       }
     } // while fetch
   }
 
-  // if the next stream is done already, try to find one that is not done yet
-  AvbStreamDataList::iterator startPoint = nextStreamToService;
-  while (nextStreamToService->done != eNotDone)
+  // current refers to the top of the sequence, which is not valid anymore after re-sorting
+  const DoneState done = current.done;
+  if (eNotDone != done)
+  {
+    // done for this window, the stream with the next launch time comes to the top
+    mSequence.pop();
+  }
+  else if (resort && mSequence.update())
+  {
+    mDiag.reordered++;
+  }
+
+  return done;
+}
+
+void IasAvbTransmitSequencer::flushBatch()
+{
+  AVB_ASSERT(NULL != mBackend);
+
+  IasDiaLogger *diaLogger = IasAvbStreamHandlerEnvironment::getDiaLogger();
+  const uint32_t count = uint32_t(mBatch.size());
+  uint32_t offset = 0u;
+  uint32_t retries = 0u;
+
+  while (offset < count)
   {
-    nextStreamToService = next(nextStreamToService);
-    mDiag.debugSkipCount++;
-    if (startPoint == nextStreamToService)
+    uint32_t sent = 0u;
+    const int32_t result = mBackend->xmitBatch(&mBatch[offset], count - offset, sent);
+    for (uint32_t i = 0u; i < sent; i++)
     {
-      break;
+      countTx(IasAvbPacketPool::getPacketOwner(mBatch[offset + i]), mBatch[offset + i], diaLogger);
+    }
+    offset += sent;
+
+    if (0 != sent)
+    {
+      retries = 0u;
+    }
+
+    if (0 == result)
+    {
+      // all done
+    }
+    else if ((-EINVAL == result) || (-ENXIO == result))
+    {
+      // fatal error, dispose of the packet and go on with the next one
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "xmit error:", int32_t(result));
+      IasAvbPacketPool::returnPacket(mBatch[offset]);
+      mDiag.dropped++;
+      offset++;
+    }
+    else if (++retries > cBatchMaxRetries)
+    {
+      DLT_LOG_CXX(*mLog, DLT_LOG_WARN, LOG_PREFIX, "xmit returns", int32_t(result), "dropping",
+          count - offset, "packets");
+      for (; offset < count; offset++)
+      {
+        IasAvbPacketPool::returnPacket(mBatch[offset]);
+        mDiag.dropped++;
+      }
+    }
+    else
+    {
+      // non-fatal errors, try again
+    }
+  }
+
+  mBatch.clear();
+}
+
+void IasAvbTransmitSequencer::countTx(IasAvbStream * stream, IasAvbPacket * packet, IasDiaLogger * diaLogger)
+{
+  recordTx(packet);
+
+  if (NULL != stream)
+  {
+    (void) stream->incFramesTx();
+  }
+  mDiag.sent++;
+
+  // Where to reset the counter
+  if (NULL != diaLogger)
+  {
+    diaLogger->incTxCount();
+  }
+}
+
+void IasAvbTransmitSequencer::resetStream(StreamData & data, bool isError)
+{
+  AVB_ASSERT(NULL != data.stream);
+
+  // toggle activation of stream to force reinit of transmission time
+  data.stream->deactivate(isError);
+  data.stream->activate(isError);
+
+  if (NULL != data.slot)
+  {
+    data.prerenderer->flush(*data.slot);
+  }
+}
+
+void IasAvbTransmitSequencer::attachPrerenderer(StreamData & data)
+{
+  IasAvbPacketPrerenderer *worker = NULL;
+  uint32_t minSlots = uint32_t(-1);
+
+  for (AvbPrerendererVec::iterator it = mPrerenderers.begin(); it != mPrerenderers.end(); it++)
+  {
+    const uint32_t numSlots = (*it)->getNumSlots();
+    if (numSlots < minSlots)
+    {
+      minSlots = numSlots;
+      worker = *it;
     }
   }
 
-  return current.done;
+  if (NULL != worker)
+  {
+    data.slot = worker->attach(data.stream);
+    // without a slot, the TX thread renders the packets itself
+    data.prerenderer = (NULL != data.slot) ? worker : NULL;
+  }
+}
+
+void IasAvbTransmitSequencer::detachPrerenderer(StreamData & data)
+{
+  if (NULL != data.slot)
+  {
+    AVB_ASSERT(NULL != data.prerenderer);
+    data.prerenderer->detach(data.slot);
+    data.slot = NULL;
+    data.prerenderer = NULL;
+  }
 }
 
 void IasAvbTransmitSequencer::logOutput(float elapsed, float reclaimed)
@@ -1203,73 +1738,21 @@ void IasAvbTransmitSequencer::logOutput(float elapsed, float reclaimed)
     mDiag.reordered = 0u;
     mDiag.dropped = 0u;
 
-    DLT_LOG_CXX(*mLog, DLT_LOG_DEBUG, LOG_PREFIX, "skipped:", mDiag.debugSkipCount,
-        "violations:", mDiag.debugTimingViolation,
+    DLT_LOG_CXX(*mLog, DLT_LOG_DEBUG, LOG_PREFIX, "violations:", mDiag.debugTimingViolation,
         "avg.reclaim:", mDiag.avgPacketReclaim,
-        "sent/reclaim:", mDiag.avgPacketSent / mDiag.avgPacketReclaim
+        "sent/reclaim:", mDiag.avgPacketSent / mDiag.avgPacketReclaim,
+        "window:", mConfig.txWindowWidth, "/", mConfig.txWindowPitch
         );
-    mDiag.debugSkipCount = 0u;
     mDiag.debugTimingViolation = 0u;
   }
 
   mDiag.sent = 0u;
 }
 
-void IasAvbTransmitSequencer::sortByLaunchTime(AvbStreamDataList::iterator & nextStreamToService)
-{
-  StreamData & current = *nextStreamToService;
-  AvbStreamDataList::iterator backward = nextStreamToService;
-
-  /* go backwards from the current stream to find packets that need to be sent earlier
-   * NOTE: in most cases, this loop will abort immediately and no reordering takes place
-   */
-  do
-  {
-    backward = prev(backward);
-
-    if ((backward->launchTime != 0u) && (current.launchTime > backward->launchTime))
-    {
-      break;
-    }
-  }
-  while (nextStreamToService != backward);
-
-  /* if nextStreamToService == backward the stream gets reordered to the position it already has and needs
-   * to be serviced again immediately, so no action needs to be taken
-   */
-  if (nextStreamToService != backward)
-  {
-    // insert() inserts before the specified position, so we need to advance by one to insert after
-    backward = next(backward);
-
-    if (nextStreamToService != backward)
-    {
-      // move current stream to new position and skip nextStreamToService to the next one
-      mSequence.insert(backward, current);
-      nextStreamToService = mSequence.erase(nextStreamToService);
-      // wrap around, if necessary
-      if (mSequence.end() == nextStreamToService)
-      {
-        nextStreamToService = mSequence.begin();
-      }
-
-      mDiag.reordered++;
-    }
-    else
-    {
-      // just skip nextStreamToService to the next one
-      nextStreamToService = next(nextStreamToService);
-    }
-  }
-}
-
-
 IasResult IasAvbTransmitSequencer::shutDown()
 {
   DLT_LOG_CXX(*mLog, DLT_LOG_DEBUG, LOG_PREFIX);
-  mLock.lock();
-  mThreadControl = cFlagEndThread;
-  mLock.unlock();
+  (void) __sync_fetch_and_or(&mThreadControl, cFlagEndThread);
   return IasResult::cOk;
 }
 
@@ -1302,7 +1785,13 @@ IasAvbProcessingResult IasAvbTransmitSequencer::addStreamToTransmitList(IasAvbSt
     AVB_ASSERT(NULL != mTransmitThread);
 
     const uint32_t newTotal = mCurrentBandwidth + stream->getTSpec().getRequiredBandwidth();
-    if (newTotal > mConfig.txMaxBandwidth)
+    if (mActiveStreams.size() >= mSequence.getCapacity())
+    {
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "max number of streams exceeded (",
+          mSequence.getCapacity(), ")");
+      result = eIasAvbProcNoSpaceLeft;
+    }
+    else if (newTotal > mConfig.txMaxBandwidth)
     {
       DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "total bandwidth exceeded (",
           newTotal, "kBit/s)");
@@ -1326,6 +1815,29 @@ IasAvbProcessingResult IasAvbTransmitSequencer::addStreamToTransmitList(IasAvbSt
         result = eIasAvbProcNoSpaceLeft;
       }
       else
+      {
+        std::lock_guard<std::mutex> lock(mLock);
+
+        StreamData data = StreamData();
+        data.stream = stream;
+        attachPrerenderer(data);
+        mActiveStreams[stream] = data;
+
+        // the TX thread picks up the stream with its next window, while it is stopped the queue is rebuilt instead
+        const bool queued = mTransmitThread->isRunning() ? pushCommand(eCmdAdd, data) : resyncCommands();
+        if (!queued)
+        {
+          /**
+           * @log Command queue full: the TX thread did not pick up the changes of the active streams.
+           */
+          DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "TX command queue full");
+          (void) mActiveStreams.erase(stream);
+          detachPrerenderer(data);
+          result = eIasAvbProcNoSpaceLeft;
+        }
+      }
+
+      if (eIasAvbProcOK == result)
       {
         DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX, "::addStreamToTransmitList: increasing total bandwidth:",
             mCurrentBandwidth,
@@ -1350,14 +1862,6 @@ IasAvbProcessingResult IasAvbTransmitSequencer::addStreamToTransmitList(IasAvbSt
 
           updateShaper();
         }
-
-        {
-          mLock.lock();
-          (void) mActiveStreams.insert( stream );
-          mLock.unlock();
-          mRequestCount++;
-          sync();
-        }
       }
     }
   }
@@ -1383,35 +1887,52 @@ IasAvbProcessingResult IasAvbTransmitSequencer::removeStreamFromTransmitList(Ias
   if (eIasAvbProcOK == result)
   {
     AVB_ASSERT(NULL != mTransmitThread);
-    mLock.lock();
-    (void) mActiveStreams.erase( stream );
-    mLock.unlock();
-    mRequestCount++;
-    sync();
+    std::lock_guard<std::mutex> lock(mLock);
 
-    if (mTransmitThread->isRunning())
+    AvbStreamMap::iterator itStream = mActiveStreams.find(stream);
+    if (mActiveStreams.end() != itStream)
     {
-      // wait up to one second for the worker thread to confirm the change
-      for (uint32_t i = 0; i < 100000u; i++)
+      StreamData data = itStream->second;
+      (void) mActiveStreams.erase(itStream);
+
+      if (!mTransmitThread->isRunning())
       {
-        ::usleep(10u);
-        sync();
-        if (mRequestCount == mResponseCount)
+        (void) resyncCommands();
+      }
+      else if (!pushCommand(eCmdRemove, data))
+      {
+        /**
+         * @log Command queue full: the TX thread did not pick up the changes of the active streams.
+         */
+        DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "TX command queue full");
+        mActiveStreams[stream] = data;
+        result = eIasAvbProcErr;
+      }
+      else
+      {
+        // wait up to one second for the worker thread to confirm the change
+        const uint32_t ticket = mCommandCount;
+        bool done = false;
+        for (uint32_t i = 0; (i < 100000u) && !done; i++)
         {
-          break;
+          ::usleep(10u);
+          done = (int32_t(mCommandsDone.load(std::memory_order_acquire) - ticket) >= 0);
+        }
+        if (!done)
+        {
+          DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "worker thread did not respond");
+
+          // restore the stream, the TX thread applies the removal and the add in order
+          mActiveStreams[stream] = data;
+          (void) pushCommand(eCmdAdd, data);
+          result = eIasAvbProcErr;
         }
       }
-      if (mRequestCount != mResponseCount)
+
+      if (eIasAvbProcOK == result)
       {
-        DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "worker thread did not respond");
-
-        // restore the stream
-        mLock.lock();
-        (void) mActiveStreams.insert( stream );
-        mLock.unlock();
-        mRequestCount++;
-        sync();
-        result = eIasAvbProcErr;
+        // the TX thread does not fetch packets of the stream anymore
+        detachPrerenderer(data);
       }
     }
 
@@ -1432,9 +1953,9 @@ IasAvbProcessingResult IasAvbTransmitSequencer::removeStreamFromTransmitList(Ias
           if (mMaxFrameSizeHigh <= stream->getTSpec().getMaxFrameSize())
           {
             mMaxFrameSizeHigh = 0u;
-            for (AvbStreamSet::iterator it = mActiveStreams.begin(); it != mActiveStreams.end(); it++)
+            for (AvbStreamMap::iterator it = mActiveStreams.begin(); it != mActiveStreams.end(); it++)
             {
-              IasAvbStream *activeStream = *it;
+              IasAvbStream *activeStream = it->first;
               AVB_ASSERT(NULL != activeStream);
               if (mMaxFrameSizeHigh < activeStream->getTSpec().getMaxFrameSize())
               {
@@ -1457,9 +1978,9 @@ void IasAvbTransmitSequencer::resetPoolsOfActiveStreams()
 {
   mLock.lock();
 
-  for (AvbStreamSet::iterator it = mActiveStreams.begin(); it != mActiveStreams.end(); it++)
+  for (AvbStreamMap::iterator it = mActiveStreams.begin(); it != mActiveStreams.end(); it++)
   {
-    IasAvbStream *stream = *it;
+    IasAvbStream *stream = it->first;
     AVB_ASSERT(NULL != stream);
     stream->resetPacketPool();
   }
@@ -1482,7 +2003,39 @@ void IasAvbTransmitSequencer::updateShaper()
   // get current link speed
   linkSpeed = IasAvbStreamHandlerEnvironment::getLinkSpeed();
 
-  if (100 == linkSpeed)
+  if (NULL != mBackend)
+  {
+    // the igb Qav registers are not available, the TX thread shapes the launch times in software
+    IasAvbCreditShaper::Config config;
+    const uint64_t slope = uint64_t(mCurrentBandwidth) * mShaperBwRate / 100u * 1000u;
+    const uint64_t slopeHigh = (IasAvbSrClass::eIasAvbSrClassHigh == mClass) ? 0u : uint64_t(mBandwidthHigh) * 1000u;
+
+    // see the igb case below for the 43 bytes added to the AVTP payload
+    if ((linkSpeed <= 0) || (eIasAvbProcOK != IasAvbCreditShaper::calculate(config, uint64_t(linkSpeed) * 1000000u,
+        slope, maxInterferenceSize + cTxWireOverhead, maxInterferenceSize, slopeHigh, mMaxFrameSizeHigh + 43u)))
+    {
+      /**
+       * @log The reserved bandwidth does not fit the link speed, the launch times are not shaped.
+       */
+      DLT_LOG_CXX(*mLog, DLT_LOG_ERROR, LOG_PREFIX, "bad software shaper params: link speed", linkSpeed,
+          "bandwidth:", slope, "bit/s");
+      config = IasAvbCreditShaper::Config();
+    }
+    else
+    {
+      DLT_LOG_CXX(*mLog, DLT_LOG_INFO, LOG_PREFIX, "set software shaping params (",
+          "Queue:", mQueueIndex,
+          "IdleSlope:", slope, "bit/s",
+          "HiCredit:", config.hiCredit, "bits",
+          "LoCredit:", config.loCredit, "bits",
+          "");
+    }
+
+    std::lock_guard<std::mutex> lock(mSwShaperLock);
+    mSwShaperConfig = config;
+    mSwShaperChanged.store(true, std::memory_order_release);
+  }
+  else if (100 == linkSpeed)
   {
     // the percentage bandwith out of full line rate @ 100Mbps (mCurrentBandwidth = kBit/s)
     bandWidth = (mCurrentBandwidth * mShaperBwRate / 100) * 1000.0 / 100000000.0;
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+/**
+ * @file    IasAvbTransmitWindowTuner.cpp
+ * @brief   The implementation of the IasAvbTransmitWindowTuner class.
+ * @date    2018
+ */
+
+#include "avb_streamhandler/IasAvbTransmitWindowTuner.hpp"
+
+#include <algorithm>
+
+namespace IasMediaTransportAvb {
+
+
+IasAvbTransmitWindowTuner::Config::Config()
+  : widthInit(24u * 125000u)
+  , pitchInit(16u * 125000u)
+  , widthMax(48u * 125000u)
+  , pitchMin(125000u)
+  , pitchMax(pitchInit)
+  , minSlack(125000u)
+  , step(125000u)
+  , growCycles(1000u)
+{
+  // do nothing
+}
+
+
+/*
+ *  Constructor.
+ */
+IasAvbTransmitWindowTuner::IasAvbTransmitWindowTuner()
+  : mConfig()
+  , mWidth(0u)
+  , mPitch(0u)
+  , mTargetPitch(0u)
+  , mPeakLag(0u)
+  , mQuietCycles(0u)
+{
+  reset();
+}
+
+
+/*
+ *  Destructor.
+ */
+IasAvbTransmitWindowTuner::~IasAvbTransmitWindowTuner()
+{
+  // do nothing
+}
+
+
+IasAvbProcessingResult IasAvbTransmitWindowTuner::init(const Config &config)
+{
+  IasAvbProcessingResult result = eIasAvbProcOK;
+
+  if ((0u == config.pitchMin) || (0u == config.step) || (0u == config.growCycles)
+      || (config.pitchMin > config.pitchInit) || (config.pitchInit > config.pitchMax)
+      || (config.widthInit < config.pitchInit) || (config.widthInit > config.widthMax)
+      || ((config.pitchMin + config.minSlack) > config.widthMax))
+  {
+    result = eIasAvbProcInvalidParam;
+  }
+  else
+  {
+    mConfig = config;
+    reset();
+  }
+
+  return result;
+}
+
+
+void IasAvbTransmitWindowTuner::reset()
+{
+  mWidth = mConfig.widthInit;
+  mPitch = mConfig.pitchInit;
+  mTargetPitch = mConfig.pitchInit;
+  // the slack of the initial window is kept until the measured lag has decayed
+  mPeakLag = (mConfig.widthInit - mConfig.pitchInit) * 2u / 3u;
+  mQuietCycles = 0u;
+}
+
+
+void IasAvbTransmitWindowTuner::update(uint64_t lag, uint32_t dryCount)
+{
+  // rise at once, decay slowly
+  if (lag >= mPeakLag)
+  {
+    mPeakLag = lag;
+  }
+  else
+  {
+    mPeakLag -= (mPeakLag - lag) >> cReleaseShift;
+  }
+
+  const uint64_t slack = std::max(mConfig.minSlack, mPeakLag + (mPeakLag >> 1));
+
+  if (0u != dryCount)
+  {
+    // the window reaches beyond the packets the streams have ready, fall back to the configured pitch
+    mQuietCycles = 0u;
+    if (mTargetPitch > mConfig.pitchInit)
+    {
+      mTargetPitch = std::max(mConfig.pitchInit, mTargetPitch - mConfig.step);
+    }
+  }
+  else if (mTargetPitch < mConfig.pitchMax)
+  {
+    // fewer wakeups while all streams keep up
+    if (++mQuietCycles >= mConfig.growCycles)
+    {
+      mQuietCycles = 0u;
+      mTargetPitch = std::min(mConfig.pitchMax, mTargetPitch + mConfig.step);
+    }
+  }
+
+  // the slack has priority, the pitch gives way if the window would exceed its maximum
+  if (slack >= (mConfig.widthMax - mConfig.pitchMin))
+  {
+    mPitch = mConfig.pitchMin;
+  }
+  else
+  {
+    mPitch = std::max(mConfig.pitchMin, std::min(mTargetPitch, mConfig.widthMax - slack));
+  }
+
+  mWidth = std::min(mConfig.widthMax, mPitch + slack);
+}
+
+
+} // namespace IasMediaTransportAvb
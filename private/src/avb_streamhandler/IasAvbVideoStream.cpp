@@ -776,9 +776,26 @@ bool IasAvbVideoStream::prepareDummyAvbPacket(IasAvbPacket* packet)
 
 void IasAvbVideoStream::readFromAvbPacket(const void* const packet, const size_t length)
 {
-  IasLocalVideoBuffer::IasVideoDesc descPacket;
+  mLock.lock();
+  readFromAvbPacketLocked(packet, length);
+  mLock.unlock();
+}
 
+
+void IasAvbVideoStream::readFromAvbPackets(const RxPacket* const packets, const size_t count)
+{
   mLock.lock();
+  for (size_t i = 0u; i < count; i++)
+  {
+    readFromAvbPacketLocked(packets[i].packet, packets[i].length);
+  }
+  mLock.unlock();
+}
+
+
+void IasAvbVideoStream::readFromAvbPacketLocked(const void* const packet, const size_t length)
+{
+  IasLocalVideoBuffer::IasVideoDesc descPacket;
 
   if (isInitialized() && isReceiveStream())
   {
@@ -1055,7 +1072,6 @@ void IasAvbVideoStream::readFromAvbPacket(const void* const packet, const size_t
     }
   }
 
-  mLock.unlock();
 }
 
 
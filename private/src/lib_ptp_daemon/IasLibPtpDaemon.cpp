@@ -85,6 +85,12 @@ IasLibPtpDaemon::IasLibPtpDaemon(std::string const &sharedMemoryName, uint32_t c
   , mTscFreq(0u)
   , mRawToLocalTstampThreshold(cRawTimeMeasurementThreshold)
   , mRawToLocalFactors()
+  , mVirtualClock(false)
+  , mVirtualTime(0u)
+  , mVirtualClockUsers(0u)
+  , mVirtualWakeups()
+  , mVirtualClockLock()
+  , mVirtualClockCond()
 {
   DLT_LOG_CXX(*mLog,  DLT_LOG_VERBOSE, LOG_PREFIX);
 }
@@ -406,6 +412,7 @@ void IasLibPtpDaemon::cleanUp()
 
   mProcessId = 0;
 
+  mVirtualClock = false;
   mInitialized = false;
 }
 
@@ -433,6 +440,12 @@ uint64_t IasLibPtpDaemon::rawToPtp(const uint64_t sysTime) const
 
 uint64_t IasLibPtpDaemon::sysToPtp(const uint64_t sysTime) const
 {
+  if (mVirtualClock)
+  {
+    // system time and PTP time are the same virtual time
+    return sysTime;
+  }
+
   (void) mLastTimeMutex.lock();
   const uint64_t offset1 = mLastTsc;
   const double factor = mTscToLocalFactor;
@@ -449,6 +462,11 @@ uint64_t IasLibPtpDaemon::sysToPtp(const uint64_t sysTime) const
 
 uint64_t IasLibPtpDaemon::ptpToSys(const uint64_t ptpTime) const
 {
+  if (mVirtualClock)
+  {
+    return ptpTime;
+  }
+
   (void) mLastTimeMutex.lock();
   const uint64_t offset1 = mLastTime;
   const double factor = bool(mTscToLocalFactor) ? 1 / mTscToLocalFactor : 0.0;
@@ -465,6 +483,11 @@ uint64_t IasLibPtpDaemon::ptpToSys(const uint64_t ptpTime) const
 
 uint64_t IasLibPtpDaemon::getLocalTime()
 {
+  if (mVirtualClock)
+  {
+    return mVirtualTime.load();
+  }
+
   (void) mLastTimeMutex.lock();
   const uint64_t offset1 = mLastTsc;
   const double factor = mTscToLocalFactor;
@@ -520,7 +543,11 @@ bool IasLibPtpDaemon::isPtpReady()
   (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cPtpPdelayCount, pdelayCount);
   (void) IasAvbStreamHandlerEnvironment::getConfigValue(IasRegKeys::cPtpSyncCount, syncCount);
 
-  if (NULL != mMemoryOffsetBuffer)
+  if (mVirtualClock)
+  {
+    ptpReadyState = true;
+  }
+  else if (NULL != mMemoryOffsetBuffer)
   {
     pData = mMemoryOffsetBuffer + sizeof(pthread_mutex_t);
     pPtpTimeData = reinterpret_cast<gPtpTimeData*>(pData);
@@ -576,8 +603,102 @@ IasAvbProcessingResult IasLibPtpDaemon::triggerStorePersistenceData() const
   return ret;
 }
 
+IasAvbProcessingResult IasLibPtpDaemon::initVirtualClock(uint64_t startTime)
+{
+  IasAvbProcessingResult result = eIasAvbProcOK;
+
+  if (mInitialized)
+  {
+    DLT_LOG_CXX(*mLog,  DLT_LOG_WARN, LOG_PREFIX, "Already initialized!");
+    result = eIasAvbProcInitializationFailed;
+  }
+  else if (0u == startTime)
+  {
+    // zero time stamps are taken as 'no time available' by the streams
+    result = eIasAvbProcInvalidParam;
+  }
+  else
+  {
+    mVirtualTime = startTime;
+    mVirtualClockUsers = 0u;
+    mVirtualWakeups.clear();
+    mVirtualClock = true;
+    mInitialized = true;
+    DLT_LOG_CXX(*mLog,  DLT_LOG_INFO, LOG_PREFIX, "virtual clock started at", startTime);
+  }
+
+  return result;
+}
+
+int32_t IasLibPtpDaemon::sleepUntil(uint64_t sysTime)
+{
+  int32_t result = 0;
+
+  if (mVirtualClock)
+  {
+    std::unique_lock<std::mutex> lock(mVirtualClockLock);
+    if (sysTime > mVirtualTime)
+    {
+      const std::multiset<uint64_t>::iterator wakeup = mVirtualWakeups.insert(sysTime);
+      while (sysTime > mVirtualTime)
+      {
+        /*
+         * Advance only if all attached threads are sleeping. A wakeup time not beyond the current time
+         * belongs to a thread that has not run yet, so wait for it to get to sleep again.
+         */
+        const uint64_t next = *mVirtualWakeups.begin();
+        if ((mVirtualWakeups.size() >= mVirtualClockUsers) && (next > mVirtualTime))
+        {
+          mVirtualTime = next;
+          mVirtualClockCond.notify_all();
+        }
+        else
+        {
+          mVirtualClockCond.wait(lock);
+        }
+      }
+      mVirtualWakeups.erase(wakeup);
+    }
+  }
+  else
+  {
+    timespec tp;
+    convertNsToTimespec(sysTime, tp);
+    // clock_nanosleep() returns a positive error number, but does not set errno
+    result = -clock_nanosleep(cSysClockId, TIMER_ABSTIME, &tp, NULL);
+  }
+
+  return result;
+}
+
+void IasLibPtpDaemon::attachVirtualClock()
+{
+  if (mVirtualClock)
+  {
+    std::lock_guard<std::mutex> lock(mVirtualClockLock);
+    mVirtualClockUsers++;
+  }
+}
+
+void IasLibPtpDaemon::detachVirtualClock()
+{
+  if (mVirtualClock)
+  {
+    std::lock_guard<std::mutex> lock(mVirtualClockLock);
+    AVB_ASSERT(0u != mVirtualClockUsers);
+    mVirtualClockUsers--;
+    // the others might have been waiting for this thread only
+    mVirtualClockCond.notify_all();
+  }
+}
+
 uint64_t IasLibPtpDaemon::getRealLocalTime(const bool force)
 {
+  if (mVirtualClock)
+  {
+    return mVirtualTime.load();
+  }
+
   uint64_t ret;
   uint64_t lt = 0u;
   uint64_t tsc1 = 0u;
@@ -33,6 +33,8 @@ extern size_t heapSpaceLeft;
 extern size_t heapSpaceInitSize;
 
 #include <arpa/inet.h>
+#include <chrono>
+#include <cstring>
 #include <sstream>
 
 namespace IasMediaTransportAvb {
@@ -419,7 +421,8 @@ TEST_F(IasTestAvbAudioStream, InitTransmit_OutOfMemory)
   uint32_t pps = IasAvbTSpec::getPacketsPerSecondByClass(srClass); // packets per second
   heapSpaceLeft = sizeof(IasAvbTSpec) + sizeof(IasAvbStreamId) + sizeof(IasAvbPacketPool) + sizeof(IasAvbPacket)
                     * poolSize + sizeof(size_t) + sizeof(igb_dma_alloc) + sizeof(IasLocalAudioBuffer::AudioData)
-                    * ((sampleFreq + pps - 1u) / pps) + sizeof(int) * (IasAvbAudioStream::cFillLevelFifoSize - 1u);
+                    * ((sampleFreq + pps - 1u) / pps) * maxNumberChannels
+                    + sizeof(int) * (IasAvbAudioStream::cFillLevelFifoSize - 1u);
   // not enough mem to create fillLevelFifo
   ASSERT_EQ(eIasAvbProcNotEnoughMemory, mAudioStream->initTransmit(srClass, maxNumberChannels, sampleFreq, format, avbStreamIdObj, poolSize, avbClockDomainObj, avbMacAddr, true));
 
@@ -716,7 +719,7 @@ TEST_F(IasTestAvbAudioStream, WriteToAvbPacket)
   uint8_t _vaddr[1024];
   memset(_vaddr, 0, sizeof _vaddr);
   packet.vaddr = _vaddr;
-  // avtpBase8[22] & 0x10                          (F)
+  // mSparseTimestamps                            (F)
   // isConnected()                                 (T)
   // mLocalStream->hasSideChannel()                (T)
   // mDummySamplesSent > 0u                        (F)
@@ -725,22 +728,20 @@ TEST_F(IasTestAvbAudioStream, WriteToAvbPacket)
   ASSERT_TRUE(mAudioStream->writeToAvbPacket(&packet));
 
   memset(_vaddr, 0, sizeof _vaddr);
-  uint8_t* const avtpBase8 = static_cast<uint8_t*>(packet.vaddr) + 18;
-  avtpBase8[22]                         = 0x10u;
+  mAudioStream->mSparseTimestamps       = true;
   mAudioStream->mSeqNum                 = 8u;
   mAudioStream->mDummySamplesSent       = 1u;
   mAudioStream->mWaitForData            = true;
   mAudioStream->mUseSaturation          = false;
   mAudioStream->mCompatibilityModeAudio = eIasAvbCompD6;
   mAudioStream->mDebugIn                = false;
-  // avtpBase8[22] & 0x10                          (T)
+  // mSparseTimestamps                            (T)
   // !(mSeqNum % 8)                                (T)
   // (eIasAvbCompSaf == mCompatibilityModeAudio)  (F)
   // || (eIasAvbCompD6 == mCompatibilityModeAudio) (|| T)
   ASSERT_TRUE(mAudioStream->writeToAvbPacket(&packet));
 
   memset(_vaddr, 0, sizeof _vaddr);
-  avtpBase8[22]                         = 0x10u;
   mAudioStream->mCompatibilityModeAudio = eIasAvbCompLatest;
   mAudioStream->mRefPlaneSampleCount     = 0u;
   mAudioStream->mRefPlaneSampleTime      = 1u;
@@ -748,7 +749,7 @@ TEST_F(IasTestAvbAudioStream, WriteToAvbPacket)
   mAudioStream->mDummySamplesSent       = 1u;
   mAudioStream->mDumpCount              = 11u;
   mAudioStream->mSampleIntervalNs       = -0.08f;
-  // avtpBase8[22] & 0x10                          (T)
+  // mSparseTimestamps                            (T)
   // !(mSeqNum % 8)                                (F)
   // (eIasAvbCompSaf == mCompatibilityModeAudio)  (F)
   // || (eIasAvbCompD6 == mCompatibilityModeAudio) (|| F)
@@ -1278,6 +1279,72 @@ TEST_F(IasTestAvbAudioStream, ReadFromAvbPacket)
 }
 #endif
 
+TEST_F(IasTestAvbAudioStream, DispatchPackets)
+{
+  ASSERT_TRUE(mAudioStream != NULL);
+
+  const uint32_t cNumPackets = 4u;
+  uint8_t packets[cNumPackets][256];
+  memset(packets, 0, sizeof packets);
+
+  ASSERT_TRUE(createEnvironment());
+
+  uint16_t maxNumberChannels      = 2u;
+  uint32_t sampleFrequency        = 48000u;
+  IasAvbMacAddress avbMacAddr   = {0};
+  IasAvbStreamId avbStreamIdObj;
+  ASSERT_EQ(eIasAvbProcOK, setConfigValue(IasRegKeys::cCompatibilityAudio, "latest"));
+  ASSERT_EQ(eIasAvbProcOK, setConfigValue(IasRegKeys::cAudioTstampBuffer,
+                           IasLocalAudioBufferDesc::AudioBufferDescMode::eIasAudioBufferDescModeFailSafe));
+
+  ASSERT_EQ(eIasAvbProcOK, mAudioStream->initReceive(IasAvbSrClass::eIasAvbSrClassHigh,
+                                                     maxNumberChannels,
+                                                     sampleFrequency,
+                                                     IasAvbAudioFormat::eIasAvbAudioFormatSaf16,
+                                                     avbStreamIdObj,
+                                                     avbMacAddr,
+                                                     2u,
+                                                     true));
+
+  LocalAudioDummyStream * localStream = new LocalAudioDummyStream(mDltCtx,
+                                                  IasAvbStreamDirection::eIasAvbReceiveFromNetwork, 1u);
+  ASSERT_EQ(eIasAvbProcOK, localStream->init(maxNumberChannels, 256u, sampleFrequency, 0u, false));
+  ASSERT_EQ(eIasAvbProcOK, mAudioStream->connectTo(localStream));
+  mAudioStream->activate();
+  mAudioStream->mValidationMode = IasAvbAudioStream::cValidateAlways;
+
+  IasAvbStream::RxPacket burst[cNumPackets];
+  for (uint32_t i = 0u; i < cNumPackets; i++)
+  {
+    uint8_t*  const avtpBase8  = packets[i];
+    uint16_t* const avtpBase16 = reinterpret_cast<uint16_t*>(avtpBase8);
+
+    avtpBase8[0]   = 0x02u;
+    avtpBase8[2]   = uint8_t(i);
+    avtpBase8[16]  = mAudioStream->mAudioFormatCode;
+    avtpBase8[17]  = uint8_t(mAudioStream->getSampleFrequencyCode(sampleFrequency) << 4);
+    avtpBase8[18]  = uint8_t(maxNumberChannels);
+    avtpBase16[10] = htons(uint16_t(6u * maxNumberChannels * sizeof(uint16_t)));
+
+    burst[i].packet = packets[i];
+    burst[i].length = sizeof packets[i];
+    burst[i].now    = 0u;
+  }
+
+  // same as dispatching them one by one: every packet is counted and validated in sequence
+  mAudioStream->dispatchPackets(burst, cNumPackets);
+  ASSERT_EQ(cNumPackets, mAudioStream->getDiagnostics().getFramesRx());
+  ASSERT_EQ(0u, mAudioStream->getDiagnostics().getSeqNumMismatch());
+  ASSERT_EQ(uint8_t(cNumPackets - 1u), mAudioStream->mSeqNum);
+
+  // empty bursts are ignored
+  mAudioStream->dispatchPackets(burst, 0u);
+  ASSERT_EQ(cNumPackets, mAudioStream->getDiagnostics().getFramesRx());
+
+  ASSERT_EQ(eIasAvbProcOK, mAudioStream->connectTo(NULL));
+  delete localStream;
+}
+
 TEST_F(IasTestAvbAudioStream, ActivationChanged)
 {
   ASSERT_TRUE(mAudioStream != NULL);
@@ -1700,13 +1767,119 @@ TEST_F(IasTestAvbAudioStream, prepareAllPackets)
   ASSERT_EQ(eIasAvbProcOK, mAudioStream->prepareAllPackets());
 
   IasAvbPacketPool * mPool = &mAudioStream->getPacketPool();
-  mPool->mLock.lock();
   mPool->mFreeBufferStack.clear();
-  mPool->mLock.unlock();
   // NULL == referencePacket
   ASSERT_EQ(eIasAvbProcInitializationFailed, mAudioStream->prepareAllPackets());
 }
 
+namespace
+{
+// per-packet header writes as done before the stream kept a header template, compatibility mode latest
+void writeAvtpHeaderLegacy(uint8_t* avtpBase8, uint8_t seqNum, uint32_t timestamp, bool uncertain,
+    uint16_t numChannels, uint8_t layout, uint16_t streamDataLength, uint8_t sampleFrequencyCode)
+{
+  uint16_t* const avtpBase16 = reinterpret_cast<uint16_t*>(avtpBase8);
+  uint32_t* const avtpBase32 = reinterpret_cast<uint32_t*>(avtpBase8);
+
+  avtpBase32[3] = htonl(timestamp);
+  if (avtpBase8[22] & 0x10)
+  {
+    if (!(seqNum % 8))
+    {
+      avtpBase8[1] |= 0x01;
+    }
+    else
+    {
+      avtpBase8[1] &= uint8_t(~0x01);
+    }
+  }
+  avtpBase8[2] = seqNum;
+  avtpBase8[22] = uint8_t((avtpBase8[22] & 0xF0) | (layout & 0x0F));
+  avtpBase8[17] = uint8_t((sampleFrequencyCode << 4) | ((numChannels >> 8) & 0x0003u));
+  avtpBase8[18] = uint8_t(numChannels & 0x00ffu);
+  *(avtpBase16 + 10) = htons(streamDataLength);
+  avtpBase8[3] = uncertain ? 0x01u : 0x00u;
+}
+}
+
+TEST_F(IasTestAvbAudioStream, writeAvtpHeader)
+{
+  ASSERT_TRUE(mAudioStream != NULL);
+  IasAvbPtpClockDomain avbClockDomainObj;
+  IasAvbStreamId avbStreamIdObj(uint64_t(2u));
+  IasAvbMacAddress avbMacAddr = {};
+  IasAvbSrClass srClass = IasAvbSrClass::eIasAvbSrClassHigh;
+  uint16_t maxNumberChannels = 8u;
+  uint32_t sampleFreq = 48000u;
+  IasAvbAudioFormat format = IasAvbAudioFormat::eIasAvbAudioFormatSaf16;
+  uint32_t poolSize = 2u;
+  ASSERT_EQ(eIasAvbProcOK, initStreamHandler());
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, setConfigValue(IasRegKeys::cAudioSparseTS, 1));
+  ASSERT_EQ(eIasAvbProcOK, mAudioStream->initTransmit(srClass,
+                                                      maxNumberChannels,
+                                                      sampleFreq,
+                                                      format,
+                                                      avbStreamIdObj,
+                                                      poolSize,
+                                                      &avbClockDomainObj,
+                                                      avbMacAddr,
+                                                      true));
+  ASSERT_EQ(eIasAvbCompLatest, mAudioStream->mCompatibilityModeAudio);
+  ASSERT_TRUE(mAudioStream->mSparseTimestamps);
+
+  // both start from the packet template
+  IasAvbPacket * packet = mAudioStream->getPacketPool().getPacket();
+  ASSERT_TRUE(NULL != packet);
+  const size_t headerLen = packet->len;
+  ASSERT_EQ(size_t(ETH_HLEN + 4u + IasAvbAudioFormatTraits<IasAvbAudioFormat::eIasAvbAudioFormatSaf16>::cHeaderSize),
+      headerLen);
+  uint8_t legacy[64];
+  uint8_t patched[64];
+  (void) memcpy(legacy, packet->getBasePtr(), headerLen);
+  (void) memcpy(patched, packet->getBasePtr(), headerLen);
+  (void) IasAvbPacketPool::returnPacket(packet);
+  uint8_t* const legacyAvtp = legacy + ETH_HLEN + 4u;
+  uint8_t* const patchedAvtp = patched + ETH_HLEN + 4u;
+  const uint8_t sfc = mAudioStream->mSampleFrequencyCode;
+
+  // bit-exact for all combinations of the per-packet inputs, incl. changes of the format block
+  for (uint32_t i = 0u; i < 512u; i++)
+  {
+    const uint8_t seqNum = uint8_t(i);
+    const uint32_t timestamp = i * 125013u;
+    const bool uncertain = (0u == (i % 5u));
+    const uint16_t numChannels = uint16_t((i / 64u) % (maxNumberChannels + 1u));
+    const uint8_t layout = uint8_t((i / 32u) % 3u);
+    const uint16_t streamDataLength = uint16_t(numChannels * 6u * 2u);
+
+    writeAvtpHeaderLegacy(legacyAvtp, seqNum, timestamp, uncertain, numChannels, layout, streamDataLength, sfc);
+    mAudioStream->mSeqNum = seqNum;
+    mAudioStream->writeAvtpHeader(patchedAvtp, timestamp, uncertain, numChannels, layout, streamDataLength);
+    ASSERT_EQ(0, memcmp(legacy, patched, headerLen)) << "packet " << i;
+  }
+
+  // per-packet header cost before and after, the format block does not change within a stream
+  const uint32_t cNumPackets = 1000000u;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0u; i < cNumPackets; i++)
+  {
+    writeAvtpHeaderLegacy(legacyAvtp, uint8_t(i), i * 125000u, false, 2u, 0u, 24u, sfc);
+  }
+  const int64_t legacyNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+  start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0u; i < cNumPackets; i++)
+  {
+    mAudioStream->mSeqNum = uint8_t(i);
+    mAudioStream->writeAvtpHeader(patchedAvtp, i * 125000u, false, 2u, 0u, 24u);
+  }
+  const int64_t patchedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+  ASSERT_EQ(0, memcmp(legacy, patched, headerLen));
+  RecordProperty("legacyPsPerPacket", int(legacyNs * 1000 / int64_t(cNumPackets)));
+  RecordProperty("templatePsPerPacket", int(patchedNs * 1000 / int64_t(cNumPackets)));
+}
+
 TEST_F(IasTestAvbAudioStream, getMaxTransmitTime)
 {
   ASSERT_TRUE(mAudioStream != NULL);
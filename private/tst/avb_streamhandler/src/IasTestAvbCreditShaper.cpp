@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file IasTestAvbCreditShaper.cpp
+ * @date 2018
+ */
+
+#include "gtest/gtest.h"
+
+#define private public
+#define protected public
+#include "avb_streamhandler/IasAvbCreditShaper.hpp"
+#undef protected
+#undef private
+
+using namespace IasMediaTransportAvb;
+
+namespace
+{
+
+const uint64_t cLinkRate = 1000000000u;   // 1 Gbit/s
+const uint64_t cIdleSlope = 100000000u;   // 100 Mbit/s reserved
+const uint32_t cMaxInterference = 1522u;
+const uint64_t cStart = 1000000000u;      // arbitrary start time in ns
+
+}
+
+
+class IasTestAvbCreditShaper : public ::testing::Test
+{
+protected:
+  IasTestAvbCreditShaper() :
+    mShaper(NULL)
+  {
+  }
+
+  virtual ~IasTestAvbCreditShaper() {}
+
+  // Sets up the test fixture.
+  virtual void SetUp()
+  {
+    mShaper = new IasAvbCreditShaper();
+  }
+
+  virtual void TearDown()
+  {
+    delete mShaper;
+    mShaper = NULL;
+  }
+
+  // configure the shaper as the highest SR class
+  void configure(uint32_t maxFrameSize)
+  {
+    IasAvbCreditShaper::Config config;
+    ASSERT_EQ(eIasAvbProcOK, IasAvbCreditShaper::calculate(config, cLinkRate, cIdleSlope, maxFrameSize,
+        cMaxInterference, 0u, 0u));
+    mShaper->configure(config);
+  }
+
+  IasAvbCreditShaper *mShaper;
+};
+
+
+TEST_F(IasTestAvbCreditShaper, CTor_DTor)
+{
+  ASSERT_TRUE(mShaper != NULL);
+  ASSERT_FALSE(mShaper->isEnabled());
+
+  // a disabled shaper does not touch the launch times
+  ASSERT_EQ(cStart, mShaper->shape(cStart, cStart + 1000u, 1500u));
+  ASSERT_EQ(cStart, mShaper->shape(cStart, 0u, 1500u));
+}
+
+TEST_F(IasTestAvbCreditShaper, calculate)
+{
+  IasAvbCreditShaper::Config config;
+
+  ASSERT_EQ(eIasAvbProcInvalidParam, IasAvbCreditShaper::calculate(config, 0u, 0u, 1000u, cMaxInterference, 0u, 0u));
+  ASSERT_EQ(eIasAvbProcInvalidParam, IasAvbCreditShaper::calculate(config, cLinkRate, cLinkRate, 1000u,
+      cMaxInterference, 0u, 0u));
+  ASSERT_EQ(eIasAvbProcInvalidParam, IasAvbCreditShaper::calculate(config, cLinkRate, cIdleSlope, 1000u,
+      cMaxInterference, cLinkRate - cIdleSlope, 1000u));
+
+  // highest class: hiCredit = maxInterferenceSize * idleSlope / portTransmitRate
+  ASSERT_EQ(eIasAvbProcOK, IasAvbCreditShaper::calculate(config, cLinkRate, cIdleSlope, 1000u, cMaxInterference, 0u, 0u));
+  ASSERT_EQ(cLinkRate, config.portTransmitRate);
+  ASSERT_EQ(cIdleSlope, config.idleSlope);
+  ASSERT_NEAR(1522.0 * 8.0 * 0.1, config.hiCredit, 1e-6);
+  // loCredit = maxFrameSize * sendSlope / portTransmitRate
+  ASSERT_NEAR(-1000.0 * 8.0 * 0.9, config.loCredit, 1e-6);
+
+  // next class: hiCredit = idleSlope * (maxInterferenceSize / (portTransmitRate - idleSlopeHigh) + maxFrameSizeHigh / portTransmitRate)
+  ASSERT_EQ(eIasAvbProcOK, IasAvbCreditShaper::calculate(config, cLinkRate, 200000000u, 1000u, cMaxInterference,
+      300000000u, 500u));
+  ASSERT_NEAR(2e8 * ((1522.0 * 8.0 / 7e8) + (500.0 * 8.0 / 1e9)), config.hiCredit, 1e-6);
+  ASSERT_NEAR(-1000.0 * 8.0 * 0.8, config.loCredit, 1e-6);
+
+  // zero bandwidth turns the shaper off
+  ASSERT_EQ(eIasAvbProcOK, IasAvbCreditShaper::calculate(config, cLinkRate, 0u, 1000u, cMaxInterference, 0u, 0u));
+  mShaper->configure(config);
+  ASSERT_FALSE(mShaper->isEnabled());
+}
+
+TEST_F(IasTestAvbCreditShaper, bandwidth)
+{
+  const uint32_t cFrameSize = 1000u;
+  const uint32_t cNumFrames = 1000u;
+  configure(cFrameSize);
+  ASSERT_TRUE(mShaper->isEnabled());
+
+  // all frames queued at once, the shaper spreads them at idleSlope
+  uint64_t first = 0u;
+  uint64_t last = 0u;
+  for (uint32_t i = 0u; i < cNumFrames; i++)
+  {
+    last = mShaper->shape(cStart, 0u, cFrameSize);
+    if (0u == i)
+    {
+      first = last;
+      ASSERT_EQ(cStart, first);
+    }
+
+    // credit stays within the bounds
+    ASSERT_LE(mShaper->getConfig().loCredit - 1e-6, mShaper->getCredit());
+    ASSERT_GE(mShaper->getConfig().hiCredit, mShaper->getCredit());
+  }
+
+  // one frame per frameSize / idleSlope = 80us
+  const double bits = double(cFrameSize) * 8.0 * double(cNumFrames);
+  const double elapsed = double(last + 8000u - first) / 1e9;
+  const double expectedPeriod = double(cFrameSize) * 8.0 * 1e9 / double(cIdleSlope);
+  ASSERT_NEAR(expectedPeriod * double(cNumFrames - 1u), double(last - first), double(cNumFrames));
+  ASSERT_LE(bits / elapsed, double(cIdleSlope) * 1.001);
+  ASSERT_GE(bits / elapsed, double(cIdleSlope) * 0.99);
+}
+
+TEST_F(IasTestAvbCreditShaper, burst)
+{
+  const uint32_t cFrameSize = 64u;
+  configure(cFrameSize);
+
+  // the frames are held back by interfering traffic for 1ms, the credit saturates at hiCredit
+  const uint64_t released = cStart + 1000000u;
+  const uint64_t frameTime = cFrameSize * 8u;  // ns at 1 Gbit/s
+  uint64_t launch = mShaper->shape(cStart, released, cFrameSize);
+  ASSERT_EQ(released, launch);
+
+  // count the frames sent back to back
+  uint32_t burst = 1u;
+  uint64_t next = mShaper->shape(cStart, 0u, cFrameSize);
+  while (next == (launch + frameTime))
+  {
+    burst++;
+    launch = next;
+    next = mShaper->shape(cStart, 0u, cFrameSize);
+  }
+
+  // maximum burst: hiCredit / (1 - idleSlope / portTransmitRate) plus the frame that drove the credit negative
+  const double alpha = double(cIdleSlope) / double(cLinkRate);
+  const double maxBurst = (mShaper->getConfig().hiCredit / (1.0 - alpha)) + (double(cFrameSize) * 8.0);
+  const double burstBits = double(burst) * double(cFrameSize) * 8.0;
+  ASSERT_LE(burstBits, maxBurst);
+  ASSERT_GE(burstBits, mShaper->getConfig().hiCredit / (1.0 - alpha));
+  ASSERT_EQ(3u, burst);
+
+  // back to idleSlope after the burst
+  ASSERT_GT(next, launch + frameTime);
+}
+
+TEST_F(IasTestAvbCreditShaper, idle)
+{
+  const uint32_t cFrameSize = 1000u;
+  configure(cFrameSize);
+
+  ASSERT_EQ(cStart, mShaper->shape(cStart, 0u, cFrameSize));
+  ASSERT_NEAR(-7200.0, mShaper->getCredit(), 1e-6);
+
+  // the credit recovers while the queue is empty, but does not grow beyond zero
+  const uint64_t later = cStart + 10000000u;
+  ASSERT_EQ(later, mShaper->shape(later, 0u, cFrameSize));
+  ASSERT_NEAR(-7200.0, mShaper->getCredit(), 1e-6);
+
+  // a frame queued before the credit has recovered has to wait
+  const uint64_t early = later + 8000u + 36000u;
+  ASSERT_EQ(later + 80000u, mShaper->shape(early, 0u, cFrameSize));
+
+  // reset drops the negative credit
+  mShaper->reset();
+  ASSERT_EQ(early, mShaper->shape(early, 0u, cFrameSize));
+}
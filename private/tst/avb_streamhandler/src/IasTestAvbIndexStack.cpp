@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file IasTestAvbIndexStack.cpp
+ * @date 2018
+ */
+
+#include "gtest/gtest.h"
+
+#define private public
+#define protected public
+#include "avb_streamhandler/IasAvbIndexStack.hpp"
+#undef protected
+#undef private
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace IasMediaTransportAvb;
+
+
+class IasTestAvbIndexStack : public ::testing::Test
+{
+protected:
+  IasTestAvbIndexStack() :
+    mStack(NULL)
+  {
+  }
+
+  virtual ~IasTestAvbIndexStack() {}
+
+  // Sets up the test fixture.
+  virtual void SetUp()
+  {
+    mStack = new IasAvbIndexStack();
+  }
+
+  virtual void TearDown()
+  {
+    delete mStack;
+    mStack = NULL;
+  }
+
+  IasAvbIndexStack *mStack;
+};
+
+
+TEST_F(IasTestAvbIndexStack, CTor_DTor)
+{
+  ASSERT_TRUE(mStack != NULL);
+  ASSERT_EQ(0u, mStack->getCapacity());
+  ASSERT_TRUE(mStack->empty());
+  ASSERT_EQ(IasAvbIndexStack::cNone, mStack->top());
+
+  uint32_t index = 0u;
+  ASSERT_FALSE(mStack->push(0u));
+  ASSERT_FALSE(mStack->pop(index));
+}
+
+TEST_F(IasTestAvbIndexStack, init)
+{
+  ASSERT_TRUE(mStack != NULL);
+  ASSERT_EQ(eIasAvbProcInvalidParam, mStack->init(0u));
+  ASSERT_EQ(eIasAvbProcInvalidParam, mStack->init(IasAvbIndexStack::cNone));
+
+  ASSERT_EQ(eIasAvbProcOK, mStack->init(4u));
+  ASSERT_EQ(4u, mStack->getCapacity());
+  ASSERT_TRUE(mStack->empty());
+  ASSERT_TRUE(mStack->push(3u));
+  ASSERT_FALSE(mStack->push(4u));
+
+  // init again drops all entries
+  ASSERT_EQ(eIasAvbProcOK, mStack->init(8u));
+  ASSERT_TRUE(mStack->empty());
+
+  mStack->cleanup();
+  ASSERT_EQ(0u, mStack->getCapacity());
+  ASSERT_FALSE(mStack->push(1u));
+}
+
+TEST_F(IasTestAvbIndexStack, pushPop)
+{
+  ASSERT_TRUE(mStack != NULL);
+  ASSERT_EQ(eIasAvbProcOK, mStack->init(4u));
+
+  for (uint32_t i = 0u; i < 4u; i++)
+  {
+    ASSERT_TRUE(mStack->push(i));
+  }
+  ASSERT_EQ(4u, mStack->size());
+
+  // an index can be on the stack only once
+  ASSERT_FALSE(mStack->push(2u));
+  ASSERT_EQ(4u, mStack->size());
+
+  // last in, first out
+  uint32_t index = IasAvbIndexStack::cNone;
+  for (uint32_t i = 4u; i > 0u; i--)
+  {
+    ASSERT_TRUE(mStack->pop(index));
+    ASSERT_EQ(i - 1u, index);
+  }
+  ASSERT_FALSE(mStack->pop(index));
+  ASSERT_TRUE(mStack->empty());
+
+  // popped indices can be pushed again
+  ASSERT_TRUE(mStack->push(2u));
+  ASSERT_TRUE(mStack->pop(index));
+  ASSERT_EQ(2u, index);
+
+  // each change of the head advances the tag
+  const uint64_t tag = mStack->mHead.load() >> 32;
+  ASSERT_TRUE(mStack->push(1u));
+  ASSERT_TRUE(mStack->pop(index));
+  ASSERT_EQ(tag + 2u, mStack->mHead.load() >> 32);
+}
+
+TEST_F(IasTestAvbIndexStack, traverse)
+{
+  ASSERT_TRUE(mStack != NULL);
+  ASSERT_EQ(eIasAvbProcOK, mStack->init(8u));
+
+  ASSERT_TRUE(mStack->push(5u));
+  ASSERT_TRUE(mStack->push(0u));
+  ASSERT_TRUE(mStack->push(7u));
+
+  std::vector<uint32_t> indices;
+  for (uint32_t i = mStack->top(); IasAvbIndexStack::cNone != i; i = mStack->next(i))
+  {
+    indices.push_back(i);
+  }
+  ASSERT_EQ(3u, indices.size());
+  ASSERT_EQ(7u, indices[0]);
+  ASSERT_EQ(0u, indices[1]);
+  ASSERT_EQ(5u, indices[2]);
+
+  mStack->clear();
+  ASSERT_TRUE(mStack->empty());
+  ASSERT_EQ(IasAvbIndexStack::cNone, mStack->top());
+  ASSERT_TRUE(mStack->push(5u));
+}
+
+TEST_F(IasTestAvbIndexStack, concurrent)
+{
+  ASSERT_TRUE(mStack != NULL);
+
+  const uint32_t cCapacity = 64u;
+  const uint32_t cNumThreads = 4u;
+  const uint32_t cNumRounds = 200000u;
+  ASSERT_EQ(eIasAvbProcOK, mStack->init(cCapacity));
+  for (uint32_t i = 0u; i < cCapacity; i++)
+  {
+    ASSERT_TRUE(mStack->push(i));
+  }
+
+  // each index taken is owned by one thread only until it is pushed back
+  std::vector<std::atomic<uint32_t> > owners(cCapacity);
+  for (uint32_t i = 0u; i < cCapacity; i++)
+  {
+    owners[i] = 0u;
+  }
+  std::atomic<uint32_t> errors(0u);
+
+  std::vector<std::thread> threads;
+  for (uint32_t t = 0u; t < cNumThreads; t++)
+  {
+    threads.push_back(std::thread([this, &owners, &errors, cNumRounds]()
+    {
+      uint32_t taken[4];
+      for (uint32_t round = 0u; round < cNumRounds; round++)
+      {
+        uint32_t count = 0u;
+        while ((count < 4u) && mStack->pop(taken[count]))
+        {
+          if (0u != owners[taken[count]].exchange(1u))
+          {
+            errors++;
+          }
+          count++;
+        }
+        while (count > 0u)
+        {
+          count--;
+          owners[taken[count]] = 0u;
+          if (!mStack->push(taken[count]))
+          {
+            errors++;
+          }
+        }
+      }
+    }));
+  }
+
+  for (std::vector<std::thread>::iterator it = threads.begin(); it != threads.end(); ++it)
+  {
+    it->join();
+  }
+
+  ASSERT_EQ(0u, errors.load());
+  ASSERT_EQ(cCapacity, mStack->size());
+
+  // nothing lost, nothing duplicated
+  std::vector<bool> seen(cCapacity, false);
+  uint32_t index = 0u;
+  while (mStack->pop(index))
+  {
+    ASSERT_LT(index, cCapacity);
+    ASSERT_FALSE(seen[index]);
+    seen[index] = true;
+  }
+  for (uint32_t i = 0u; i < cCapacity; i++)
+  {
+    ASSERT_TRUE(seen[i]);
+  }
+}
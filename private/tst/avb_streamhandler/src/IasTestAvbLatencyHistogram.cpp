@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file IasTestAvbLatencyHistogram.cpp
+ * @date 2018
+ */
+
+#include "gtest/gtest.h"
+
+#define private public
+#define protected public
+#include "avb_streamhandler/IasAvbLatencyHistogram.hpp"
+#undef protected
+#undef private
+
+#include <thread>
+
+using namespace IasMediaTransportAvb;
+
+class IasTestAvbLatencyHistogram : public ::testing::Test
+{
+protected:
+  IasTestAvbLatencyHistogram() :
+    mHistogram(NULL)
+  {
+  }
+
+  virtual ~IasTestAvbLatencyHistogram() {}
+
+  // Sets up the test fixture.
+  virtual void SetUp()
+  {
+    mHistogram = new IasAvbLatencyHistogram();
+  }
+
+  virtual void TearDown()
+  {
+    delete mHistogram;
+    mHistogram = NULL;
+  }
+
+  IasAvbLatencyHistogram *mHistogram;
+};
+
+
+TEST_F(IasTestAvbLatencyHistogram, CTor_DTor)
+{
+  ASSERT_TRUE(mHistogram != NULL);
+  ASSERT_EQ(0u, mHistogram->getCount());
+  ASSERT_EQ(0, mHistogram->getMin());
+  ASSERT_EQ(0, mHistogram->getMax());
+  ASSERT_EQ(0, mHistogram->getMean());
+  ASSERT_EQ(0, mHistogram->getValueAtPercentile(50.0));
+}
+
+TEST_F(IasTestAvbLatencyHistogram, buckets)
+{
+  // the buckets cover the value range without gaps
+  ASSERT_EQ(0u, IasAvbLatencyHistogram::getBucketLowerBound(0u));
+  for (uint32_t i = 1u; i < IasAvbLatencyHistogram::cNumBuckets; i++)
+  {
+    ASSERT_EQ(IasAvbLatencyHistogram::getBucketUpperBound(i - 1u) + 1u, IasAvbLatencyHistogram::getBucketLowerBound(i));
+    ASSERT_EQ(i, IasAvbLatencyHistogram::getBucketIndex(IasAvbLatencyHistogram::getBucketLowerBound(i)));
+    ASSERT_EQ(i, IasAvbLatencyHistogram::getBucketIndex(IasAvbLatencyHistogram::getBucketUpperBound(i)));
+  }
+  ASSERT_EQ(IasAvbLatencyHistogram::cMaxValue,
+            IasAvbLatencyHistogram::getBucketUpperBound(IasAvbLatencyHistogram::cNumBuckets - 1u));
+  ASSERT_EQ(IasAvbLatencyHistogram::cNumBuckets - 1u, IasAvbLatencyHistogram::getBucketIndex(uint64_t(1u) << 40));
+
+  // relative bucket width
+  const uint32_t index = IasAvbLatencyHistogram::getBucketIndex(1000000u);
+  const uint64_t width = IasAvbLatencyHistogram::getBucketUpperBound(index) - IasAvbLatencyHistogram::getBucketLowerBound(index) + 1u;
+  ASSERT_LE(width * IasAvbLatencyHistogram::cSubBuckets, IasAvbLatencyHistogram::getBucketLowerBound(index));
+}
+
+TEST_F(IasTestAvbLatencyHistogram, record)
+{
+  ASSERT_TRUE(mHistogram != NULL);
+
+  for (int64_t i = 1; i <= 1000; i++)
+  {
+    mHistogram->record(i * 1000);
+  }
+  ASSERT_EQ(1000u, mHistogram->getCount());
+  ASSERT_EQ(1000, mHistogram->getMin());
+  ASSERT_EQ(1000000, mHistogram->getMax());
+  ASSERT_EQ(500500, mHistogram->getMean());
+
+  const int64_t median = mHistogram->getValueAtPercentile(50.0);
+  ASSERT_LE(500000, median);
+  ASSERT_GE(500000 + 500000 / int64_t(IasAvbLatencyHistogram::cSubBuckets), median);
+  ASSERT_EQ(1000000, mHistogram->getValueAtPercentile(100.0));
+  ASSERT_EQ(1000000, mHistogram->getValueAtPercentile(99.99));
+  ASSERT_LE(1000, mHistogram->getValueAtPercentile(0.0));
+
+  mHistogram->reset();
+  ASSERT_EQ(0u, mHistogram->getCount());
+  ASSERT_EQ(0u, mHistogram->getBucketCount(IasAvbLatencyHistogram::getBucketIndex(1000u)));
+}
+
+TEST_F(IasTestAvbLatencyHistogram, outOfRange)
+{
+  ASSERT_TRUE(mHistogram != NULL);
+
+  mHistogram->record(-5000);
+  mHistogram->record(-10);
+  mHistogram->record(60);
+  mHistogram->record(int64_t(1) << 40);
+  ASSERT_EQ(4u, mHistogram->getCount());
+  ASSERT_EQ(2u, mHistogram->getNegativeCount());
+  ASSERT_EQ(1u, mHistogram->getOverflowCount());
+  ASSERT_EQ(-5000, mHistogram->getMin());
+  ASSERT_EQ(int64_t(1) << 40, mHistogram->getMax());
+
+  // negative samples rank first and are reported as the minimum
+  ASSERT_EQ(-5000, mHistogram->getValueAtPercentile(50.0));
+  ASSERT_EQ(60, mHistogram->getValueAtPercentile(75.0));
+  ASSERT_EQ(int64_t(IasAvbLatencyHistogram::cMaxValue), mHistogram->getValueAtPercentile(100.0));
+  ASSERT_EQ(1u, mHistogram->getBucketCount(IasAvbLatencyHistogram::cNumBuckets - 1u));
+}
+
+TEST_F(IasTestAvbLatencyHistogram, merge)
+{
+  ASSERT_TRUE(mHistogram != NULL);
+
+  IasAvbLatencyHistogram other;
+  mHistogram->merge(other);
+  ASSERT_EQ(0u, mHistogram->getCount());
+
+  other.record(-20);
+  other.record(3000);
+  mHistogram->merge(other);
+  ASSERT_EQ(2u, mHistogram->getCount());
+  ASSERT_EQ(-20, mHistogram->getMin());
+  ASSERT_EQ(3000, mHistogram->getMax());
+
+  other.reset();
+  other.record(100);
+  other.record(int64_t(1) << 40);
+  mHistogram->merge(other);
+  ASSERT_EQ(4u, mHistogram->getCount());
+  ASSERT_EQ(1u, mHistogram->getNegativeCount());
+  ASSERT_EQ(1u, mHistogram->getOverflowCount());
+  ASSERT_EQ(-20, mHistogram->getMin());
+  ASSERT_EQ(int64_t(1) << 40, mHistogram->getMax());
+  ASSERT_EQ(1u, mHistogram->getBucketCount(IasAvbLatencyHistogram::getBucketIndex(100u)));
+  ASSERT_EQ(1u, mHistogram->getBucketCount(IasAvbLatencyHistogram::getBucketIndex(3000u)));
+  ASSERT_EQ(((int64_t(1) << 40) + 3080) / 4, mHistogram->getMean());
+}
+
+TEST_F(IasTestAvbLatencyHistogram, snapshotAndRequestReset)
+{
+  ASSERT_TRUE(mHistogram != NULL);
+
+  mHistogram->record(100);
+  mHistogram->record(200);
+
+  IasAvbLatencyHistogram copy;
+  mHistogram->snapshot(copy);
+  ASSERT_EQ(2u, copy.getCount());
+  ASSERT_EQ(150, copy.getMean());
+
+  // the samples stay until the writer records the next one, but are not reported anymore
+  mHistogram->requestReset();
+  ASSERT_EQ(2u, mHistogram->getCount());
+  mHistogram->snapshot(copy);
+  ASSERT_EQ(0u, copy.getCount());
+
+  mHistogram->record(300);
+  mHistogram->snapshot(copy);
+  ASSERT_EQ(1u, copy.getCount());
+  ASSERT_EQ(300, copy.getMin());
+  ASSERT_EQ(1u, copy.getBucketCount(IasAvbLatencyHistogram::getBucketIndex(300u)));
+}
+
+TEST_F(IasTestAvbLatencyHistogram, snapshotConcurrent)
+{
+  ASSERT_TRUE(mHistogram != NULL);
+
+  const uint64_t cNumValues = 200000u;
+  std::thread writer([this, cNumValues]()
+  {
+    for (uint64_t i = 0u; i < cNumValues; i++)
+    {
+      mHistogram->record(int64_t(i % 5000u) - 10);
+    }
+  });
+
+  uint64_t lastCount = 0u;
+  bool consistent = true;
+  IasAvbLatencyHistogram copy;
+  while (consistent && (lastCount < cNumValues))
+  {
+    mHistogram->snapshot(copy);
+
+    // every copy has to be the state after a complete record()
+    uint64_t total = copy.getNegativeCount();
+    for (uint32_t i = 0u; i < IasAvbLatencyHistogram::cNumBuckets; i++)
+    {
+      total += copy.getBucketCount(i);
+    }
+    consistent = (total == copy.getCount()) && (copy.getCount() >= lastCount);
+    lastCount = copy.getCount();
+  }
+  writer.join();
+
+  ASSERT_TRUE(consistent);
+  ASSERT_EQ(cNumValues, lastCount);
+}
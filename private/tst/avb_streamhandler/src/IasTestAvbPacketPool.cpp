@@ -18,6 +18,16 @@
 
 #include "test_common/IasSpringVilleInfo.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
 extern size_t heapSpaceLeft;
 extern size_t heapSpaceInitSize;
 
@@ -294,18 +304,22 @@ TEST_F(IasTestAvbPacketPool, DoReturnPacket)
 
   IasAvbPacket *p = mAvbPacketPool->getPacket();
   ASSERT_TRUE(NULL != p);
+  ASSERT_EQ(poolSize - 1u, mAvbPacketPool->mFreeBufferStack.size());
 
   // healthy return
-  result = mAvbPacketPool->returnPacket(&packet);
+  result = mAvbPacketPool->returnPacket(p);
   ASSERT_EQ(eIasAvbProcOK, result);
+  ASSERT_EQ(poolSize, mAvbPacketPool->mFreeBufferStack.size());
 
-  // return once too many - warning message issued
-  result = mAvbPacketPool->returnPacket(&packet);
+  // return once too many - error message issued, the packet is not put on the stack twice
+  result = mAvbPacketPool->returnPacket(p);
   ASSERT_EQ(eIasAvbProcOK, result);
+  ASSERT_EQ(poolSize, mAvbPacketPool->mFreeBufferStack.size());
 
-  // return twice too many - ignored silently
+  // a packet that is not part of the pool
   result = mAvbPacketPool->returnPacket(&packet);
-  ASSERT_EQ(eIasAvbProcOK, result);
+  ASSERT_EQ(eIasAvbProcInvalidParam, result);
+  ASSERT_EQ(poolSize, mAvbPacketPool->mFreeBufferStack.size());
 }
 
 TEST_F(IasTestAvbPacketPool, InitAllPacketsFromTemplate)
@@ -369,4 +383,182 @@ TEST_F(IasTestAvbPacketPool, Reset)
   ASSERT_EQ(eIasAvbProcNotInitialized, mAvbPacketPool->reset());
 }
 
+TEST_F(IasTestAvbPacketPool, resetWhileReturning)
+{
+  ASSERT_TRUE(NULL != mAvbPacketPool);
+
+  mEnvironment->setDefaultConfigValues();
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cXmitBackend, "memory"));
+  const uint32_t poolSize = 64u;
+  ASSERT_EQ(eIasAvbProcOK, mAvbPacketPool->init(128u, poolSize));
+
+  // the igb reclaim of another sequencer returns the packets while the pool is reset
+  for (uint32_t round = 0u; round < 100u; round++)
+  {
+    std::vector<IasAvbPacket*> packets;
+    IasAvbPacket *packet = NULL;
+    while (NULL != (packet = mAvbPacketPool->getPacket()))
+    {
+      packets.push_back(packet);
+    }
+    ASSERT_EQ(poolSize, packets.size());
+
+    std::thread reclaim([&packets]()
+    {
+      for (std::vector<IasAvbPacket*>::iterator it = packets.begin(); it != packets.end(); ++it)
+      {
+        (void) IasAvbPacketPool::returnPacket(*it);
+      }
+    });
+    ASSERT_EQ(eIasAvbProcOK, mAvbPacketPool->reset());
+    reclaim.join();
+
+    // each packet is free exactly once
+    std::vector<bool> seen(poolSize, false);
+    uint32_t count = 0u;
+    for (uint32_t index = mAvbPacketPool->mFreeBufferStack.top(); IasAvbIndexStack::cNone != index;
+         index = mAvbPacketPool->mFreeBufferStack.next(index))
+    {
+      ASSERT_GT(poolSize, index);
+      ASSERT_FALSE(seen[index]);
+      seen[index] = true;
+      count++;
+    }
+    ASSERT_EQ(poolSize, count);
+    ASSERT_EQ(poolSize, mAvbPacketPool->mFreeBufferStack.size());
+  }
+}
+
+TEST_F(IasTestAvbPacketPool, allocators)
+{
+  ASSERT_TRUE(NULL != mAvbPacketPool);
+
+  // no igb device needed with the memory transmit backend
+  mEnvironment->setDefaultConfigValues();
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cXmitBackend, "memory"));
+
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cPacketPoolAllocator, "bogus"));
+  ASSERT_EQ(eIasAvbProcInvalidParam, mAvbPacketPool->init(256u, 64u));
+  ASSERT_TRUE(NULL == mAvbPacketPool->mAllocator);
+
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cPacketPoolAllocator, "igb"));
+  ASSERT_EQ(eIasAvbProcInitializationFailed, mAvbPacketPool->init(256u, 64u));
+
+  // heap pages are single system pages
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cPacketPoolAllocator, "heap"));
+  ASSERT_EQ(eIasAvbProcOK, mAvbPacketPool->init(256u, 64u));
+  const size_t pageSize = size_t(::sysconf(_SC_PAGESIZE));
+  ASSERT_EQ((64u * 256u + pageSize - 1u) / pageSize, mAvbPacketPool->mDmaPages.size());
+  mAvbPacketPool->cleanup();
+
+  // huge pages hold the whole pool, with or without huge pages reserved on this machine
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cPacketPoolAllocator, "hugepage"));
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cPacketPoolHugePageNode, 0u));
+  const uint32_t poolSize = 2048u;
+  ASSERT_EQ(eIasAvbProcOK, mAvbPacketPool->init(1500u, poolSize));
+  ASSERT_FALSE(mAvbPacketPool->mAllocator->isDmaCapable());
+  ASSERT_EQ(1u, mAvbPacketPool->mDmaPages.size());
+  ASSERT_EQ(0u, mAvbPacketPool->mDmaPages[0]->mmap_size % (2u * 1024u * 1024u));
+  ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(mAvbPacketPool->mDmaPages[0]->dma_vaddr) % (2u * 1024u * 1024u));
+
+  std::vector<IasAvbPacket*> packets;
+  IasAvbPacket *packet = NULL;
+  while (NULL != (packet = mAvbPacketPool->getPacket()))
+  {
+    ASSERT_EQ(0u, static_cast<uint8_t*>(packet->getBasePtr())[1499]);
+    std::memset(packet->getBasePtr(), 0xA5, 1500u);
+    packets.push_back(packet);
+  }
+  ASSERT_EQ(poolSize, packets.size());
+  for (std::vector<IasAvbPacket*>::iterator it = packets.begin(); it != packets.end(); ++it)
+  {
+    ASSERT_EQ(eIasAvbProcOK, IasAvbPacketPool::returnPacket(*it));
+  }
+  mAvbPacketPool->cleanup();
+  ASSERT_TRUE(NULL == mAvbPacketPool->mAllocator);
+}
+
+TEST_F(IasTestAvbPacketPool, contention)
+{
+  ASSERT_TRUE(NULL != mAvbPacketPool);
+
+  // without igb device, the pool takes its pages from the heap
+  mEnvironment->setDefaultConfigValues();
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cXmitBackend, "memory"));
+  const uint32_t poolSize = 256u;
+  ASSERT_EQ(eIasAvbProcOK, mAvbPacketPool->init(128u, poolSize));
+  ASSERT_FALSE(mAvbPacketPool->mAllocator->isDmaCapable());
+
+  // producers take packets and hand them over to the consumers, which return them, each thread on its own core
+  const uint32_t cNumPairs = 2u;
+  const uint32_t cNumPackets = 500000u;
+  const uint32_t numCpus = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<std::atomic<IasAvbPacket*> > handover(cNumPairs);
+  std::atomic<uint32_t> errors(0u);
+  std::vector<std::thread> threads;
+
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0u; i < (2u * cNumPairs); i++)
+  {
+    threads.push_back(std::thread([this, i, &handover, &errors, cNumPackets]()
+    {
+      std::atomic<IasAvbPacket*> &slot = handover[i / 2u];
+      for (uint32_t n = 0u; n < cNumPackets; n++)
+      {
+        if (0u == (i % 2u))
+        {
+          IasAvbPacket *packet = NULL;
+          while (NULL == (packet = mAvbPacketPool->getPacket()))
+          {
+            std::this_thread::yield();
+          }
+          // plus some packets taken and returned on the same thread
+          IasAvbPacket *own = mAvbPacketPool->getPacket();
+          if ((NULL != own) && (eIasAvbProcOK != IasAvbPacketPool::returnPacket(own)))
+          {
+            errors++;
+          }
+          IasAvbPacket *expected = NULL;
+          while (!slot.compare_exchange_weak(expected, packet))
+          {
+            expected = NULL;
+            std::this_thread::yield();
+          }
+        }
+        else
+        {
+          IasAvbPacket *packet = NULL;
+          while (NULL == (packet = slot.exchange(NULL)))
+          {
+            std::this_thread::yield();
+          }
+          if (eIasAvbProcOK != IasAvbPacketPool::returnPacket(packet))
+          {
+            errors++;
+          }
+        }
+      }
+    }));
+
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(i % numCpus, &cpuSet);
+    (void) pthread_setaffinity_np(threads.back().native_handle(), sizeof cpuSet, &cpuSet);
+  }
+
+  for (std::vector<std::thread>::iterator it = threads.begin(); it != threads.end(); ++it)
+  {
+    it->join();
+  }
+  const std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+
+  ASSERT_EQ(0u, errors.load());
+  ASSERT_EQ(poolSize, mAvbPacketPool->mFreeBufferStack.size());
+
+  const int64_t us = std::max(int64_t(1), int64_t(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+  // one get and one return per handed over packet, twice that for the packets kept on the producer
+  const uint64_t ops = uint64_t(cNumPairs) * cNumPackets * 4u;
+  RecordProperty("opsPerSecond", int(ops * 1000000u / uint64_t(us)));
+}
+
 } /* IasMediaTransportAvb */
@@ -0,0 +1,287 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ *  @file IasTestAvbPacketPrerenderer.cpp
+ *  @date 2018
+ */
+#include "gtest/gtest.h"
+
+#define private public
+#define protected public
+#include "avb_streamhandler/IasAvbPacketPrerenderer.hpp"
+#include "avb_streamhandler/IasAvbPacketPool.hpp"
+#include "avb_streamhandler/IasAvbPacket.hpp"
+#include "avb_streamhandler/IasAvbStream.hpp"
+#include "avb_streamhandler/IasAvbStreamHandlerEnvironment.hpp"
+#undef protected
+#undef private
+
+#include <linux/if_ether.h>
+
+extern size_t heapSpaceLeft;
+extern size_t heapSpaceInitSize;
+
+namespace IasMediaTransportAvb
+{
+
+// hands out the packets of a pool, one per 125us, numbered like a real stream
+class IasAvbRenderStreamMock : public IasAvbStream
+{
+  public:
+    IasAvbRenderStreamMock(DltContext &dltContext, IasAvbPacketPool &pool)
+      : IasAvbStream(dltContext, eIasAvbAudioStream)
+      , mLaunchTime(0u)
+      , mSeqNum(0u)
+    {
+      mPacketPool = &pool;
+    }
+
+    virtual ~IasAvbRenderStreamMock()
+    {
+      // the pool belongs to the test
+      mPacketPool = NULL;
+    }
+
+    virtual IasAvbPacket* preparePacket(uint64_t nextWindowStart)
+    {
+      (void) nextWindowStart;
+      IasAvbPacket *packet = mPacketPool->getPacket();
+      if (NULL != packet)
+      {
+        mLaunchTime += 125000u;
+        packet->attime = mLaunchTime;
+        setSeqNum(packet, mSeqNum++);
+      }
+      return packet;
+    }
+
+    virtual void readFromAvbPacket(const void* packet, size_t length) { (void) packet; (void) length; }
+    virtual bool writeToAvbPacket(IasAvbPacket* packet, uint64_t n) { (void) packet; (void) n; return false; }
+    virtual void derivedCleanup() {}
+
+    static void setSeqNum(IasAvbPacket *packet, uint8_t seqNum)
+    {
+      static_cast<uint8_t*>(packet->getBasePtr())[ETH_HLEN + 4u + 2u] = seqNum;
+    }
+
+    static uint8_t getSeqNum(const IasAvbPacket *packet)
+    {
+      return static_cast<const uint8_t*>(packet->getBasePtr())[ETH_HLEN + 4u + 2u];
+    }
+
+    uint64_t mLaunchTime;
+    uint8_t mSeqNum;
+};
+
+class IasTestAvbPacketPrerenderer : public ::testing::Test
+{
+protected:
+  IasTestAvbPacketPrerenderer():
+    mEnvironment(NULL),
+    mPrerenderer(NULL)
+  {
+    DLT_REGISTER_APP("IAAS", "AVB Streamhandler");
+  }
+
+  virtual ~IasTestAvbPacketPrerenderer()
+  {
+    DLT_UNREGISTER_APP();
+  }
+
+  // Sets up the test fixture.
+  virtual void SetUp()
+  {
+    heapSpaceLeft = heapSpaceInitSize;
+
+    dlt_enable_local_print();
+    mEnvironment = new IasAvbStreamHandlerEnvironment(DLT_LOG_INFO);
+    ASSERT_TRUE(NULL != mEnvironment);
+    mEnvironment->registerDltContexts();
+    mEnvironment->setDefaultConfigValues();
+    // no igb device needed, the packet pool takes its pages from the heap
+    ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cXmitBackend, "socket"));
+
+    DLT_REGISTER_CONTEXT_LL_TS(mDltCtx,
+              "TEST",
+              "IasTestAvbPacketPrerenderer",
+              DLT_LOG_INFO,
+              DLT_TRACE_STATUS_OFF);
+
+    mPrerenderer = new IasAvbPacketPrerenderer(mDltCtx);
+  }
+
+  virtual void TearDown()
+  {
+    delete mPrerenderer;
+    mPrerenderer = NULL;
+
+    if (NULL != mEnvironment)
+    {
+      mEnvironment->unregisterDltContexts();
+      delete mEnvironment;
+      mEnvironment = NULL;
+    }
+
+    heapSpaceLeft = heapSpaceInitSize;
+
+    DLT_UNREGISTER_CONTEXT(mDltCtx);
+  }
+
+  IasAvbStreamHandlerEnvironment* mEnvironment;
+  IasAvbPacketPrerenderer* mPrerenderer;
+  DltContext mDltCtx;
+};
+
+
+TEST_F(IasTestAvbPacketPrerenderer, CTor_DTor)
+{
+  ASSERT_TRUE(NULL != mPrerenderer);
+  ASSERT_FALSE(mPrerenderer->isInitialized());
+  ASSERT_EQ(0u, mPrerenderer->getNumSlots());
+}
+
+TEST_F(IasTestAvbPacketPrerenderer, init)
+{
+  ASSERT_TRUE(NULL != mPrerenderer);
+  ASSERT_EQ(eIasAvbProcNotInitialized, mPrerenderer->start());
+  ASSERT_EQ(eIasAvbProcOK, mPrerenderer->stop());
+
+  ASSERT_EQ(eIasAvbProcInvalidParam, mPrerenderer->init("AvbTxRndTst", 0u, 125000u, 64u));
+  ASSERT_EQ(eIasAvbProcInvalidParam, mPrerenderer->init("AvbTxRndTst", 5000000u, 0u, 64u));
+  ASSERT_EQ(eIasAvbProcInvalidParam, mPrerenderer->init("AvbTxRndTst", 5000000u, 125000u, 0u));
+  ASSERT_EQ(eIasAvbProcInvalidParam, mPrerenderer->init("AvbTxRndTst", 5000000u, 125000u,
+      IasAvbPacketPrerenderer::cMaxQueueSize + 1u));
+  ASSERT_EQ(eIasAvbProcOK, mPrerenderer->init("AvbTxRndTst", 5000000u, 2000000u, 64u));
+  ASSERT_EQ(eIasAvbProcInitializationFailed, mPrerenderer->init("AvbTxRndTst", 5000000u, 2000000u, 64u));
+
+  mPrerenderer->cleanup();
+  ASSERT_FALSE(mPrerenderer->isInitialized());
+}
+
+TEST_F(IasTestAvbPacketPrerenderer, attachDetach)
+{
+  ASSERT_TRUE(NULL != mPrerenderer);
+  ASSERT_EQ(eIasAvbProcOK, mPrerenderer->init("AvbTxRndTst", 5000000u, 2000000u, 3u));
+
+  // a pool smaller than the queue would run dry before the queue is full
+  IasAvbPacketPool smallPool(mDltCtx);
+  ASSERT_EQ(eIasAvbProcOK, smallPool.init(128u, 2u));
+  IasAvbRenderStreamMock smallStream(mDltCtx, smallPool);
+  ASSERT_TRUE(NULL == mPrerenderer->attach(&smallStream));
+  ASSERT_EQ(0u, mPrerenderer->getNumSlots());
+
+  // the stream is not touched unless the worker thread runs
+  IasAvbPacketPool pool(mDltCtx);
+  ASSERT_EQ(eIasAvbProcOK, pool.init(128u, 4u));
+  IasAvbRenderStreamMock stream(mDltCtx, pool);
+  IasAvbPacketPrerenderer::Slot *slot1 = mPrerenderer->attach(&stream);
+  IasAvbPacketPrerenderer::Slot *slot2 = mPrerenderer->attach(&stream);
+  ASSERT_TRUE(NULL != slot1);
+  ASSERT_TRUE(NULL != slot2);
+  ASSERT_EQ(2u, mPrerenderer->getNumSlots());
+  ASSERT_EQ(4u, slot1->queue.getCapacity());
+  ASSERT_EQ(3u, slot1->depth);
+
+  IasAvbPacketPrerenderer::Rendered entry;
+  entry.packet = pool.getPacket();
+  entry.generation = 0u;
+  ASSERT_TRUE(slot1->queue.push(entry));
+  ASSERT_EQ(3u, pool.mFreeBufferStack.size());
+
+  // detach returns the queued packets
+  mPrerenderer->detach(slot1);
+  ASSERT_EQ(1u, mPrerenderer->getNumSlots());
+  ASSERT_EQ(4u, pool.mFreeBufferStack.size());
+  ASSERT_EQ(slot2, mPrerenderer->mSlots[0]);
+
+  mPrerenderer->detach(slot2);
+  ASSERT_EQ(0u, mPrerenderer->getNumSlots());
+}
+
+TEST_F(IasTestAvbPacketPrerenderer, fetchFlush)
+{
+  ASSERT_TRUE(NULL != mPrerenderer);
+  ASSERT_EQ(eIasAvbProcOK, mPrerenderer->init("AvbTxRndTst", 5000000u, 2000000u, 8u));
+
+  IasAvbPacketPool pool(mDltCtx);
+  ASSERT_EQ(eIasAvbProcOK, pool.init(128u, 8u));
+  IasAvbRenderStreamMock stream(mDltCtx, pool);
+
+  IasAvbPacketPrerenderer::Slot *slot = mPrerenderer->attach(&stream);
+  ASSERT_TRUE(NULL != slot);
+  ASSERT_TRUE(NULL == mPrerenderer->fetchPacket(*slot));
+
+  IasAvbPacketPrerenderer::Rendered entry;
+  IasAvbPacket *packets[4];
+  for (uint32_t i = 0u; i < 4u; i++)
+  {
+    packets[i] = pool.getPacket();
+    ASSERT_TRUE(NULL != packets[i]);
+    IasAvbRenderStreamMock::setSeqNum(packets[i], uint8_t(10u + i));
+    entry.packet = packets[i];
+    entry.generation = 0u;
+    ASSERT_TRUE(slot->queue.push(entry));
+  }
+
+  // packets come out in the order they have been rendered
+  ASSERT_EQ(packets[0], mPrerenderer->fetchPacket(*slot));
+  ASSERT_EQ(10u, IasAvbRenderStreamMock::getSeqNum(packets[0]));
+  IasAvbPacketPool::returnPacket(packets[0]);
+
+  // reset of the stream drops the queued packets
+  mPrerenderer->flush(*slot);
+  ASSERT_EQ(1u, slot->generation.load());
+  ASSERT_EQ(0u, slot->queue.size());
+  ASSERT_EQ(8u, pool.mFreeBufferStack.size());
+
+  // a packet rendered while the reset was going on is dropped as well
+  entry.packet = pool.getPacket();
+  IasAvbRenderStreamMock::setSeqNum(entry.packet, 14u);
+  entry.generation = 0u;
+  ASSERT_TRUE(slot->queue.push(entry));
+  IasAvbPacket *packet = pool.getPacket();
+  IasAvbRenderStreamMock::setSeqNum(packet, 15u);
+  entry.packet = packet;
+  entry.generation = 1u;
+  ASSERT_TRUE(slot->queue.push(entry));
+  ASSERT_EQ(packet, mPrerenderer->fetchPacket(*slot));
+  // the dropped packets did not use up sequence numbers
+  ASSERT_EQ(11u, IasAvbRenderStreamMock::getSeqNum(packet));
+  ASSERT_EQ(7u, pool.mFreeBufferStack.size());
+  IasAvbPacketPool::returnPacket(packet);
+
+  mPrerenderer->detach(slot);
+}
+
+TEST_F(IasTestAvbPacketPrerenderer, renderDepth)
+{
+  ASSERT_TRUE(NULL != mPrerenderer);
+  ASSERT_EQ(eIasAvbProcOK, mPrerenderer->init("AvbTxRndTst", 5000000u, 2000000u, 5u));
+
+  IasAvbPacketPool pool(mDltCtx);
+  ASSERT_EQ(eIasAvbProcOK, pool.init(128u, 8u));
+  IasAvbRenderStreamMock stream(mDltCtx, pool);
+  IasAvbPacketPrerenderer::Slot *slot = mPrerenderer->attach(&stream);
+  ASSERT_TRUE(NULL != slot);
+  ASSERT_EQ(8u, slot->queue.getCapacity());
+
+  // the lead time would allow 40 packets, the queue holds no more than the configured 5
+  mPrerenderer->render(*slot, 0u);
+  ASSERT_EQ(5u, slot->queue.size());
+  ASSERT_EQ(3u, pool.mFreeBufferStack.size());
+
+  for (uint32_t i = 0u; i < 5u; i++)
+  {
+    IasAvbPacket *packet = mPrerenderer->fetchPacket(*slot);
+    ASSERT_TRUE(NULL != packet);
+    ASSERT_EQ(i, IasAvbRenderStreamMock::getSeqNum(packet));
+    IasAvbPacketPool::returnPacket(packet);
+  }
+
+  mPrerenderer->detach(slot);
+}
+
+} // namespace IasMediaTransportAvb
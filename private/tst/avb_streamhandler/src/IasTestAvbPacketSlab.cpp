@@ -0,0 +1,281 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file IasTestAvbPacketSlab.cpp
+ * @date 2018
+ */
+
+#include "gtest/gtest.h"
+
+#define private public
+#define protected public
+#include "avb_streamhandler/IasAvbPacketSlab.hpp"
+#include "avb_streamhandler/IasAvbPacketPool.hpp"
+#include "avb_streamhandler/IasAvbStreamHandlerEnvironment.hpp"
+#undef protected
+#undef private
+
+#include <cstring>
+#include <vector>
+
+extern size_t heapSpaceLeft;
+extern size_t heapSpaceInitSize;
+
+namespace IasMediaTransportAvb
+{
+
+class IasTestAvbPacketSlab : public ::testing::Test
+{
+protected:
+  IasTestAvbPacketSlab():
+    mEnvironment(NULL)
+  {
+    DLT_REGISTER_APP("IAAS", "AVB Streamhandler");
+  }
+
+  virtual ~IasTestAvbPacketSlab()
+  {
+    DLT_UNREGISTER_APP();
+  }
+
+  // Sets up the test fixture.
+  virtual void SetUp()
+  {
+    heapSpaceLeft = heapSpaceInitSize;
+
+    DLT_REGISTER_CONTEXT_LL_TS(mDltCtx,
+              "TEST",
+              "IasTestAvbPacketSlab",
+              DLT_LOG_INFO,
+              DLT_TRACE_STATUS_OFF);
+
+    mEnvironment = new IasAvbStreamHandlerEnvironment(DLT_LOG_INFO);
+    ASSERT_TRUE(NULL != mEnvironment);
+    mEnvironment->registerDltContexts();
+    mEnvironment->setDefaultConfigValues();
+
+    // no igb device needed, the slab takes its pages from the heap
+    ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cXmitBackend, "memory"));
+  }
+
+  virtual void TearDown()
+  {
+    if (NULL != mEnvironment)
+    {
+      mEnvironment->unregisterDltContexts();
+      delete mEnvironment;
+      mEnvironment = NULL;
+    }
+
+    heapSpaceLeft = heapSpaceInitSize;
+
+    DLT_UNREGISTER_CONTEXT(mDltCtx);
+  }
+
+  IasAvbStreamHandlerEnvironment* mEnvironment;
+  DltContext mDltCtx;
+};
+
+
+TEST_F(IasTestAvbPacketSlab, init)
+{
+  IasAvbPacketSlab slab(mDltCtx);
+  ASSERT_EQ(0u, slab.getPageCount());
+  ASSERT_EQ(eIasAvbProcInvalidParam, slab.init(0u));
+
+  // rounded up to whole pages
+  ASSERT_EQ(eIasAvbProcOK, slab.init(10u * IasAvbPacketSlab::cPageSize + 1u));
+  ASSERT_EQ(eIasAvbProcInitializationFailed, slab.init(IasAvbPacketSlab::cPageSize));
+  ASSERT_EQ(11u, slab.getPageCount());
+  ASSERT_EQ(11u, slab.getFreePageCount());
+  ASSERT_FALSE(slab.isDmaCapable());
+
+  slab.cleanup();
+  ASSERT_EQ(0u, slab.getPageCount());
+}
+
+TEST_F(IasTestAvbPacketSlab, reservation)
+{
+  IasAvbPacketSlab slab(mDltCtx);
+  ASSERT_EQ(eIasAvbProcOK, slab.init(8u * IasAvbPacketSlab::cPageSize));
+
+  // pool A reserves 3 pages, pool B 4 pages
+  uint32_t borrowedA = 0u;
+  uint32_t borrowedB = 0u;
+  ASSERT_EQ(eIasAvbProcOK, slab.reserve(3u));
+  ASSERT_EQ(eIasAvbProcOK, slab.reserve(4u));
+  ASSERT_EQ(eIasAvbProcNotEnoughMemory, slab.reserve(2u));
+  ASSERT_EQ(7u, slab.getReservedPageCount());
+
+  // A takes its reservation and the only page not promised to B
+  std::vector<IasAvbPacketSlab::Page> pagesA(5u);
+  for (uint32_t i = 0u; i < 4u; i++)
+  {
+    ASSERT_TRUE(slab.borrowPage(3u, borrowedA, pagesA[i]));
+  }
+  ASSERT_FALSE(slab.borrowPage(3u, borrowedA, pagesA[4]));
+  ASSERT_EQ(4u, borrowedA);
+  ASSERT_EQ(4u, slab.getFreePageCount());
+
+  // B still gets all pages reserved, but no more
+  std::vector<IasAvbPacketSlab::Page> pagesB(5u);
+  for (uint32_t i = 0u; i < 4u; i++)
+  {
+    ASSERT_TRUE(slab.borrowPage(4u, borrowedB, pagesB[i]));
+  }
+  ASSERT_FALSE(slab.borrowPage(4u, borrowedB, pagesB[4]));
+  ASSERT_EQ(0u, slab.getFreePageCount());
+
+  // the pages are distinct
+  for (uint32_t i = 0u; i < 4u; i++)
+  {
+    for (uint32_t j = 0u; j < 4u; j++)
+    {
+      ASSERT_NE(pagesA[i].dma_vaddr, pagesB[j].dma_vaddr);
+    }
+  }
+
+  // the page A gives back beyond its reservation can be borrowed by B
+  slab.returnPage(3u, borrowedA, pagesA[3]);
+  ASSERT_EQ(3u, borrowedA);
+  ASSERT_TRUE(slab.borrowPage(4u, borrowedB, pagesB[4]));
+  ASSERT_EQ(5u, borrowedB);
+
+  // B returns everything and cancels its reservation, which makes room for a new one
+  for (uint32_t i = 0u; i < 5u; i++)
+  {
+    slab.returnPage(4u, borrowedB, pagesB[i]);
+  }
+  ASSERT_EQ(0u, borrowedB);
+  slab.unreserve(4u);
+  ASSERT_EQ(eIasAvbProcOK, slab.reserve(5u));
+  ASSERT_EQ(eIasAvbProcNotEnoughMemory, slab.reserve(1u));
+
+  for (uint32_t i = 0u; i < 3u; i++)
+  {
+    slab.returnPage(3u, borrowedA, pagesA[i]);
+  }
+  ASSERT_EQ(8u, slab.getFreePageCount());
+}
+
+TEST_F(IasTestAvbPacketSlab, sharedPools)
+{
+  // 16 pages, 5 packets of 800 bytes per page
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cPacketPoolSlabSize,
+      16u * IasAvbPacketSlab::cPageSize));
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cPacketPoolSlabReserve, 8u));
+  ASSERT_EQ(eIasAvbProcOK, mEnvironment->createPacketSlab());
+  IasAvbPacketSlab *slab = IasAvbStreamHandlerEnvironment::getPacketSlab();
+  ASSERT_TRUE(NULL != slab);
+  ASSERT_EQ(16u, slab->getPageCount());
+
+  // each pool reserves two pages, for its first 8 packets
+  IasAvbPacketPool poolA(mDltCtx);
+  IasAvbPacketPool poolB(mDltCtx);
+  ASSERT_EQ(eIasAvbProcOK, poolA.init(800u, 40u));
+  ASSERT_EQ(eIasAvbProcOK, poolB.init(800u, 40u));
+  ASSERT_EQ(10u, poolA.getPacketCount());
+  ASSERT_EQ(10u, poolA.mFreeBufferStack.size());
+  ASSERT_EQ(12u, slab->getFreePageCount());
+
+  // A takes all pages not reserved
+  IasAvbPacket *packet = poolA.getPacket();
+  ASSERT_TRUE(NULL != packet);
+  ASSERT_EQ(eIasAvbProcOK, poolA.attachMemory());
+  ASSERT_EQ(40u, poolA.getPacketCount());
+  ASSERT_EQ(39u, poolA.mFreeBufferStack.size());
+  ASSERT_EQ(6u, slab->getFreePageCount());
+
+  // the pages reserved by another pool are not lent to B
+  IasAvbPacketPool *poolC = new IasAvbPacketPool(mDltCtx);
+  ASSERT_EQ(eIasAvbProcOK, poolC->init(800u, 40u));
+  ASSERT_EQ(4u, slab->getFreePageCount());
+  ASSERT_EQ(eIasAvbProcOK, poolB.attachMemory());
+  ASSERT_EQ(30u, poolB.getPacketCount());
+  ASSERT_EQ(0u, slab->getFreePageCount());
+  IasAvbPacketPool poolD(mDltCtx);
+  ASSERT_EQ(eIasAvbProcNotEnoughMemory, poolD.init(800u, 40u));
+
+  // B gets the rest once C is gone
+  delete poolC;
+  ASSERT_EQ(2u, slab->getFreePageCount());
+  ASSERT_EQ(eIasAvbProcOK, poolB.attachMemory());
+  ASSERT_EQ(40u, poolB.getPacketCount());
+  ASSERT_EQ(0u, slab->getFreePageCount());
+
+  // the packets of the borrowed pages are distinct and usable
+  std::vector<IasAvbPacket*> packets;
+  IasAvbPacket *p = NULL;
+  while (NULL != (p = poolB.getPacket()))
+  {
+    std::memset(p->getBasePtr(), 0x5A, 800u);
+    packets.push_back(p);
+  }
+  ASSERT_EQ(40u, packets.size());
+
+  // a page with a packet in use stays with the pool
+  poolB.releaseMemory();
+  ASSERT_EQ(40u, poolB.getPacketCount());
+  for (std::vector<IasAvbPacket*>::iterator it = packets.begin() + 1; it != packets.end(); ++it)
+  {
+    ASSERT_EQ(eIasAvbProcOK, IasAvbPacketPool::returnPacket(*it));
+  }
+  poolB.releaseMemory();
+  ASSERT_EQ(15u, poolB.getPacketCount());
+  ASSERT_EQ(14u, poolB.mFreeBufferStack.size());
+  ASSERT_EQ(eIasAvbProcOK, IasAvbPacketPool::returnPacket(packets[0]));
+  poolB.releaseMemory();
+  ASSERT_EQ(10u, poolB.getPacketCount());
+  ASSERT_EQ(10u, poolB.mFreeBufferStack.size());
+
+  // reset only puts the packets having memory back
+  ASSERT_EQ(eIasAvbProcOK, poolB.reset());
+  ASSERT_EQ(10u, poolB.mFreeBufferStack.size());
+
+  ASSERT_EQ(eIasAvbProcOK, IasAvbPacketPool::returnPacket(packet));
+  poolA.releaseMemory();
+  ASSERT_EQ(10u, poolA.getPacketCount());
+  ASSERT_EQ(12u, slab->getFreePageCount());
+
+  poolA.cleanup();
+  poolB.cleanup();
+  ASSERT_EQ(16u, slab->getFreePageCount());
+  ASSERT_EQ(0u, slab->getReservedPageCount());
+}
+
+TEST_F(IasTestAvbPacketSlab, template)
+{
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cPacketPoolSlabSize,
+      8u * IasAvbPacketSlab::cPageSize));
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cPacketPoolSlabReserve, 1u));
+  ASSERT_EQ(eIasAvbProcOK, mEnvironment->createPacketSlab());
+
+  IasAvbPacketPool pool(mDltCtx);
+  ASSERT_EQ(eIasAvbProcOK, pool.init(1024u, 16u));
+  ASSERT_EQ(4u, pool.getPacketCount());
+
+  IasAvbPacket *reference = pool.getPacket();
+  ASSERT_TRUE(NULL != reference);
+  std::memset(reference->getBasePtr(), 0x42, 64u);
+  reference->len = 64u;
+  ASSERT_EQ(eIasAvbProcOK, pool.initAllPacketsFromTemplate(reference));
+  ASSERT_EQ(eIasAvbProcOK, IasAvbPacketPool::returnPacket(reference));
+
+  // the packets of the pages borrowed later get the template as well
+  ASSERT_EQ(eIasAvbProcOK, pool.attachMemory());
+  ASSERT_EQ(16u, pool.getPacketCount());
+  IasAvbPacket *p = NULL;
+  uint32_t count = 0u;
+  while (NULL != (p = pool.getPacket()))
+  {
+    ASSERT_EQ(64u, p->len);
+    ASSERT_EQ(0x42u, static_cast<uint8_t*>(p->getBasePtr())[63]);
+    count++;
+  }
+  ASSERT_EQ(16u, count);
+}
+
+} // namespace IasMediaTransportAvb
@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file IasTestAvbPcapFile.cpp
+ * @date 2018
+ */
+
+#include "gtest/gtest.h"
+
+#define private public
+#define protected public
+#include "avb_streamhandler/IasAvbPcapFile.hpp"
+#undef protected
+#undef private
+
+#include <cstring>
+#include <unistd.h>
+
+using namespace IasMediaTransportAvb;
+
+class IasTestAvbPcapFile : public ::testing::Test
+{
+protected:
+  IasTestAvbPcapFile() :
+    mPcapFile(NULL)
+  {
+  }
+
+  virtual ~IasTestAvbPcapFile() {}
+
+  // Sets up the test fixture.
+  virtual void SetUp()
+  {
+    mPcapFile = new IasAvbPcapFile();
+  }
+
+  virtual void TearDown()
+  {
+    delete mPcapFile;
+    mPcapFile = NULL;
+    (void) unlink(cFileName);
+  }
+
+  IasAvbPcapFile *mPcapFile;
+  static const char cFileName[];
+};
+
+const char IasTestAvbPcapFile::cFileName[] = "/tmp/IasTestAvbPcapFile.pcap";
+
+
+TEST_F(IasTestAvbPcapFile, CTor_DTor)
+{
+  ASSERT_TRUE(mPcapFile != NULL);
+  ASSERT_FALSE(mPcapFile->isOpen());
+  ASSERT_EQ(0u, mPcapFile->getNumFrames());
+}
+
+TEST_F(IasTestAvbPcapFile, notOpen)
+{
+  ASSERT_TRUE(mPcapFile != NULL);
+
+  uint8_t buffer[64];
+  size_t length = 0u;
+  uint64_t timestamp = 0u;
+  ASSERT_EQ(eIasAvbProcNotInitialized, mPcapFile->readFrame(buffer, sizeof buffer, length, timestamp));
+  ASSERT_EQ(eIasAvbProcNotInitialized, mPcapFile->writeFrame(buffer, sizeof buffer, 0u));
+  ASSERT_EQ(eIasAvbProcInitializationFailed, mPcapFile->openRead("/nonexistent/file.pcap"));
+
+  // read and write are exclusive
+  ASSERT_EQ(eIasAvbProcOK, mPcapFile->openWrite(cFileName));
+  ASSERT_EQ(eIasAvbProcInitializationFailed, mPcapFile->openRead(cFileName));
+  ASSERT_EQ(eIasAvbProcNotInitialized, mPcapFile->readFrame(buffer, sizeof buffer, length, timestamp));
+}
+
+TEST_F(IasTestAvbPcapFile, roundTrip)
+{
+  ASSERT_TRUE(mPcapFile != NULL);
+
+  uint8_t frame[100];
+  for (uint32_t i = 0u; i < sizeof frame; i++)
+  {
+    frame[i] = uint8_t(i);
+  }
+
+  ASSERT_EQ(eIasAvbProcOK, mPcapFile->openWrite(cFileName));
+  ASSERT_EQ(eIasAvbProcOK, mPcapFile->writeFrame(frame, sizeof frame, 1500000123u));
+  ASSERT_EQ(eIasAvbProcOK, mPcapFile->writeFrame(frame, 60u, 1500000456u));
+  ASSERT_EQ(2u, mPcapFile->getNumFrames());
+  mPcapFile->close();
+
+  ASSERT_EQ(eIasAvbProcOK, mPcapFile->openRead(cFileName));
+  ASSERT_FALSE(mPcapFile->mSwapped);
+  ASSERT_TRUE(mPcapFile->mNanoseconds);
+
+  uint8_t buffer[80];
+  size_t length = 0u;
+  uint64_t timestamp = 0u;
+
+  // larger than the buffer, truncated
+  ASSERT_EQ(eIasAvbProcOK, mPcapFile->readFrame(buffer, sizeof buffer, length, timestamp));
+  ASSERT_EQ(sizeof buffer, length);
+  ASSERT_EQ(1500000123u, timestamp);
+  ASSERT_EQ(0, memcmp(frame, buffer, length));
+
+  // the rest of the first frame has been skipped
+  ASSERT_EQ(eIasAvbProcOK, mPcapFile->readFrame(buffer, sizeof buffer, length, timestamp));
+  ASSERT_EQ(60u, length);
+  ASSERT_EQ(1500000456u, timestamp);
+  ASSERT_EQ(0, memcmp(frame, buffer, length));
+
+  ASSERT_EQ(eIasAvbProcOff, mPcapFile->readFrame(buffer, sizeof buffer, length, timestamp));
+  ASSERT_EQ(2u, mPcapFile->getNumFrames());
+}
+
+TEST_F(IasTestAvbPcapFile, swappedMicroseconds)
+{
+  ASSERT_TRUE(mPcapFile != NULL);
+
+  // big endian file with us resolution, as written by tcpdump on such a host
+  const uint8_t file[] =
+  {
+    0xA1, 0xB2, 0xC3, 0xD4, 0x00, 0x02, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x04,
+    0xDE, 0xAD, 0xBE, 0xEF
+  };
+
+  FILE *f = fopen(cFileName, "wb");
+  ASSERT_TRUE(NULL != f);
+  ASSERT_EQ(1u, fwrite(file, sizeof file, 1u, f));
+  fclose(f);
+
+  ASSERT_EQ(eIasAvbProcOK, mPcapFile->openRead(cFileName));
+  ASSERT_TRUE(mPcapFile->mSwapped);
+  ASSERT_FALSE(mPcapFile->mNanoseconds);
+
+  uint8_t buffer[16];
+  size_t length = 0u;
+  uint64_t timestamp = 0u;
+  ASSERT_EQ(eIasAvbProcOK, mPcapFile->readFrame(buffer, sizeof buffer, length, timestamp));
+  ASSERT_EQ(4u, length);
+  ASSERT_EQ(2000003000u, timestamp);
+  ASSERT_EQ(0xDE, buffer[0]);
+  ASSERT_EQ(eIasAvbProcOff, mPcapFile->readFrame(buffer, sizeof buffer, length, timestamp));
+}
+
+TEST_F(IasTestAvbPcapFile, invalidFiles)
+{
+  ASSERT_TRUE(mPcapFile != NULL);
+
+  uint8_t frame[32];
+  memset(frame, 0, sizeof frame);
+
+  // truncated within a frame
+  ASSERT_EQ(eIasAvbProcOK, mPcapFile->openWrite(cFileName));
+  ASSERT_EQ(eIasAvbProcOK, mPcapFile->writeFrame(frame, sizeof frame, 0u));
+  mPcapFile->close();
+  ASSERT_EQ(0, truncate(cFileName, 24 + 16 + 10));
+
+  uint8_t buffer[64];
+  size_t length = 0u;
+  uint64_t timestamp = 0u;
+  ASSERT_EQ(eIasAvbProcOK, mPcapFile->openRead(cFileName));
+  ASSERT_EQ(eIasAvbProcErr, mPcapFile->readFrame(buffer, sizeof buffer, length, timestamp));
+  mPcapFile->close();
+
+  // not a pcap file
+  FILE *f = fopen(cFileName, "wb");
+  ASSERT_TRUE(NULL != f);
+  ASSERT_EQ(1u, fwrite(buffer, sizeof buffer, 1u, f));
+  fclose(f);
+  ASSERT_EQ(eIasAvbProcUnsupportedFormat, mPcapFile->openRead(cFileName));
+  ASSERT_FALSE(mPcapFile->isOpen());
+}
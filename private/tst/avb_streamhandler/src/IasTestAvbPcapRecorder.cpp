@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file IasTestAvbPcapRecorder.cpp
+ * @date 2018
+ */
+
+#include "gtest/gtest.h"
+
+#define private public
+#define protected public
+#include "avb_streamhandler/IasAvbPcapRecorder.hpp"
+#undef protected
+#undef private
+
+#include <cstring>
+#include <thread>
+#include <unistd.h>
+
+using namespace IasMediaTransportAvb;
+
+class IasTestAvbPcapRecorder : public ::testing::Test
+{
+protected:
+  IasTestAvbPcapRecorder() :
+    mRecorder(NULL)
+  {
+    DLT_REGISTER_APP("IAAS", "AVB Streamhandler");
+  }
+
+  virtual ~IasTestAvbPcapRecorder()
+  {
+    DLT_UNREGISTER_APP();
+  }
+
+  // Sets up the test fixture.
+  virtual void SetUp()
+  {
+    DLT_REGISTER_CONTEXT_LL_TS(mDltCtx,
+              "TEST",
+              "IasTestAvbPcapRecorder",
+              DLT_LOG_INFO,
+              DLT_TRACE_STATUS_OFF);
+
+    mRecorder = new IasAvbPcapRecorder(mDltCtx);
+  }
+
+  virtual void TearDown()
+  {
+    delete mRecorder;
+    mRecorder = NULL;
+    (void) unlink(cFileName);
+
+    DLT_UNREGISTER_CONTEXT(mDltCtx);
+  }
+
+  // frame carrying the producer and a sequence number, so the order per producer can be checked
+  static void makeFrame(uint8_t *frame, size_t length, uint8_t producer, uint32_t seq)
+  {
+    std::memset(frame, 0, length);
+    frame[0] = producer;
+    std::memcpy(frame + 1u, &seq, sizeof seq);
+  }
+
+  IasAvbPcapRecorder *mRecorder;
+  DltContext mDltCtx;
+  static const char cFileName[];
+};
+
+const char IasTestAvbPcapRecorder::cFileName[] = "/tmp/IasTestAvbPcapRecorder.pcap";
+
+
+TEST_F(IasTestAvbPcapRecorder, init)
+{
+  ASSERT_TRUE(mRecorder != NULL);
+  ASSERT_EQ(eIasAvbProcInvalidParam, mRecorder->init(cFileName, 0u, 16u));
+  ASSERT_EQ(eIasAvbProcInvalidParam, mRecorder->init(cFileName, 1u, 0u));
+  ASSERT_EQ(eIasAvbProcInitializationFailed, mRecorder->init("/nonexistent/file.pcap", 1u, 16u));
+  ASSERT_TRUE(mRecorder->mLanes.empty());
+  ASSERT_TRUE(NULL == mRecorder->mThread);
+
+  ASSERT_EQ(eIasAvbProcOK, mRecorder->init(cFileName, 2u, 16u));
+  ASSERT_EQ(2u, mRecorder->mLanes.size());
+  ASSERT_EQ(eIasAvbProcInitializationFailed, mRecorder->init(cFileName, 2u, 16u));
+
+  mRecorder->cleanup();
+  ASSERT_FALSE(mRecorder->mFile.isOpen());
+  ASSERT_EQ(0u, mRecorder->getNumFrames());
+}
+
+TEST_F(IasTestAvbPcapRecorder, producers)
+{
+  ASSERT_TRUE(mRecorder != NULL);
+
+  const uint32_t cNumProducers = 2u;
+  const uint32_t cNumFrames = 2000u;
+  ASSERT_EQ(eIasAvbProcOK, mRecorder->init(cFileName, cNumProducers, 256u));
+
+  std::thread producers[cNumProducers];
+  for (uint32_t p = 0u; p < cNumProducers; p++)
+  {
+    producers[p] = std::thread([this, p, cNumFrames]()
+    {
+      uint8_t frame[64];
+      for (uint32_t seq = 0u; seq < cNumFrames; seq++)
+      {
+        makeFrame(frame, sizeof frame, uint8_t(p), seq);
+        while (!mRecorder->record(p, frame, sizeof frame, uint64_t(seq) * 125000u))
+        {
+          // lane full, give the writer time to catch up
+          usleep(100u);
+        }
+      }
+    });
+  }
+  for (uint32_t p = 0u; p < cNumProducers; p++)
+  {
+    producers[p].join();
+  }
+
+  mRecorder->cleanup();
+  ASSERT_EQ(uint64_t(cNumProducers * cNumFrames), mRecorder->getNumFrames());
+
+  IasAvbPcapFile file;
+  ASSERT_EQ(eIasAvbProcOK, file.openRead(cFileName));
+  uint32_t next[cNumProducers] = {};
+  uint8_t buffer[64];
+  size_t length = 0u;
+  uint64_t timestamp = 0u;
+  while (eIasAvbProcOK == file.readFrame(buffer, sizeof buffer, length, timestamp))
+  {
+    ASSERT_EQ(sizeof buffer, length);
+    ASSERT_LT(buffer[0], cNumProducers);
+    uint32_t seq = 0u;
+    std::memcpy(&seq, buffer + 1u, sizeof seq);
+    // in order per producer
+    ASSERT_EQ(next[buffer[0]], seq);
+    ASSERT_EQ(uint64_t(seq) * 125000u, timestamp);
+    next[buffer[0]]++;
+  }
+  for (uint32_t p = 0u; p < cNumProducers; p++)
+  {
+    ASSERT_EQ(cNumFrames, next[p]);
+  }
+}
+
+TEST_F(IasTestAvbPcapRecorder, dropAndTruncate)
+{
+  ASSERT_TRUE(mRecorder != NULL);
+  ASSERT_EQ(eIasAvbProcOK, mRecorder->init(cFileName, 1u, 2u));
+
+  // without the writer thread the lane cannot get its records back
+  ASSERT_TRUE(IasResult::cOk == mRecorder->mThread->stop());
+
+  uint8_t frame[IasAvbPcapRecorder::cMaxFrameLength + 100u];
+  makeFrame(frame, sizeof frame, 0u, 0u);
+  ASSERT_TRUE(mRecorder->record(0u, frame, sizeof frame, 1u));
+  ASSERT_TRUE(mRecorder->record(0u, frame, 60u, 2u));
+  ASSERT_FALSE(mRecorder->record(0u, frame, 60u, 3u));
+  ASSERT_EQ(1u, mRecorder->getNumDropped());
+
+  // the queued frames are written on cleanup
+  mRecorder->cleanup();
+  ASSERT_EQ(2u, mRecorder->getNumFrames());
+
+  IasAvbPcapFile file;
+  ASSERT_EQ(eIasAvbProcOK, file.openRead(cFileName));
+  uint8_t buffer[sizeof frame];
+  size_t length = 0u;
+  uint64_t timestamp = 0u;
+  ASSERT_EQ(eIasAvbProcOK, file.readFrame(buffer, sizeof buffer, length, timestamp));
+  ASSERT_EQ(size_t(IasAvbPcapRecorder::cMaxFrameLength), length);
+  ASSERT_EQ(1u, timestamp);
+  ASSERT_EQ(0, memcmp(frame, buffer, length));
+  ASSERT_EQ(eIasAvbProcOK, file.readFrame(buffer, sizeof buffer, length, timestamp));
+  ASSERT_EQ(60u, length);
+  ASSERT_EQ(2u, timestamp);
+  ASSERT_EQ(eIasAvbProcOff, file.readFrame(buffer, sizeof buffer, length, timestamp));
+}
@@ -243,6 +243,8 @@ protected:
   IasAvbProcessingResult createProperCRStream(uint64_t uStreamId = 0u);
 
   void createMaxFds();
+  bool sendLocalFrames(const IasAvbMacAddress * dmac, uint8_t * frame, size_t length, uint32_t numFrames,
+                       uint32_t pauseInterval = 0u);
 
   IasAvbReceiveEngine* mAvbReceiveEngine;
   IasAvbStreamHandlerEnvironment* mEnvironment;
@@ -329,6 +331,69 @@ void IasTestAvbReceiveEngine::createMaxFds()
               DLT_STRING(strerror(errno)));
 }
 
+/*
+ * Sends numFrames copies of the 1722 frame on the loopback interface, with the frame counter in byte 2
+ * (sequence_num). A NULL dmac leaves the destination to the kernel. With a pauseInterval the sender sleeps
+ * for a millisecond after every pauseInterval-th frame, so the receiver is not flooded.
+ */
+bool IasTestAvbReceiveEngine::sendLocalFrames(const IasAvbMacAddress * dmac, uint8_t * frame, size_t length,
+                                              uint32_t numFrames, uint32_t pauseInterval)
+{
+  bool ret = true;
+
+  // By using SOCK_DGRAM we get the physical layer populated automatically.
+  int sendSocket = socket(PF_PACKET, SOCK_DGRAM, htons(ETH_P_IEEE1722));
+  if (sendSocket < 0)
+  {
+    DLT_LOG(mDltContext, DLT_LOG_ERROR, DLT_STRING("Error creating socket:"), DLT_STRING(strerror(errno)));
+    ret = false;
+  }
+  else
+  {
+    struct ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    strncpy(ifr.ifr_name, "lo", (sizeof ifr.ifr_name) - 1u);
+
+    if (ioctl(sendSocket, SIOCGIFINDEX, &ifr) == -1)
+    {
+      DLT_LOG(mDltContext, DLT_LOG_ERROR, DLT_STRING("Error getting socket if index:"), DLT_STRING(strerror(errno)));
+      ret = false;
+    }
+    else
+    {
+      sockaddr_ll addr;
+      memset(&addr, 0, sizeof addr);
+      addr.sll_family = AF_PACKET;
+      addr.sll_ifindex = ifr.ifr_ifindex;
+      addr.sll_protocol = htons(ETH_P_IEEE1722);
+      if (NULL != dmac)
+      {
+        addr.sll_halen = ETH_ALEN;
+        memcpy(addr.sll_addr, *dmac, ETH_ALEN);
+      }
+
+      for (uint32_t count = 0u; count < numFrames; count++)
+      {
+        frame[2] = uint8_t(count);
+        if (sendto(sendSocket, frame, length, 0, (struct sockaddr*)&addr, (socklen_t)sizeof addr) < 0)
+        {
+          DLT_LOG(mDltContext, DLT_LOG_ERROR, DLT_STRING("Error sending frame"), DLT_UINT32(count),
+                  DLT_STRING(strerror(errno)));
+          ret = false;
+        }
+        if ((0u != pauseInterval) && (0u == (count % pauseInterval)))
+        {
+          usleep(1000);
+        }
+      }
+    }
+
+    close(sendSocket);
+  }
+
+  return ret;
+}
+
 TEST_F(IasTestAvbReceiveEngine, Init)
 {
   ASSERT_TRUE(mAvbReceiveEngine != NULL);
@@ -417,6 +482,10 @@ TEST_F(IasTestAvbReceiveEngine, OpenReceiveSocket)
 {
   ASSERT_TRUE(mAvbReceiveEngine != NULL);
   mEnvironment->setDefaultConfigValues();
+#if !defined(DIRECT_RX_DMA)
+  // the socket path opens any existing interface, the default one included
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cNwIfName, "nonexistent0"));
+#endif /* !DIRECT_RX_DMA */
 
   ASSERT_EQ(eIasAvbProcInitializationFailed, mAvbReceiveEngine->openReceiveSocket());
 
@@ -461,7 +530,12 @@ TEST_F(IasTestAvbReceiveEngine, StartStop_Thread)
 
   // receive socket already initialized
   result = mAvbReceiveEngine->start();
+#if defined(DIRECT_RX_DMA)
   ASSERT_EQ(eIasAvbProcInitializationFailed, result);
+#else
+  // the running workers are left alone
+  ASSERT_EQ(eIasAvbProcOK, result);
+#endif
 
   usleep(100);
   result = mAvbReceiveEngine->stop();
@@ -655,6 +729,39 @@ TEST_F(IasTestAvbReceiveEngine, getAvbStreamInfo)
   ASSERT_TRUE(mAvbReceiveEngine->getAvbStreamInfo(audioStreamId, returnedAudioInfo, returnedVideoInfo, returnedCRFInfo));
 }
 
+TEST_F(IasTestAvbReceiveEngine, getStreamLatency)
+{
+  ASSERT_TRUE(mAvbReceiveEngine != NULL);
+  ASSERT_TRUE(LocalSetup());
+  ASSERT_EQ(eIasAvbProcOK, mAvbReceiveEngine->init());
+  IasAvbStreamId audioStreamId((uint64_t(1u))), otherStreamId((uint64_t(2u)));
+
+  IasAvbLatencyHistogram presentation;
+  IasAvbLatencyHistogram dispatch;
+  ASSERT_FALSE(mAvbReceiveEngine->getStreamLatency(audioStreamId, presentation, dispatch, false));
+
+  ASSERT_EQ(eIasAvbProcOK, createProperAudioStream(audioStreamId));
+  IasAvbStream *stream = mAvbReceiveEngine->mAvbStreams[audioStreamId].stream;
+  ASSERT_TRUE(NULL != stream);
+  stream->mPresentationLatency.record(-1000);
+  stream->mPresentationLatency.record(500000);
+  stream->recordDispatchLatency(20000);
+
+  ASSERT_TRUE(mAvbReceiveEngine->getStreamLatency(audioStreamId, presentation, dispatch, false));
+  ASSERT_EQ(2u, presentation.getCount());
+  ASSERT_EQ(1u, presentation.getNegativeCount());
+  ASSERT_EQ(1u, dispatch.getCount());
+  ASSERT_EQ(20000, dispatch.getMax());
+
+  ASSERT_TRUE(mAvbReceiveEngine->getStreamLatency(audioStreamId, presentation, dispatch, true));
+  ASSERT_EQ(2u, presentation.getCount());
+  ASSERT_TRUE(mAvbReceiveEngine->getStreamLatency(audioStreamId, presentation, dispatch, false));
+  ASSERT_EQ(0u, presentation.getCount());
+  ASSERT_EQ(0u, dispatch.getCount());
+
+  ASSERT_FALSE(mAvbReceiveEngine->getStreamLatency(otherStreamId, presentation, dispatch, false));
+}
+
 TEST_F(IasTestAvbReceiveEngine, getAvbStreamInfo_ClockRef)
 {
   ASSERT_TRUE(mAvbReceiveEngine != NULL);
@@ -938,7 +1045,12 @@ TEST_F(IasTestAvbReceiveEngine, localhost_run_wildcardMac_sent)
     usleep(200);
     if (1 == count)
     {
-      mAvbReceiveEngine->mAvbStreams.clear();
+      while (!mAvbReceiveEngine->mAvbStreams.empty())
+      {
+        // the wildcard stream might be re-keyed when the engine is locked, so the ID is copied and may be gone
+        const IasAvbStreamId id = mAvbReceiveEngine->mAvbStreams.begin()->first;
+        (void) mAvbReceiveEngine->destroyAvbStream(id);
+      }
 
       IasAvbStreamId streamId(uint64_t(0u));
       IasAvbMacAddress mac = {'A', 'A', 'A', 'A', 'A', 'A'};
@@ -949,7 +1061,12 @@ TEST_F(IasTestAvbReceiveEngine, localhost_run_wildcardMac_sent)
       memset(&buffer, 0, sizeof buffer);
       buffer[1] = 0x80;
 
-      mAvbReceiveEngine->mAvbStreams.clear();
+      while (!mAvbReceiveEngine->mAvbStreams.empty())
+      {
+        // the wildcard stream might be re-keyed when the engine is locked, so the ID is copied and may be gone
+        const IasAvbStreamId id = mAvbReceiveEngine->mAvbStreams.begin()->first;
+        (void) mAvbReceiveEngine->destroyAvbStream(id);
+      }
 
       IasAvbStreamId streamId(uint64_t(0u));
       IasAvbMacAddress mac = {'A', 'A', 'A', 'A', 'A', 'A'};
@@ -970,6 +1087,450 @@ TEST_F(IasTestAvbReceiveEngine, localhost_run_wildcardMac_sent)
   sleep(3);
 }
 
+#if !defined(DIRECT_RX_DMA)
+TEST_F(IasTestAvbReceiveEngine, localhost_run_rxRing)
+{
+  ASSERT_TRUE(mAvbReceiveEngine != NULL);
+
+  ASSERT_TRUE(LocalHostSetup());
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cRxSocketRing, 1u));
+
+  ASSERT_EQ(eIasAvbProcOK, mAvbReceiveEngine->init());
+  ASSERT_TRUE(NULL != mAvbReceiveEngine->mWorkers[0].ring);
+  ASSERT_EQ(eIasAvbProcOK, createProperAudioStream());
+  ASSERT_EQ(eIasAvbProcOK, mAvbReceiveEngine->start());
+
+  uint8_t buffer[256];
+  memset(&buffer, 0, sizeof buffer);
+  buffer[0] = 0x02; // AAF
+  buffer[1] = 0x81; // sv, tv
+
+  const uint32_t cNumPackets = 1000u;
+  ASSERT_TRUE(sendLocalFrames(NULL, buffer, sizeof buffer, cNumPackets, 100u));
+
+  sleep(1);
+  ASSERT_EQ(eIasAvbProcOK, mAvbReceiveEngine->stop());
+
+  const uint64_t frames = mAvbReceiveEngine->mWorkers[0].stats.framesTotal;
+  const uint64_t syscalls = mAvbReceiveEngine->mWorkers[0].stats.syscallsTotal;
+  RecordProperty("ringFrames", int(frames));
+  RecordProperty("ringSyscalls", int(syscalls));
+  ASSERT_LE(uint64_t(cNumPackets), frames);
+  // the ring is drained per wakeup, so syscalls per packet has to be well below one
+  ASSERT_LT(double(syscalls) / double(frames), 0.5);
+}
+
+TEST_F(IasTestAvbReceiveEngine, rxRing_invalidGeometry)
+{
+  ASSERT_TRUE(mAvbReceiveEngine != NULL);
+
+  ASSERT_TRUE(LocalHostSetup());
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cRxSocketRing, 1u));
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cRxSocketRingBlockSize, 1000u));
+
+  ASSERT_NE(eIasAvbProcOK, mAvbReceiveEngine->init());
+  ASSERT_TRUE(NULL == mAvbReceiveEngine->mWorkers[0].ring);
+  ASSERT_EQ(-1, mAvbReceiveEngine->mWorkers[0].socket);
+}
+
+TEST_F(IasTestAvbReceiveEngine, localhost_run_workers)
+{
+  ASSERT_TRUE(mAvbReceiveEngine != NULL);
+
+  ASSERT_TRUE(LocalHostSetup());
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cRxWorkers, 2u));
+
+  ASSERT_EQ(eIasAvbProcOK, mAvbReceiveEngine->init());
+  ASSERT_EQ(2u, mAvbReceiveEngine->mNumWorkers);
+  ASSERT_NE(-1, mAvbReceiveEngine->mWorkers[1].socket);
+  ASSERT_TRUE(NULL != mAvbReceiveEngine->mWorkers[1].thread);
+
+  // streams are sharded by the last DMAC byte
+  IasAvbMacAddress dmac[2] = {{0x91, 0xE0, 0xF0, 0x00, 0xFE, 0x00}, {0x91, 0xE0, 0xF0, 0x00, 0xFE, 0x01}};
+  for (uint32_t i = 0u; i < 2u; i++)
+  {
+    IasAvbStreamId streamId(uint64_t(i + 1u));
+    ASSERT_EQ(eIasAvbProcOK, createProperAudioStream(streamId, &dmac[i]));
+    ASSERT_EQ(i, mAvbReceiveEngine->mAvbStreams[streamId].worker);
+  }
+  ASSERT_EQ(eIasAvbProcOK, mAvbReceiveEngine->start());
+
+  const uint32_t cNumPackets = 200u;
+  for (uint32_t i = 0u; i < 2u; i++)
+  {
+    uint8_t buffer[256];
+    memset(&buffer, 0, sizeof buffer);
+    buffer[0] = 0x02; // AAF
+    buffer[1] = 0x80; // sv
+    buffer[11] = uint8_t(i + 1u); // stream id
+
+    ASSERT_TRUE(sendLocalFrames(&dmac[i], buffer, sizeof buffer, cNumPackets, 50u));
+  }
+
+  sleep(1);
+  ASSERT_EQ(eIasAvbProcOK, mAvbReceiveEngine->stop());
+
+  for (uint32_t i = 0u; i < 2u; i++)
+  {
+    const IasAvbReceiveEngine::RxStatistics &stats = mAvbReceiveEngine->mWorkers[i].stats;
+    RecordProperty("worker" + std::to_string(i) + "Frames", int(stats.framesTotal));
+    ASSERT_LE(uint64_t(cNumPackets), stats.framesTotal);
+    ASSERT_EQ(0u, stats.framesMisrouted);
+  }
+}
+
+TEST_F(IasTestAvbReceiveEngine, localhost_run_wildcardRekey)
+{
+  ASSERT_TRUE(mAvbReceiveEngine != NULL);
+
+  ASSERT_TRUE(LocalHostSetup());
+  ASSERT_EQ(eIasAvbProcOK, mAvbReceiveEngine->init());
+
+  IasAvbMacAddress dmac = {0x91, 0xE0, 0xF0, 0x00, 0xFE, 0x10};
+  const IasAvbStreamId wildcardId(uint64_t(0u));
+  const IasAvbStreamId streamId(uint64_t(0x42u));
+  ASSERT_EQ(eIasAvbProcOK, createProperAudioStream(wildcardId, &dmac));
+  ASSERT_EQ(eIasAvbProcOK, mAvbReceiveEngine->start());
+
+  uint8_t buffer[256];
+  memset(&buffer, 0, sizeof buffer);
+  buffer[0] = 0x02; // AAF
+  buffer[1] = 0x80; // sv
+  buffer[11] = 0x42u; // stream id
+  ASSERT_TRUE(sendLocalFrames(&dmac, buffer, sizeof buffer, 10u));
+  usleep(100000);
+
+  // the worker only asks for the re-key and keeps using the wildcard entry
+  ASSERT_EQ(uint64_t(streamId), mAvbReceiveEngine->mRekeyStreamId.load());
+  ASSERT_TRUE(mAvbReceiveEngine->mAvbStreams.end() != mAvbReceiveEngine->mAvbStreams.find(wildcardId));
+  ASSERT_LE(10u, mAvbReceiveEngine->mAvbStreams[wildcardId].stream->getDiagnostics().getFramesRx());
+
+  // the control thread carries it out when it takes the lock
+  mAvbReceiveEngine->lock();
+  mAvbReceiveEngine->unlock();
+  ASSERT_EQ(0u, mAvbReceiveEngine->mRekeyStreamId.load());
+  ASSERT_TRUE(mAvbReceiveEngine->mAvbStreams.end() == mAvbReceiveEngine->mAvbStreams.find(wildcardId));
+  ASSERT_TRUE(mAvbReceiveEngine->mAvbStreams.end() != mAvbReceiveEngine->mAvbStreams.find(streamId));
+  ASSERT_EQ(streamId, mAvbReceiveEngine->mAvbStreams[streamId].stream->getStreamId());
+
+  const IasAvbReceiveEngine::StreamTable * table = mAvbReceiveEngine->mStreamTable.load();
+  ASSERT_TRUE(NULL != table);
+  ASSERT_TRUE(NULL == table->wildcard);
+  ASSERT_TRUE(NULL != IasAvbReceiveEngine::findStream(*table, uint64_t(streamId)));
+
+  ASSERT_EQ(eIasAvbProcOK, mAvbReceiveEngine->stop());
+}
+
+TEST_F(IasTestAvbReceiveEngine, localhost_run_event_wakeup)
+{
+  ASSERT_TRUE(mAvbReceiveEngine != NULL);
+
+  ASSERT_TRUE(LocalHostSetup());
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cRxSocketRing, 1u));
+
+  IasAvbMacAddress dmac = {0x91, 0xE0, 0xF0, 0x00, 0xFE, 0x00};
+  IasAvbStreamId streamId(uint64_t(1u));
+
+  uint8_t buffer[256];
+  memset(&buffer, 0, sizeof buffer);
+  buffer[0] = 0x02; // AAF
+  buffer[1] = 0x80; // sv
+  buffer[11] = 1u;  // stream id
+
+  const IasAvbReceiveEngine::RxWakeupMode cModes[] = {IasAvbReceiveEngine::eRxWakeupPoll,
+                                                      IasAvbReceiveEngine::eRxWakeupEvent,
+                                                      IasAvbReceiveEngine::eRxWakeupBusyPoll};
+  const char * const cModeNames[] = {"timed", "event", "busyPoll"};
+  const size_t cNumModes = sizeof cModes / sizeof cModes[0];
+  double wakeupsPerSec[cNumModes];
+
+  for (size_t mode = 0u; mode < cNumModes; mode++)
+  {
+    // a fresh engine per mode, the wakeup mode is read by init()
+    delete mAvbReceiveEngine;
+    mAvbReceiveEngine = new IasAvbReceiveEngine();
+    ASSERT_EQ(IasAvbResult::eIasAvbResultOk,
+              mEnvironment->setConfigValue(IasRegKeys::cRxWakeup, uint64_t(cModes[mode])));
+
+    ASSERT_EQ(eIasAvbProcOK, mAvbReceiveEngine->init());
+    ASSERT_EQ(cModes[mode], mAvbReceiveEngine->mWakeupMode);
+    if (IasAvbReceiveEngine::eRxWakeupPoll != cModes[mode])
+    {
+      ASSERT_NE(-1, mAvbReceiveEngine->mWorkers[0].epollFd);
+      ASSERT_NE(-1, mAvbReceiveEngine->mWorkers[0].timerFd);
+    }
+    ASSERT_EQ(eIasAvbProcOK, createProperAudioStream(streamId, &dmac));
+
+    struct timespec begin;
+    struct timespec end;
+    (void) clock_gettime(CLOCK_MONOTONIC, &begin);
+    ASSERT_EQ(eIasAvbProcOK, mAvbReceiveEngine->start());
+
+    // frames further apart than the cycle wait, so each one needs its own wakeup
+    const uint32_t cNumPackets = 100u;
+    for (uint32_t i = 0u; i < cNumPackets; i++)
+    {
+      ASSERT_TRUE(sendLocalFrames(&dmac, buffer, sizeof buffer, 1u));
+      usleep(5000u);
+    }
+
+    sleep(1);
+    ASSERT_EQ(eIasAvbProcOK, mAvbReceiveEngine->stop());
+    (void) clock_gettime(CLOCK_MONOTONIC, &end);
+
+    const IasAvbReceiveEngine::RxStatistics &stats = mAvbReceiveEngine->mWorkers[0].stats;
+    const double elapsed = double(end.tv_sec - begin.tv_sec) + double(end.tv_nsec - begin.tv_nsec) / 1e9;
+    wakeupsPerSec[mode] = double(stats.wakeupsTotal) / elapsed;
+    const std::string name(cModeNames[mode]);
+    RecordProperty(name + "WakeupsPerSec", int(wakeupsPerSec[mode]));
+    RecordProperty(name + "Syscalls", int(stats.syscallsTotal));
+    RecordProperty(name + "LatencyAvgNs",
+                   int((0u != stats.latencyCountTotal) ? (stats.latencyAccTotal / stats.latencyCountTotal) : 0u));
+    ASSERT_LE(uint64_t(cNumPackets), stats.framesTotal);
+    ASSERT_LT(0u, stats.wakeupsTotal);
+
+    ASSERT_EQ(eIasAvbProcOK, mAvbReceiveEngine->destroyAvbStream(streamId));
+  }
+
+  // the event driven worker wakes up for frames and stream timeouts only, the timed one also after each cycle wait
+  ASSERT_LT(wakeupsPerSec[1], wakeupsPerSec[0]);
+}
+
+TEST_F(IasTestAvbReceiveEngine, buildReceiveFilter)
+{
+  ASSERT_TRUE(mAvbReceiveEngine != NULL);
+  ASSERT_TRUE(LocalSetup());
+  ASSERT_EQ(eIasAvbProcOK, mAvbReceiveEngine->init());
+
+  std::vector<struct sock_filter> program;
+  const size_t cHeaderSize = 8u;
+
+  // no streams, drop everything after the header
+  mAvbReceiveEngine->buildReceiveFilter(NULL, program);
+  ASSERT_EQ(cHeaderSize + 1u, program.size());
+  ASSERT_EQ(0u, program.back().k);
+
+  for (uint64_t id = 1u; id <= 3u; id++)
+  {
+    IasAvbStreamId streamId(id);
+    ASSERT_EQ(eIasAvbProcOK, createProperAudioStream(streamId));
+  }
+  mAvbReceiveEngine->buildReceiveFilter(mAvbReceiveEngine->mStreamTable.load(), program);
+  ASSERT_EQ(cHeaderSize + 3u * 5u + 1u, program.size());
+  ASSERT_EQ(0u, program.back().k);
+
+  // a wildcard stream with DMAC is matched by its DMAC
+  IasAvbMacAddress dmac = {0x91, 0xE0, 0xF0, 0x00, 0xFE, 0x10};
+  ASSERT_EQ(eIasAvbProcOK, createProperAudioStream(IasAvbStreamId(uint64_t(0u)), &dmac));
+  mAvbReceiveEngine->buildReceiveFilter(mAvbReceiveEngine->mStreamTable.load(), program);
+  ASSERT_EQ(cHeaderSize + 4u * 5u + 1u, program.size());
+  bool dmacFound = false;
+  for (size_t i = 0u; i < program.size(); i++)
+  {
+    dmacFound = dmacFound || (((BPF_JMP | BPF_JEQ | BPF_K) == program[i].code) && (0x91E0F000u == program[i].k));
+  }
+  ASSERT_TRUE(dmacFound);
+
+  // a wildcard stream without DMAC needs all stream data
+  ASSERT_EQ(eIasAvbProcOK, mAvbReceiveEngine->destroyAvbStream(IasAvbStreamId(uint64_t(0u))));
+  ASSERT_EQ(eIasAvbProcOK, createProperAudioStream(IasAvbStreamId(uint64_t(0u))));
+  mAvbReceiveEngine->buildReceiveFilter(mAvbReceiveEngine->mStreamTable.load(), program);
+  ASSERT_EQ(cHeaderSize + 1u, program.size());
+  ASSERT_NE(0u, program.back().k);
+}
+
+TEST_F(IasTestAvbReceiveEngine, localhost_run_filter)
+{
+  ASSERT_TRUE(mAvbReceiveEngine != NULL);
+
+  ASSERT_TRUE(LocalHostSetup());
+  ASSERT_EQ(eIasAvbProcOK, mAvbReceiveEngine->init());
+  ASSERT_TRUE(mAvbReceiveEngine->mUseRxFilter);
+
+  IasAvbMacAddress dmac = {0x91, 0xE0, 0xF0, 0x00, 0xFE, 0x00};
+  ASSERT_EQ(eIasAvbProcOK, createProperAudioStream(IasAvbStreamId(uint64_t(1u)), &dmac));
+  ASSERT_EQ(eIasAvbProcOK, mAvbReceiveEngine->start());
+
+  uint8_t buffer[256];
+  memset(&buffer, 0, sizeof buffer);
+  buffer[0] = 0x02; // AAF
+
+  // foreign traffic: control PDUs and other streams' data must not reach the engine
+  const uint32_t cNumPackets = 100u;
+  buffer[11] = 0x55; // stream id
+  buffer[1] = 0x00;
+  ASSERT_TRUE(sendLocalFrames(&dmac, buffer, sizeof buffer, cNumPackets / 2u));
+  buffer[1] = 0x80; // sv
+  ASSERT_TRUE(sendLocalFrames(&dmac, buffer, sizeof buffer, cNumPackets / 2u));
+  usleep(100000);
+  ASSERT_EQ(0u, mAvbReceiveEngine->mWorkers[0].stats.framesTotal);
+
+  buffer[11] = 1u;  // stream id
+  ASSERT_TRUE(sendLocalFrames(&dmac, buffer, sizeof buffer, cNumPackets));
+
+  sleep(1);
+  ASSERT_EQ(eIasAvbProcOK, mAvbReceiveEngine->stop());
+  ASSERT_LE(uint64_t(cNumPackets), mAvbReceiveEngine->mWorkers[0].stats.framesTotal);
+}
+
+TEST_F(IasTestAvbReceiveEngine, invalidWakeupMode)
+{
+  ASSERT_TRUE(mAvbReceiveEngine != NULL);
+  ASSERT_TRUE(LocalSetup());
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk,
+            mEnvironment->setConfigValue(IasRegKeys::cRxWakeup, uint64_t(IasAvbReceiveEngine::eRxWakeupBusyPoll + 1u)));
+  ASSERT_EQ(eIasAvbProcInvalidParam, mAvbReceiveEngine->init());
+}
+
+TEST_F(IasTestAvbReceiveEngine, receiveFrameTimestamp)
+{
+  ASSERT_TRUE(mAvbReceiveEngine != NULL);
+
+  ASSERT_TRUE(LocalHostSetup());
+  // no streams, let everything through
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cRxSocketFilter, 0u));
+  ASSERT_EQ(eIasAvbProcOK, mAvbReceiveEngine->init());
+  ASSERT_EQ(IasAvbReceiveEngine::eRxTimestampSoftware, mAvbReceiveEngine->mTimestampMode);
+
+  IasAvbReceiveEngine::RxWorker &worker = mAvbReceiveEngine->mWorkers[0];
+  IasLibPtpDaemon* ptp = IasAvbStreamHandlerEnvironment::getPtpProxy();
+  ASSERT_TRUE(NULL != ptp);
+
+  // no time stamp, the fallback is used
+  worker.realToLocal = 1000;
+  ASSERT_EQ(42u, mAvbReceiveEngine->toLocalTime(worker, 0u, 0u, false, 42u));
+  ASSERT_EQ(2000000001u, mAvbReceiveEngine->toLocalTime(worker, 2u, 1u, true, 42u));
+  ASSERT_EQ(2000001001u, mAvbReceiveEngine->toLocalTime(worker, 2u, 1u, false, 42u));
+
+  IasAvbMacAddress broadcast = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+  uint8_t buffer[64];
+  memset(&buffer, 0, sizeof buffer);
+  buffer[0] = 0x02; // AAF
+
+  const uint64_t before = ptp->getLocalTime();
+  ASSERT_TRUE(sendLocalFrames(&broadcast, buffer, sizeof buffer, 1u));
+  usleep(10000);
+
+  const uint64_t now = ptp->getLocalTime();
+  mAvbReceiveEngine->updateClockOffset(worker, now);
+
+  uint64_t rxTime = 0u;
+  ASSERT_LT(0, mAvbReceiveEngine->receiveFrame(worker, worker.buffer, now, rxTime));
+
+  // the kernel stamped the frame when it was sent, well before the wakeup; allow for clock jitter
+  ASSERT_NE(now, rxTime);
+  ASSERT_LE(before, rxTime + 1000000u);
+  ASSERT_GT(now, rxTime);
+}
+
+TEST_F(IasTestAvbReceiveEngine, pcapReplayRecord)
+{
+  ASSERT_TRUE(mAvbReceiveEngine != NULL);
+
+  const std::string replayFile("/tmp/IasTestAvbReceiveEngine_replay.pcap");
+  const std::string recordFile("/tmp/IasTestAvbReceiveEngine_record.pcap");
+  IasAvbMacAddress dmac = {0x91, 0xE0, 0xF0, 0x00, 0xFE, 0x00};
+
+  // a class A stream, 8000 packets/s
+  const uint32_t cNumPackets = 1000u;
+  {
+    IasAvbPcapFile capture;
+    ASSERT_EQ(eIasAvbProcOK, capture.openWrite(replayFile));
+
+    uint8_t frame[ETH_HLEN + 64u];
+    memset(frame, 0, sizeof frame);
+    memcpy(frame, dmac, ETH_ALEN);
+    frame[12] = 0x22;  // AVTP
+    frame[13] = 0xF0;
+    uint8_t * const avtp = frame + ETH_HLEN;
+    avtp[0] = 0x02; // AAF
+    avtp[1] = 0x80; // sv
+    avtp[11] = 1u;  // stream id
+
+    for (uint32_t count = 0u; count < cNumPackets; count++)
+    {
+      avtp[2] = uint8_t(count);
+      ASSERT_EQ(eIasAvbProcOK, capture.writeFrame(frame, sizeof frame, 1000000000u + uint64_t(count) * 125000u));
+    }
+  }
+
+  ASSERT_TRUE(LocalHostSetup());
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cRxPcapReplay, replayFile));
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cRxPcapReplayRealtime, 0u));
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cRxPcapRecord, recordFile));
+  ASSERT_EQ(eIasAvbProcOK, mAvbReceiveEngine->init());
+  ASSERT_TRUE(NULL != mAvbReceiveEngine->mPcapReplay);
+  ASSERT_FALSE(mAvbReceiveEngine->mReplayRealtime);
+  ASSERT_TRUE(NULL != mAvbReceiveEngine->mPcapRecord);
+
+  ASSERT_EQ(eIasAvbProcOK, createProperAudioStream(IasAvbStreamId(uint64_t(1u)), &dmac));
+  ASSERT_EQ(eIasAvbProcOK, mAvbReceiveEngine->start());
+  sleep(1);
+  ASSERT_EQ(eIasAvbProcOK, mAvbReceiveEngine->stop());
+
+  // replayed as fast as possible, all frames have been seen and recorded
+  ASSERT_EQ(uint64_t(cNumPackets), mAvbReceiveEngine->mWorkers[0].stats.framesTotal);
+  ASSERT_EQ(uint64_t(cNumPackets), mAvbReceiveEngine->mPcapReplay->getNumFrames());
+  // write what is still queued and close the recording
+  mAvbReceiveEngine->mPcapRecord->cleanup();
+  ASSERT_EQ(0u, mAvbReceiveEngine->mPcapRecord->getNumDropped());
+
+  IasAvbPcapFile record;
+  ASSERT_EQ(eIasAvbProcOK, record.openRead(recordFile));
+  uint8_t buffer[256];
+  size_t length = 0u;
+  uint64_t timestamp = 0u;
+  uint64_t lastTimestamp = 0u;
+  uint32_t numRecorded = 0u;
+  while (eIasAvbProcOK == record.readFrame(buffer, sizeof buffer, length, timestamp))
+  {
+    // the frames are passed on with the original distance
+    if (0u != numRecorded)
+    {
+      ASSERT_EQ(125000u, timestamp - lastTimestamp);
+    }
+    ASSERT_EQ(uint8_t(numRecorded), buffer[ETH_HLEN + 2u]);
+    lastTimestamp = timestamp;
+    numRecorded++;
+  }
+  ASSERT_EQ(cNumPackets, numRecorded);
+
+  (void) unlink(replayFile.c_str());
+  (void) unlink(recordFile.c_str());
+}
+
+TEST_F(IasTestAvbReceiveEngine, pcapReplayMissingFile)
+{
+  ASSERT_TRUE(mAvbReceiveEngine != NULL);
+  ASSERT_TRUE(LocalSetup());
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk,
+            mEnvironment->setConfigValue(IasRegKeys::cRxPcapReplay, std::string("/nonexistent/capture.pcap")));
+  ASSERT_EQ(eIasAvbProcInitializationFailed, mAvbReceiveEngine->init());
+}
+
+TEST_F(IasTestAvbReceiveEngine, invalidTimestampMode)
+{
+  ASSERT_TRUE(mAvbReceiveEngine != NULL);
+  ASSERT_TRUE(LocalSetup());
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk,
+            mEnvironment->setConfigValue(IasRegKeys::cRxTimestamping, uint64_t(IasAvbReceiveEngine::eRxTimestampHardware + 1u)));
+  ASSERT_EQ(eIasAvbProcInvalidParam, mAvbReceiveEngine->init());
+}
+#endif
+
+TEST_F(IasTestAvbReceiveEngine, invalidWorkerCount)
+{
+  ASSERT_TRUE(mAvbReceiveEngine != NULL);
+  ASSERT_TRUE(LocalSetup());
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cRxWorkers, 0u));
+  ASSERT_EQ(eIasAvbProcInvalidParam, mAvbReceiveEngine->init());
+
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk,
+            mEnvironment->setConfigValue(IasRegKeys::cRxWorkers, uint64_t(IasAvbReceiveEngine::cRxWorkersMax + 1u)));
+  ASSERT_EQ(eIasAvbProcInvalidParam, mAvbReceiveEngine->init());
+  ASSERT_TRUE(NULL == mAvbReceiveEngine->mReceiveThread);
+}
+
 TEST_F(IasTestAvbReceiveEngine, ConnectVideoStreams)
 {
   ASSERT_TRUE(mAvbReceiveEngine != NULL);
@@ -1049,19 +1610,114 @@ TEST_F(IasTestAvbReceiveEngine, closeSocket)
 {
   ASSERT_TRUE(mAvbReceiveEngine != NULL);
 
-  mAvbReceiveEngine->mReceiveSocket = 0;
+  mAvbReceiveEngine->mWorkers[0].socket = 0;
   mAvbReceiveEngine->closeSocket();
-  ASSERT_EQ(-1, mAvbReceiveEngine->mReceiveSocket);
+  ASSERT_EQ(-1, mAvbReceiveEngine->mWorkers[0].socket);
 }
 
 TEST_F(IasTestAvbReceiveEngine, cleanup)
 {
   ASSERT_TRUE(mAvbReceiveEngine != NULL);
 
-  mAvbReceiveEngine->mReceiveSocket = 0;
+  mAvbReceiveEngine->mWorkers[0].socket = 0;
   mAvbReceiveEngine->cleanup();
 }
 
+TEST_F(IasTestAvbReceiveEngine, streamTableLookup)
+{
+  ASSERT_TRUE(mAvbReceiveEngine != NULL);
+  ASSERT_TRUE(LocalSetup());
+  ASSERT_EQ(eIasAvbProcOK, mAvbReceiveEngine->init());
+
+  ASSERT_TRUE(NULL == mAvbReceiveEngine->mStreamTable.load());
+
+  // enough streams to force the table to grow beyond its initial size
+  for (uint64_t id = 1u; id <= 10u; id++)
+  {
+    IasAvbStreamId streamId(id);
+    ASSERT_EQ(eIasAvbProcOK, createProperAudioStream(streamId));
+  }
+
+  const IasAvbReceiveEngine::StreamTable * table = mAvbReceiveEngine->mStreamTable.load();
+  ASSERT_TRUE(NULL != table);
+  ASSERT_EQ(10u, table->streams.size());
+  ASSERT_LE(20u, table->slots.size());
+  ASSERT_TRUE(NULL == table->wildcard);
+  for (uint64_t id = 1u; id <= 10u; id++)
+  {
+    IasAvbReceiveEngine::StreamData * data = IasAvbReceiveEngine::findStream(*table, id);
+    ASSERT_TRUE(NULL != data);
+    ASSERT_EQ(id, uint64_t(data->stream->getStreamId()));
+  }
+  ASSERT_TRUE(NULL == IasAvbReceiveEngine::findStream(*table, 11u));
+
+  // destroying a stream publishes a new table without it
+  ASSERT_EQ(eIasAvbProcOK, mAvbReceiveEngine->destroyAvbStream(IasAvbStreamId(uint64_t(5u))));
+  table = mAvbReceiveEngine->mStreamTable.load();
+  ASSERT_TRUE(NULL != table);
+  ASSERT_EQ(9u, table->streams.size());
+  ASSERT_TRUE(NULL == IasAvbReceiveEngine::findStream(*table, 5u));
+  ASSERT_TRUE(NULL != IasAvbReceiveEngine::findStream(*table, 6u));
+
+  IasAvbStreamId wildcardId(uint64_t(0u));
+  ASSERT_EQ(eIasAvbProcOK, createProperAudioStream(wildcardId));
+  table = mAvbReceiveEngine->mStreamTable.load();
+  ASSERT_TRUE(NULL != table->wildcard);
+  ASSERT_EQ(table->wildcard, IasAvbReceiveEngine::findStream(*table, 0u));
+}
+
+TEST_F(IasTestAvbReceiveEngine, checkStreamTimeouts)
+{
+  ASSERT_TRUE(mAvbReceiveEngine != NULL);
+  ASSERT_TRUE(LocalSetup());
+  ASSERT_EQ(eIasAvbProcOK, mAvbReceiveEngine->init());
+
+  for (uint64_t id = 1u; id <= 3u; id++)
+  {
+    IasAvbStreamId streamId(id);
+    ASSERT_EQ(eIasAvbProcOK, createProperAudioStream(streamId));
+  }
+
+  const uint64_t cIdleWait = 25000000u;
+  const uint64_t start = 1000000000u;
+  IasAvbReceiveEngine::RxWorker &worker = mAvbReceiveEngine->mWorkers[0];
+  ASSERT_EQ(eIasAvbProcOK, worker.timeouts.init(mAvbReceiveEngine->mTimeoutTick, start));
+
+  // the first check fills the wheel, new streams have never been dispatched and time out at once
+  mAvbReceiveEngine->checkStreamTimeouts(worker, start, cIdleWait);
+  ASSERT_EQ(mAvbReceiveEngine->mStreamTable.load()->generation, worker.timeoutGeneration);
+  for (uint64_t id = 1u; id <= 3u; id++)
+  {
+    ASSERT_EQ(start, mAvbReceiveEngine->mAvbStreams[IasAvbStreamId(id)].lastTimeDispatched);
+  }
+  ASSERT_EQ(3u, worker.timeouts.getSize());
+
+  // stream 2 receives data, only the others time out
+  const uint64_t dataTime = start + cIdleWait / 2u;
+  mAvbReceiveEngine->mAvbStreams[IasAvbStreamId(uint64_t(2u))].lastTimeDispatched = dataTime;
+  const uint64_t expiry = start + cIdleWait;
+  mAvbReceiveEngine->checkStreamTimeouts(worker, expiry - 1u, cIdleWait);
+  ASSERT_EQ(start, mAvbReceiveEngine->mAvbStreams[IasAvbStreamId(uint64_t(1u))].lastTimeDispatched);
+  mAvbReceiveEngine->checkStreamTimeouts(worker, expiry, cIdleWait);
+  ASSERT_EQ(expiry, mAvbReceiveEngine->mAvbStreams[IasAvbStreamId(uint64_t(1u))].lastTimeDispatched);
+  ASSERT_EQ(dataTime, mAvbReceiveEngine->mAvbStreams[IasAvbStreamId(uint64_t(2u))].lastTimeDispatched);
+  ASSERT_EQ(expiry, mAvbReceiveEngine->mAvbStreams[IasAvbStreamId(uint64_t(3u))].lastTimeDispatched);
+  ASSERT_EQ(3u, worker.timeouts.getSize());
+
+  // a destroyed stream is dropped from the wheel with the next table
+  ASSERT_EQ(eIasAvbProcOK, mAvbReceiveEngine->destroyAvbStream(IasAvbStreamId(uint64_t(3u))));
+  mAvbReceiveEngine->checkStreamTimeouts(worker, expiry, cIdleWait);
+  ASSERT_EQ(2u, worker.timeouts.getSize());
+}
+
+TEST_F(IasTestAvbReceiveEngine, invalidTimeoutTick)
+{
+  ASSERT_TRUE(mAvbReceiveEngine != NULL);
+  ASSERT_TRUE(LocalSetup());
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cRxTimeoutTick, 0u));
+  ASSERT_EQ(eIasAvbProcInvalidParam, mAvbReceiveEngine->init());
+}
+
 TEST_F(IasTestAvbReceiveEngine, checkStreamState)
 {
   ASSERT_TRUE(mAvbReceiveEngine != NULL);
@@ -1167,6 +1823,48 @@ TEST_F(IasTestAvbReceiveEngine, startIgbReceiveEngine)
   usleep(100);
   mAvbReceiveEngine->stopIgbReceiveEngine();
 }
+
+TEST_F(IasTestAvbReceiveEngine, shardFilterSameDmac)
+{
+  ASSERT_TRUE(mAvbReceiveEngine != NULL);
+  ASSERT_TRUE(LocalSetup());
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cRxWorkers, 2u));
+  ASSERT_EQ(eIasAvbProcOK, mAvbReceiveEngine->init());
+
+  IasAvbMacAddress dmac = {0x91,0xE0,0xF0,0x00,0xFE,0x00};
+  uint64_t id = 1u;
+
+  // take all filters
+  for (; id <= IasAvbReceiveEngine::cRxShardFilters; id++)
+  {
+    dmac[5] = uint8_t(2u * id + 1u);
+    ASSERT_EQ(eIasAvbProcOK, createProperAudioStream(IasAvbStreamId(id), &dmac));
+    ASSERT_EQ(1u, mAvbReceiveEngine->mAvbStreams[IasAvbStreamId(id)].worker);
+  }
+
+  // no filter left, so the stream is served by worker 0
+  const uint64_t fallbackId = id++;
+  dmac[5] = 0x41;
+  ASSERT_EQ(eIasAvbProcOK, createProperAudioStream(IasAvbStreamId(fallbackId), &dmac));
+  ASSERT_EQ(0u, mAvbReceiveEngine->mAvbStreams[IasAvbStreamId(fallbackId)].worker);
+
+  // a filter is released, but must not be used for the DMAC served by worker 0
+  ASSERT_EQ(eIasAvbProcOK, mAvbReceiveEngine->destroyAvbStream(IasAvbStreamId(uint64_t(1u))));
+  const uint64_t sameDmacId = id++;
+  ASSERT_EQ(eIasAvbProcOK, createProperAudioStream(IasAvbStreamId(sameDmacId), &dmac));
+  ASSERT_EQ(0u, mAvbReceiveEngine->mAvbStreams[IasAvbStreamId(sameDmacId)].worker);
+  for (size_t i = 0u; i < IasAvbReceiveEngine::cRxShardFilters; i++)
+  {
+    ASSERT_TRUE((0u == mAvbReceiveEngine->mShardFilters[i].refCount)
+                || (0 != memcmp(mAvbReceiveEngine->mShardFilters[i].dmac, dmac, sizeof dmac)));
+  }
+
+  // other DMACs still get the released filter
+  const uint64_t otherId = id++;
+  dmac[5] = 0x43;
+  ASSERT_EQ(eIasAvbProcOK, createProperAudioStream(IasAvbStreamId(otherId), &dmac));
+  ASSERT_EQ(1u, mAvbReceiveEngine->mAvbStreams[IasAvbStreamId(otherId)].worker);
+}
 #endif
 
 } // IasMediaTransportAvb
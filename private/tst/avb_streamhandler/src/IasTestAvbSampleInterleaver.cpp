@@ -0,0 +1,309 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file IasTestAvbSampleInterleaver.cpp
+ * @date 2018
+ */
+
+#include "gtest/gtest.h"
+
+#define private public
+#define protected public
+#include "avb_streamhandler/IasAvbSampleInterleaver.hpp"
+#undef protected
+#undef private
+
+#include <chrono>
+#include <sstream>
+#include <vector>
+
+using namespace IasMediaTransportAvb;
+
+namespace {
+
+// the per-sample loop IasAvbAudioStream used before the kernels
+void interleaveReference(uint8_t *payload, const int16_t *samples, uint32_t channelStride,
+    uint32_t numChannels, uint32_t numSamples)
+{
+  for (uint32_t ch = 0u; ch < numChannels; ch++)
+  {
+    for (uint32_t s = 0u; s < numSamples; s++)
+    {
+      const uint16_t value = uint16_t(samples[(ch * channelStride) + s]);
+      uint8_t * const out = payload + (((s * numChannels) + ch) * 2u);
+      out[0] = uint8_t(value >> 8);
+      out[1] = uint8_t(value);
+    }
+  }
+}
+
+void deinterleaveReference(int16_t *samples, uint32_t channelStride, const uint8_t *payload,
+    uint32_t frameChannels, uint32_t numChannels, uint32_t numSamples)
+{
+  for (uint32_t ch = 0u; ch < numChannels; ch++)
+  {
+    for (uint32_t s = 0u; s < numSamples; s++)
+    {
+      const uint8_t * const in = payload + (((s * frameChannels) + ch) * 2u);
+      samples[(ch * channelStride) + s] = int16_t(uint16_t((uint32_t(in[0]) << 8) | in[1]));
+    }
+  }
+}
+
+} // anonymous namespace
+
+
+class IasTestAvbSampleInterleaver : public ::testing::Test
+{
+protected:
+  IasTestAvbSampleInterleaver() {}
+
+  virtual ~IasTestAvbSampleInterleaver() {}
+
+  virtual void SetUp() {}
+
+  virtual void TearDown() {}
+
+  // distinct values with both bytes varying, so swapped or misplaced samples are detected
+  static void fill(std::vector<int16_t> &samples)
+  {
+    for (size_t i = 0u; i < samples.size(); i++)
+    {
+      samples[i] = int16_t(uint16_t((i * 0x9E37u) ^ 0x5A01u));
+    }
+  }
+};
+
+
+TEST_F(IasTestAvbSampleInterleaver, dispatch)
+{
+  ASSERT_TRUE(IasAvbSampleInterleaver::isSupported(IasAvbSampleInterleaver::eIsaScalar));
+  ASSERT_FALSE(IasAvbSampleInterleaver::isSupported(IasAvbSampleInterleaver::eIsaCount));
+  ASSERT_TRUE(NULL == IasAvbSampleInterleaver::getInterleave(IasAvbSampleInterleaver::eIsaCount));
+  ASSERT_TRUE(NULL == IasAvbSampleInterleaver::getDeinterleave(IasAvbSampleInterleaver::eIsaCount));
+
+  // the selected kernels are those of the best supported instruction set
+  const IasAvbSampleInterleaver::Isa isa = IasAvbSampleInterleaver::getIsa();
+  ASSERT_TRUE(IasAvbSampleInterleaver::isSupported(isa));
+  for (int i = int(isa) + 1; i < int(IasAvbSampleInterleaver::eIsaCount); i++)
+  {
+    ASSERT_FALSE(IasAvbSampleInterleaver::isSupported(IasAvbSampleInterleaver::Isa(i)));
+  }
+  ASSERT_EQ(IasAvbSampleInterleaver::getInterleave(isa), IasAvbSampleInterleaver::sInterleave);
+  ASSERT_EQ(IasAvbSampleInterleaver::getDeinterleave(isa), IasAvbSampleInterleaver::sDeinterleave);
+
+  for (int i = 0; i < int(IasAvbSampleInterleaver::eIsaCount); i++)
+  {
+    const IasAvbSampleInterleaver::Isa isa2 = IasAvbSampleInterleaver::Isa(i);
+    const bool supported = IasAvbSampleInterleaver::isSupported(isa2);
+    ASSERT_EQ(supported, NULL != IasAvbSampleInterleaver::getInterleave(isa2));
+    ASSERT_EQ(supported, NULL != IasAvbSampleInterleaver::getDeinterleave(isa2));
+  }
+}
+
+TEST_F(IasTestAvbSampleInterleaver, interleave)
+{
+  const uint32_t cMaxChannels = 17u;
+  const uint32_t cMaxSamples = 40u;
+  const uint32_t cStride = cMaxSamples + 3u;   // channel buffers not aligned to the blocks
+  std::vector<int16_t> samples(cStride * cMaxChannels);
+  fill(samples);
+
+  for (int i = 0; i < int(IasAvbSampleInterleaver::eIsaCount); i++)
+  {
+    IasAvbSampleInterleaver::InterleaveFunc interleave = IasAvbSampleInterleaver::getInterleave(IasAvbSampleInterleaver::Isa(i));
+    if (NULL == interleave)
+    {
+      continue;
+    }
+
+    for (uint32_t numChannels = 1u; numChannels <= cMaxChannels; numChannels++)
+    {
+      for (uint32_t numSamples = 0u; numSamples <= cMaxSamples; numSamples++)
+      {
+        const size_t payloadSize = numChannels * numSamples * 2u;
+        // one guard byte behind the payload must not be touched
+        std::vector<uint8_t> expected(payloadSize + 1u, 0xA5u);
+        std::vector<uint8_t> actual(payloadSize + 1u, 0xA5u);
+
+        interleaveReference(&expected[0], &samples[0], cStride, numChannels, numSamples);
+        interleave(&actual[0], &samples[0], cStride, numChannels, numSamples);
+
+        std::stringstream ss;
+        ss << "isa " << i << " channels " << numChannels << " samples " << numSamples;
+        SCOPED_TRACE(ss.str());
+        ASSERT_TRUE(expected == actual);
+      }
+    }
+  }
+}
+
+TEST_F(IasTestAvbSampleInterleaver, deinterleave)
+{
+  const uint32_t cMaxChannels = 17u;
+  const uint32_t cMaxSamples = 40u;
+  const uint32_t cStride = cMaxSamples + 3u;
+  const int16_t cGuard = int16_t(0x7E7E);
+  std::vector<int16_t> source(cMaxChannels * cMaxSamples);
+  fill(source);
+  std::vector<uint8_t> payload(source.size() * 2u);
+  interleaveReference(&payload[0], &source[0], 1u, uint32_t(source.size()), 1u);
+
+  for (int i = 0; i < int(IasAvbSampleInterleaver::eIsaCount); i++)
+  {
+    IasAvbSampleInterleaver::DeinterleaveFunc deinterleave =
+        IasAvbSampleInterleaver::getDeinterleave(IasAvbSampleInterleaver::Isa(i));
+    if (NULL == deinterleave)
+    {
+      continue;
+    }
+
+    for (uint32_t frameChannels = 1u; frameChannels <= cMaxChannels; frameChannels++)
+    {
+      // the stream may read fewer channels than the packet carries
+      for (uint32_t numChannels = 1u; numChannels <= frameChannels; numChannels++)
+      {
+        for (uint32_t numSamples = 0u; numSamples <= cMaxSamples; numSamples++)
+        {
+          std::vector<int16_t> expected(cStride * numChannels, cGuard);
+          std::vector<int16_t> actual(cStride * numChannels, cGuard);
+
+          deinterleaveReference(&expected[0], cStride, &payload[0], frameChannels, numChannels, numSamples);
+          deinterleave(&actual[0], cStride, &payload[0], frameChannels, numChannels, numSamples);
+
+          std::stringstream ss;
+          ss << "isa " << i << " frame " << frameChannels << " channels " << numChannels << " samples " << numSamples;
+          SCOPED_TRACE(ss.str());
+          ASSERT_TRUE(expected == actual);
+        }
+      }
+    }
+  }
+}
+
+TEST_F(IasTestAvbSampleInterleaver, roundTrip)
+{
+  const uint32_t cChannels[] = { 2u, 4u, 6u, 8u };
+  const uint32_t cSamples = 48u;
+  std::vector<int16_t> source(cSamples * 8u);
+  fill(source);
+
+  for (size_t c = 0u; c < sizeof cChannels / sizeof cChannels[0]; c++)
+  {
+    const uint32_t numChannels = cChannels[c];
+    std::vector<uint8_t> payload(numChannels * cSamples * 2u);
+    std::vector<int16_t> sink(numChannels * cSamples);
+
+    IasAvbSampleInterleaver::interleave(&payload[0], &source[0], cSamples, numChannels, cSamples);
+    IasAvbSampleInterleaver::deinterleave(&sink[0], cSamples, &payload[0], numChannels, numChannels, cSamples);
+
+    ASSERT_TRUE(std::equal(sink.begin(), sink.end(), source.begin()));
+  }
+}
+
+// a class A packet at 48 kHz: 6 samples per channel, the vector kernels must match the scalar one
+TEST_F(IasTestAvbSampleInterleaver, classAPacket)
+{
+  const uint32_t cChannels[] = { 2u, 4u, 8u, 16u };
+  const uint32_t cSamples = 6u;
+  const uint32_t cStride = 64u;
+  const uint8_t cGuard = 0xA5u;
+  std::vector<int16_t> source(cStride * 16u);
+  fill(source);
+
+  IasAvbSampleInterleaver::InterleaveFunc interleaveScalar =
+      IasAvbSampleInterleaver::getInterleave(IasAvbSampleInterleaver::eIsaScalar);
+  IasAvbSampleInterleaver::DeinterleaveFunc deinterleaveScalar =
+      IasAvbSampleInterleaver::getDeinterleave(IasAvbSampleInterleaver::eIsaScalar);
+  ASSERT_TRUE(NULL != interleaveScalar);
+  ASSERT_TRUE(NULL != deinterleaveScalar);
+
+  for (int i = int(IasAvbSampleInterleaver::eIsaSse2); i < int(IasAvbSampleInterleaver::eIsaCount); i++)
+  {
+    IasAvbSampleInterleaver::InterleaveFunc interleave = IasAvbSampleInterleaver::getInterleave(IasAvbSampleInterleaver::Isa(i));
+    IasAvbSampleInterleaver::DeinterleaveFunc deinterleave = IasAvbSampleInterleaver::getDeinterleave(IasAvbSampleInterleaver::Isa(i));
+    if ((NULL == interleave) || (NULL == deinterleave))
+    {
+      continue;
+    }
+
+    for (size_t c = 0u; c < sizeof cChannels / sizeof cChannels[0]; c++)
+    {
+      const uint32_t numChannels = cChannels[c];
+      const size_t payloadBytes = numChannels * cSamples * 2u;
+
+      // the payload is followed by a guard byte the kernels must not touch
+      std::vector<uint8_t> expected(payloadBytes + 1u, cGuard);
+      std::vector<uint8_t> payload(payloadBytes + 1u, cGuard);
+      interleaveScalar(&expected[0], &source[0], cStride, numChannels, cSamples);
+      interleave(&payload[0], &source[0], cStride, numChannels, cSamples);
+      ASSERT_TRUE(payload == expected) << "isa " << i << " channels " << numChannels;
+
+      // only the first 6 samples of each channel are written
+      std::vector<int16_t> sinkScalar(cStride * numChannels, int16_t(0x7E7E));
+      std::vector<int16_t> sink(cStride * numChannels, int16_t(0x7E7E));
+      deinterleaveScalar(&sinkScalar[0], cStride, &payload[0], numChannels, numChannels, cSamples);
+      deinterleave(&sink[0], cStride, &payload[0], numChannels, numChannels, cSamples);
+      ASSERT_TRUE(sink == sinkScalar) << "isa " << i << " channels " << numChannels;
+      for (uint32_t ch = 0u; ch < numChannels; ch++)
+      {
+        ASSERT_TRUE(std::equal(&sink[ch * cStride], &sink[ch * cStride] + cSamples, &source[ch * cStride]));
+        ASSERT_EQ(int16_t(0x7E7E), sink[(ch * cStride) + cSamples]);
+      }
+    }
+  }
+}
+
+TEST_F(IasTestAvbSampleInterleaver, benchmark)
+{
+  // 8 channels, packets of class A at 48 kHz and of larger ones e.g. at 384 kHz
+  const uint32_t cNumChannels = 8u;
+  const uint32_t cPacketSamples[] = { 6u, 48u };
+  const uint32_t cNumPackets = 200000u;
+  const char * const cIsaNames[] = { "scalar", "sse2", "avx2" };
+  static_assert(sizeof cIsaNames / sizeof cIsaNames[0] == IasAvbSampleInterleaver::eIsaCount, "names missing");
+
+  std::vector<int16_t> samples(cNumChannels * 48u);
+  std::vector<uint8_t> payload(samples.size() * 2u);
+  fill(samples);
+
+  for (int i = 0; i < int(IasAvbSampleInterleaver::eIsaCount); i++)
+  {
+    const IasAvbSampleInterleaver::Isa isa = IasAvbSampleInterleaver::Isa(i);
+    IasAvbSampleInterleaver::InterleaveFunc interleave = IasAvbSampleInterleaver::getInterleave(isa);
+    IasAvbSampleInterleaver::DeinterleaveFunc deinterleave = IasAvbSampleInterleaver::getDeinterleave(isa);
+    if ((NULL == interleave) || (NULL == deinterleave))
+    {
+      continue;
+    }
+
+    for (size_t p = 0u; p < sizeof cPacketSamples / sizeof cPacketSamples[0]; p++)
+    {
+      const uint32_t numSamples = cPacketSamples[p];
+
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      for (uint32_t n = 0u; n < cNumPackets; n++)
+      {
+        interleave(&payload[0], &samples[0], numSamples, cNumChannels, numSamples);
+      }
+      const int64_t txNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+      start = std::chrono::steady_clock::now();
+      for (uint32_t n = 0u; n < cNumPackets; n++)
+      {
+        deinterleave(&samples[0], numSamples, &payload[0], cNumChannels, cNumChannels, numSamples);
+      }
+      const int64_t rxNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+      std::stringstream tx;
+      tx << cIsaNames[i] << "InterleavePsPerPacket" << numSamples;
+      RecordProperty(tx.str(), int(txNs * 1000 / int64_t(cNumPackets)));
+      std::stringstream rx;
+      rx << cIsaNames[i] << "DeinterleavePsPerPacket" << numSamples;
+      RecordProperty(rx.str(), int(rxNs * 1000 / int64_t(cNumPackets)));
+    }
+  }
+}
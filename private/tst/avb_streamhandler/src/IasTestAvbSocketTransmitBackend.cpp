@@ -0,0 +1,429 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ *  @file IasTestAvbSocketTransmitBackend.cpp
+ *  @date 2018
+ */
+#include "gtest/gtest.h"
+
+#define private public
+#define protected public
+#include "avb_streamhandler/IasAvbSocketTransmitBackend.hpp"
+#include "avb_streamhandler/IasAvbPacketPool.hpp"
+#include "avb_streamhandler/IasAvbPacket.hpp"
+#include "avb_streamhandler/IasAvbStreamHandlerEnvironment.hpp"
+#include "avb_streamhandler/IasAvbTSpec.hpp"
+#undef protected
+#undef private
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <linux/capability.h>
+#include <linux/if_ether.h>
+
+#ifndef CLOCK_TAI
+#define CLOCK_TAI 11
+#endif
+
+extern size_t heapSpaceLeft;
+extern size_t heapSpaceInitSize;
+
+namespace IasMediaTransportAvb
+{
+
+namespace {
+
+const char * const cVethTx = "avbtxtst0";
+const char * const cVethRx = "avbtxtst1";
+const uint64_t cEtfDelta = 500000u;   // ns the ETF qdisc dequeues a frame ahead of its launch time
+
+bool hasNetAdmin()
+{
+  struct __user_cap_header_struct header;
+  struct __user_cap_data_struct data[2];
+  header.version = _LINUX_CAPABILITY_VERSION_3;
+  header.pid = 0;
+  return (0 == syscall(SYS_capget, &header, data)) && (0u != (data[0].effective & (1u << CAP_NET_ADMIN)));
+}
+
+uint64_t getTaiTime()
+{
+  struct timespec tp;
+  (void) clock_gettime(CLOCK_TAI, &tp);
+  return uint64_t(tp.tv_sec) * 1000000000u + uint64_t(tp.tv_nsec);
+}
+
+} // anonymous namespace
+
+class IasTestAvbSocketTransmitBackend : public ::testing::Test
+{
+protected:
+  IasTestAvbSocketTransmitBackend():
+    mEnvironment(NULL),
+    mBackend(NULL),
+    mVeth(false)
+  {
+    DLT_REGISTER_APP("IAAS", "AVB Streamhandler");
+  }
+
+  virtual ~IasTestAvbSocketTransmitBackend()
+  {
+    DLT_UNREGISTER_APP();
+  }
+
+  // Sets up the test fixture.
+  virtual void SetUp()
+  {
+    heapSpaceLeft = heapSpaceInitSize;
+
+    dlt_enable_local_print();
+    mEnvironment = new IasAvbStreamHandlerEnvironment(DLT_LOG_INFO);
+    ASSERT_TRUE(NULL != mEnvironment);
+    mEnvironment->registerDltContexts();
+    mEnvironment->setDefaultConfigValues();
+    ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cXmitBackend, "socket"));
+
+    DLT_REGISTER_CONTEXT_LL_TS(mDltCtx,
+              "TEST",
+              "IasTestAvbSocketTransmitBackend",
+              DLT_LOG_INFO,
+              DLT_TRACE_STATUS_OFF);
+
+    mBackend = new IasAvbSocketTransmitBackend(mDltCtx);
+  }
+
+  virtual void TearDown()
+  {
+    delete mBackend;
+    mBackend = NULL;
+
+    if (mVeth)
+    {
+      // removes the peer as well
+      if (0 != system((std::string("ip link del ") + cVethTx + " 2>/dev/null").c_str()))
+      {
+        std::cerr << "could not delete " << cVethTx << std::endl;
+      }
+      mVeth = false;
+    }
+
+    if (NULL != mEnvironment)
+    {
+      mEnvironment->unregisterDltContexts();
+      delete mEnvironment;
+      mEnvironment = NULL;
+    }
+
+    heapSpaceLeft = heapSpaceInitSize;
+
+    DLT_UNREGISTER_CONTEXT(mDltCtx);
+  }
+
+  // creates a veth pair with an ETF qdisc on the sending end, false if not permitted or not supported
+  bool setupVethEtf()
+  {
+    bool ret = false;
+
+    if (!hasNetAdmin())
+    {
+      std::cout << "[ SKIPPED  ] CAP_NET_ADMIN needed to set up veth and ETF qdisc" << std::endl;
+    }
+    else if (0 != system((std::string("ip link add ") + cVethTx + " type veth peer name " + cVethRx
+                          + " 2>/dev/null").c_str()))
+    {
+      std::cout << "[ SKIPPED  ] veth not available" << std::endl;
+    }
+    else
+    {
+      mVeth = true;
+      const std::string etf = std::string("tc qdisc add dev ") + cVethTx + " root etf clockid CLOCK_TAI delta "
+          + std::to_string(cEtfDelta) + " 2>/dev/null";
+      ret = (0 == system((std::string("ip link set ") + cVethTx + " up").c_str()))
+          && (0 == system((std::string("ip link set ") + cVethRx + " up").c_str()))
+          && (0 == system(etf.c_str()));
+      if (!ret)
+      {
+        std::cout << "[ SKIPPED  ] ETF qdisc not available" << std::endl;
+      }
+    }
+
+    return ret;
+  }
+
+  // fills in a broadcast AVTP frame with a source address to recognize it on the receive side
+  static void fillFrame(IasAvbPacket *packet, uint8_t marker)
+  {
+    uint8_t *frame = static_cast<uint8_t*>(packet->getBasePtr());
+    std::memset(frame, 0xFF, 6u);
+    const uint8_t source[6] = { 0x02u, 0x00u, 0x00u, 0x00u, 0x00u, marker };
+    std::memcpy(frame + 6u, source, sizeof source);
+    frame[12] = 0x81u;
+    frame[13] = 0x00u;
+    frame[14] = 0x00u;
+    frame[15] = 0x02u;
+    frame[16] = 0x22u;
+    frame[17] = 0xF0u;
+    packet->len = 64u;
+  }
+
+  // waits for the frame sent with fillFrame(marker), returns the CLOCK_TAI time it arrived or 0 on timeout
+  static uint64_t receiveFrame(int32_t sock, uint8_t marker, int32_t timeoutMs)
+  {
+    uint64_t ret = 0u;
+    struct pollfd pfd;
+    pfd.fd = sock;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    while ((0u == ret) && (poll(&pfd, 1u, timeoutMs) > 0))
+    {
+      uint8_t buf[128];
+      const ssize_t len = recv(sock, buf, sizeof buf, 0);
+      // frames from the stack, e.g. IPv6 router solicitations, are skipped
+      if ((len >= 12) && (0x02u == buf[6]) && (marker == buf[11]))
+      {
+        ret = getTaiTime();
+      }
+    }
+
+    return ret;
+  }
+
+  IasAvbStreamHandlerEnvironment* mEnvironment;
+  IasAvbSocketTransmitBackend* mBackend;
+  DltContext mDltCtx;
+  bool mVeth;
+};
+
+
+TEST_F(IasTestAvbSocketTransmitBackend, CTor_DTor)
+{
+  ASSERT_TRUE(NULL != mBackend);
+  ASSERT_EQ(-1, mBackend->mSocket);
+  ASSERT_TRUE(IasAvbStreamHandlerEnvironment::isSocketTransmitBackend());
+}
+
+TEST_F(IasTestAvbSocketTransmitBackend, notInitialized)
+{
+  ASSERT_TRUE(NULL != mBackend);
+
+  IasAvbPacket packet;
+  ASSERT_EQ(-ENXIO, mBackend->xmit(&packet));
+  ASSERT_EQ(0u, mBackend->reclaimPackets());
+
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cNwIfName, "nonexistent0"));
+  ASSERT_EQ(eIasAvbProcInitializationFailed, mBackend->init(0u, IasAvbSrClass::eIasAvbSrClassHigh));
+  ASSERT_EQ(-1, mBackend->mSocket);
+}
+
+TEST_F(IasTestAvbSocketTransmitBackend, sendLoopback)
+{
+  ASSERT_TRUE(NULL != mBackend);
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cNwIfName, "lo"));
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(
+      std::string(IasRegKeys::cXmitSocketPriority) + IasAvbTSpec::getClassSuffix(IasAvbSrClass::eIasAvbSrClassHigh), 5u));
+  ASSERT_EQ(eIasAvbProcOK, mBackend->init(0u, IasAvbSrClass::eIasAvbSrClassHigh));
+  ASSERT_EQ(eIasAvbProcInitializationFailed, mBackend->init(0u, IasAvbSrClass::eIasAvbSrClassHigh));
+
+  // without igb device, the pool takes its pages from the heap
+  IasAvbPacketPool pool(mDltCtx);
+  ASSERT_EQ(eIasAvbProcOK, pool.init(128u, 4u));
+  ASSERT_FALSE(pool.mAllocator->isDmaCapable());
+
+  IasAvbPacket *packet = pool.getPacket();
+  ASSERT_TRUE(NULL != packet);
+  uint8_t *frame = static_cast<uint8_t*>(packet->getBasePtr());
+  std::memset(frame, 0xFF, 12u);                       // broadcast, source
+  frame[12] = 0x81u;                                   // VLAN tag
+  frame[13] = 0x00u;
+  frame[16] = 0x22u;                                   // AVTP
+  frame[17] = 0xF0u;
+  packet->len = 64u;
+  packet->attime = 0u;                                 // launch time in the past, no ETF qdisc on lo
+
+  ASSERT_EQ(0, mBackend->xmit(packet));
+  ASSERT_EQ(3u, pool.mFreeBufferStack.size());
+  ASSERT_EQ(1u, mBackend->reclaimPackets());
+  ASSERT_EQ(4u, pool.mFreeBufferStack.size());
+  ASSERT_EQ(0u, mBackend->reclaimPackets());
+
+  mBackend->cleanup();
+  ASSERT_EQ(-1, mBackend->mSocket);
+}
+
+TEST_F(IasTestAvbSocketTransmitBackend, sendBatchLoopback)
+{
+  ASSERT_TRUE(NULL != mBackend);
+  uint32_t sent = 1u;
+  ASSERT_EQ(-ENXIO, mBackend->xmitBatch(NULL, 0u, sent));
+  ASSERT_EQ(0u, sent);
+
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cNwIfName, "lo"));
+  ASSERT_EQ(eIasAvbProcOK, mBackend->init(0u, IasAvbSrClass::eIasAvbSrClassHigh));
+
+  const uint32_t cNumPackets = IasAvbSocketTransmitBackend::cMaxBatch + 2u;
+  IasAvbPacketPool pool(mDltCtx);
+  ASSERT_EQ(eIasAvbProcOK, pool.init(128u, cNumPackets));
+
+  IasAvbPacket *packets[cNumPackets];
+  for (uint32_t i = 0u; i < cNumPackets; i++)
+  {
+    packets[i] = pool.getPacket();
+    ASSERT_TRUE(NULL != packets[i]);
+    uint8_t *frame = static_cast<uint8_t*>(packets[i]->getBasePtr());
+    std::memset(frame, 0xFF, 12u);
+    frame[12] = 0x81u;
+    frame[13] = 0x00u;
+    frame[16] = 0x22u;
+    frame[17] = 0xF0u;
+    packets[i]->len = 64u;
+    packets[i]->attime = i;
+  }
+
+  // more than one sendmmsg() call
+  ASSERT_EQ(0, mBackend->xmitBatch(packets, cNumPackets, sent));
+  ASSERT_EQ(cNumPackets, sent);
+  ASSERT_EQ(0u, pool.mFreeBufferStack.size());
+  ASSERT_EQ(cNumPackets, mBackend->reclaimPackets());
+  ASSERT_EQ(cNumPackets, pool.mFreeBufferStack.size());
+
+  mBackend->cleanup();
+}
+
+TEST_F(IasTestAvbSocketTransmitBackend, txTimestamps)
+{
+  ASSERT_TRUE(NULL != mBackend);
+  IasAvbTransmitBackend::TxTimestamp stamps[8];
+  ASSERT_FALSE(mBackend->enableTxTimestamps());
+  ASSERT_EQ(0u, mBackend->getTxTimestamps(stamps, 8u));
+
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cNwIfName, "lo"));
+  ASSERT_EQ(eIasAvbProcOK, mBackend->init(0u, IasAvbSrClass::eIasAvbSrClassHigh));
+  ASSERT_TRUE(mBackend->enableTxTimestamps());
+
+  const uint32_t cNumPackets = 4u;
+  IasAvbPacketPool pool(mDltCtx);
+  ASSERT_EQ(eIasAvbProcOK, pool.init(128u, cNumPackets));
+
+  struct timespec tp;
+  ASSERT_EQ(0, clock_gettime(CLOCK_REALTIME, &tp));
+  const uint64_t before = uint64_t(tp.tv_sec) * 1000000000u + uint64_t(tp.tv_nsec);
+
+  for (uint32_t i = 0u; i < cNumPackets; i++)
+  {
+    IasAvbPacket *packet = pool.getPacket();
+    ASSERT_TRUE(NULL != packet);
+    uint8_t *frame = static_cast<uint8_t*>(packet->getBasePtr());
+    std::memset(frame, 0xFF, 12u);
+    frame[12] = 0x81u;
+    frame[13] = 0x00u;
+    frame[16] = 0x22u;
+    frame[17] = 0xF0u;
+    packet->len = 64u;
+    packet->attime = 0u;
+    ASSERT_EQ(0, mBackend->xmit(packet));
+  }
+
+  // lo has no hardware time stamps, without PTP proxy the software time stamps are taken as they are
+  uint32_t count = 0u;
+  for (uint32_t retry = 0u; (retry < 100u) && (count < cNumPackets); retry++)
+  {
+    (void) mBackend->reclaimPackets();
+    count += mBackend->getTxTimestamps(&stamps[count], 8u - count);
+    (void) usleep(1000u);
+  }
+
+  ASSERT_EQ(0, clock_gettime(CLOCK_REALTIME, &tp));
+  const uint64_t after = uint64_t(tp.tv_sec) * 1000000000u + uint64_t(tp.tv_nsec);
+
+  ASSERT_EQ(cNumPackets, count);
+  for (uint32_t i = 0u; i < cNumPackets; i++)
+  {
+    ASSERT_EQ(i, stamps[i].id);
+    ASSERT_LE(before, stamps[i].time);
+    ASSERT_GE(after, stamps[i].time);
+  }
+  ASSERT_EQ(0u, mBackend->getStampOverflowCount());
+
+  mBackend->cleanup();
+  ASSERT_FALSE(mBackend->mTimestamps);
+}
+
+TEST_F(IasTestAvbSocketTransmitBackend, launchTimeEtf)
+{
+  ASSERT_TRUE(NULL != mBackend);
+  if (!setupVethEtf())
+  {
+    return;
+  }
+
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cNwIfName, cVethTx));
+  ASSERT_EQ(eIasAvbProcOK, mBackend->init(0u, IasAvbSrClass::eIasAvbSrClassHigh));
+
+  const int32_t rxSock = int32_t(socket(PF_PACKET, SOCK_RAW, htons(ETH_P_ALL)));
+  ASSERT_LE(0, rxSock);
+  struct sockaddr_ll addr;
+  std::memset(&addr, 0, sizeof addr);
+  addr.sll_family = AF_PACKET;
+  addr.sll_protocol = htons(ETH_P_ALL);
+  addr.sll_ifindex = int32_t(if_nametoindex(cVethRx));
+  ASSERT_EQ(0, bind(rxSock, reinterpret_cast<struct sockaddr*>(&addr), sizeof addr));
+
+  IasAvbPacketPool pool(mDltCtx);
+  ASSERT_EQ(eIasAvbProcOK, pool.init(128u, 4u));
+
+  // without PTP proxy the launch time is taken as CLOCK_TAI, the qdisc holds the frame back until then
+  IasAvbPacket *packet = pool.getPacket();
+  ASSERT_TRUE(NULL != packet);
+  fillFrame(packet, 1u);
+  const uint64_t launchTime = getTaiTime() + 20000000u;
+  packet->attime = launchTime;
+  ASSERT_EQ(0, mBackend->xmit(packet));
+
+  const uint64_t rxTime = receiveFrame(rxSock, 1u, 1000);
+  ASSERT_NE(0u, rxTime);
+  ASSERT_LE(launchTime - cEtfDelta, rxTime);
+  ASSERT_EQ(1u, mBackend->reclaimPackets());
+  ASSERT_EQ(0u, mBackend->getMissedCount());
+  ASSERT_EQ(0u, mBackend->getInvalidCount());
+
+  // a launch time in the past is rejected by the qdisc and reported on the error queue
+  packet = pool.getPacket();
+  ASSERT_TRUE(NULL != packet);
+  fillFrame(packet, 2u);
+  packet->attime = getTaiTime() - 1000000u;
+  const int32_t rc = mBackend->xmit(packet);
+  if (0 != rc)
+  {
+    // the drop is also returned by the send call
+    ASSERT_EQ(-ENOBUFS, rc);
+    (void) IasAvbPacketPool::returnPacket(packet);
+  }
+
+  for (uint32_t retry = 0u; (retry < 100u) && (0u == mBackend->getInvalidCount()); retry++)
+  {
+    (void) mBackend->reclaimPackets();
+    (void) usleep(1000u);
+  }
+  ASSERT_EQ(1u, mBackend->getInvalidCount());
+  ASSERT_EQ(0u, mBackend->getMissedCount());
+  ASSERT_EQ(0u, receiveFrame(rxSock, 2u, 50));
+  ASSERT_EQ(4u, pool.mFreeBufferStack.size());
+
+  (void) close(rxSock);
+  mBackend->cleanup();
+}
+
+} // namespace IasMediaTransportAvb
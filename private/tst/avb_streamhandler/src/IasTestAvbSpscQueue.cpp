@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file IasTestAvbSpscQueue.cpp
+ * @date 2018
+ */
+
+#include "gtest/gtest.h"
+
+#define private public
+#define protected public
+#include "avb_streamhandler/IasAvbSpscQueue.hpp"
+#undef protected
+#undef private
+
+#include <thread>
+
+using namespace IasMediaTransportAvb;
+
+typedef IasAvbSpscQueue<uint32_t> Queue;
+
+
+class IasTestAvbSpscQueue : public ::testing::Test
+{
+protected:
+  IasTestAvbSpscQueue() :
+    mQueue(NULL)
+  {
+  }
+
+  virtual ~IasTestAvbSpscQueue() {}
+
+  // Sets up the test fixture.
+  virtual void SetUp()
+  {
+    mQueue = new Queue();
+  }
+
+  virtual void TearDown()
+  {
+    delete mQueue;
+    mQueue = NULL;
+  }
+
+  Queue *mQueue;
+};
+
+
+TEST_F(IasTestAvbSpscQueue, CTor_DTor)
+{
+  ASSERT_TRUE(mQueue != NULL);
+  ASSERT_EQ(0u, mQueue->getCapacity());
+  ASSERT_EQ(0u, mQueue->size());
+
+  uint32_t value = 0u;
+  ASSERT_FALSE(mQueue->push(value));
+  ASSERT_FALSE(mQueue->pop(value));
+}
+
+TEST_F(IasTestAvbSpscQueue, init)
+{
+  ASSERT_TRUE(mQueue != NULL);
+  ASSERT_EQ(eIasAvbProcInvalidParam, mQueue->init(0u));
+  ASSERT_EQ(eIasAvbProcInvalidParam, mQueue->init(0x80000001u));
+
+  // rounded up to the next power of two
+  ASSERT_EQ(eIasAvbProcOK, mQueue->init(5u));
+  ASSERT_EQ(8u, mQueue->getCapacity());
+  ASSERT_EQ(eIasAvbProcOK, mQueue->init(1u));
+  ASSERT_EQ(1u, mQueue->getCapacity());
+  ASSERT_TRUE(mQueue->push(1u));
+  ASSERT_FALSE(mQueue->push(2u));
+
+  // init again drops all entries
+  ASSERT_EQ(eIasAvbProcOK, mQueue->init(4u));
+  ASSERT_EQ(0u, mQueue->size());
+
+  mQueue->cleanup();
+  ASSERT_EQ(0u, mQueue->getCapacity());
+  ASSERT_FALSE(mQueue->push(1u));
+}
+
+TEST_F(IasTestAvbSpscQueue, pushPop)
+{
+  ASSERT_TRUE(mQueue != NULL);
+  ASSERT_EQ(eIasAvbProcOK, mQueue->init(4u));
+
+  uint32_t value = 0u;
+  uint32_t expected = 0u;
+  uint32_t next = 0u;
+
+  // several rounds, so the indices wrap around the storage
+  for (uint32_t round = 0u; round < 10u; round++)
+  {
+    while (mQueue->push(next))
+    {
+      next++;
+    }
+    ASSERT_EQ(4u, mQueue->size());
+
+    for (uint32_t i = 0u; i < 3u; i++)
+    {
+      ASSERT_TRUE(mQueue->pop(value));
+      ASSERT_EQ(expected++, value);
+    }
+    ASSERT_EQ(1u, mQueue->size());
+  }
+
+  ASSERT_TRUE(mQueue->pop(value));
+  ASSERT_EQ(expected, value);
+  ASSERT_FALSE(mQueue->pop(value));
+  ASSERT_EQ(0u, mQueue->size());
+}
+
+TEST_F(IasTestAvbSpscQueue, wrapIndex)
+{
+  ASSERT_TRUE(mQueue != NULL);
+  ASSERT_EQ(eIasAvbProcOK, mQueue->init(4u));
+
+  // free running indices close to the overflow
+  mQueue->mHead = uint32_t(-2);
+  mQueue->mTail = uint32_t(-2);
+
+  uint32_t value = 0u;
+  for (uint32_t i = 0u; i < 4u; i++)
+  {
+    ASSERT_TRUE(mQueue->push(i));
+  }
+  ASSERT_FALSE(mQueue->push(4u));
+  ASSERT_EQ(4u, mQueue->size());
+
+  for (uint32_t i = 0u; i < 4u; i++)
+  {
+    ASSERT_TRUE(mQueue->pop(value));
+    ASSERT_EQ(i, value);
+  }
+  ASSERT_FALSE(mQueue->pop(value));
+}
+
+TEST_F(IasTestAvbSpscQueue, concurrent)
+{
+  ASSERT_TRUE(mQueue != NULL);
+  ASSERT_EQ(eIasAvbProcOK, mQueue->init(64u));
+
+  const uint32_t cNumValues = 1000000u;
+
+  std::thread producer([this, cNumValues]()
+  {
+    for (uint32_t i = 0u; i < cNumValues; i++)
+    {
+      while (!mQueue->push(i))
+      {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  // the values have to arrive complete and in order
+  uint32_t expected = 0u;
+  uint32_t errors = 0u;
+  uint32_t value = 0u;
+  while (expected < cNumValues)
+  {
+    if (mQueue->pop(value))
+    {
+      if (expected != value)
+      {
+        errors++;
+      }
+      expected++;
+    }
+    else
+    {
+      std::this_thread::yield();
+    }
+  }
+
+  producer.join();
+
+  ASSERT_EQ(0u, errors);
+  ASSERT_FALSE(mQueue->pop(value));
+}
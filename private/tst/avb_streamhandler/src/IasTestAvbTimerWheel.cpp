@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file IasTestAvbTimerWheel.cpp
+ * @date 2018
+ */
+
+#include "gtest/gtest.h"
+
+#define private public
+#define protected public
+#include "avb_streamhandler/IasAvbTimerWheel.hpp"
+#undef protected
+#undef private
+
+#include <map>
+#include <cstdlib>
+
+using namespace IasMediaTransportAvb;
+
+class IasTestAvbTimerWheel : public ::testing::Test
+{
+protected:
+  IasTestAvbTimerWheel() :
+    mTimerWheel(NULL)
+  {
+  }
+
+  virtual ~IasTestAvbTimerWheel() {}
+
+  // Sets up the test fixture.
+  virtual void SetUp()
+  {
+    mTimerWheel = new IasAvbTimerWheel();
+  }
+
+  virtual void TearDown()
+  {
+    delete mTimerWheel;
+    mTimerWheel = NULL;
+  }
+
+  IasAvbTimerWheel *mTimerWheel;
+  static const uint64_t cTick;
+};
+
+const uint64_t IasTestAvbTimerWheel::cTick = 1000u;
+
+
+TEST_F(IasTestAvbTimerWheel, CTor_DTor)
+{
+  ASSERT_TRUE(mTimerWheel != NULL);
+  ASSERT_EQ(0u, mTimerWheel->getSize());
+  ASSERT_EQ(0u, mTimerWheel->getNextExpiry());
+}
+
+TEST_F(IasTestAvbTimerWheel, init)
+{
+  ASSERT_TRUE(mTimerWheel != NULL);
+  ASSERT_EQ(eIasAvbProcInvalidParam, mTimerWheel->init(0u, 0u));
+  ASSERT_EQ(eIasAvbProcOK, mTimerWheel->init(cTick, 123456u));
+  ASSERT_EQ(cTick, mTimerWheel->getTick());
+
+  mTimerWheel->add(1u, 200000u);
+  ASSERT_EQ(1u, mTimerWheel->getSize());
+  ASSERT_EQ(eIasAvbProcOK, mTimerWheel->init(cTick, 123456u));
+  ASSERT_EQ(0u, mTimerWheel->getSize());
+}
+
+TEST_F(IasTestAvbTimerWheel, expiry)
+{
+  ASSERT_TRUE(mTimerWheel != NULL);
+  ASSERT_EQ(eIasAvbProcOK, mTimerWheel->init(cTick, 0u));
+
+  std::vector<uint64_t> expired;
+
+  // deadlines are rounded up to the next tick, level 0 and 1
+  mTimerWheel->add(1u, 1500u);
+  mTimerWheel->add(2u, 2000u);
+  mTimerWheel->add(3u, 100000u);
+  ASSERT_EQ(3u, mTimerWheel->getSize());
+  ASSERT_EQ(2000u, mTimerWheel->getNextExpiry());
+
+  ASSERT_EQ(0u, mTimerWheel->advance(1999u, expired));
+  ASSERT_EQ(2u, mTimerWheel->advance(2000u, expired));
+  ASSERT_EQ(2u, expired.size());
+  ASSERT_EQ(1u, mTimerWheel->getSize());
+
+  // level 0 is empty, the next wakeup is when level 1 turns
+  ASSERT_EQ(64000u, mTimerWheel->getNextExpiry());
+
+  expired.clear();
+  ASSERT_EQ(0u, mTimerWheel->advance(99999u, expired));
+  ASSERT_EQ(1u, mTimerWheel->advance(100000u, expired));
+  ASSERT_EQ(3u, expired[0]);
+  ASSERT_EQ(0u, mTimerWheel->getSize());
+
+  // past deadlines are due with the next tick
+  expired.clear();
+  mTimerWheel->add(4u, 0u);
+  ASSERT_EQ(0u, mTimerWheel->advance(100000u, expired));
+  ASSERT_EQ(1u, mTimerWheel->advance(101000u, expired));
+  ASSERT_EQ(4u, expired[0]);
+}
+
+TEST_F(IasTestAvbTimerWheel, outOfRange)
+{
+  ASSERT_TRUE(mTimerWheel != NULL);
+  ASSERT_EQ(eIasAvbProcOK, mTimerWheel->init(1u, 0u));
+
+  // beyond the range of the wheel, parked in the top level and re-inserted when it turns
+  const uint64_t range = uint64_t(1u) << (IasAvbTimerWheel::cSlotBits * IasAvbTimerWheel::cLevels);
+  const uint64_t deadline = range + 5u;
+  std::vector<uint64_t> expired;
+  mTimerWheel->add(1u, deadline);
+
+  ASSERT_EQ(0u, mTimerWheel->advance(deadline - 1u, expired));
+  ASSERT_EQ(1u, mTimerWheel->getSize());
+  ASSERT_EQ(1u, mTimerWheel->advance(deadline, expired));
+  ASSERT_EQ(0u, mTimerWheel->getSize());
+}
+
+TEST_F(IasTestAvbTimerWheel, randomized)
+{
+  ASSERT_TRUE(mTimerWheel != NULL);
+
+  srand(1u);
+  uint64_t now = 987654321u;
+  ASSERT_EQ(eIasAvbProcOK, mTimerWheel->init(cTick, now));
+
+  std::map<uint64_t, uint64_t> pending;  // key -> deadline, not before the time it was added
+  std::vector<uint64_t> expired;
+  uint64_t key = 0u;
+
+  for (uint32_t step = 0u; step < 10000u; step++)
+  {
+    for (uint32_t i = uint32_t(rand() % 4); i > 0u; i--)
+    {
+      const uint64_t deadline = now + uint64_t(rand() % int(300u * cTick));
+      mTimerWheel->add(key, deadline);
+      pending[key] = deadline;
+      key++;
+    }
+
+    now += uint64_t(rand() % int(3u * cTick));
+    expired.clear();
+    (void) mTimerWheel->advance(now, expired);
+
+    for (std::vector<uint64_t>::const_iterator it = expired.begin(); expired.end() != it; it++)
+    {
+      std::map<uint64_t, uint64_t>::iterator entry = pending.find(*it);
+      ASSERT_TRUE(pending.end() != entry);
+      ASSERT_LE(entry->second, now);
+      pending.erase(entry);
+    }
+
+    // everything due at least a tick ago must have expired
+    for (std::map<uint64_t, uint64_t>::const_iterator it = pending.begin(); pending.end() != it; it++)
+    {
+      ASSERT_GT(it->second + cTick, now);
+    }
+    ASSERT_EQ(pending.size(), mTimerWheel->getSize());
+  }
+}
@@ -0,0 +1,339 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file IasTestAvbTransmitSchedule.cpp
+ * @date 2018
+ */
+
+#include "gtest/gtest.h"
+
+#define private public
+#define protected public
+#include "avb_streamhandler/IasAvbTransmitSchedule.hpp"
+#undef protected
+#undef private
+
+#include <list>
+#include <vector>
+#include <chrono>
+#include <sstream>
+
+using namespace IasMediaTransportAvb;
+
+namespace
+{
+
+struct Entry
+{
+  uint64_t launchTime;
+  uint64_t period;
+  uint32_t id;
+
+  bool operator<(const Entry& x) const
+  {
+    return launchTime < x.launchTime;
+  }
+};
+
+typedef IasAvbTransmitSchedule<Entry> Schedule;
+typedef std::list<Entry> EntryList;
+
+// simple LCG, the test has to be reproducible
+uint32_t nextRandom(uint32_t &state)
+{
+  state = state * 1664525u + 1013904223u;
+  return state >> 8;
+}
+
+void createStreams(uint32_t numStreams, std::vector<Entry> &streams)
+{
+  uint32_t seed = 42u;
+  streams.clear();
+  for (uint32_t i = 0u; i < numStreams; i++)
+  {
+    Entry e;
+    e.id = i;
+    // class A packet rate and some slower ones, random phase
+    e.period = 125000u * (1u + (i % 4u));
+    e.launchTime = 1000000u + (nextRandom(seed) % e.period);
+    streams.push_back(e);
+  }
+}
+
+// the algorithm the transmit sequencer used before: walk back from the current stream and move it behind
+// the first stream with an earlier launch time
+void sortByLaunchTime(EntryList &sequence, EntryList::iterator &current)
+{
+  EntryList::iterator backward = current;
+  do
+  {
+    if (sequence.begin() == backward)
+    {
+      backward = sequence.end();
+    }
+    backward--;
+
+    if (current->launchTime > backward->launchTime)
+    {
+      break;
+    }
+  }
+  while (current != backward);
+
+  if (current != backward)
+  {
+    backward++;
+    if (sequence.end() == backward)
+    {
+      backward = sequence.begin();
+    }
+
+    if (current != backward)
+    {
+      (void) sequence.insert(backward, *current);
+      current = sequence.erase(current);
+    }
+    else
+    {
+      current++;
+    }
+    if (sequence.end() == current)
+    {
+      current = sequence.begin();
+    }
+  }
+}
+
+} // namespace
+
+
+class IasTestAvbTransmitSchedule : public ::testing::Test
+{
+protected:
+  IasTestAvbTransmitSchedule() :
+    mSchedule(NULL)
+  {
+  }
+
+  virtual ~IasTestAvbTransmitSchedule() {}
+
+  // Sets up the test fixture.
+  virtual void SetUp()
+  {
+    mSchedule = new Schedule();
+  }
+
+  virtual void TearDown()
+  {
+    delete mSchedule;
+    mSchedule = NULL;
+  }
+
+  Schedule *mSchedule;
+};
+
+
+TEST_F(IasTestAvbTransmitSchedule, CTor_DTor)
+{
+  ASSERT_TRUE(mSchedule != NULL);
+  ASSERT_EQ(0u, mSchedule->getCapacity());
+  ASSERT_EQ(0u, mSchedule->size());
+  ASSERT_EQ(0u, mSchedule->getPending());
+}
+
+TEST_F(IasTestAvbTransmitSchedule, init)
+{
+  ASSERT_TRUE(mSchedule != NULL);
+  ASSERT_EQ(eIasAvbProcInvalidParam, mSchedule->init(0u));
+  ASSERT_EQ(eIasAvbProcOK, mSchedule->init(2u));
+  ASSERT_EQ(2u, mSchedule->getCapacity());
+
+  Entry e = Entry();
+  ASSERT_TRUE(mSchedule->add(e));
+  ASSERT_TRUE(mSchedule->add(e));
+  ASSERT_FALSE(mSchedule->add(e));
+  ASSERT_EQ(2u, mSchedule->size());
+  ASSERT_EQ(0u, mSchedule->getPending());
+
+  // init again drops all entries
+  ASSERT_EQ(eIasAvbProcOK, mSchedule->init(4u));
+  ASSERT_EQ(0u, mSchedule->size());
+
+  mSchedule->cleanup();
+  ASSERT_EQ(0u, mSchedule->getCapacity());
+  ASSERT_FALSE(mSchedule->add(e));
+}
+
+TEST_F(IasTestAvbTransmitSchedule, order)
+{
+  ASSERT_TRUE(mSchedule != NULL);
+  const uint32_t numStreams = 100u;
+  ASSERT_EQ(eIasAvbProcOK, mSchedule->init(numStreams));
+
+  uint32_t seed = 1u;
+  for (uint32_t i = 0u; i < numStreams; i++)
+  {
+    Entry e;
+    e.id = i;
+    e.period = 0u;
+    e.launchTime = nextRandom(seed) % 1000u;
+    ASSERT_TRUE(mSchedule->add(e));
+  }
+
+  for (uint32_t round = 0u; round < 2u; round++)
+  {
+    mSchedule->rearm();
+    ASSERT_EQ(numStreams, mSchedule->getPending());
+
+    uint64_t last = 0u;
+    for (uint32_t i = 0u; i < numStreams; i++)
+    {
+      ASSERT_LE(last, mSchedule->top().launchTime);
+      last = mSchedule->top().launchTime;
+      mSchedule->pop();
+    }
+    ASSERT_EQ(0u, mSchedule->getPending());
+    ASSERT_EQ(numStreams, mSchedule->size());
+  }
+}
+
+TEST_F(IasTestAvbTransmitSchedule, update)
+{
+  ASSERT_TRUE(mSchedule != NULL);
+  std::vector<Entry> streams;
+  createStreams(16u, streams);
+  ASSERT_EQ(eIasAvbProcOK, mSchedule->init(uint32_t(streams.size())));
+  for (std::vector<Entry>::iterator it = streams.begin(); it != streams.end(); ++it)
+  {
+    ASSERT_TRUE(mSchedule->add(*it));
+  }
+  mSchedule->rearm();
+
+  // the packets come out in launch time order
+  uint64_t last = 0u;
+  for (uint32_t i = 0u; i < 10000u; i++)
+  {
+    Entry &e = mSchedule->top();
+    ASSERT_LE(last, e.launchTime);
+    last = e.launchTime;
+    e.launchTime += e.period;
+    (void) mSchedule->update();
+  }
+
+  // update of the only pending entry
+  for (uint32_t i = 1u; i < streams.size(); i++)
+  {
+    mSchedule->pop();
+  }
+  ASSERT_EQ(1u, mSchedule->getPending());
+  mSchedule->top().launchTime += 1000000u;
+  ASSERT_FALSE(mSchedule->update());
+}
+
+TEST_F(IasTestAvbTransmitSchedule, erase)
+{
+  ASSERT_TRUE(mSchedule != NULL);
+  std::vector<Entry> streams;
+  createStreams(8u, streams);
+  ASSERT_EQ(eIasAvbProcOK, mSchedule->init(uint32_t(streams.size())));
+  for (std::vector<Entry>::iterator it = streams.begin(); it != streams.end(); ++it)
+  {
+    ASSERT_TRUE(mSchedule->add(*it));
+  }
+  mSchedule->rearm();
+  mSchedule->pop();
+
+  // erase the odd ones while iterating downwards
+  for (uint32_t i = mSchedule->size(); i > 0u; i--)
+  {
+    if (0u != ((*mSchedule)[i - 1u].id & 1u))
+    {
+      mSchedule->erase(i - 1u);
+    }
+  }
+  ASSERT_EQ(4u, mSchedule->size());
+  ASSERT_EQ(0u, mSchedule->getPending());
+  for (uint32_t i = 0u; i < mSchedule->size(); i++)
+  {
+    ASSERT_EQ(0u, (*mSchedule)[i].id & 1u);
+  }
+
+  mSchedule->rearm();
+  ASSERT_EQ(4u, mSchedule->getPending());
+  ASSERT_TRUE(mSchedule->add(streams[1]));
+  ASSERT_EQ(0u, mSchedule->getPending());
+
+  mSchedule->clear();
+  ASSERT_EQ(0u, mSchedule->size());
+}
+
+TEST_F(IasTestAvbTransmitSchedule, benchmark)
+{
+  // compares the list based sequencing previously used by the transmit sequencer with the schedule
+  const uint32_t cNumPackets = 200000u;
+  const uint32_t cNumStreams[] = { 8u, 64u, 256u };
+
+  for (uint32_t n = 0u; n < (sizeof cNumStreams / sizeof cNumStreams[0]); n++)
+  {
+    std::vector<Entry> streams;
+    createStreams(cNumStreams[n], streams);
+
+    // list
+    EntryList sequence(streams.begin(), streams.end());
+    sequence.sort();
+    EntryList::iterator current = sequence.begin();
+    uint32_t listViolations = 0u;
+    uint64_t last = 0u;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0u; i < cNumPackets; i++)
+    {
+      if (current->launchTime < last)
+      {
+        listViolations++;
+      }
+      last = current->launchTime;
+      current->launchTime += current->period;
+      sortByLaunchTime(sequence, current);
+    }
+    const int64_t listNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    // schedule
+    Schedule schedule;
+    ASSERT_EQ(eIasAvbProcOK, schedule.init(cNumStreams[n]));
+    for (std::vector<Entry>::iterator it = streams.begin(); it != streams.end(); ++it)
+    {
+      ASSERT_TRUE(schedule.add(*it));
+    }
+    schedule.rearm();
+    uint32_t heapViolations = 0u;
+    last = 0u;
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0u; i < cNumPackets; i++)
+    {
+      Entry &e = schedule.top();
+      if (e.launchTime < last)
+      {
+        heapViolations++;
+      }
+      last = e.launchTime;
+      e.launchTime += e.period;
+      (void) schedule.update();
+    }
+    const int64_t heapNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    std::stringstream list;
+    list << "listPsPerPacket" << cNumStreams[n];
+    RecordProperty(list.str(), int(listNs * 1000 / int64_t(cNumPackets)));
+    std::stringstream order;
+    order << "listOutOfOrder" << cNumStreams[n];
+    RecordProperty(order.str(), int(listViolations));
+    std::stringstream heap;
+    heap << "heapPsPerPacket" << cNumStreams[n];
+    RecordProperty(heap.str(), int(heapNs * 1000 / int64_t(cNumPackets)));
+
+    ASSERT_EQ(0u, heapViolations);
+  }
+}
@@ -18,6 +18,7 @@
 #include "avb_streamhandler/IasAvbTransmitEngine.hpp"
 #include "lib_ptp_daemon/IasLibPtpDaemon.hpp"
 #include "avb_streamhandler/IasAvbPacket.hpp"
+#include "avb_streamhandler/IasAvbPacketPool.hpp"
 #include "avb_streamhandler/IasAvbStreamHandlerEventInterface.hpp"
 #undef protected
 #undef private
@@ -59,6 +60,52 @@ private:
     }
 };
 
+// accepts or rejects packets as scripted, returns accepted packets to their pool right away
+class FakeTransmitBackend : public IasAvbTransmitBackend
+{
+public:
+    FakeTransmitBackend() : results(), accepted(0u) {}
+    virtual ~FakeTransmitBackend() {}
+
+    virtual IasAvbProcessingResult init(uint32_t queueIndex, IasAvbSrClass qavClass)
+    {
+        (void) queueIndex;
+        (void) qavClass;
+        return eIasAvbProcOK;
+    }
+    virtual void cleanup() {}
+    virtual int32_t xmit(IasAvbPacket *packet)
+    {
+        int32_t result = 0;
+        if (!results.empty())
+        {
+            result = results.front();
+            results.erase(results.begin());
+        }
+        if (0 == result)
+        {
+            (void) IasAvbPacketPool::returnPacket(packet);
+            accepted++;
+        }
+        return result;
+    }
+    virtual uint32_t reclaimPackets() { return 0u; }
+    virtual uint32_t getTxTimestamps(TxTimestamp *txStamps, uint32_t max)
+    {
+        uint32_t count = 0u;
+        while ((count < max) && !stamps.empty())
+        {
+            txStamps[count++] = stamps.front();
+            stamps.erase(stamps.begin());
+        }
+        return count;
+    }
+
+    std::vector<int32_t> results;
+    uint32_t accepted;
+    std::vector<TxTimestamp> stamps;
+};
+
 class IasTestAvbTransmitSequencer : public ::testing::Test
 {
 protected:
@@ -252,6 +299,28 @@ TEST_F(IasTestAvbTransmitSequencer, initWindowWidthPitch)
   ASSERT_EQ(eIasAvbProcInitializationFailed, result);
 }
 
+TEST_F(IasTestAvbTransmitSequencer, initWindowAuto)
+{
+  ASSERT_TRUE(NULL != mEnvironment);
+  ASSERT_TRUE(NULL != mSequencer);
+
+  mEnvironment->setConfigValue(IasRegKeys::cXmitWndWidth, 3000000u);
+  mEnvironment->setConfigValue(IasRegKeys::cXmitWndPitch, 2000000u);
+  mEnvironment->setConfigValue(IasRegKeys::cXmitWndAuto, 1u);
+
+  // max width below the initial width
+  mEnvironment->setConfigValue(IasRegKeys::cXmitWndWidthMax, 2000000u);
+  ASSERT_EQ(eIasAvbProcInitializationFailed, mSequencer->init(0u, IasAvbSrClass::eIasAvbSrClassHigh, false));
+
+  mEnvironment->setConfigValue(IasRegKeys::cXmitWndWidthMax, 5000000u);
+  mEnvironment->setConfigValue(IasRegKeys::cXmitWndPitchMax, 2500000u);
+  ASSERT_EQ(eIasAvbProcOK, mSequencer->init(0u, IasAvbSrClass::eIasAvbSrClassHigh, false));
+  ASSERT_EQ(5000000u, mSequencer->mWindowTuner.mConfig.widthMax);
+  ASSERT_EQ(2500000u, mSequencer->mWindowTuner.mConfig.pitchMax);
+  ASSERT_EQ(3000000u, mSequencer->mWindowTuner.getWidth());
+  ASSERT_EQ(2000000u, mSequencer->mWindowTuner.getPitch());
+}
+
 TEST_F(IasTestAvbTransmitSequencer, initWindowPitch)
 {
   ASSERT_TRUE(NULL != mEnvironment);
@@ -475,23 +544,22 @@ TEST_F(IasTestAvbTransmitSequencer, serviceStream)
   IasAvbTransmitSequencer * sequencer = mTransmitEngine->getSequencerByStream(mTransmitEngine->mAvbStreams[streamID]);
   ASSERT_TRUE(NULL != sequencer);
   {
-    sequencer->mLock.lock();
-    sequencer->mRequestCount++;
-    sequencer->mLock.unlock();
-    IasAvbTransmitSequencer::AvbStreamDataList::iterator nextStreamToService = sequencer->mSequence.end();
-    sequencer->updateSequence(nextStreamToService);
+    sequencer->updateSequence();
     sleep(1);
 
     IasLibPtpDaemon * ptp = IasAvbStreamHandlerEnvironment::getPtpProxy();
     uint64_t now = ptp->getLocalTime();
 
-    IasAvbTransmitSequencer::AvbStreamDataList::iterator nextStream = sequencer->mSequence.begin();
+    IasAvbTransmitSequencer::StreamData * nextStream = &sequencer->mSequence.top();
     (*nextStream).done = IasAvbTransmitSequencer::DoneState::eTxError;
     (*nextStream).packet = NULL;
 
     IasAvbStream *stream = nextStream->stream;
     (*nextStream).stream = NULL;
-    ASSERT_EQ(IasAvbTransmitSequencer::DoneState::eTxError, sequencer->serviceStream(now, nextStream));
+    ASSERT_EQ(IasAvbTransmitSequencer::DoneState::eTxError, sequencer->serviceStream(now));
+    // the stream is done for this window and has been parked
+    ASSERT_EQ(0u, sequencer->mSequence.getPending());
+    sequencer->mSequence.rearm();
     nextStream->stream = stream;
 
     (*nextStream).done = IasAvbTransmitSequencer::DoneState::eNotDone;
@@ -500,7 +568,7 @@ TEST_F(IasTestAvbTransmitSequencer, serviceStream)
     now = ptp->getLocalTime();
     (*nextStream).packet->attime = now + sequencer->mConfig.txWindowWidth + 1u;
     (*nextStream).launchTime = now;
-    ASSERT_EQ(IasAvbTransmitSequencer::DoneState::eEndOfWindow, sequencer->serviceStream(now, nextStream));
+    ASSERT_EQ(IasAvbTransmitSequencer::DoneState::eEndOfWindow, sequencer->serviceStream(now));
 
     now = ptp->getLocalTime();
     (*nextStream).packet->attime = now;
@@ -526,17 +594,13 @@ TEST_F(IasTestAvbTransmitSequencer, serviceStreamDummyPacket)
   IasAvbTransmitSequencer * sequencer = mTransmitEngine->getSequencerByStream(mTransmitEngine->mAvbStreams[streamID]);
   ASSERT_TRUE(NULL != sequencer);
   {
-    sequencer->mLock.lock();
-    sequencer->mRequestCount++;
-    sequencer->mLock.unlock();
-    IasAvbTransmitSequencer::AvbStreamDataList::iterator nextStreamToService = sequencer->mSequence.end();
-    sequencer->updateSequence(nextStreamToService);
+    sequencer->updateSequence();
     sleep(1);
 
     IasLibPtpDaemon * ptp = IasAvbStreamHandlerEnvironment::getPtpProxy();
     uint64_t now = ptp->getLocalTime();
 
-    IasAvbTransmitSequencer::AvbStreamDataList::iterator nextStream = sequencer->mSequence.begin();
+    IasAvbTransmitSequencer::StreamData * nextStream = &sequencer->mSequence.top();
 
     (*nextStream).done = IasAvbTransmitSequencer::DoneState::eNotDone;
     IasAvbPacket *packet = new IasAvbPacket();
@@ -545,7 +609,7 @@ TEST_F(IasTestAvbTransmitSequencer, serviceStreamDummyPacket)
     now = ptp->getLocalTime();
     (*nextStream).packet->attime = now + sequencer->mConfig.txWindowWidth;
     (*nextStream).launchTime = now;
-    ASSERT_EQ(IasAvbTransmitSequencer::DoneState::eNotDone, sequencer->serviceStream(now, nextStream));
+    ASSERT_EQ(IasAvbTransmitSequencer::DoneState::eNotDone, sequencer->serviceStream(now));
     delete packet;
     (*nextStream).packet = nullptr;
   }
@@ -567,17 +631,13 @@ TEST_F(IasTestAvbTransmitSequencer, serviceStreamSendPacket)
   IasAvbTransmitSequencer * sequencer = mTransmitEngine->getSequencerByStream(mTransmitEngine->mAvbStreams[streamID]);
   ASSERT_TRUE(NULL != sequencer);
   {
-    sequencer->mLock.lock();
-    sequencer->mRequestCount++;
-    sequencer->mLock.unlock();
-    IasAvbTransmitSequencer::AvbStreamDataList::iterator nextStreamToService = sequencer->mSequence.end();
-    sequencer->updateSequence(nextStreamToService);
+    sequencer->updateSequence();
     sleep(1);
 
     IasLibPtpDaemon * ptp = IasAvbStreamHandlerEnvironment::getPtpProxy();
     uint64_t now = ptp->getLocalTime();
 
-    IasAvbTransmitSequencer::AvbStreamDataList::iterator nextStream = sequencer->mSequence.begin();
+    IasAvbTransmitSequencer::StreamData * nextStream = &sequencer->mSequence.top();
 
     now = ptp->getLocalTime();
     (*nextStream).done = IasAvbTransmitSequencer::DoneState::eNotDone;
@@ -587,7 +647,7 @@ TEST_F(IasTestAvbTransmitSequencer, serviceStreamSendPacket)
     (*nextStream).packet->attime = now + sequencer->mConfig.txWindowWidth;
     (*nextStream).launchTime = now;
     sequencer->mDiag.debugLastLaunchTime = (*nextStream).packet->attime;
-    ASSERT_EQ(IasAvbTransmitSequencer::DoneState::eNotDone, sequencer->serviceStream(now, nextStream));
+    ASSERT_EQ(IasAvbTransmitSequencer::DoneState::eNotDone, sequencer->serviceStream(now));
     delete packet;
     (*nextStream).packet = nullptr;
   }
@@ -647,17 +707,13 @@ TEST_F(IasTestAvbTransmitSequencer, serviceStreamEINVAL)
   IasAvbTransmitSequencer * sequencer = mTransmitEngine->getSequencerByStream(mTransmitEngine->mAvbStreams[streamID]);
   ASSERT_TRUE(NULL != sequencer);
   {
-    sequencer->mLock.lock();
-    sequencer->mRequestCount++;
-    sequencer->mLock.unlock();
-    IasAvbTransmitSequencer::AvbStreamDataList::iterator nextStreamToService = sequencer->mSequence.end();
-    sequencer->updateSequence(nextStreamToService);
+    sequencer->updateSequence();
     sleep(1);
 
     IasLibPtpDaemon * ptp = IasAvbStreamHandlerEnvironment::getPtpProxy();
     uint64_t now = ptp->getLocalTime();
 
-    IasAvbTransmitSequencer::AvbStreamDataList::iterator nextStream = sequencer->mSequence.begin();
+    IasAvbTransmitSequencer::StreamData * nextStream = &sequencer->mSequence.top();
 
     now = ptp->getLocalTime();
     (*nextStream).done = IasAvbTransmitSequencer::DoneState::eNotDone;
@@ -668,10 +724,15 @@ TEST_F(IasTestAvbTransmitSequencer, serviceStreamEINVAL)
     sequencer->mDiag.debugLastLaunchTime = (*nextStream).packet->attime;
     _device_t * tempDev = sequencer->mIgbDevice;
     sequencer->mIgbDevice = nullptr;
-    ASSERT_EQ(IasAvbTransmitSequencer::DoneState::eTxError, sequencer->serviceStream(now, nextStream));
+    IasAvbPacket * const packet = (*nextStream).packet;
+    const uint32_t dropped = sequencer->mDiag.dropped;
+    ASSERT_EQ(IasAvbTransmitSequencer::DoneState::eTxError, sequencer->serviceStream(now));
     sequencer->mIgbDevice = tempDev;
+    // the packet has been disposed of and must not be sent again
+    ASSERT_TRUE(NULL == (*nextStream).packet);
+    ASSERT_EQ(dropped + 1u, sequencer->mDiag.dropped);
 
-    delete (*nextStream).packet;
+    delete packet;
   }
 }
 
@@ -691,17 +752,13 @@ TEST_F(IasTestAvbTransmitSequencer, serviceStreamENXIO)
   IasAvbTransmitSequencer * sequencer = mTransmitEngine->getSequencerByStream(mTransmitEngine->mAvbStreams[streamID]);
   ASSERT_TRUE(NULL != sequencer);
   {
-    sequencer->mLock.lock();
-    sequencer->mRequestCount++;
-    sequencer->mLock.unlock();
-    IasAvbTransmitSequencer::AvbStreamDataList::iterator nextStreamToService = sequencer->mSequence.end();
-    sequencer->updateSequence(nextStreamToService);
+    sequencer->updateSequence();
     sleep(1);
 
     IasLibPtpDaemon * ptp = IasAvbStreamHandlerEnvironment::getPtpProxy();
     uint64_t now = ptp->getLocalTime();
 
-    IasAvbTransmitSequencer::AvbStreamDataList::iterator nextStream = sequencer->mSequence.begin();
+    IasAvbTransmitSequencer::StreamData * nextStream = &sequencer->mSequence.top();
 
     now = ptp->getLocalTime();
     (*nextStream).done = IasAvbTransmitSequencer::DoneState::eNotDone;
@@ -712,10 +769,14 @@ TEST_F(IasTestAvbTransmitSequencer, serviceStreamENXIO)
     sequencer->mDiag.debugLastLaunchTime = (*nextStream).packet->attime;
     void * tempPrivData = sequencer->mIgbDevice->private_data;
     sequencer->mIgbDevice->private_data = nullptr;
-    ASSERT_EQ(IasAvbTransmitSequencer::DoneState::eTxError, sequencer->serviceStream(now, nextStream));
+    IasAvbPacket * const packet = (*nextStream).packet;
+    const uint32_t dropped = sequencer->mDiag.dropped;
+    ASSERT_EQ(IasAvbTransmitSequencer::DoneState::eTxError, sequencer->serviceStream(now));
     sequencer->mIgbDevice->private_data = tempPrivData;
+    ASSERT_TRUE(NULL == (*nextStream).packet);
+    ASSERT_EQ(dropped + 1u, sequencer->mDiag.dropped);
 
-    delete (*nextStream).packet;
+    delete packet;
   }
 }
 
@@ -776,6 +837,12 @@ TEST_F(IasTestAvbTransmitSequencer, addStreamToTransmitList)
   ASSERT_EQ(eIasAvbProcNotInitialized, sequencer->addStreamToTransmitList(stream));
 
   sequencer->mTransmitThread = seqTransmitThread;
+  // mActiveStreams.size() >= mSequence.getCapacity() (T)
+  ASSERT_EQ(eIasAvbProcOK, sequencer->mSequence.init(1u));
+  sequencer->mActiveStreams[nullStream] = IasAvbTransmitSequencer::StreamData();
+  ASSERT_EQ(eIasAvbProcNoSpaceLeft, sequencer->addStreamToTransmitList(stream));
+  (void) sequencer->mActiveStreams.erase(nullStream);
+
   sequencer->mCurrentBandwidth = sequencer->mConfig.txMaxBandwidth;
   // newTotal > mConfig.txMaxBandwidth (T)
   ASSERT_EQ(eIasAvbProcNoSpaceLeft, sequencer->addStreamToTransmitList(stream));
@@ -809,7 +876,7 @@ TEST_F(IasTestAvbTransmitSequencer, removeStreamFromTransmitList)
   ASSERT_EQ(eIasAvbProcNotInitialized, sequencer->removeStreamFromTransmitList(stream));
 }
 
-TEST_F(IasTestAvbTransmitSequencer, sortByLaunchTime)
+TEST_F(IasTestAvbTransmitSequencer, launchTimeOrder)
 {
   ASSERT_TRUE(LocalSetup());
 
@@ -826,38 +893,197 @@ TEST_F(IasTestAvbTransmitSequencer, sortByLaunchTime)
   ASSERT_EQ(eIasAvbProcOK, mTransmitEngine->activateAvbStream(secondStreamID));
   ASSERT_EQ(eIasAvbProcOK, mTransmitEngine->activateAvbStream(firstStreamID));
 
-  ASSERT_EQ(eIasAvbProcOK, mTransmitEngine->start());
-  sleep(1);
-
   IasAvbTransmitSequencer * sequencer = mTransmitEngine->getSequencerByStream(mTransmitEngine->mAvbStreams[firstStreamID]);
 
   ASSERT_TRUE(NULL != sequencer);
-  // let worker thread block to avoid interference with the test code below
-  // use a mutex guard to ensure thread is unblocked even if anything goes wrong
+  // the worker thread is not started, so the test code acts as the TX thread
   {
-    std::lock_guard<std::mutex> autoLock(sequencer->mLock);
-    sequencer->mRequestCount++;
-    sleep(1);
+    sequencer->updateSequence();
+
+    IasAvbTransmitSequencer::AvbStreamDataSchedule & sequence = sequencer->mSequence;
+    ASSERT_EQ(3u, sequence.size());
+    IasAvbTransmitSequencer::StreamData saved[3];
+    for (uint32_t i = 0u; i < 3u; i++)
+    {
+      saved[i] = sequence[i];
+    }
 
-    IasAvbTransmitSequencer::AvbStreamDataList::iterator lastStream = std::prev(sequencer->mSequence.end());
-    IasAvbTransmitSequencer::AvbStreamDataList::iterator middleStream = std::prev(lastStream);
-    IasAvbTransmitSequencer::AvbStreamDataList::iterator firstStream = sequencer->mSequence.begin();
     IasLibPtpDaemon * ptp = IasAvbStreamHandlerEnvironment::getPtpProxy();
     uint64_t customLaunchTime = ptp->getLocalTime();
-    (*firstStream).launchTime = customLaunchTime;
-    (*middleStream).launchTime = customLaunchTime + 2u;
-    (*lastStream).launchTime = customLaunchTime + 1u;
+    sequence[0].launchTime = customLaunchTime + 2u;
+    sequence[1].launchTime = customLaunchTime;
+    sequence[2].launchTime = customLaunchTime + 1u;
+    IasAvbStream * const latest = sequence[0].stream;
+    IasAvbStream * const earliest = sequence[1].stream;
+    IasAvbStream * const middle = sequence[2].stream;
+    sequence.rearm();
+    ASSERT_EQ(3u, sequence.getPending());
+    ASSERT_EQ(earliest, sequence.top().stream);
+
+    // a later launch time moves the stream back
+    sequence.top().launchTime = customLaunchTime + 3u;
+    ASSERT_TRUE(sequence.update());
+    ASSERT_EQ(middle, sequence.top().stream);
+    ASSERT_FALSE(sequence.update());
+
+    // a stream done for the window is parked
+    sequence.pop();
+    ASSERT_EQ(2u, sequence.getPending());
+    ASSERT_EQ(latest, sequence.top().stream);
+    sequence.pop();
+    ASSERT_EQ(earliest, sequence.top().stream);
+
+    for (uint32_t i = 0u; i < 3u; i++)
+    {
+      sequence[i] = saved[i];
+    }
+    sequence.rearm();
+  }
+}
+
+TEST_F(IasTestAvbTransmitSequencer, commandQueue)
+{
+  ASSERT_TRUE(LocalSetup());
+
+  IasAvbPtpClockDomain clockdomain;
+  IasAvbStreamId firstStreamID((uint64_t)0u), secondStreamID((uint64_t)1u);
 
-    sequencer->sortByLaunchTime(lastStream);
+  ASSERT_EQ(eIasAvbProcOK, mTransmitEngine->init());
+
+  ASSERT_EQ(eIasAvbProcOK, createProperAudioStream(&clockdomain, firstStreamID));
+  ASSERT_EQ(eIasAvbProcOK, createProperAudioStream(&clockdomain, secondStreamID));
+  IasAvbStream * first = mTransmitEngine->mAvbStreams[firstStreamID];
+  IasAvbStream * second = mTransmitEngine->mAvbStreams[secondStreamID];
+
+  IasAvbTransmitSequencer * sequencer = mTransmitEngine->getSequencerByStream(first);
+  ASSERT_TRUE(NULL != sequencer);
+  ASSERT_LE(2u * sequencer->mConfig.txMaxStreams + 1u, uint64_t(sequencer->mCommands.getCapacity()));
+
+  // while the worker thread is stopped, each change rebuilds the queue: reset + add per active stream
+  ASSERT_EQ(eIasAvbProcOK, mTransmitEngine->activateAvbStream(firstStreamID));
+  ASSERT_EQ(eIasAvbProcOK, mTransmitEngine->activateAvbStream(secondStreamID));
+  ASSERT_EQ(3u, sequencer->mCommands.size());
+  ASSERT_EQ(2u, sequencer->mActiveStreams.size());
+
+  sequencer->updateSequence();
+  ASSERT_EQ(0u, sequencer->mCommands.size());
+  ASSERT_EQ(sequencer->mCommandCount, sequencer->mCommandsDone.load());
+  ASSERT_EQ(2u, sequencer->mSequence.size());
+
+  // commands are applied in order
+  {
+    std::lock_guard<std::mutex> lock(sequencer->mLock);
+    ASSERT_TRUE(sequencer->pushCommand(IasAvbTransmitSequencer::eCmdRemove, sequencer->mActiveStreams[first]));
+    ASSERT_TRUE(sequencer->pushCommand(IasAvbTransmitSequencer::eCmdAdd, sequencer->mActiveStreams[first]));
+    ASSERT_TRUE(sequencer->pushCommand(IasAvbTransmitSequencer::eCmdRemove, sequencer->mActiveStreams[second]));
+  }
+  sequencer->updateSequence();
+  ASSERT_EQ(sequencer->mCommandCount, sequencer->mCommandsDone.load());
+  ASSERT_EQ(1u, sequencer->mSequence.size());
+  ASSERT_EQ(first, sequencer->mSequence[0].stream);
+
+  // a reset clears the sequence
+  {
+    std::lock_guard<std::mutex> lock(sequencer->mLock);
+    ASSERT_TRUE(sequencer->pushCommand(IasAvbTransmitSequencer::eCmdReset, IasAvbTransmitSequencer::StreamData()));
+  }
+  sequencer->updateSequence();
+  ASSERT_EQ(0u, sequencer->mSequence.size());
+
+  // removal while the worker thread is stopped does not wait for it
+  ASSERT_EQ(eIasAvbProcOK, mTransmitEngine->deactivateAvbStream(secondStreamID));
+  ASSERT_EQ(1u, sequencer->mActiveStreams.size());
+  sequencer->updateSequence();
+  ASSERT_EQ(1u, sequencer->mSequence.size());
+  ASSERT_EQ(first, sequencer->mSequence[0].stream);
+}
+
+TEST_F(IasTestAvbTransmitSequencer, flushBatch)
+{
+  ASSERT_TRUE(NULL != mSequencer);
+  mEnvironment->setDefaultConfigValues();
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cXmitBackend, "socket"));
+
+  // without igb device the pool uses heap pages
+  IasAvbPacketPool pool(mDltContext);
+  ASSERT_EQ(eIasAvbProcOK, pool.init(128u, 8u));
+
+  FakeTransmitBackend * backend = new FakeTransmitBackend();
+  mSequencer->mBackend = backend;
+
+  // the second packet is accepted on the second attempt, the third one is dropped
+  backend->results.push_back(0);
+  backend->results.push_back(-EAGAIN);
+  backend->results.push_back(0);
+  backend->results.push_back(-EINVAL);
+  for (uint32_t i = 0u; i < 4u; i++)
+  {
+    mSequencer->mBatch.push_back(pool.getPacket());
+  }
+  mSequencer->flushBatch();
+  ASSERT_TRUE(mSequencer->mBatch.empty());
+  ASSERT_EQ(3u, backend->accepted);
+  // only the accepted packets count as sent
+  ASSERT_EQ(3u, mSequencer->mDiag.sent);
+  ASSERT_EQ(1u, mSequencer->mDiag.dropped);
+  ASSERT_EQ(8u, pool.mFreeBufferStack.size());
+
+  // packets are dropped if the backend does not make progress
+  for (uint32_t i = 0u; i <= IasAvbTransmitSequencer::cBatchMaxRetries; i++)
+  {
+    backend->results.push_back(-EAGAIN);
+  }
+  mSequencer->mBatch.push_back(pool.getPacket());
+  mSequencer->mBatch.push_back(pool.getPacket());
+  mSequencer->flushBatch();
+  ASSERT_TRUE(mSequencer->mBatch.empty());
+  ASSERT_EQ(3u, backend->accepted);
+  ASSERT_EQ(3u, mSequencer->mDiag.sent);
+  ASSERT_EQ(3u, mSequencer->mDiag.dropped);
+  ASSERT_EQ(8u, pool.mFreeBufferStack.size());
+}
+
+TEST_F(IasTestAvbTransmitSequencer, initPrerender)
+{
+  ASSERT_TRUE(NULL != mEnvironment);
+  ASSERT_TRUE(NULL != mSequencer);
+
+  // lead time shorter than the TX window
+  mEnvironment->setConfigValue(IasRegKeys::cXmitPrerenderWorkers, 2u);
+  mEnvironment->setConfigValue(IasRegKeys::cXmitPrerenderLead, IasAvbTransmitSequencer::cMinTxWindowWidth - 1u);
+  ASSERT_EQ(eIasAvbProcInitializationFailed, mSequencer->init(0u, IasAvbSrClass::eIasAvbSrClassHigh, false));
+  ASSERT_TRUE(mSequencer->mPrerenderers.empty());
 
-    (*firstStream).launchTime = 0u;
+  mEnvironment->setConfigValue(IasRegKeys::cXmitPrerenderWorkers, IasAvbTransmitSequencer::cMaxPrerenderWorkers + 1u);
+  mEnvironment->setConfigValue(IasRegKeys::cXmitPrerenderLead, 5000000u);
+  ASSERT_EQ(eIasAvbProcInitializationFailed, mSequencer->init(0u, IasAvbSrClass::eIasAvbSrClassHigh, false));
 
-    sequencer->sortByLaunchTime(lastStream);
+  mEnvironment->setConfigValue(IasRegKeys::cXmitPrerenderWorkers, 2u);
+  ASSERT_EQ(eIasAvbProcOK, mSequencer->init(0u, IasAvbSrClass::eIasAvbSrClassHigh, false));
+  ASSERT_EQ(2u, mSequencer->mPrerenderers.size());
+
+  // streams are spread over the workers
+  IasAvbTransmitSequencer::StreamData data[3];
+  for (uint32_t i = 0u; i < 3u; i++)
+  {
+    data[i].stream = reinterpret_cast<IasAvbStream*>(0x1000);
+    data[i].prerenderer = NULL;
+    data[i].slot = NULL;
+    mSequencer->attachPrerenderer(data[i]);
+    ASSERT_TRUE(NULL != data[i].slot);
+  }
+  ASSERT_NE(data[0].prerenderer, data[1].prerenderer);
+  ASSERT_EQ(3u, data[0].prerenderer->getNumSlots() + data[1].prerenderer->getNumSlots());
 
-    (*firstStream).launchTime = customLaunchTime;
+  for (uint32_t i = 0u; i < 3u; i++)
+  {
+    mSequencer->detachPrerenderer(data[i]);
+    ASSERT_TRUE(NULL == data[i].slot);
+    ASSERT_TRUE(NULL == data[i].prerenderer);
   }
 
-  mTransmitEngine->stop();
+  mSequencer->cleanup();
+  ASSERT_TRUE(mSequencer->mPrerenderers.empty());
 }
 
 TEST_F(IasTestAvbTransmitSequencer, reclaimPackets)
@@ -877,6 +1103,77 @@ TEST_F(IasTestAvbTransmitSequencer, reclaimPackets)
   ASSERT_EQ(0u, sequencer->reclaimPackets());
 }
 
+TEST_F(IasTestAvbTransmitSequencer, txTimestamps)
+{
+  ASSERT_TRUE(LocalSetup());
+  IasAvbPtpClockDomain clockdomain;
+  IasAvbStreamId streamID((uint64_t)0);
+
+  ASSERT_EQ(eIasAvbProcOK, mTransmitEngine->init());
+  ASSERT_EQ(eIasAvbProcOK, createProperAudioStream(&clockdomain, streamID));
+
+  IasAvbStream * stream = mTransmitEngine->mAvbStreams[streamID];
+  IasAvbTransmitSequencer * sequencer = mTransmitEngine->getSequencerByStream(stream);
+  ASSERT_TRUE(NULL != sequencer);
+  const IasAvbSrClass srClass = stream->getTSpec().getClass();
+
+  FakeTransmitBackend * backend = new FakeTransmitBackend();
+  sequencer->mBackend = backend;
+  IasAvbTransmitSequencer::TxRecord record;
+  record.stream = NULL;
+  record.attime = 0u;
+  record.id = 0u;
+  sequencer->mTxRecords.assign(IasAvbTransmitSequencer::cTxRecords, record);
+
+  // the packets are attributed to the stream owning their pool
+  IasAvbPacket * packet = stream->mPacketPool->getPacket();
+  ASSERT_TRUE(NULL != packet);
+  packet->attime = 1000u;
+  sequencer->recordTx(packet);
+  packet->attime = 2000u;
+  sequencer->recordTx(packet);
+  ASSERT_EQ(2u, sequencer->mTxRecordCount);
+  ASSERT_EQ(stream, sequencer->mTxRecords[0].stream);
+
+  // time stamps may come out of order, unknown ids are ignored
+  IasAvbTransmitBackend::TxTimestamp stamp;
+  stamp.id = 1u;
+  stamp.time = 2500u;
+  backend->stamps.push_back(stamp);
+  stamp.id = 0u;
+  stamp.time = 900u;
+  backend->stamps.push_back(stamp);
+  stamp.id = 7u;
+  stamp.time = 0u;
+  backend->stamps.push_back(stamp);
+  sequencer->processTxTimestamps();
+  ASSERT_TRUE(backend->stamps.empty());
+  ASSERT_EQ(2u, stream->getLaunchLateness().getCount());
+  ASSERT_EQ(-100, stream->getLaunchLateness().getMin());
+  ASSERT_EQ(500, stream->getLaunchLateness().getMax());
+  ASSERT_EQ(2u, sequencer->getLaunchLateness(srClass).getCount());
+
+  // each packet is counted once
+  stamp.id = 1u;
+  backend->stamps.push_back(stamp);
+  sequencer->processTxTimestamps();
+  ASSERT_EQ(2u, stream->getLaunchLateness().getCount());
+
+  // the records of a removed stream are dropped
+  sequencer->recordTx(packet);
+  sequencer->invalidateTxRecords(stream);
+  ASSERT_TRUE(NULL == sequencer->mTxRecords[2].stream);
+  IasAvbPacketPool::returnPacket(packet);
+
+  IasAvbLatencyHistogram lateness;
+  ASSERT_TRUE(mTransmitEngine->getStreamLaunchLateness(streamID, lateness, false));
+  ASSERT_EQ(2u, lateness.getCount());
+  ASSERT_FALSE(mTransmitEngine->getStreamLaunchLateness(IasAvbStreamId(uint64_t(1u)), lateness, false));
+  ASSERT_TRUE(mTransmitEngine->getClassLaunchLateness(srClass, lateness, true));
+  ASSERT_EQ(2u, lateness.getCount());
+  ASSERT_TRUE(mTransmitEngine->getClassLaunchLateness(srClass, lateness, false));
+  ASSERT_EQ(0u, lateness.getCount());
+}
 
 // below test has to be moved out to separate file
 //TEST_F(IasTestAvbTransmitSequencer, serviceStreamENOSPC)
@@ -895,17 +1192,13 @@ TEST_F(IasTestAvbTransmitSequencer, reclaimPackets)
 //  IasAvbTransmitSequencer * sequencer = mTransmitEngine->getSequencerByStream(mTransmitEngine->mAvbStreams[streamID]);
 //  ASSERT_TRUE(NULL != sequencer);
 //  {
-//    sequencer->mLock.lock();
-//    sequencer->mRequestCount++;
-//    sequencer->mLock.unlock();
-//    IasAvbTransmitSequencer::AvbStreamDataList::iterator nextStreamToService = sequencer->mSequence.end();
-//    sequencer->updateSequence(nextStreamToService);
+//    sequencer->updateSequence();
 //    sleep(1);
 
 //    IasLibPtpDaemon * ptp = IasAvbStreamHandlerEnvironment::getPtpProxy();
 //    uint64_t now = ptp->getLocalTime();
 
-//    IasAvbTransmitSequencer::AvbStreamDataList::iterator nextStream = sequencer->mSequence.begin();
+//    IasAvbTransmitSequencer::StreamData * nextStream = &sequencer->mSequence.top();
 
 //    now = ptp->getLocalTime();
 //    (*nextStream).done = IasAvbTransmitSequencer::DoneState::eNotDone;
@@ -918,7 +1211,7 @@ TEST_F(IasTestAvbTransmitSequencer, reclaimPackets)
 //    struct tx_ring *txr = &adapter->tx_rings[sequencer->mQueueIndex];
 //    uint16_t tempTxAvail = txr->tx_avail;
 //    txr->tx_avail = 1u;
-//    ASSERT_EQ(IasAvbTransmitSequencer::DoneState::eNotDone, sequencer->serviceStream(now, nextStream));
+//    ASSERT_EQ(IasAvbTransmitSequencer::DoneState::eNotDone, sequencer->serviceStream(now));
 //    txr->tx_avail = tempTxAvail;
 //  }
 //}
@@ -0,0 +1,288 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file IasTestAvbTransmitSimulation.cpp
+ * @date 2018
+ * @brief Runs the TX path on the virtual clock with the in-memory transmit backend.
+ */
+
+#include "gtest/gtest.h"
+
+#define private public
+#define protected public
+#include "avb_streamhandler/IasAvbMemoryTransmitBackend.hpp"
+#include "avb_streamhandler/IasAvbPacketPool.hpp"
+#include "avb_streamhandler/IasAvbPacket.hpp"
+#include "avb_streamhandler/IasAvbStream.hpp"
+#include "avb_streamhandler/IasAvbTransmitSequencer.hpp"
+#include "avb_streamhandler/IasAvbTransmitEngine.hpp"
+#include "avb_streamhandler/IasAvbStreamHandlerEnvironment.hpp"
+#undef protected
+#undef private
+
+#include "avb_streamhandler/IasAvbPtpClockDomain.hpp"
+#include "lib_ptp_daemon/IasLibPtpDaemon.hpp"
+
+#include <chrono>
+#include <errno.h>
+#include <vector>
+
+extern size_t heapSpaceLeft;
+extern size_t heapSpaceInitSize;
+
+namespace IasMediaTransportAvb
+{
+
+namespace
+{
+
+const uint64_t cStart = 1000000000u;          // virtual start time in ns
+const uint64_t cDuration = 6000000000u;       // simulated time in ns
+const uint64_t cMeasureStart = cStart + 4000000000u;
+const uint64_t cMeasureEnd = cStart + cDuration - 100000000u;
+const uint32_t cHighStreams = 8u;
+const uint32_t cLowStreams = 4u;
+const uint32_t cHighSequencers = 2u;
+
+}
+
+
+class IasTestAvbTransmitSimulation : public ::testing::Test
+{
+protected:
+  /// @brief a packet seen by the in-memory backend, with the stream identified independent of the run
+  struct Trace
+  {
+    uint64_t  attime;
+    uint64_t  streamId;
+
+    bool operator==(const Trace &other) const
+    {
+      return (attime == other.attime) && (streamId == other.streamId);
+    }
+  };
+
+  IasTestAvbTransmitSimulation():
+    mEnvironment(NULL)
+  {
+    DLT_REGISTER_APP("IAAS", "AVB Streamhandler");
+  }
+
+  virtual ~IasTestAvbTransmitSimulation()
+  {
+    DLT_UNREGISTER_APP();
+  }
+
+  // Sets up the test fixture.
+  virtual void SetUp()
+  {
+    heapSpaceLeft = heapSpaceInitSize;
+
+    DLT_REGISTER_CONTEXT_LL_TS(mDltCtx,
+              "TEST",
+              "IasTestAvbTransmitSimulation",
+              DLT_LOG_INFO,
+              DLT_TRACE_STATUS_OFF);
+
+    createEnvironment();
+  }
+
+  virtual void TearDown()
+  {
+    destroyEnvironment();
+
+    heapSpaceLeft = heapSpaceInitSize;
+
+    DLT_UNREGISTER_CONTEXT(mDltCtx);
+  }
+
+  void createEnvironment()
+  {
+    mEnvironment = new IasAvbStreamHandlerEnvironment(DLT_LOG_INFO);
+    ASSERT_TRUE(NULL != mEnvironment);
+    mEnvironment->registerDltContexts();
+    mEnvironment->setDefaultConfigValues();
+    ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cXmitBackend, "memory"));
+    ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cPtpVirtualClock, cStart));
+    ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cXmitMemoryRecords, 262144u));
+    ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(
+        std::string(IasRegKeys::cXmitSeqCount) + "high", cHighSequencers));
+  }
+
+  void destroyEnvironment()
+  {
+    if (NULL != mEnvironment)
+    {
+      mEnvironment->unregisterDltContexts();
+      delete mEnvironment;
+      mEnvironment = NULL;
+    }
+  }
+
+  // runs the schedule for cDuration of virtual time, returns the packets of the measurement window per sequencer
+  void simulate(std::vector<std::vector<Trace> > &traces)
+  {
+    ASSERT_EQ(eIasAvbProcOK, mEnvironment->createIgbDevice());
+    ASSERT_TRUE(NULL == IasAvbStreamHandlerEnvironment::getIgbDevice());
+    ASSERT_EQ(eIasAvbProcOK, mEnvironment->createPtpProxy());
+    IasLibPtpDaemon *ptp = IasAvbStreamHandlerEnvironment::getPtpProxy();
+    ASSERT_TRUE(NULL != ptp);
+    ASSERT_TRUE(ptp->isVirtualClock());
+
+    // the clock domain has to outlive the streams
+    IasAvbPtpClockDomain clockDomain;
+    IasAvbTransmitEngine engine;
+    ASSERT_EQ(eIasAvbProcOK, engine.init());
+    const IasAvbMacAddress destMacAddr = {0};
+
+    for (uint32_t i = 0u; i < (cHighStreams + cLowStreams); i++)
+    {
+      const IasAvbSrClass srClass = (i < cHighStreams) ? IasAvbSrClass::eIasAvbSrClassHigh : IasAvbSrClass::eIasAvbSrClassLow;
+      const IasAvbStreamId streamId(uint64_t(i + 1u));
+      ASSERT_EQ(eIasAvbProcOK, engine.createTransmitAudioStream(srClass, 2u, 48000u,
+          IasAvbAudioFormat::eIasAvbAudioFormatSaf16, &clockDomain, streamId, destMacAddr, true));
+      ASSERT_EQ(eIasAvbProcOK, engine.activateAvbStream(streamId));
+    }
+
+    // this thread drives the virtual clock along with the sequencers, so it wakes up at the end of the schedule
+    ptp->attachVirtualClock();
+    const std::chrono::steady_clock::time_point wallStart = std::chrono::steady_clock::now();
+    ASSERT_EQ(eIasAvbProcOK, engine.start());
+    ASSERT_EQ(0, ptp->sleepUntil(cStart + cDuration));
+    ptp->detachVirtualClock();
+    ASSERT_EQ(eIasAvbProcOK, engine.stop());
+    const std::chrono::steady_clock::duration wall = std::chrono::steady_clock::now() - wallStart;
+    RecordProperty("wallTimeMs", int(std::chrono::duration_cast<std::chrono::milliseconds>(wall).count()));
+
+    traces.clear();
+    for (uint32_t i = 0u; i < IasAvbTransmitEngine::cMaxSequencers; i++)
+    {
+      IasAvbTransmitSequencer *seq = engine.mSequencers[i];
+      if (NULL != seq)
+      {
+        IasAvbMemoryTransmitBackend *backend = dynamic_cast<IasAvbMemoryTransmitBackend*>(seq->mBackend);
+        ASSERT_TRUE(NULL != backend);
+
+        // each sequencer hands its packets over in launch time order
+        const IasAvbMemoryTransmitBackend::Stats &stats = backend->getStats();
+        ASSERT_LT(0u, stats.packets);
+        ASSERT_EQ(0u, stats.reordered);
+
+        std::vector<IasAvbMemoryTransmitBackend::Record> records;
+        backend->getRecords(records);
+        ASSERT_FALSE(records.empty());
+        ASSERT_GT(cMeasureStart, records.front().attime);
+
+        traces.push_back(std::vector<Trace>());
+        for (std::vector<IasAvbMemoryTransmitBackend::Record>::const_iterator it = records.begin(); it != records.end(); it++)
+        {
+          if ((it->attime >= cMeasureStart) && (it->attime < cMeasureEnd))
+          {
+            ASSERT_TRUE(NULL != it->stream);
+            Trace trace;
+            trace.attime = it->attime;
+            trace.streamId = uint64_t(it->stream->getStreamId());
+            traces.back().push_back(trace);
+          }
+        }
+      }
+    }
+  }
+
+  IasAvbStreamHandlerEnvironment* mEnvironment;
+  DltContext mDltCtx;
+};
+
+
+TEST_F(IasTestAvbTransmitSimulation, memoryBackend)
+{
+  IasAvbMemoryTransmitBackend backend(mDltCtx);
+  IasAvbPacket packet;
+  ASSERT_EQ(-ENXIO, backend.xmit(&packet));
+
+  ASSERT_EQ(IasAvbResult::eIasAvbResultOk, mEnvironment->setConfigValue(IasRegKeys::cXmitMemoryRecords, 3u));
+  ASSERT_EQ(eIasAvbProcOK, backend.init(0u, IasAvbSrClass::eIasAvbSrClassHigh));
+  ASSERT_EQ(eIasAvbProcInitializationFailed, backend.init(0u, IasAvbSrClass::eIasAvbSrClassHigh));
+
+  // without igb device, the pool takes its pages from the heap
+  IasAvbPacketPool pool(mDltCtx);
+  ASSERT_EQ(eIasAvbProcOK, pool.init(128u, 4u));
+  ASSERT_FALSE(pool.mAllocator->isDmaCapable());
+
+  const uint64_t launch[4] = { 100u, 200u, 150u, 300u };
+  for (uint32_t i = 0u; i < 4u; i++)
+  {
+    IasAvbPacket *p = pool.getPacket();
+    ASSERT_TRUE(NULL != p);
+    p->len = 64u + i;
+    p->attime = launch[i];
+    ASSERT_EQ(0, backend.xmit(p));
+  }
+  ASSERT_EQ(0u, pool.mFreeBufferStack.size());
+
+  const IasAvbMemoryTransmitBackend::Stats &stats = backend.getStats();
+  ASSERT_EQ(4u, stats.packets);
+  ASSERT_EQ(4u * 64u + 6u, stats.bytes);
+  ASSERT_EQ(1u, stats.reordered);
+  ASSERT_EQ(100u, stats.firstLaunch);
+  ASSERT_EQ(300u, stats.lastLaunch);
+
+  // only the last three are kept
+  std::vector<IasAvbMemoryTransmitBackend::Record> records;
+  backend.getRecords(records);
+  ASSERT_EQ(3u, records.size());
+  ASSERT_EQ(200u, records[0].attime);
+  ASSERT_EQ(150u, records[1].attime);
+  ASSERT_EQ(300u, records[2].attime);
+  ASSERT_EQ(67u, records[2].length);
+
+  ASSERT_EQ(4u, backend.reclaimPackets());
+  ASSERT_EQ(4u, pool.mFreeBufferStack.size());
+  ASSERT_EQ(0u, backend.reclaimPackets());
+
+  backend.cleanup();
+  ASSERT_EQ(-ENXIO, backend.xmit(&packet));
+}
+
+TEST_F(IasTestAvbTransmitSimulation, schedule)
+{
+  std::vector<std::vector<Trace> > traces;
+  simulate(traces);
+  ASSERT_FALSE(HasFatalFailure());
+  ASSERT_EQ(cHighSequencers + 1u, traces.size());
+
+  // every stream sends one packet per class measurement interval
+  std::vector<uint64_t> counts(cHighStreams + cLowStreams + 1u, 0u);
+  for (size_t i = 0u; i < traces.size(); i++)
+  {
+    for (size_t j = 0u; j < traces[i].size(); j++)
+    {
+      ASSERT_LT(traces[i][j].streamId, counts.size());
+      counts[traces[i][j].streamId]++;
+    }
+  }
+
+  const double window = double(cMeasureEnd - cMeasureStart);
+  for (uint32_t id = 1u; id <= (cHighStreams + cLowStreams); id++)
+  {
+    const double interval = (id <= cHighStreams) ? 125000.0 : 250000.0;
+    ASSERT_NEAR(window / interval, double(counts[id]), 2.0) << "stream " << id;
+  }
+
+  // the same schedule gives the same packet sequence
+  destroyEnvironment();
+  createEnvironment();
+  std::vector<std::vector<Trace> > again;
+  simulate(again);
+  ASSERT_FALSE(HasFatalFailure());
+  ASSERT_EQ(traces.size(), again.size());
+  for (size_t i = 0u; i < traces.size(); i++)
+  {
+    ASSERT_TRUE(traces[i] == again[i]) << "sequencer " << i;
+  }
+}
+
+} // namespace IasMediaTransportAvb
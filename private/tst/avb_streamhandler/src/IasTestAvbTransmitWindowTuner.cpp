@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2018 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+*/
+/**
+ * @file IasTestAvbTransmitWindowTuner.cpp
+ * @date 2018
+ */
+
+#include "gtest/gtest.h"
+
+#define private public
+#define protected public
+#include "avb_streamhandler/IasAvbTransmitWindowTuner.hpp"
+#undef protected
+#undef private
+
+using namespace IasMediaTransportAvb;
+
+namespace
+{
+
+const uint64_t cStep = 125000u;
+
+}
+
+
+class IasTestAvbTransmitWindowTuner : public ::testing::Test
+{
+protected:
+  IasTestAvbTransmitWindowTuner() :
+    mTuner(NULL)
+  {
+  }
+
+  virtual ~IasTestAvbTransmitWindowTuner() {}
+
+  // Sets up the test fixture.
+  virtual void SetUp()
+  {
+    mTuner = new IasAvbTransmitWindowTuner();
+  }
+
+  virtual void TearDown()
+  {
+    delete mTuner;
+    mTuner = NULL;
+  }
+
+  // runs a number of cycles with the same measurements, checks the slack covers the lag in each cycle
+  void run(uint32_t cycles, uint64_t lag, uint32_t dryCount)
+  {
+    for (uint32_t i = 0u; i < cycles; i++)
+    {
+      mTuner->update(lag, dryCount);
+      ASSERT_LE(mTuner->getPitch() + lag, mTuner->getWidth());
+      ASSERT_LE(mTuner->getWidth(), mTuner->mConfig.widthMax);
+      ASSERT_GE(mTuner->getPitch(), mTuner->mConfig.pitchMin);
+      ASSERT_LE(mTuner->getPitch(), mTuner->mConfig.pitchMax);
+    }
+  }
+
+  IasAvbTransmitWindowTuner *mTuner;
+};
+
+
+TEST_F(IasTestAvbTransmitWindowTuner, CTor_DTor)
+{
+  ASSERT_TRUE(mTuner != NULL);
+  ASSERT_EQ(24u * cStep, mTuner->getWidth());
+  ASSERT_EQ(16u * cStep, mTuner->getPitch());
+}
+
+TEST_F(IasTestAvbTransmitWindowTuner, init)
+{
+  IasAvbTransmitWindowTuner::Config config;
+
+  config.pitchMin = 0u;
+  ASSERT_EQ(eIasAvbProcInvalidParam, mTuner->init(config));
+  config = IasAvbTransmitWindowTuner::Config();
+  config.pitchMax = config.pitchInit - 1u;
+  ASSERT_EQ(eIasAvbProcInvalidParam, mTuner->init(config));
+  config = IasAvbTransmitWindowTuner::Config();
+  config.widthMax = config.widthInit - 1u;
+  ASSERT_EQ(eIasAvbProcInvalidParam, mTuner->init(config));
+  config = IasAvbTransmitWindowTuner::Config();
+  config.widthInit = config.pitchInit - 1u;
+  ASSERT_EQ(eIasAvbProcInvalidParam, mTuner->init(config));
+
+  config = IasAvbTransmitWindowTuner::Config();
+  config.widthInit = 8u * cStep;
+  config.pitchInit = 4u * cStep;
+  ASSERT_EQ(eIasAvbProcOK, mTuner->init(config));
+  ASSERT_EQ(8u * cStep, mTuner->getWidth());
+  ASSERT_EQ(4u * cStep, mTuner->getPitch());
+}
+
+TEST_F(IasTestAvbTransmitWindowTuner, shrinkWhenQuiet)
+{
+  // the initial slack is given up slowly
+  const uint64_t widthInit = mTuner->getWidth();
+  run(10u, 10000u, 0u);
+  ASSERT_LT(mTuner->getWidth(), widthInit);
+  ASSERT_GT(mTuner->getWidth(), widthInit - cStep);
+
+  run(5000u, 10000u, 0u);
+  ASSERT_EQ(mTuner->getPitch() + mTuner->mConfig.minSlack, mTuner->getWidth());
+}
+
+TEST_F(IasTestAvbTransmitWindowTuner, widenUnderLoad)
+{
+  run(5000u, 10000u, 0u);
+  const uint64_t widthQuiet = mTuner->getWidth();
+
+  // a single late wakeup widens the window at once
+  run(1u, 800000u, 0u);
+  ASSERT_EQ(16u * cStep + 1200000u, mTuner->getWidth());
+  ASSERT_GT(mTuner->getWidth(), widthQuiet);
+
+  // and it stays wide for a while
+  run(10u, 10000u, 0u);
+  ASSERT_GT(mTuner->getWidth(), 16u * cStep + 1100000u);
+
+  // if the slack does not fit, the pitch gives way
+  run(1u, 3000000u, 0u);
+  ASSERT_EQ(mTuner->mConfig.widthMax, mTuner->getWidth());
+  ASSERT_EQ(mTuner->mConfig.widthMax - 4500000u, mTuner->getPitch());
+
+  // beyond the bounds, the window is as wide as allowed
+  mTuner->update(10000000u, 0u);
+  ASSERT_EQ(mTuner->mConfig.widthMax, mTuner->getWidth());
+  ASSERT_EQ(mTuner->mConfig.pitchMin, mTuner->getPitch());
+}
+
+TEST_F(IasTestAvbTransmitWindowTuner, pitch)
+{
+  IasAvbTransmitWindowTuner::Config config;
+  config.pitchMax = 20u * cStep;
+  config.growCycles = 10u;
+  ASSERT_EQ(eIasAvbProcOK, mTuner->init(config));
+
+  // the pitch grows while no stream runs dry
+  run(10u, 10000u, 0u);
+  ASSERT_EQ(17u * cStep, mTuner->getPitch());
+  run(100u, 10000u, 0u);
+  ASSERT_EQ(20u * cStep, mTuner->getPitch());
+
+  // and goes back to the configured one if streams run dry
+  run(1u, 10000u, 1u);
+  ASSERT_EQ(19u * cStep, mTuner->getPitch());
+  run(10u, 10000u, 2u);
+  ASSERT_EQ(16u * cStep, mTuner->getPitch());
+
+  mTuner->reset();
+  ASSERT_EQ(24u * cStep, mTuner->getWidth());
+  ASSERT_EQ(16u * cStep, mTuner->getPitch());
+}
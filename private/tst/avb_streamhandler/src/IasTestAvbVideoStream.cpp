@@ -931,9 +931,7 @@ TEST_F(IasTestAvbVideoStream, prepareAllPackets)
                                                          dmac,
                                                          preconfigured));
   IasAvbPacketPool * mPool = &mAvbVideoStream->getPacketPool();
-  mPool->mLock.lock();
   mPool->mFreeBufferStack.clear();
-  mPool->mLock.unlock();
   // NULL == referencePacket
   ASSERT_EQ(eIasAvbProcInitializationFailed, mAvbVideoStream->prepareAllPackets());
 }
@@ -19,6 +19,10 @@
 
 #include "test_common/IasSpringVilleInfo.hpp"
 
+#include <mutex>
+#include <thread>
+#include <vector>
+
 namespace IasMediaTransportAvb{
 
 class IasTestLibPtpDaemon : public ::testing::Test
@@ -331,4 +335,61 @@ TEST_F(IasTestLibPtpDaemon, ptpToSys_invalid_params)
   ASSERT_TRUE(0u == libPtpDaemon->ptpToSys(0));
 }
 
+TEST_F(IasTestLibPtpDaemon, virtualClock)
+{
+  ASSERT_TRUE(NULL != libPtpDaemon);
+  ASSERT_FALSE(libPtpDaemon->isVirtualClock());
+  ASSERT_EQ(eIasAvbProcInvalidParam, libPtpDaemon->initVirtualClock(0u));
+
+  const uint64_t cStart = 1000000000u;
+  ASSERT_EQ(eIasAvbProcOK, libPtpDaemon->initVirtualClock(cStart));
+  ASSERT_EQ(eIasAvbProcInitializationFailed, libPtpDaemon->initVirtualClock(cStart));
+  ASSERT_TRUE(libPtpDaemon->isVirtualClock());
+  ASSERT_TRUE(libPtpDaemon->isPtpReady());
+  ASSERT_EQ(cStart, libPtpDaemon->getLocalTime());
+  ASSERT_EQ(cStart, libPtpDaemon->getSysTime());
+  ASSERT_EQ(cStart + 5u, libPtpDaemon->ptpToSys(cStart + 5u));
+  ASSERT_EQ(cStart + 5u, libPtpDaemon->sysToPtp(cStart + 5u));
+
+  // nobody else attached: the clock jumps to the wakeup time at once
+  ASSERT_EQ(0, libPtpDaemon->sleepUntil(cStart + 3600000000000u));
+  ASSERT_EQ(cStart + 3600000000000u, libPtpDaemon->getLocalTime());
+  ASSERT_EQ(0, libPtpDaemon->sleepUntil(cStart));
+  ASSERT_EQ(cStart + 3600000000000u, libPtpDaemon->getLocalTime());
+
+  // two attached threads take turns in wakeup order
+  const uint64_t base = libPtpDaemon->getSysTime();
+  std::vector<uint64_t> wakeups;
+  std::mutex lock;
+  libPtpDaemon->attachVirtualClock();
+  libPtpDaemon->attachVirtualClock();
+  std::thread other([&]() {
+    for (uint64_t t = base + 3u; t <= base + 30u; t += 3u)
+    {
+      ASSERT_EQ(0, libPtpDaemon->sleepUntil(t));
+      std::lock_guard<std::mutex> guard(lock);
+      wakeups.push_back(libPtpDaemon->getSysTime());
+    }
+    libPtpDaemon->detachVirtualClock();
+  });
+  for (uint64_t t = base + 2u; t <= base + 20u; t += 2u)
+  {
+    ASSERT_EQ(0, libPtpDaemon->sleepUntil(t));
+    std::lock_guard<std::mutex> guard(lock);
+    wakeups.push_back(libPtpDaemon->getSysTime());
+  }
+  libPtpDaemon->detachVirtualClock();
+  other.join();
+
+  ASSERT_EQ(20u, wakeups.size());
+  for (size_t i = 1u; i < wakeups.size(); i++)
+  {
+    ASSERT_LE(wakeups[i - 1u], wakeups[i]);
+  }
+  ASSERT_EQ(base + 30u, libPtpDaemon->getSysTime());
+
+  libPtpDaemon->cleanUp();
+  ASSERT_FALSE(libPtpDaemon->isVirtualClock());
+}
+
 } // namespace
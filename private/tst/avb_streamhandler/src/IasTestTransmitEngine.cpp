@@ -896,5 +896,86 @@ TEST_F(IasTestTransmitEngine, disconnectStreams)
   delete clockDomain;
 }
 
+TEST_F(IasTestTransmitEngine, sequencerTopology)
+{
+  ASSERT_TRUE(LocalSetup());
+  // libigb has one Qav queue per class
+  mEnvironment->setConfigValue(std::string(IasRegKeys::cXmitSeqCount) + "high", 2u);
+  mEnvironment->setConfigValue(IasRegKeys::cXmitSeqMaxStreams, 1u);
+  ASSERT_EQ(eIasAvbProcOK, mTransmitEngine->init());
+  ASSERT_EQ(1u, mTransmitEngine->mMaxStreamsPerSequencer);
+  ASSERT_EQ(eIasAvbProcInvalidParam, mTransmitEngine->createSequencerOnDemand(IasAvbSrClass::eIasAvbSrClassHigh));
+  ASSERT_TRUE(NULL == mTransmitEngine->getSequencerByClass(IasAvbSrClass::eIasAvbSrClassHigh));
+
+  mEnvironment->setConfigValue(std::string(IasRegKeys::cXmitSeqCount) + "high", 0u);
+  ASSERT_EQ(eIasAvbProcInvalidParam, mTransmitEngine->createSequencerOnDemand(IasAvbSrClass::eIasAvbSrClassHigh));
+
+  mEnvironment->setConfigValue(std::string(IasRegKeys::cXmitSeqCount) + "high", 1u);
+  IasAvbPtpClockDomain *clockDomain = new IasAvbPtpClockDomain();
+  IasAvbStreamId firstId(uint64_t(1u));
+  IasAvbStreamId secondId(uint64_t(2u));
+  ASSERT_EQ(eIasAvbProcOK, createProperAudioStream(clockDomain, firstId));
+  IasAvbTransmitSequencer *seq = mTransmitEngine->getSequencerByStream(mTransmitEngine->mAvbStreams[firstId]);
+  ASSERT_TRUE(NULL != seq);
+  ASSERT_EQ(0u, seq->getQueueIndex());
+
+  // the only sequencer of the class is full
+  ASSERT_EQ(eIasAvbProcNoSpaceLeft, createProperAudioStream(clockDomain, secondId));
+  ASSERT_TRUE(mTransmitEngine->mAvbStreams.end() == mTransmitEngine->mAvbStreams.find(secondId));
+
+  ASSERT_EQ(eIasAvbProcOK, mTransmitEngine->destroyAvbStream(firstId));
+  ASSERT_TRUE(mTransmitEngine->mStreamSequencers.empty());
+  ASSERT_EQ(eIasAvbProcOK, createProperAudioStream(clockDomain, secondId));
+  ASSERT_EQ(seq, mTransmitEngine->getSequencerByStream(mTransmitEngine->mAvbStreams[secondId]));
+
+  delete clockDomain;
+}
+
+TEST_F(IasTestTransmitEngine, placeStream)
+{
+  ASSERT_TRUE(LocalSetup());
+  ASSERT_EQ(eIasAvbProcOK, mTransmitEngine->init());
+  ASSERT_EQ(eIasAvbProcOK, mTransmitEngine->createSequencerOnDemand(IasAvbSrClass::eIasAvbSrClassHigh));
+
+  // a second sequencer of the class, as created with the socket backend
+  IasAvbTransmitSequencer *first = mTransmitEngine->mSequencers[0];
+  IasAvbTransmitSequencer *second = new IasAvbTransmitSequencer(mDltCtx);
+  second->mClass = IasAvbSrClass::eIasAvbSrClassHigh;
+  mTransmitEngine->mSequencers[1] = second;
+
+  IasAvbPtpClockDomain *clockDomain = new IasAvbPtpClockDomain();
+  IasAvbTransmitSequencer *placed[4] = { NULL, NULL, NULL, NULL };
+  for (uint32_t i = 0u; i < 4u; i++)
+  {
+    IasAvbStreamId streamId(uint64_t(i + 1u));
+    ASSERT_EQ(eIasAvbProcOK, createProperAudioStream(clockDomain, streamId));
+    placed[i] = mTransmitEngine->getSequencerByStream(mTransmitEngine->mAvbStreams[streamId]);
+  }
+
+  // equal streams alternate, on equal load the first sequencer wins
+  ASSERT_EQ(first, placed[0]);
+  ASSERT_EQ(second, placed[1]);
+  ASSERT_EQ(first, placed[2]);
+  ASSERT_EQ(second, placed[3]);
+
+  // the next stream fills the gap
+  IasAvbStreamId fifthId(uint64_t(5u));
+  ASSERT_EQ(eIasAvbProcOK, mTransmitEngine->destroyAvbStream(IasAvbStreamId(uint64_t(2u))));
+  ASSERT_EQ(eIasAvbProcOK, createProperAudioStream(clockDomain, fifthId));
+  ASSERT_EQ(second, mTransmitEngine->getSequencerByStream(mTransmitEngine->mAvbStreams[fifthId]));
+
+  // the low class gets its own sequencer
+  IasAvbStreamId lowId(uint64_t(6u));
+  IasAvbMacAddress destMacAddr = {0};
+  ASSERT_EQ(eIasAvbProcOK, mTransmitEngine->createTransmitAudioStream(IasAvbSrClass::eIasAvbSrClassLow, 2u, 48000u,
+      IasAvbAudioFormat::eIasAvbAudioFormatSaf16, clockDomain, lowId, destMacAddr, true));
+  IasAvbTransmitSequencer *low = mTransmitEngine->getSequencerByStream(mTransmitEngine->mAvbStreams[lowId]);
+  ASSERT_TRUE(NULL != low);
+  ASSERT_EQ(IasAvbSrClass::eIasAvbSrClassLow, low->getClass());
+  ASSERT_EQ(low, mTransmitEngine->mSequencers[2]);
+
+  delete clockDomain;
+}
+
 } // namespace IasMediaTransportAvb
 